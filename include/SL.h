@@ -41,7 +41,9 @@
 #include <math.h>                // for math functions
 #include <string.h>              // for string functions
 //-----------------------------------------------------------------------------
-// Half precision floating point type
+// Half precision floating point type. Round to nearest breaks ties to even
+// like the F16C and NEON conversions (see SLGLVertexBuffer::encode).
+#define HALF_ROUND_TIES_TO_EVEN 1
 #include <half.hpp>
 using namespace half_float;
 
@@ -285,6 +287,8 @@ class SL
                                                  const SLint line, 
                                                  const SLchar* file);
     static SLuint           maxThreads          ();
+    static SLbool           isWorkerThread      ();
+    static void             isWorkerThread      (SLbool isWorker);
     static SLstring         getCWD              ();
     static void             parseCmdLineArgs    (SLVstring& cmdLineArgs);
     static SLbool           noTestIsRunning     (){return (SLint)testScene == -1;}
@@ -16,9 +16,10 @@
 //-----------------------------------------------------------------------------
 //! SLAccelStruct is an abstract base class for acceleration structures
 /*! The SLAccelStruct class serves as common class for the SLUniformGrid,
-SLCompactGrid and the SLKDTree class. All derived acceleration structures must
-be able to build, draw, intersect with a ray and update statistics.
-All structures work on meshes.
+SLCompactGrid, SLBVH and the SLKDTree class. All derived acceleration structures
+must be able to build, draw, intersect with a ray and update statistics.
+All structures work on meshes. Structures that can follow moving vertices of
+the same triangles without a full build override refit.
 */
 class SLAccelStruct
 {
@@ -31,6 +32,9 @@ class SLAccelStruct
         virtual void        draw           (SLSceneView* sv) = 0;
         virtual SLbool      intersect      (SLRay* ray, SLNode* node) = 0;
         virtual void        disposeBuffers () = 0;
+
+        //! Updates for moved vertices. Returns false if a build is needed.
+        virtual SLbool      refit          () {return false;}
    
     protected:
                 SLMesh*     _m;             //!< Pointer to the mesh
@@ -18,6 +18,16 @@
 #include <SLAnimPlayback.h>
 #include <SLSkeleton.h>
 
+//-----------------------------------------------------------------------------
+//! Animated node with its transform before and after the last animation step
+struct SLAnimPose
+{   SLNode*     node;           //!< animated node or joint
+    SLSkeleton* skeleton;       //!< skeleton of the joint or nullptr
+    SLMat4f     prevOM;         //!< object matrix before the last step
+    SLMat4f     currOM;         //!< object matrix after the last step
+    SLbool      isMoving;       //!< flag if prevOM and currOM differ
+};
+typedef vector<SLAnimPose> SLVAnimPose;
 //-----------------------------------------------------------------------------
 //! SLAnimManager is the central class for all animation handling.
 /*!   
@@ -27,6 +37,13 @@ If keeps a list of all skeletons and node animations and also holds a list of
 all animation playback controllers.
 The update of all animations is done before the rendering of all SLSceneView in
 SLScene::updateIfAllViewsGotPainted by calling the SLAnimManager::update.
+\n
+With a fixed simulation time step SLScene calls update zero or more times per
+frame. To render a smooth motion in between two steps storePreviousPose saves
+the object matrices of all animated nodes and joints before the last step and
+interpolatePose blends them with the result of the step. restoreCurrentPose
+puts back the unblended result before the next step, so the interpolation
+never feeds back into the simulation.
 */
 class SLAnimManager
 {
@@ -46,6 +63,9 @@ public:
     SLVSkeleton&    skeletons           () { return _skeletons; }
 
     SLbool          update              (SLfloat elapsedTimeSec);
+    void            storePreviousPose   ();
+    SLbool          interpolatePose     (SLfloat alpha);
+    SLbool          restoreCurrentPose  ();
     void            drawVisuals         (SLSceneView* sv);
     void            clear               ();
 
@@ -53,6 +73,7 @@ private:
     SLVSkeleton     _skeletons;         //!< all skeleton instances
     SLMAnimation    _nodeAnimations;    //!< node animations
     SLMAnimPlayback _nodeAnimPlaybacks; //!< node animation playbacks
+    SLVAnimPose     _poses;             //!< animated nodes for the interpolation
 };
 //-----------------------------------------------------------------------------
 #endif
@@ -32,7 +32,7 @@ class SLAnimTrack
 {
 public:
                         SLAnimTrack             (SLAnimation* parent);
-                       ~SLAnimTrack             ();
+    virtual            ~SLAnimTrack             ();
 
             SLKeyframe* createKeyframe          (SLfloat time);   // create and add a new keyframe
             SLfloat     getKeyframesAtTime      (SLfloat time,
@@ -63,6 +63,8 @@ protected:
 */
 class SLNodeAnimTrack : public SLAnimTrack
 {
+    SL_MEMPOOL_CLASS(SLNodeAnimTrack)
+
 public:
                         SLNodeAnimTrack         (SLAnimation* parent);
                        ~SLNodeAnimTrack         ();
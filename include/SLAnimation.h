@@ -75,6 +75,7 @@ public:
     // Getters
     const   SLstring&   name            () { return _name; }
             SLfloat     lengthSec       () const { return _lengthSec; }
+    const   SLMNodeAnimTrack& nodeAnimTracks() const { return _nodeAnimTracks; }
 
     // Setters
             void        name            (const SLstring& name) { _name = name; }
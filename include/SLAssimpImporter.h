@@ -34,13 +34,18 @@ supported file formats and the import processing options.
 class SLAssimpImporter : public SLImporter
 {
     public:
-                SLAssimpImporter() {}
+                SLAssimpImporter() : _useCache(false) {}
                 SLAssimpImporter(SLLogVerbosity consoleVerb)
-                    : SLImporter(consoleVerb) { }
+                    : SLImporter(consoleVerb), _useCache(false) { }
                 SLAssimpImporter(const SLstring& logFile,
                                  SLLogVerbosity logConsoleVerb = LV_normal,
                                  SLLogVerbosity logFileVerb = LV_diagnostic)
-                    : SLImporter(logFile, logConsoleVerb, logFileVerb) { }
+                    : SLImporter(logFile, logConsoleVerb, logFileVerb),
+                      _useCache(false) { }
+
+            //! If true the import is read from & written to an SLMeshCache file
+            void        useCache(SLbool use) {_useCache = use;}
+            SLbool      useCache() const {return _useCache;}
 
             SLNode*     load    (SLstring pathFilename,
                                 SLbool loadMeshesOnly = true,
@@ -86,9 +91,22 @@ protected:
     // SL type containers
     typedef std::vector<SLMesh*>        MeshList;
 
+    SLbool      _useCache;          //!< flag if the binary mesh cache is used
     SLuint      _jointIndex;        //!< index counter used when iterating over joints
     MeshList	_skinnedMeshes;     //!< list containing all of the skinned meshes, used to assign the skinned materials
 
+    // parallel loading
+    typedef std::map<SLstring, SLGLTexture*> SLTextureMap;
+    typedef std::vector<std::function<void()>> SLVJob;
+
+    SLTextureMap    _textureMap;        //!< map from texture file to texture for sharing
+    SLVGLTexture    _deferredTextures;  //!< new textures with images not yet loaded
+    SLVJob          _jobs;              //!< loading jobs executed in loadParallel
+    atomic<SLuint>  _nextJob;           //!< index of the next job to execute
+    atomic<SLuint>  _jobsDone;          //!< NO. of finished jobs
+    vector<vector<SLVuint>> _lodIndices; //!< LOD index sets per mesh for the mesh cache
+    vector<SLVfloat>        _lodErrors;  //!< LOD errors per mesh for the mesh cache
+
 
     // loading helper
     aiNode*         getNodeByName(const SLstring& name);    // return an aiNode ptr if name exists, or null if it doesn't
@@ -103,7 +121,12 @@ protected:
 
     SLMaterial*     loadMaterial(SLint index, aiMaterial* material, SLstring modelPath);
     SLGLTexture*    loadTexture(SLstring &path, SLTextureType texType);
-    SLMesh*         loadMesh(aiMesh *mesh);
+    SLMesh*         createMesh(aiMesh *mesh);
+    void            loadMesh(aiMesh *mesh, SLMesh* m);
+    SLbool          loadJoints(aiMesh *mesh, SLMesh* m);
+    void            loadParallel();
+    void            generateLODs();
+    void            runJobs(const bool isMainThread);
     SLNode*         loadNodesRec(SLNode *curNode, aiNode *aiNode, SLMeshMap& meshes, SLbool loadMeshesOnly = true);
     SLAnimation*    loadAnimation(aiAnimation* anim);
     SLstring        checkFilePath(SLstring modelPath, SLstring texFile);
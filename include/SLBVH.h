@@ -0,0 +1,93 @@
+//#############################################################################
+//  File:      SLBVH.h
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLBVH_H
+#define SLBVH_H
+
+#include <stdafx.h>
+#include <SLAccelStruct.h>
+#include <SLGLVertexArrayExt.h>
+
+//-----------------------------------------------------------------------------
+//! Max. NO. of triangles in a leaf node
+#define SL_BVH_MAX_LEAF_TRIS 8
+//! Max. depth of the tree (size of the traversal stack)
+#define SL_BVH_MAX_DEPTH 64
+//! Factor of SAH cost growth after a refit that triggers a rebuild
+#define SL_BVH_REBUILD_RATIO 1.5f
+//-----------------------------------------------------------------------------
+//! Node of the bounding volume hierarchy with 32 bytes
+/*! For inner nodes count is 0 and first is the index of the left child. The
+right child always follows the left one. For leaf nodes first is the offset
+into the triangle index array and count the NO. of triangles.
+*/
+struct SLBVHNode
+{   SLVec3f     min;        //!< min. point of AABB
+    SLuint      first;      //!< left child or first triangle index
+    SLVec3f     max;        //!< max. point of AABB
+    SLuint      count;      //!< NO. of triangles (0 for inner nodes)
+};
+typedef vector<SLBVHNode> SLVBVHNode;
+//-----------------------------------------------------------------------------
+//! Refittable bounding volume hierarchy for deforming meshes
+/*!
+SLBVH is the acceleration structure for skinned meshes whose vertices move
+every frame while the triangles stay the same. SLBVH::build creates a binary
+tree with a binned surface area heuristic (SAH). The children of a node are
+always stored after their parent.
+\n
+SLBVH::refit keeps the tree and only updates the node bounds with the moved
+vertices in finalP: First the leaf bounds from their triangles in parallel and
+then the inner nodes bottom-up by walking the node array backwards. A refit
+tree is correct but its quality drops the more the triangles of a node move
+apart. The SAH cost relative to the surface of the root is therefore compared
+with the cost after the last build and refit returns false if it grew by more
+than SL_BVH_REBUILD_RATIO. SLMesh::updateAccelStruct then rebuilds the tree.
+*/
+class SLBVH : public SLAccelStruct
+{
+    public:
+                    SLBVH               (SLMesh* m);
+                   ~SLBVH               (){;}
+
+        void        build               (SLVec3f minV, SLVec3f maxV);
+        SLbool      refit               ();
+        void        updateStats         (SLNodeStats &stats);
+        void        draw                (SLSceneView* sv);
+        SLbool      intersect           (SLRay* ray, SLNode* node);
+
+        void        deleteAll           ();
+        void        disposeBuffers      (){if (_vao.id()) _vao.clearAttribs();}
+
+        // Getters
+        SLuint      numNodes            () const {return (SLuint)_nodes.size();}
+        SLuint      numLeaves           () const {return (SLuint)_leaves.size();}
+        SLfloat     buildCost           () const {return _buildCost;}
+        SLfloat     cost                () const {return _cost;}
+        SLuint      numRefits           () const {return _numRefits;}
+        SLuint      numBuilds           () const {return _numBuilds;}
+
+    private:
+        SLuint      triIndex            (SLuint t, SLuint corner) const;
+        void        refitLeaves         (SLuint firstLeaf, SLuint endLeaf);
+        SLfloat     refitInnerNodes     ();
+
+        SLuint      _numTriangles;      //!< NO. of triangles at the last build
+        SLVBVHNode  _nodes;             //!< Nodes with the root at index 0
+        SLVuint     _leaves;            //!< Indices of all leaf nodes
+        SLVuint     _triangles;         //!< Triangle indices of all leaves
+        SLfloat     _buildCost;         //!< SAH cost after the last build
+        SLfloat     _cost;              //!< SAH cost after the last refit
+        SLuint      _numRefits;         //!< NO. of refits since the last build
+        SLuint      _numBuilds;         //!< NO. of builds
+        SLGLVertexArrayExt  _vao;       //!< Vertex array object for rendering
+};
+//-----------------------------------------------------------------------------
+#endif //SLBVH_H
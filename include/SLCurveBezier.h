@@ -15,12 +15,22 @@
 #include <SLMat4.h>
 #include <SLGLVertexArrayExt.h>
 
+//-----------------------------------------------------------------------------
+//! NO. of arc length table intervals per curve segment
+#define SL_BEZIER_ARCLEN_SAMPLES 16
 //-----------------------------------------------------------------------------
 //!The SLCurveBezier class implements a Bezier curve interpolation
 /*!The SLCurveBezier class implements a Bezier curve interpolation. The math
 is originally based on the implementation from the book:
 "Essential Mathematics for Games and Interactive Applications" from 
 James M. Van Verth and Lars M. Bishop.
+\n
+For fast arc length queries init builds a table with the arc length from the
+curve start at SL_BEZIER_ARCLEN_SAMPLES+1 equidistant parameters per segment.
+The segment of a time is found by binary search over the point times.
+arcLength and findParamByDist look up the table and only measure the short
+rest within one table interval. If the control points get changed
+buildArcLengthTable must be called again.
 */
 class SLCurveBezier : public SLCurve
 {
@@ -48,13 +58,19 @@ class SLCurveBezier : public SLCurve
                                      const SLVec3f& P0, const SLVec3f& P1, 
                                      const SLVec3f& P2, const SLVec3f& P3);
         SLfloat     arcLength       (SLfloat t1, SLfloat t2);
+        SLfloat     arcLengthTo     (SLfloat t);
         SLfloat     findParamByDist (SLfloat t1, SLfloat s);
+        void        buildArcLengthTable();
 
         // Getters
         SLint       numControlPoints(){return 2*((SLint)_points.size()-1);}
         SLVVec3f&   controls        (){return _controls;}
 
     protected:
+        SLuint      findSegment     (SLfloat t);
+        SLVec3f     segmentVelocity (SLuint i, SLfloat u);
+
+        SLVfloat            _arcLengths;//!< Arc length from start at the table params
         SLVVec3f            _controls;  //!< Control points of Bzier curve
         SLGLVertexArrayExt  _vao;       //!< Vertex array object for rendering
 };
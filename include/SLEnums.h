@@ -66,6 +66,13 @@ enum SLPixelFormat
     PF_bgra_integer = 0x8D9B       //                 GL4
 };
 //-----------------------------------------------------------------------------
+//! Data type of one pixel channel according to the OpenGL type defines
+enum SLPixelDataType
+{   PD_ubyte = 0x1401,             // ES2 ES3 GL2 GL3 GL4 (GL_UNSIGNED_BYTE)
+    PD_half  = 0x140B,             //     ES3     GL3 GL4 (GL_HALF_FLOAT)
+    PD_float = 0x1406              // ES2 ES3 GL2 GL3 GL4 (GL_FLOAT)
+};
+//-----------------------------------------------------------------------------
 //! SLCommand enumerates all possible menu and keyboard commands
 enum SLCommand
 {   C_sceneAll = 0,   // Loads all scenes one after the other
@@ -114,6 +121,8 @@ enum SLCommand
     C_multiSampleToggle,// Toggles multisampling
     C_depthTestToggle,  // Toggles the depth test flag
     C_frustCullToggle,  // Toggles frustum culling
+    C_occlCullToggle,   // Toggles occlusion culling
+    C_clusterLightToggle,// Toggles clustered lighting
     C_waitEventsToggle, // Toggles the wait event flag
 
     C_skeletonToggle,   // Toggles skeleton drawing bit
@@ -159,10 +168,12 @@ enum SLCommand
     C_camSpeedLimitDec, // Decrements the speed limit by 10%
 
     C_statsToggle,      // Toggles statistics on/off
+    C_profileToggle,    // Starts or stops & saves the profiler recording
 
     C_renderOpenGL,     // Render with GL
     C_rtContinuously,   // Do ray tracing continuously
     C_rtDistributed,    // Do ray tracing distributed
+    C_rtProgressive,    // Do ray tracing progressively coarse to fine
     C_rtStop,           // Stop ray tracing
     C_rt1,              //1: Do ray tracing with max. depth 1
     C_rt2,              //2: Do ray tracing with max. depth 2
@@ -183,7 +194,13 @@ enum SLCommand
     C_pt1000,           // Do pathtracing 1000 Rays
     C_pt5000,           // Do pathtracing 5000 Rays
     C_pt10000,          // Do pathtracing 10000 Rays
-    C_ptSaveImage       // Save the ray tracing image
+    C_ptSaveImage,      // Save the ray tracing image
+    C_ptSamplerRandom,  // Use random numbers for pathtracing
+    C_ptSamplerHalton,  // Use the Halton sequence for pathtracing
+    C_ptSamplerSobol,   // Use the scrambled Sobol sequence for pathtracing
+    C_ptSamplerBlueNoise, // Use the blue noise rotated Sobol sequence
+    C_ptSetReference,   // Set the pathtracing image as RMSE reference
+    C_ptTestSamplers    // Log the convergence test of the samplers
 };
 //-----------------------------------------------------------------------------
 //! Mouse button codes
@@ -310,7 +327,9 @@ enum SLShaderProg
     SP_bumpNormalParallax,
     SP_fontTex,
     SP_stereoOculus,
-    SP_stereoOculusDistortion
+    SP_stereoOculusDistortion,
+    SP_perPixBlinnClustered,
+    SP_perPixBlinnTexClustered
 };
 //-----------------------------------------------------------------------------
 //! Type definition for GLSL uniform1f variables that change per frame.
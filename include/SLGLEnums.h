@@ -57,6 +57,21 @@ enum SLGLAttributeType
     AT_custom9      //!< Custom vertex attribute 0
 };
 //-----------------------------------------------------------------------------
+//! Enumeration for the encoding of float vertex attributes in a VBO
+/*! All encodings except AE_float and AE_half are normalized integers that
+arrive as floats in the shader. AE_unorm16 is relative to the per component
+range of the attribute. It needs the dequantization matrix from
+SLGLVertexArray::dequantMatrix to be applied in a shader matrix uniform.
+*/
+enum SLGLAttributeEncoding
+{   AE_float,       //!< 32 bit float per component (no encoding)
+    AE_half,        //!< 16 bit half float per component
+    AE_unorm16,     //!< 16 bit unsigned short relative to the attribute range
+    AE_snorm16,     //!< 16 bit signed short for components within [-1,1]
+    AE_unorm8,      //!< 8 bit unsigned byte for components within [0,1] (colors)
+    AE_snorm10      //!< 10-10-10-2 bit packed int for unit vectors (normals, tangents)
+};
+//-----------------------------------------------------------------------------
 //! Enumeration for buffer usage types also supported by OpenGL ES
 enum SLGLBufferUsage
 {   BU_static  = GL_STATIC_DRAW,        //!< Buffer will be modified once and used many times.
@@ -15,6 +15,8 @@
 #include <stdafx.h>
 #include <SLStack.h>
 
+class SLLightClusters;
+
 //-----------------------------------------------------------------------------
 static const SLint SL_MAX_LIGHTS = 8;   //!< max. number of used lights
 //-----------------------------------------------------------------------------
@@ -62,6 +64,7 @@ class SLGLState
         SLVec3f  lightAtt[SL_MAX_LIGHTS];         //!< att. factor (const,linear,quadratic)
         SLint    lightDoAtt[SL_MAX_LIGHTS];       //!< Flag if att. must be calculated
         SLCol4f  globalAmbientLight;              //!< global ambient light intensity
+        SLLightClusters* lightClusters;           //!< Clustered lights of the drawn view or nullptr
 
         // material
         SLCol4f  matAmbient;                      //!< ambient color reflection (ka)
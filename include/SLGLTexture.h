@@ -14,6 +14,9 @@
 #include <stdafx.h>
 #include <SLImage.h>
 #include <SLGLVertexArray.h>
+#include <mutex>
+
+class SLTexResidency;
 
 //-----------------------------------------------------------------------------
 // Special constants for anisotropic filtering
@@ -42,6 +45,36 @@ enum SLTextureType
     TT_font     //*_F.glf
 };
 //-----------------------------------------------------------------------------
+//! Min. size of the base level of a texture with dropped mip levels
+#define SL_TEX_MIN_LOD_SIZE 16
+//-----------------------------------------------------------------------------
+//! NO. of bits of the tile size of the CPU mipmap levels (4x4 texels)
+#define SL_TEX_TILE_BITS 2
+#define SL_TEX_TILE_SIZE (1 << SL_TEX_TILE_BITS)
+//-----------------------------------------------------------------------------
+//! One level of the CPU mipmap pyramid of a texture for ray tracing
+/*!
+The float texels are stored block-linear in tiles of 4x4 texels (256 bytes).
+The 4 texels of a bilinear lookup lie mostly in the same tile, so lookups at
+random positions touch fewer cache lines than in a line by line layout.
+*/
+struct SLTexMipLevel
+{   SLint       width;      //!< Width in texels
+    SLint       height;     //!< Height in texels
+    SLint       tilesX;     //!< NO. of tiles in x direction
+    SLVCol4f    texels;     //!< Texels in tiles of SL_TEX_TILE_SIZE^2 texels
+
+    //! Returns the index of the texel at x,y (line 0 is the bottom line)
+    SLint index(SLint x, SLint y) const
+    {   SLint tile = (y >> SL_TEX_TILE_BITS) * tilesX + (x >> SL_TEX_TILE_BITS);
+        return (tile << (2*SL_TEX_TILE_BITS)) +
+               ((y & (SL_TEX_TILE_SIZE-1)) << SL_TEX_TILE_BITS) +
+               (x & (SL_TEX_TILE_SIZE-1));
+    }
+    const SLCol4f& texel(SLint x, SLint y) const {return texels[index(x, y)];}
+};
+typedef vector<SLTexMipLevel> SLVTexMipLevel;
+//-----------------------------------------------------------------------------
 //! Texture object for OpenGL texturing
 /*!      
 The SLGLTexture class implements an OpenGL texture object that can is used by the 
@@ -51,6 +84,15 @@ you will need 6 images (_images[0-5]). For 3D textures you can have as much
 images of the same size than your GPU and/or CPU memory can hold.
 The images are not released after the OpenGL texture creation. They may be needed
 for ray tracing.
+\n
+For ray tracing getTexelf with a footprint size does a mipmapped lookup in a
+CPU mipmap pyramid of float texels (see SLTexMipLevel). The pyramid is built
+at the first such lookup of a mipmapped 2D texture by SLImage::downsample.
+\n
+The textures of a scene are managed by its SLTexResidency within a GPU memory
+budget. A texture may be evicted from the GPU or uploaded without its _lodLevel
+finest mip levels (see SLGLTexture::applyResidency). The images stay on the
+CPU, so it can be uploaded again at any level.
 */
 class SLGLTexture : public SLObject
 {
@@ -64,7 +106,8 @@ class SLGLTexture : public SLObject
                                              SLint      mag_filte = GL_LINEAR,
                                              SLTextureType  type = TT_unknown,
                                              SLint      wrapS = GL_REPEAT,
-                                             SLint      wrapT = GL_REPEAT);
+                                             SLint      wrapT = GL_REPEAT,
+                                             SLbool     deferLoad = false);
 
                             //! ctor for 3D texture with internal image allocation
                             SLGLTexture     (SLVstring  imageFilenames,
@@ -89,6 +132,8 @@ class SLGLTexture : public SLObject
             void            bindActive      (SLint texID=0);
             void            fullUpdate      ();
             void            drawSprite      (SLbool doUpdate = false);
+            void            loadDeferred    ();
+            void            applyResidency  (SLint level);
       
             // Setters
             void            texType         (SLTextureType bt)  {_texType = bt;}
@@ -100,6 +145,7 @@ class SLGLTexture : public SLObject
             SLTextureType   texType         (){return _texType;}
             SLfloat         bumpScale       (){return _bumpScale;}
             SLCol4f         getTexelf       (SLfloat s, SLfloat t);
+            SLCol4f         getTexelf       (SLfloat s, SLfloat t, SLfloat footprint);
             SLbool          hasAlpha        (){return (_images.size() &&
                                                    ((_images[0]->format()==PF_rgba  ||
                                                     _images[0]->format()==PF_bgra) ||
@@ -109,12 +155,16 @@ class SLGLTexture : public SLObject
             SLMat4f         tm              (){return _tm;}
             SLbool          autoCalcTM3D    (){return _autoCalcTM3D;}
             SLbool          needsUpdate     (){return _needsUpdate;}
+            SLuint          bytesOnGPU      (){return _bytesOnGPU;}
+            SLint           lodLevel        (){return _lodLevel;}
+            SLint           maxLodLevel     ();
+            SLint           residencyID     (){return _residencyID;}
       
             // Misc     
             SLTextureType   detectType      (SLstring filename);  
             SLuint          closestPowerOf2 (SLuint num); 
             SLuint          nextPowerOf2    (SLuint num);
-            void            build2DMipmaps  (SLint target, SLuint index);
+            void            build2DMipmaps  (SLint target, SLImage* img);
             void            setVideoImage   (SLstring videoImageFile);
             SLbool          copyVideoImage  (SLint width, SLint height,
                                              SLPixelFormat glFormat, 
@@ -131,6 +181,8 @@ class SLGLTexture : public SLObject
     protected:
             // loading the image files
             void        load            (SLstring filename);
+            void        buildMipmapsCPU ();
+            SLCol4f     getTexelMip     (SLint level, SLfloat s, SLfloat t);
                                
             SLGLState*      _stateGL;        //!< Pointer to global SLGLState instance
             SLVImage        _images;         //!< vector of SLImage pointers
@@ -148,6 +200,12 @@ class SLGLTexture : public SLObject
             SLbool          _resizeToPow2;   //!< Flag if image should be resized to n^2
             SLGLVertexArray _vaoSprite;      //!< Vertex array object for sprite rendering
             atomic<bool>    _needsUpdate;    //!< Flag if image needs an update
+            SLVTexMipLevel  _mipsCPU;        //!< CPU mipmap pyramid for ray tracing
+            atomic<bool>    _mipsCPUValid;   //!< Flag if _mipsCPU is built from _images[0]
+            mutex           _mipsCPUMutex;   //!< Guards the building of _mipsCPU
+            SLint           _lodLevel;       //!< NO. of finest mip levels not on the GPU
+            SLint           _residencyID;    //!< ID in _residency (-1 = not managed)
+            SLTexResidency* _residency;      //!< Residency manager of the scene
 };
 //-----------------------------------------------------------------------------
 //! STL vector of SLGLTexture pointers
@@ -29,6 +29,11 @@ they will be stored in a separate VBO. All float attributes will be in one VBO
 (_VBOf) and all half float attributes are stored in one half float VBO (_VBOh).
 Half float attributes only use 2 bytes per number but will be converted to 4
 byte floats before they arrive in the shader. 
+Float attributes can also be stored in a compact normalized integer encoding
+(see SLGLAttributeEncoding). Positions and texture coordinates encoded with
+AE_unorm16 are relative to their range. The matrix that maps them back must be
+multiplied to the matrix uniform that is applied to them in the shader
+(see SLGLVertexArray::dequantMatrix and SLMesh::draw).\n
 Vertices can be drawn either directly as in the array (SLGLVertexArray::drawArrayAs) 
 or by element (SLGLVertexArray::drawElementsAs) with a separate indices buffer.\n
 The setup of a VAO has multiple steps:\n
@@ -65,29 +70,60 @@ class SLGLVertexArray
                                          void* dataPointer,
                                          SLbool convertToHalf=false);
 
+        //! Adds a vertex attribute with data pointer, element size and encoding
+        void        setAttrib           (SLGLAttributeType type, 
+                                         SLint elementSize, 
+                                         SLint location, 
+                                         void* dataPointer,
+                                         SLGLAttributeEncoding encoding);
+
         //! Adds a vertex attribute with vector of SLfloat
         void        setAttrib           (SLGLAttributeType type,
                                          SLint location, 
                                          SLVfloat* data,
-                                         SLbool convertToHalf=false) {setAttrib(type, 1, location, &data->operator[](0));}
+                                         SLbool convertToHalf=false) {setAttrib(type, 1, location, &data->operator[](0), convertToHalf);}
+
+        //! Adds a vertex attribute with vector of SLfloat and an encoding
+        void        setAttrib           (SLGLAttributeType type,
+                                         SLint location, 
+                                         SLVfloat* data,
+                                         SLGLAttributeEncoding encoding) {setAttrib(type, 1, location, &data->operator[](0), encoding);}
 
         //! Adds a vertex attribute with vector of SLVec2f
         void        setAttrib           (SLGLAttributeType type,
                                          SLint location, 
                                          SLVVec2f* data,
-                                         SLbool convertToHalf=false) {setAttrib(type, 2, location, &data->operator[](0));}
+                                         SLbool convertToHalf=false) {setAttrib(type, 2, location, &data->operator[](0), convertToHalf);}
+
+        //! Adds a vertex attribute with vector of SLVec2f and an encoding
+        void        setAttrib           (SLGLAttributeType type,
+                                         SLint location, 
+                                         SLVVec2f* data,
+                                         SLGLAttributeEncoding encoding) {setAttrib(type, 2, location, &data->operator[](0), encoding);}
 
         //! Adds a vertex attribute with vector of SLVec3f
         void        setAttrib           (SLGLAttributeType type,
                                          SLint location, 
                                          SLVVec3f* data,
-                                         SLbool convertToHalf=false) {setAttrib(type, 3, location, &data->operator[](0));}
+                                         SLbool convertToHalf=false) {setAttrib(type, 3, location, &data->operator[](0), convertToHalf);}
+
+        //! Adds a vertex attribute with vector of SLVec3f and an encoding
+        void        setAttrib           (SLGLAttributeType type,
+                                         SLint location, 
+                                         SLVVec3f* data,
+                                         SLGLAttributeEncoding encoding) {setAttrib(type, 3, location, &data->operator[](0), encoding);}
 
         //! Adds a vertex attribute with vector of SLVec4f
         void        setAttrib           (SLGLAttributeType type,
                                          SLint location, 
                                          SLVVec4f* data,
-                                         SLbool convertToHalf=false) {setAttrib(type, 4, location, &data->operator[](0));}
+                                         SLbool convertToHalf=false) {setAttrib(type, 4, location, &data->operator[](0), convertToHalf);}
+
+        //! Adds a vertex attribute with vector of SLVec4f and an encoding
+        void        setAttrib           (SLGLAttributeType type,
+                                         SLint location, 
+                                         SLVVec4f* data,
+                                         SLGLAttributeEncoding encoding) {setAttrib(type, 4, location, &data->operator[](0), encoding);}
         
         //! Adds the index array for indexed element drawing
         void        setIndices          (SLuint numIndices,
@@ -109,10 +145,12 @@ class SLGLVertexArray
                                                                         BT_uint, 
                                                                         &indices->operator[](0));}
         
-        //! Updates a specific vertex attribute in the VBO
+        //! Updates a specific vertex attribute or a range of it in the VBO
         void        updateAttrib        (SLGLAttributeType type, 
                                          SLint elementSize, 
-                                         void* dataPointer);
+                                         void* dataPointer,
+                                         SLuint firstVertex = 0,
+                                         SLuint numVertices = 0);
         
         //! Updates a specific vertex attribute in the VBO
         void        updateAttrib        (SLGLAttributeType type, 
@@ -130,21 +168,33 @@ class SLGLVertexArray
         void        updateAttrib        (SLGLAttributeType type, 
                                          SLVVec4f* data) {updateAttrib(type, 4, (void*)&data->operator[](0));}
         
+        //! Starts writing the float attributes of a streamed VAO directly
+        SLbool      beginUpdate         ();
+
+        //! Returns the pointer to write a float attribute between beginUpdate and endUpdate
+        void*       attribData          (SLGLAttributeType type) {return _VBOf.attribData(type);}
+
+        //! Ends the update and moves the attributes to the written data
+        void        endUpdate           ();
+
         //! Generates the VA & VB objects for a NO. of vertices
         void        generate            (SLuint numVertices, 
                                          SLGLBufferUsage usage = BU_static,
                                          SLbool outputInterleaved = true);
 
-        //! Draws the VAO by element indices with a primitive type
+        //! Draws the VAO by element indices with a primitive type (offset in indices)
         void        drawElementsAs      (SLGLPrimitiveType primitiveType,
                                          SLuint numIndexes = 0,
-                                         SLuint indexOffsetBytes = 0);
+                                         SLuint indexOffset = 0);
         
         //! Draws the VAO as an array with a primitive type 
         void        drawArrayAs         (SLGLPrimitiveType primitiveType,
                                          SLint firstVertex = 0,
                                          SLsizei countVertices = 0);
 
+        //! Returns the matrix that maps an AE_unorm16 attribute back to its range
+        SLMat4f     dequantMatrix       (SLGLAttributeType type);
+
         // Some getters
         SLint       numVertices         () {return _numVertices;}
         SLint       numIndices          () {return _numIndices;}
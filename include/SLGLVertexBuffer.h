@@ -25,10 +25,16 @@ struct SLGLAttribute
     void*   dataPointer;      //!< pointer to the attributes source data
     SLint   location;         //!< GLSL input variable location index
     SLbool  convertToHalf;    //!< Flag if float attribute is converted to half float 
+    SLGLAttributeEncoding encoding; //!< encoding of the float attribute in the buffer
+    SLVec4f quantMin;         //!< min. value per component for AE_unorm16
+    SLVec4f quantRange;       //!< value range per component for AE_unorm16
 };
 //-----------------------------------------------------------------------------
 typedef vector<SLGLAttribute>  SLVVertexAttrib;
 //-----------------------------------------------------------------------------
+//! NO. of regions in the ring of a streamed vertex buffer
+#define SL_VBO_RING_SIZE 3
+//-----------------------------------------------------------------------------
 
 
 
@@ -41,11 +47,25 @@ attributes only use 2 bytes per number but will be converted to 4 byte floats
 before they arrive in the shader. The performance gain with half floats is not
 remarkable. In some cases it even slows down the performance. Use half floats
 only if you have very large models.\n
+Each float attribute can also be encoded individually into a more compact
+normalized integer format (see SLGLAttributeEncoding). The encoding is done
+in SLGLVertexBuffer::encode just before the upload to the GPU. Attributes
+with 3 components of 16 bit or 8 bit are padded to 4 components to keep all
+attributes 4 byte aligned.\n
 Attributes can be either be in sequential order (first all positions, then all 
 normals, etc.) or interleaved (all attributes together for one vertex). See 
 SLGLVertexBuffer::generate for more information.\n
 Vertex index buffer are not handled in this class. They are generated in
-SLGLVertexArray.
+SLGLVertexArray.\n
+Sequential buffers with the usage BU_stream can be rewritten every frame
+without waiting for the GPU between beginUpdate and endUpdate. With OpenGL 3.2
+or OpenGL ES 3.0 the buffer becomes a ring of SL_VBO_RING_SIZE copies of the
+vertex data at the first update. Each update writes into the next region that
+is mapped unsynchronized after its fence has signaled that the GPU finished
+reading it. The attribute pointers are moved to the region. The static
+attributes are copied into all regions once. On older OpenGL versions the
+data is written into a CPU copy that is uploaded with glBufferData, which
+orphans the old storage instead of stalling.
 */
 class SLGLVertexBuffer
 {
@@ -62,10 +82,12 @@ class SLGLVertexBuffer
         SLint       attribIndex         (SLGLAttributeType type);
 
                 
-        //! Updates a specific vertex attribute in the VBO
+        //! Updates a specific vertex attribute or a range of it in the VBO
         void        updateAttrib        (SLGLAttributeType type, 
                                          SLint elementSize, 
-                                         void* dataPointer);
+                                         void* dataPointer,
+                                         SLuint firstVertex = 0,
+                                         SLuint numVertices = 0);
         
         //! Updates a specific vertex attribute in the VBO
         void        updateAttrib        (SLGLAttributeType type, 
@@ -83,6 +105,15 @@ class SLGLVertexBuffer
         void        updateAttrib        (SLGLAttributeType type, 
                                          SLVVec4f& data) {updateAttrib(type, 4, (void*)&data[0]);}
 
+        //! Maps the next region of a streamed VBO and returns its first byte
+        SLuchar*    beginUpdate         ();
+
+        //! Unmaps or uploads the region written after beginUpdate
+        void        endUpdate           ();
+
+        //! Returns the pointer to the float attribute data between beginUpdate and endUpdate
+        void*       attribData          (SLGLAttributeType type);
+
         //! Generates the VBO
         void        generate            (SLuint numVertices, 
                                          SLGLBufferUsage usage = BU_static,
@@ -103,8 +134,13 @@ class SLGLVertexBuffer
         static SLuint totalBufferCount;     //! static total no. of buffers in use
         static SLuint totalBufferSize;      //! static total size of all buffers in bytes
         
+        static SLuint totalBufferSizeFloat; //! static total size of all buffers with float attributes
+        
         //! Returns the size of a buffer data type
         static SLint sizeOfType(SLGLBufferType type);
+
+        //! Returns the size in bytes of one attribute element in the buffer
+        static SLint sizeOfElement(const SLGLAttribute& a);
                                                
     protected:
         SLuint          _id;                //! OpenGL id of vertex buffer object
@@ -115,6 +151,20 @@ class SLGLVertexBuffer
         SLint           _strideBytes;       //! Distance for interleaved attributes in bytes
         SLuint          _sizeBytes;         //! Total size of float VBO in bytes
         SLGLBufferUsage _usage;             //! buffer usage (static, dynamic or stream)
+        SLuint          _sizeBytesFloat;    //! Size of the VBO if all attributes were float
+        SLuint          _ringSize;          //! NO. of regions in the VBO (1 or SL_VBO_RING_SIZE)
+        SLuint          _ringIndex;         //! Index of the region used for drawing
+        void*           _ringFences[SL_VBO_RING_SIZE]; //! GLsync fences after the draws of a region
+        SLuchar*        _mapped;            //! Mapped region or staging data while updating
+        SLVuchar        _staging;           //! CPU copy of a streamed VBO without mapping
+
+    private:
+        void            encode              (SLGLAttribute& a,
+                                             SLVuchar& data,
+                                             SLbool calcRange);
+        void            attribPointer       (SLGLAttribute& a);
+        void            createRing          ();
+        static SLbool   hasRingSupport      ();
 };
 //-----------------------------------------------------------------------------
 
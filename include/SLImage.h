@@ -75,18 +75,26 @@ typedef struct
     GLuint  Bpp;           // Bits per pixel
 } sTGA;
 //-----------------------------------------------------------------------------
-//! Small image class for loading JPG, PNG, BMP, TGA and saving PNG files 
-/*! Minimal class for loading JPG, PNG, BMP, TGA and saving PNG files. In addition
-you can fill, resize, flip and convolve an image. The class is used in 
-SLGLTexture. SLImage interpretes an image starting at bottom left as OpenGL.
+//! Small image class for loading JPG, PNG, BMP, TGA, HDR and saving PNG & HDR files 
+/*! Minimal class for loading JPG, PNG, BMP, TGA, HDR and saving PNG & HDR files.
+In addition you can fill, resize, flip and convolve an image. The class is used
+in SLGLTexture. SLImage interpretes an image starting at bottom left as OpenGL.
+\n
+The channels of a pixel are either 8-bit unsigned bytes (PD_ubyte), 16-bit
+half floats (PD_half) or 32-bit floats (PD_float). Float images hold linear
+values that are not clamped to 1. They can be loaded from and saved to Radiance
+HDR files. toneMap converts them into an 8-bit image for display. readLine and
+writeLine convert a whole line from and to float colors so that the format
+switch is done once per line instead of once per pixel.
 */
 class SLImage : public SLObject
 {
     public:
-                            SLImage         () {_data=0; _width=0; _height=0;}
+                            SLImage         () {_data=0; _width=0; _height=0; _dataType=PD_ubyte;}
                             SLImage         (SLint width,
                                              SLint height,
-                                             SLPixelFormat format);
+                                             SLPixelFormat format,
+                                             SLPixelDataType dataType=PD_ubyte);
                             SLImage         (const SLstring imageFilename); 
                             SLImage         (SLImage &srcImage);
                            ~SLImage         ();
@@ -94,7 +102,8 @@ class SLImage : public SLObject
             void            clearData       ();
             SLbool          allocate        (SLint width,
                                              SLint height,
-                                             SLPixelFormat format);
+                                             SLPixelFormat format,
+                                             SLPixelDataType dataType=PD_ubyte);
             void            load            (const SLstring filename);
             SLbool          load            (SLint width,
                                              SLint height,
@@ -103,16 +112,24 @@ class SLImage : public SLObject
                                              SLuchar* data,
                                              SLbool isTopLeft);
             void            savePNG         (const SLstring filename);
+            void            saveHDR         (const SLstring filename);
             SLCol4f         getPixeli       (SLint x, SLint y);
             SLCol4f         getPixelf       (SLfloat x, SLfloat y);
             void            setPixeli       (SLint x, SLint y, SLCol4f color);
             void            setPixeliRGB    (SLint x, SLint y, SLCol3f color);
             void            setPixeliRGB    (SLint x, SLint y, SLCol4f color);
             void            setPixeliRGBA   (SLint x, SLint y, SLCol4f color);
+            void            readLine        (SLint y, SLCol4f* colors);
+            void            writeLine       (SLint y, const SLCol4f* colors);
+            void            convert         (SLPixelDataType dataType);
+            void            toneMap         (SLImage* dstImg,
+                                             SLfloat exposure=1.0f,
+                                             SLfloat gamma=2.2f);
             void            resize          (SLint width,
                                              SLint height,
                                              SLImage* dstImg=0,
                                              SLbool invert=false);
+            void            downsample      (SLImage* dstImg);
             void            flipY           ();
             void            convolve3x3     (SLfloat* kernel);
             void            fill            (SLubyte r=0, 
@@ -127,16 +144,29 @@ class SLImage : public SLObject
             SLuint          bytesPerLine    () {return _bytesPerLine;}
             SLuint          bytesPerImage   () {return _bytesPerImage;}
             SLPixelFormat   format          () {return _format;}
+            SLPixelDataType dataType        () {return _dataType;}
+            SLubyte*        line            (SLint y) {return _data + y*_bytesPerLine;}
+            SLhalf*         lineh           (SLint y) {assert(_dataType==PD_half);
+                                                       return (SLhalf*)line(y);}
+            SLfloat*        linef           (SLint y) {assert(_dataType==PD_float);
+                                                       return (SLfloat*)line(y);}
             SLstring        formatString    ();
             SLstring        path            () {return _path;}
                                             
+    static  SLint           numChannels     (SLPixelFormat pixelFormat);
+    static  SLint           bytesPerChannel (SLPixelDataType dataType);
+
     private:
-            SLint           bytesPerPixel   (SLPixelFormat pixelFormat);
-            SLint           bytesPerLine    (SLint width, SLPixelFormat pixelFormat);
+            SLint           bytesPerPixel   (SLPixelFormat pixelFormat,
+                                             SLPixelDataType dataType=PD_ubyte);
+            SLint           bytesPerLine    (SLint width,
+                                             SLPixelFormat pixelFormat,
+                                             SLPixelDataType dataType=PD_ubyte);
             void            loadJPG         (SLstring filename);
             void            loadPNG         (SLstring filename);
             void            loadBMP         (SLstring filename);
             void            loadTGA         (SLstring filename);
+            void            loadHDR         (SLstring filename);
             void            loadTGAuncompr  (SLstring filename, FILE* fp, sTGA& tga);
             void            loadTGAcompr    (SLstring filename, FILE* fp, sTGA& tga);
                                             
@@ -144,6 +174,7 @@ class SLImage : public SLObject
             SLint           _width;         //!< width of the texture image in pixel
             SLint           _height;        //!< height of the texture image
             SLPixelFormat   _format;        //!< OpenGL pixel format
+            SLPixelDataType _dataType;      //!< Data type of a pixel channel
             SLint           _bytesPerPixel; //!< Number of bytes per pixel
             SLint           _bytesPerLine;  //!< Number of bytes per line (stride)
             SLint           _bytesPerImage; //!< Number of bytes per image
@@ -46,7 +46,20 @@ enum SLPostProcessSteps
     SLProcess_FlipUVs = 0x800000,
     SLProcess_FlipWindingOrder = 0x1000000,
     SLProcess_SplitByJointCount = 0x2000000,
-    SLProcess_Dejoint = 0x4000000
+    SLProcess_Dejoint = 0x4000000,
+
+    //! The assimp steps that SLImporter::load uses by default
+    SLProcess_Default = SLProcess_Triangulate
+                      | SLProcess_JoinIdenticalVertices
+                      | SLProcess_SplitLargeMeshes
+                      | SLProcess_RemoveRedundantMaterials
+                      | SLProcess_SortByPType
+                      | SLProcess_FindDegenerates
+                      | SLProcess_FindInvalidData,
+
+    // SLProject specific steps that are not passed to assimp
+    SLProcess_SLOptimizeMeshes = 0x40000000, //!< Calls SLMesh::optimize on all meshes
+    SLProcess_SLGenerateLODs   = 0x20000000  //!< Generates LOD index sets for all meshes
 };
 
 //-----------------------------------------------------------------------------
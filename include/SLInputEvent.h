@@ -17,11 +17,63 @@
 
 
 //-----------------------------------------------------------------------------
-//! Baseclass for all system input events.
+//! Parameters of all mouse related input events
+struct SLMouseEvent
+{   SLint           x;
+    SLint           y;
+    SLMouseButton   button;
+    SLKey           modifier;
+};
+//-----------------------------------------------------------------------------
+//! Parameters of all keypress related input events
+struct SLKeyEvent
+{   SLKey           key;
+    SLKey           modifier;
+};
+//-----------------------------------------------------------------------------
+//! Parameters of the two finger touch related input events
+struct SLTouchEvent
+{   SLint           x1;
+    SLint           y1;
+    SLint           x2;
+    SLint           y2;
+};
+//-----------------------------------------------------------------------------
+//! Parameters of all device rotation related input events
+struct SLRotationEvent
+{   SLfloat         x, y, z, w;
+};
+//-----------------------------------------------------------------------------
+//! Parameters of window resize events
+struct SLResizeEvent
+{   SLint           width;
+    SLint           height;
+};
+//-----------------------------------------------------------------------------
+//! Parameters of SLCommand input events
+/*! SLCommand event's can be generated by any GUI system that uses SLProject. */
+struct SLCommandEvent
+{   SLCommand       cmd;
+};
+//-----------------------------------------------------------------------------
+//! Parameters of unicode character input events
+/*! Character input differs from simple key input that it can be generated from
+a combination of different key presses. Some key's might not fire a character 
+event, others might fire multiple at once.
+*/
+struct SLCharInputEvent
+{   SLuint          character;
+};
+//-----------------------------------------------------------------------------
+//! System input event as tagged union of all event parameters
 /*! SLProject has it's own internal event queue to guarantee the same input
 handling accross multiple platforms. Some system's might send system events
 asynchronously. This is why we provide the SLInputEvent class for all
-system relevant input events. 
+system relevant input events.
+\n
+SLInputEvent is a plain value with a fixed size. The type tells which member
+of the union is valid. The events get copied into the fixed ring buffer of the
+SLInputManager, so queueing an event never allocates memory.
 */
 class SLInputEvent
 {
@@ -47,109 +99,23 @@ public:
     } type;         //!< concrete type of the event
     SLint svIndex;  //!< index of the receiving scene view for this event
 
-	SLInputEvent(Type t)
-        : type(t)
-	{ }
+    union
+    {   SLMouseEvent     mouse;     //!< Mouse*, LongTouch
+        SLKeyEvent       key;       //!< KeyDown, KeyUp
+        SLTouchEvent     touch;     //!< Touch2*
+        SLRotationEvent  rotation;  //!< DeviceRotation*
+        SLResizeEvent    resize;    //!< Resize
+        SLCommandEvent   command;   //!< Command
+        SLCharInputEvent character; //!< CharacterInput
+    };
+
+    SLInputEvent() : type(NumEvents), svIndex(0)
+    {   rotation.x = rotation.y = rotation.z = rotation.w = 0.0f;
+    }
+
+    SLInputEvent(Type t, SLint sceneViewIndex) : type(t), svIndex(sceneViewIndex)
+    {   rotation.x = rotation.y = rotation.z = rotation.w = 0.0f;
+    }
 };
-
-//-----------------------------------------------------------------------------
-//! Specialized SLInput class for all mouse related input events.
-class SLMouseEvent : public SLInputEvent
-{
-public:
-    SLint x;
-    SLint y;
-    SLMouseButton button;
-    SLKey modifier;
-
-    SLMouseEvent(Type t)
-        : SLInputEvent(t)
-    { }
-};
-
-//-----------------------------------------------------------------------------
-//! Specialized SLInput class for all keypress related input events.
-class SLKeyEvent : public SLInputEvent
-{
-public:
-    SLKey key;
-    SLKey modifier;
-
-    SLKeyEvent(Type t)
-        : SLInputEvent(t)
-    { }
-};
-
-//-----------------------------------------------------------------------------
-//! Specialized SLInput class for touch related input events.
-class SLTouchEvent : public SLInputEvent
-{
-public:
-    SLint x1;
-    SLint y1;
-    SLint x2;
-    SLint y2;
-
-    SLTouchEvent(Type t)
-        : SLInputEvent(t)
-    { }
-};
-
-//-----------------------------------------------------------------------------
-//! Specialized SLInput class for all device rotation related input events.
-class SLRotationEvent : public SLInputEvent
-{
-public:
-    float x, y, z, w;
-
-    SLRotationEvent(Type t)
-        : SLInputEvent(t)
-    { }
-};
-
-//-----------------------------------------------------------------------------
-//! Specialized SLInput class for window resize events.
-class SLResizeEvent : public SLInputEvent
-{
-public:
-    int width;
-    int height;
-    
-    SLResizeEvent()
-        : SLInputEvent(Resize)
-    { }
-};
-
-//-----------------------------------------------------------------------------
-//! Specialized SLInput class for specialized SLCommand input event's.
-/*! SLCommand event's can be generated by any GUI system that uses SLProject. */
-class SLCommandEvent : public SLInputEvent
-{
-public:
-    SLCommand cmd;
-
-    SLCommandEvent()
-        : SLInputEvent(Command)
-    { }
-};
-
-//-----------------------------------------------------------------------------
-//! Specialized SLInput class for unicode character input.
-/*! Character input differs from simple key input that it can be generated from
-a combination of different key presses. Some key's might not fire a character 
-event, others might fire multiple at once.
-*/
-class SLCharInputEvent : public SLInputEvent
-{
-public:
-    SLuint character;
-
-    SLCharInputEvent()
-        : SLInputEvent(CharacterInput)
-    { }
-};
-
-//-----------------------------------------------------------------------------
-typedef std::queue<const SLInputEvent*> SLQInputEvent;
 //-----------------------------------------------------------------------------
 #endif
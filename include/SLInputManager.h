@@ -15,15 +15,28 @@
 #include <SLInputEvent.h>
 #include <SLInputDevice.h>
 
+//-----------------------------------------------------------------------------
+//! NO. of slots in the system event ring (must be a power of 2)
+#define SL_INPUT_QUEUE_SIZE 1024
 //-----------------------------------------------------------------------------
 //! SLInputManager. manages system input and custom input devices.
 /*! Every user input has to go through the SLInputManager. System event's
-like touch, mouse, character input will be encapsulated in SLInputEvent
-subclasses and will be queued up before being sent to the relevant SLSceneView.
+like touch, mouse, character input will be encapsulated in an SLInputEvent
+and will be queued up before being sent to the relevant SLSceneView.
 Custom SLInputDevices can also be created. The SLInputDevices are guaranteed to 
 receive a call to their poll() function whenever the SLInputManager requires them
 to send out new events.
 
+The system events are copied into a fixed ring buffer of SL_INPUT_QUEUE_SIZE
+slots. queueEvent may be called from any thread (e.g. the UI or sensor thread
+on Android or the Qt event thread) while pollEvents works them off on the
+OpenGL thread. The ring is a bounded multiple producer single consumer queue
+with a sequence number per slot: A producer claims a slot with a compare &
+swap on the tail, copies the event and publishes it by its sequence number.
+No lock and no memory allocation is involved. If the ring is full the event
+gets dropped and counted. Successive mouse move or two finger move events of
+the same scene view get coalesced into the latest one while being worked off.
+
 SLInputManager is a singleton class and only ever exists once.
 */
 class SLInputManager
@@ -34,16 +47,36 @@ public:
     static  SLInputManager& instance        ();
 
             SLbool          pollEvents      ();
-            void            queueEvent      (const SLInputEvent* e);
+            SLbool          queueEvent      (const SLInputEvent& e);
+
+            // Statistics
+            SLuint          numQueued       () const {return _numQueued.load(memory_order_relaxed);}
+            SLuint          numDropped      () const {return _numDropped.load(memory_order_relaxed);}
+            SLuint          numCoalesced    () const {return _numCoalesced.load(memory_order_relaxed);}
+            SLuint          maxQueueFill    () const {return _maxFill.load(memory_order_relaxed);}
 
 private:
+    //! Slot of the event ring with its sequence number
+    struct SLInputEventSlot
+    {   atomic<SLuint>  seq;            //!< == index: free, == index+1: filled
+        SLInputEvent    event;          //!< copy of the queued event
+    };
+
     static  SLInputManager  _instance;      //!< the singleton instance of the input manager
-            SLQInputEvent   _systemEvents;  //!< queue for known system events
+            SLInputEventSlot _slots[SL_INPUT_QUEUE_SIZE]; //!< ring buffer of system events
+            atomic<SLuint>  _tail;          //!< next slot to be claimed by a producer
+            atomic<SLuint>  _head;          //!< next slot to be read by the consumer
+            atomic<SLuint>  _numQueued;     //!< NO. of queued events
+            atomic<SLuint>  _numDropped;    //!< NO. of events dropped on a full ring
+            atomic<SLuint>  _numCoalesced;  //!< NO. of move events coalesced
+            atomic<SLuint>  _maxFill;       //!< max. NO. of events in the ring
             SLVInputDevice  _devices;       //!< list of activated SLInputDevices
 
                             // Constructor is private to prevent instantiation
-                            SLInputManager  (){ }
+                            SLInputManager  ();
 
+            SLbool          popEvent        (SLInputEvent& e);
+      const SLInputEvent*   peekEvent       ();
             SLbool          processQueuedEvents();
 };
 //-----------------------------------------------------------------------------
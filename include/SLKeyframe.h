@@ -22,6 +22,7 @@ class SLKeyframe
 public:
                             SLKeyframe  (const SLAnimTrack* parent,
                                          SLfloat time);
+    virtual                ~SLKeyframe  () {}
 
             bool            operator<   (const SLKeyframe& other) const;
 
@@ -42,6 +43,8 @@ Keeps track of translation, rotation and scale.
 */
 class SLTransformKeyframe : public SLKeyframe
 {
+    SL_MEMPOOL_CLASS(SLTransformKeyframe)
+
 public:    
                         SLTransformKeyframe(const SLAnimTrack* parent,
                                             SLfloat time);
@@ -0,0 +1,150 @@
+//#############################################################################
+//  File:      SLLightClusters.h
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLLIGHTCLUSTERS_H
+#define SLLIGHTCLUSTERS_H
+
+#include <stdafx.h>
+#include <SLLight.h>
+
+class SLGLProgram;
+
+//-----------------------------------------------------------------------------
+//! Max. NO. of lights in the clustered lighting path
+#define SL_CLUSTER_MAX_LIGHTS 1024
+//! NO. of depth slices of the cluster grid
+#define SL_CLUSTER_SLICES 24
+//! Min. width & height of a cluster tile in pixels
+#define SL_CLUSTER_TILE_SIZE 64
+//! First of the 3 texture units used for the cluster textures
+#define SL_CLUSTER_TEX_UNIT 8
+//-----------------------------------------------------------------------------
+//! Light as seen by the cluster assignment in view space
+struct SLClusterLight
+{   SLVec3f     posVS;      //!< Position in view space
+    SLfloat     radius;     //!< Range of influence (FLT_MAX for unlimited)
+    SLVec3f     dirVS;      //!< Spot direction in view space
+    SLfloat     spotCutoff; //!< Spot cutoff angle in degrees (>= 180 for point lights)
+};
+typedef vector<SLClusterLight> SLVClusterLight;
+//-----------------------------------------------------------------------------
+//! Clustered forward lighting with a CPU light to cluster assignment
+/*!
+SLLightClusters divides the view frustum into a grid of clusters (froxels):
+The screen is divided into tiles of at least SL_CLUSTER_TILE_SIZE pixels and
+the depth range between the near and the far clipping plane into
+SL_CLUSTER_SLICES slices with exponentially growing depth. The depth slice of
+a view space depth z is log(-z/near) * numZ / log(far/near).
+\n
+SLLightClusters::assign computes the view space AABB of all clusters and tests
+every light against them: First the sphere of influence against the AABB of
+the cluster (4 lights at once with SSE or NEON) and for spot lights then the
+cone against the bounding sphere of the cluster. The depth slices are
+distributed on SL::maxThreads() threads. The result is the index list of the
+lights of each cluster in one array. The assignment doesn't need OpenGL and
+can be tested on the CPU alone.
+\n
+SLLightClusters::update collects the lights of the scene, calculates their
+range of influence from their attenuation, does the assignment and uploads
+the result into 3 data textures: the light parameters (RGBA32F), the offset &
+count of each cluster (RG32UI) and the light index list (R32UI). The shader
+programs SP_perPixBlinnClustered and SP_perPixBlinnTexClustered find the
+cluster of a fragment from gl_FragCoord and its view space depth and only
+evaluate the lights of this cluster. Because of the integer textures the
+clustered path needs OpenGL 3 or OpenGL ES 3.
+\n
+SLSceneView uses the clustered lighting if it is turned on in the menu or if
+the scene has more than SL_MAX_LIGHTS lights. SLMaterial::activate then
+replaces the standard Blinn-Phong programs by their clustered variants.
+Other shader programs still get the first SL_MAX_LIGHTS lights as uniforms.
+*/
+class SLLightClusters
+{
+    public:
+                        SLLightClusters     ();
+                       ~SLLightClusters     ();
+
+            void        assign              (const SLMat4f& projection,
+                                             SLint viewportW,
+                                             SLint viewportH,
+                                             SLfloat clipNear,
+                                             SLfloat clipFar,
+                                             const SLVClusterLight& lights);
+            void        update              (SLVLight& lights,
+                                             const SLMat4f& view,
+                                             const SLMat4f& projection,
+                                             SLint viewportW,
+                                             SLint viewportH,
+                                             SLfloat clipNear,
+                                             SLfloat clipFar);
+            void        setUniforms         (SLGLProgram* sp);
+            void        deleteGL            ();
+
+            SLint       clusterIndex        (SLfloat pixelX,
+                                             SLfloat pixelY,
+                                             SLfloat zVS) const;
+            SLGLProgram* program            (SLGLProgram* sp);
+            SLbool      usesProgram         (SLGLProgram* sp);
+
+     static SLGLProgram* createProgram      (SLbool withTexture);
+     static SLbool      isSupported         ();
+     static SLfloat     lightRadius         (SLLight* light);
+
+            // Getters
+            SLint       numX                () const {return _numX;}
+            SLint       numY                () const {return _numY;}
+            SLint       numZ                () const {return _numZ;}
+            SLint       tileSize            () const {return _tileSize;}
+            SLuint      numClusters         () const {return (SLuint)(_numX*_numY*_numZ);}
+            SLuint      numLights           () const {return _numLights;}
+            SLuint      numIndices          () const {return (SLuint)_indices.size();}
+            SLuint      maxLightsPerCluster () const {return _maxPerCluster;}
+            SLuint      numLightsInCluster  (SLuint c) const {return _grid[c*2+1];}
+      const SLuint*     lightsInCluster     (SLuint c) const {return _indices.empty() ? nullptr :
+                                                                     &_indices[_grid[c*2]];}
+
+    private:
+            void        buildBounds         (const SLMat4f& projection,
+                                             SLint viewportW,
+                                             SLint viewportH,
+                                             SLfloat clipNear,
+                                             SLfloat clipFar);
+            void        assignSlice         (SLint z,
+                                             const SLVClusterLight& lights);
+            void        upload              ();
+
+            SLint       _numX;              //!< NO. of tiles in x
+            SLint       _numY;              //!< NO. of tiles in y
+            SLint       _numZ;              //!< NO. of depth slices
+            SLint       _tileSize;          //!< Tile width & height in pixels
+            SLfloat     _near;              //!< Near clipping distance
+            SLfloat     _sliceScale;        //!< numZ / log(far/near)
+            SLMat4f     _projection;        //!< Projection of the last bounds
+            SLint       _viewportW;         //!< Viewport width of the last bounds
+            SLint       _viewportH;         //!< Viewport height of the last bounds
+            SLfloat     _far;               //!< Far clipping distance of the last bounds
+            SLVVec3f    _boundsMin;         //!< View space AABB min. of each cluster
+            SLVVec3f    _boundsMax;         //!< View space AABB max. of each cluster
+            SLVuint     _grid;              //!< Light offset & count of each cluster
+            SLVuint     _indices;           //!< Light indices of all clusters
+            vector<SLVuint> _sliceIndices;  //!< Light indices of each depth slice
+            SLuint      _numLights;         //!< NO. of assigned lights
+            SLuint      _maxPerCluster;     //!< Max. NO. of lights in one cluster
+
+            SLVClusterLight _lights;        //!< Temp. lights in view space
+            SLVfloat    _lightData;         //!< Light parameters as uploaded
+            SLuint      _texLights;         //!< Texture with the light parameters
+            SLuint      _texGrid;           //!< Texture with the cluster ranges
+            SLuint      _texIndices;        //!< Texture with the light indices
+            SLint       _texLightsH;        //!< Allocated height of light texture
+            SLint       _texIndicesH;       //!< Allocated height of index texture
+};
+//-----------------------------------------------------------------------------
+#endif
@@ -113,6 +113,7 @@ class SLMaterial : public SLObject
             SLfloat         kn              () {return _kn;}
             SLVGLTexture&   textures        () {return _textures;}
             SLGLProgram*    program         () {return _program;}
+            SLGLProgram*    activeProgram   () {return _activeProgram;}
 
      static SLMaterial*     defaultMaterial ();
      static void            defaultMaterial (SLMaterial* mat);
@@ -136,6 +137,7 @@ class SLMaterial : public SLObject
             SLfloat         _kn;            //!< refraction index
             SLVGLTexture    _textures;      //!< vector of texture pointers
             SLGLProgram*    _program;       //!< pointer to a GLSL shader program
+            SLGLProgram*    _activeProgram; //!< program used since the last activate (may be a clustered variant)
 
     private:
     static  SLMaterial*     _defaultMaterial;//!< Global default material for meshes that don't define their own.
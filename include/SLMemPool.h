@@ -0,0 +1,116 @@
+//#############################################################################
+//  File:      SL/SLMemPool.h
+//  Author:    Marcus Hudritsch
+//  Purpose:   Chunked memory pool for the many small scenegraph objects
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLMEMPOOL_H
+#define SLMEMPOOL_H
+
+#include <stdafx.h>
+#include <mutex>
+
+//-----------------------------------------------------------------------------
+//! Approx. NO. of bytes of one chunk of a memory pool
+#define SL_MEMPOOL_CHUNK_BYTES 65536
+//-----------------------------------------------------------------------------
+//! Memory pool of fixed size blocks that are allocated in large chunks
+/*!
+SLMemPool hands out blocks of one size from chunks of about
+SL_MEMPOOL_CHUNK_BYTES bytes. Freed blocks go into a free list and are reused
+first. So objects that get created together lie close together in memory and
+an allocation or deallocation costs only a few instructions under a lock
+instead of a call to the system heap.
+\n
+A class gets its pool with the macro SL_MEMPOOL_CLASS that defines the class
+operators new and delete. Derived classes use the same operators. If they are
+larger than the block size they are allocated on the heap as before. The
+sized operator delete gets the size of the dynamic type, so the class needs a
+virtual destructor if it is deleted by a base pointer. So a pool belongs to
+the concrete class that gets instantiated (e.g. SLTransformKeyframe) and not
+to its abstract base. A base class that is instantiated itself and has
+frequent subclasses of similar size (e.g. SLMesh and the primitives) uses
+SL_MEMPOOL_CLASS_SIZE with the size of the largest of them.
+\n
+SLMemPool::releaseAll is called by SLScene::unInit after the scene got deleted.
+It returns all chunks without any used block to the system in one go.
+The pools themselves are never deleted, so objects may still be deleted during
+the static destruction at program exit.
+*/
+class SLMemPool
+{
+    public:
+                        SLMemPool       (const SLchar* name, size_t blockSize);
+
+            void*       allocate        ();
+            void        deallocate      (void* block);
+            SLuint      release         ();
+
+    static  SLuint      releaseAll      ();
+    static  void        statsAll        (SLuint& numAllocs,
+                                         SLuint& numLive,
+                                         SLuint& numBytes);
+
+            // Getters
+      const SLchar*     name            () const {return _name;}
+            size_t      blockSize       () const {return _blockSize;}
+            SLuint      numAllocs       () const {return _numAllocs;}
+            SLuint      numLive         () const {return _numLive;}
+            SLuint      numChunks       () const {return (SLuint)_chunks.size();}
+            SLuint      numBytes        () const {return numChunks() * _blocksPerChunk * (SLuint)_blockSize;}
+
+    private:
+            //! Free block with the link to the next free block
+            struct SLFreeBlock {SLFreeBlock* next;};
+
+            void        addChunk        ();
+
+            mutex       _mutex;         //!< Guards the free list and the chunks
+      const SLchar*     _name;          //!< Name of the pooled class (string literal)
+            size_t      _blockSize;     //!< Size of a block in bytes
+            SLuint      _blocksPerChunk;//!< NO. of blocks in a chunk
+            vector<SLuchar*> _chunks;   //!< Allocated chunks
+            SLFreeBlock* _freeList;     //!< First free block
+            SLuint      _numAllocs;     //!< NO. of allocations since the start
+            SLuint      _numLive;       //!< NO. of blocks in use
+};
+//-----------------------------------------------------------------------------
+#ifndef SL_MEMLEAKDETECT
+/*!
+Defines the class operators new and delete of the class _Cls so that it gets
+allocated in its own SLMemPool with blocks of _BlockSize bytes. _BlockSize is
+evaluated once at the first allocation and must be at least sizeof(_Cls).
+Place it at the beginning of the class body. With the memory leak detector of
+SL_MEMLEAKDETECT it expands to nothing because debug_new redefines the new
+operator.
+*/
+#define SL_MEMPOOL_CLASS_SIZE(_Cls, _BlockSize) \
+    public: \
+    static  SLMemPool&  memPool         () \
+                        {   static SLMemPool* pool = new SLMemPool(#_Cls, _BlockSize); \
+                            return *pool; \
+                        } \
+    static  void*       operator new    (size_t size) \
+                        {   return size <= memPool().blockSize() ? \
+                                   memPool().allocate() : ::operator new(size); \
+                        } \
+    static  void        operator delete (void* p, size_t size) \
+                        {   if (!p) return; \
+                            if (size <= memPool().blockSize()) \
+                                memPool().deallocate(p); \
+                            else ::operator delete(p); \
+                        } \
+    private:
+#else
+#define SL_MEMPOOL_CLASS_SIZE(_Cls, _BlockSize)
+#endif
+//-----------------------------------------------------------------------------
+//! Defines the pool operators of the class _Cls with blocks of its own size
+#define SL_MEMPOOL_CLASS(_Cls) SL_MEMPOOL_CLASS_SIZE(_Cls, sizeof(_Cls))
+//-----------------------------------------------------------------------------
+#endif
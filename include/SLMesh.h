@@ -124,12 +124,23 @@ weights for four joints by which it can be influenced. This transform is
 called skinning and can be done in CPU in the method transformSkin or by
 a vertex shader. If the skinning is done on CPU two additional arrays
 (_finalP and _finalN) for the transformed vertices and normals are needed.
+\n
+\n
+A mesh can hold a chain of simplified levels of detail (LOD) that are
+generated with SLMesh::generateLODs. A LOD is only an index set into the
+vertices of the mesh (_lodI), so all levels share the vertex data and the
+vertex buffer. The LOD level is selected per node in SLNode::cullRec and
+SLMesh::draw draws the index range of the node's level. Ray tracing always
+uses the full detail mesh.
 */      
 class SLMesh : public SLObject
 {   
+    SL_MEMPOOL_CLASS_SIZE(SLMesh, poolBlockSize())
+
     public:                    
                             SLMesh          (SLstring name = "Mesh");
                            ~SLMesh          ();
+    static  size_t          poolBlockSize   ();
                
     virtual void            init            (SLNode* node);
     virtual void            draw            (SLSceneView* sv, SLNode* node);
@@ -147,6 +158,30 @@ class SLMesh : public SLObject
             void            calcCenterRad   (SLVec3f& center, SLfloat& radius);
             SLbool          hitTriangleOS   (SLRay* ray, SLNode* node, SLuint iT);
             void            useHalfFloats   (SLbool useHalf);
+            void            useQuantization (SLbool useQuant);
+
+            // Mesh optimization (see SLMesh_optimize.cpp)
+            void            optimize        (SLbool printStats = false);
+            SLuint          weldVertices    ();
+            void            optimizeVertexCache();
+            void            optimizeVertexFetch();
+            SLfloat         calcACMR        (SLuint cacheSize = 32);
+            SLfloat         calcATVR        (SLuint cacheSize = 32);
+
+            // Level of detail (see SLMesh_simplify.cpp)
+            void            generateLODs    (SLuint numLODs = 4,
+                                             SLfloat ratio = 0.5f);
+            void            simplifyLODs    (SLuint numLODs,
+                                             SLfloat ratio,
+                                             vector<SLVuint>& lodIndices,
+                                             SLVfloat& lodErrors);
+            void            addLODs         (const vector<SLVuint>& lodIndices,
+                                             const SLVfloat& lodErrors);
+            SLint           numLODs         () const {return (SLint)_lodErrors.size() + 1;}
+            SLint           validLOD        (SLint level) const {return SL_clamp(level, 0, numLODs()-1);}
+            SLuint          lodNumI         (SLint level);
+            SLfloat         lodError        (SLint level) const;
+      const SLuint*         lodIndices      (SLint level) const;
 
             void            transformSkin   ();
 
@@ -194,6 +229,10 @@ class SLMesh : public SLObject
             SLGLVertexArrayExt  _vaoT;          //!< OpenGL VAO for optional tangent drawing
             SLGLVertexArrayExt  _vaoS;          //!< OpenGL VAO for optional selection drawing
             SLbool              _useHalf;       //!< Use half floats for N,T,C, Tc,Ji & Jw
+            SLbool              _useQuant;      //!< Use quantized attributes for P,N,T,C & Tc
+            SLVuint             _lodI;          //!< index sets of the LOD levels 1-n one after the other
+            SLVuint             _lodStart;      //!< start of each LOD level in _lodI and the end
+            SLVfloat            _lodErrors;     //!< max. geometric error in OS of the LOD levels 1-n
                
             SLbool              _isVolume;      //!< Flag for RT if mesh is a closed volume
             SLAccelStruct*      _accelStruct;           //!< KD-tree or uniform grid
@@ -206,6 +245,11 @@ class SLMesh : public SLObject
             SLVVec3f*           _finalN;        //!< pointer to final vertex normal vector
 
             void            notifyParentNodesAABBUpdate() const;
+
+            SLVuint         getIndices32    ();
+            void            setIndices      (const SLVuint& indices);
+            void            reorderAttributes(const SLVuint& newToOld);
+            SLuint          calcCacheMisses (SLuint cacheSize);
 };
 //-----------------------------------------------------------------------------
 typedef std::vector<SLMesh*>  SLVMesh;
@@ -0,0 +1,72 @@
+//#############################################################################
+//  File:      SL/SLMeshCache.h
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>
+#include <SLNode.h>
+#include <SLMesh.h>
+
+#ifndef SLMESHCACHE_H
+#define SLMESHCACHE_H
+
+//-----------------------------------------------------------------------------
+//! Version of the binary cache format. Increment on every format change.
+#define SL_MESHCACHE_VERSION 2
+//-----------------------------------------------------------------------------
+//! Binary cache file for imported models
+/*! An SLMeshCache holds the name of a binary cache file for a model file
+that was imported e.g. with SLAssimpImporter. The cache file name contains
+a 64 bit key that is built from the content of the model file, the import
+flags and the cache format version. The key is calculated on first use. If the
+model file or the import flags change a new cache file is used.
+\n
+The cache file stores the materials with their texture file names, all
+vertex attribute vectors (P, N, Tc, C, T, Ji, Jw) and index vectors
+(I16, I32) of the meshes and the node hierarchy with the local transforms.
+If the model was imported with LODs (SLProcess_SLGenerateLODs) the LOD index
+sets and errors of every mesh are stored as well, so that a cache hit only
+has to call SLMesh::addLODs instead of simplifying the meshes again.
+On load the file is memory mapped. Index and joint vectors are filled with
+one bulk copy each, the SLVec attributes component by component. No normals
+or tangents have to be recalculated.
+\n
+Meshes that are bound to a skeleton and node animations are not cached.
+The importer doesn't write a cache file for such models.
+*/
+class SLMeshCache
+{
+    public:
+                    SLMeshCache     (SLstring modelFile,
+                                     SLuint importFlags,
+                                     SLbool loadMeshesOnly);
+
+            SLbool  exists          ();
+            SLNode* load            (SLVMesh& meshes);
+            SLbool  save            (SLNode* root, SLVMesh& meshes,
+                                     const vector<vector<SLVuint>>& lodIndices,
+                                     const vector<SLVfloat>& lodErrors);
+
+            // Getters
+            SLstring    cacheFile   () {init(); return _cacheFile;}
+            SLuint64    key         () {init(); return _key;}
+
+    static  SLstring    cacheDir;   //!< Cache directory (empty = model dir.)
+
+    private:
+            void        init        ();
+    static  SLuint64    hashFile    (const SLstring& pathFilename);
+
+            SLstring    _modelFile; //!< Model file with path
+            SLuint      _flags;     //!< Import flags
+            SLbool      _meshesOnly;//!< Flag if only nodes with meshes are loaded
+            SLstring    _cacheFile; //!< Cache file with path (empty until init)
+            SLuint64    _key;       //!< Hash key of model, flags & version
+};
+//-----------------------------------------------------------------------------
+#endif // SLMESHCACHE_H
@@ -17,6 +17,8 @@
 #include <SLNode.h>
 #include <SLDrawBits.h>
 #include <SLEventHandler.h>
+#include <SLNodeIndex.h>
+#include <SLTransformStore.h>
 
 class SLSceneView;
 class SLRay;
@@ -24,6 +26,11 @@ class SLAABBox;
 class SLNode;
 class SLAnimation;
 
+//-----------------------------------------------------------------------------
+//! Default layer of a node for ray queries (see SLRayQuery)
+#define SL_LAYER_DEFAULT 0x00000001
+//! Layer mask that matches all layers
+#define SL_LAYER_ALL     0xFFFFFFFF
 //-----------------------------------------------------------------------------
 //! SLVNode typdef for a vector of SLNodes
 typedef std::vector<SLNode*>  SLVNode;
@@ -47,6 +54,9 @@ struct SLNodeStats
     SLfloat     numVoxEmpty;   //!< NO. of empty voxels
     SLuint      numVoxMaxTria; //!< Max. no. of triangles per voxel
     SLuint      numAnimations; //!< NO. of animations
+    SLuint      numPoolAllocs; //!< NO. of allocations in SLMemPools
+    SLuint      numPoolLive;   //!< NO. of objects in use in SLMemPools
+    SLuint      numPoolBytes;  //!< NO. of bytes in SLMemPool chunks
 
     //! Resets all counters to zero
     void clear()
@@ -64,6 +74,9 @@ struct SLNodeStats
         numVoxEmpty    = 0.0f;
         numVoxMaxTria  = 0;
         numAnimations  = 0;
+        numPoolAllocs  = 0;
+        numPoolLive    = 0;
+        numPoolBytes   = 0;
     }
 
     //! Prints all statistic informations on the std out stream.
@@ -84,6 +97,9 @@ struct SLNodeStats
         SL_LOG("Meshes         : %d\n", numMeshes);
         SL_LOG("Triangles      : %d\n", numTriangles);
         SL_LOG("Lights         : %d\n", numLights);
+        SL_LOG("Pool Allocs    : %d\n", numPoolAllocs);
+        SL_LOG("Pool Live      : %d\n", numPoolLive);
+        SL_LOG("MB Pools       : %f\n", (SLfloat)numPoolBytes / 1000000.0f);
         SL_LOG("\n");
     }
 };
@@ -104,6 +120,19 @@ Multiple nodes can point to the same mesh object.
 The nodes meshes are drawn by the methods SLNode::drawMeshes and alternatively
 by SLNode::drawRec.
 
+All nodes with a parent are registered in the hashed SLNodeIndex of the scene
+(SLScene::nodeIndex) by their name, their dynamic type and their meshes.
+SLNode::find, SLNode::findChild and SLNode::findChildren look the nodes up in
+the index without a traversal of the tree. SLNode::findByPath resolves a path
+of node names separated by '/'.
+
+The world matrices of the nodes below SLScene::_root3D are updated in the
+flattened SLTransformStore. For these nodes SLNode::needUpdate flags the AABB
+of the node and its parents and puts the node in the dirty list of the store
+instead of flagging the whole subtree. SLNode::updateAndGetWM flushes this
+list and must therefore not be called from worker threads while it is not
+empty.
+
 A node can be transformed and has therefore a object matrix (_om) for its local
 transform. All other matrices such as the world matrix (_wm), the inverse
 world matrix (_wmI) and the normal world matrix (_wmN) are derived from the
@@ -131,12 +160,21 @@ SLNode.
 class SLNode: public SLObject, public SLEventHandler
 {
     friend class SLSceneView;
+    friend class SLTransformStore;
+    friend class SLNodeIndex;
+
+    SL_MEMPOOL_CLASS_SIZE(SLNode, poolBlockSize())
 
     public:
                             SLNode              (SLstring name="Node");
                             SLNode              (SLMesh* mesh, SLstring name="Node");
                             SLNode              (const SLNode& node);
     virtual                ~SLNode              ();
+    static  size_t          poolBlockSize       ();
+
+            // Setters & getters of the name that keep the node index in sync
+            using           SLObject::name;
+    virtual void            name                (const SLstring& Name);
          
             // Recursive scene traversal methods (see impl. for details)
     virtual void            cullRec             (SLSceneView* sv);
@@ -153,13 +191,14 @@ class SLNode: public SLObject, public SLEventHandler
             SLint           numMeshes           () {return (SLint)_meshes.size();}
             void            addMesh             (SLMesh* mesh);
             bool            insertMesh          (SLMesh* insertM, SLMesh* afterM);
-            void            removeMeshes        () {_meshes.clear();}
+            void            removeMeshes        ();
             bool            removeMesh          ();
             bool            removeMesh          (SLMesh* mesh);
             bool            removeMesh          (SLstring name);
             SLMesh*         findMesh            (SLstring name);
             SLbool          containsMesh        (const SLMesh* mesh);
     virtual void            drawMeshes          (SLSceneView* sv);
+            void            selectLOD           (SLSceneView* sv);
                
             // Children methods (see impl. for details)
             SLint           numChildren         () {return (SLint)_children.size();}
@@ -180,6 +219,9 @@ class SLNode: public SLObject, public SLEventHandler
                                                  SLbool findRecursive = true);
             vector<SLNode*> findChildren        (const SLMesh* mesh,
                                                  SLbool findRecursive = true);
+            SLNode*         findByPath          (const SLstring& path);
+            template<typename T>
+    static  SLbool          isOfType            (SLNode* node) {return dynamic_cast<T*>(node) != nullptr;}
             
             // local direction getter functions
             SLVec3f         translation         () const;
@@ -234,6 +276,7 @@ class SLNode: public SLObject, public SLEventHandler
             void            parent              (SLNode* p);
             void            om                  (const SLMat4f& mat) {_om = mat; needUpdate();}
             void            animation           (SLAnimation* a)  {_animation = a;}
+            void            layers              (SLuint layers) {_layers = layers;}
     virtual void            needUpdate          ();
             void            needWMUpdate        ();
             void            needAABBUpdate      ();
@@ -251,11 +294,18 @@ class SLNode: public SLObject, public SLEventHandler
             SLAABBox*       aabb                () {return &_aabb;}
             SLAnimation*    animation           () {return _animation;}
             SLVMesh&        meshes              () {return _meshes;}
+            SLint           lodLevel            () {return _lodLevel;}
+            SLuint          layers              () const {return _layers;}
             SLVNode&        children            () {return _children;}
       const SLSkeleton*     skeleton            ();
+            SLTransformStore* store             () const {return _store;}
 
     private:
             void            updateWM            () const;   
+            SLNodeIndex*    childIndex          () const;
+            template<typename T>
+            T*              findChildRec        (const SLstring& name,
+                                                 SLbool findRecursive);
             template<typename T>            
             void            findChildrenHelper  (const SLstring& name, 
                                                  vector<T*>& list, 
@@ -280,6 +330,18 @@ class SLNode: public SLObject, public SLEventHandler
             SLDrawBits   _drawBits;         //!< node level drawing flags
             SLAABBox     _aabb;             //!< axis aligned bounding box
             SLAnimation* _animation;        //!< animation of the node
+            SLint        _lodLevel;         //!< level of detail of the meshes (0=full)
+            SLuint       _layers;           //!< layer bits for ray queries
+            SLNodeIndex* _nodeIndex;        //!< node index of the scene (0=not indexed)
+      const type_info*   _indexType;        //!< type in the node index (0=not indexed)
+            SLuint       _indexSeq;         //!< NO. of the addition to the node index
+            SLuint       _indexNameSlot;    //!< slot in the name list of the node index
+            SLuint       _indexTypeSlot;    //!< slot in the type list of the node index
+            vector<pair<const SLMesh*, SLuint>> _indexMeshes; //!< indexed meshes with their slots
+            SLuint       _indexOrder;       //!< depth first number in the node index
+            SLuint       _indexLast;        //!< last depth first number of the subtree
+            SLTransformStore* _store;       //!< flat transform store of the node (0=none)
+            SLint        _slot;             //!< index in the transform store (-1=none)
 };
 
 ////////////////////////
@@ -302,10 +364,25 @@ T* SLNode::find(const SLstring& name, SLbool findRecursive)
 //-----------------------------------------------------------------------------
 /*!
 SLNode::findChild<T> finds the first child that is of type T or a subclass of T.
+The children are looked up in the node index of the scene. The result is the
+same as of the tree search SLNode::findChildRec, which is only used for
+children that are not indexed.
 @todo Add regex functionality to the name search
 */
 template<typename T>
 T* SLNode::findChild(const SLstring& name, SLbool findRecursive)
+{   
+    SLNodeIndex* index = childIndex();
+    if (!index) return findChildRec<T>(name, findRecursive);
+    return dynamic_cast<T*>(index->findFirst(this, name, findRecursive, isOfType<T>));
+}
+//-----------------------------------------------------------------------------
+/*!
+SLNode::findChildRec<T> is the tree search of findChild<T>. It checks first
+all direct children and then descends into them.
+*/
+template<typename T>
+T* SLNode::findChildRec(const SLstring& name, SLbool findRecursive)
 {   
     for (SLint i = 0; i < _children.size(); ++i)
     {
@@ -317,7 +394,7 @@ T* SLNode::findChild(const SLstring& name, SLbool findRecursive)
     if (findRecursive)
     {
         for (SLint i = 0; i < _children.size(); ++i)
-        {   T* found = _children[i]->findChild<T>(name, findRecursive);
+        {   T* found = _children[i]->findChildRec<T>(name, findRecursive);
             if (found)
                 return found;
         }
@@ -331,13 +408,24 @@ T* SLNode::findChild(const SLstring& name, SLbool findRecursive)
 /*!
 SLNode::findChildren<T> finds a list of all children that are of type T or
 subclasses of T. If a name is specified only nodes with that name are included.
+The nodes are looked up in the node index in depth first order.
 @todo Add regex functionality to the name search
 */
 template<typename T>
 vector<T*> SLNode::findChildren(const SLstring& name, SLbool findRecursive)
 {
     vector<T*> list;
-    findChildrenHelper<T>(name, list, findRecursive);
+    SLNodeIndex* index = childIndex();
+    if (!index)
+    {   findChildrenHelper<T>(name, list, findRecursive);
+        return list;
+    }
+
+    SLVNode found;
+    index->findAll(this, name, findRecursive, isOfType<T>, found);
+    list.reserve(found.size());
+    for (auto node : found)
+        list.push_back(dynamic_cast<T*>(node));
     return list;
 }
 //-----------------------------------------------------------------------------
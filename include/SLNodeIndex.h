@@ -0,0 +1,135 @@
+//#############################################################################
+//  File:      SLNodeIndex.h
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLNODEINDEX_H
+#define SLNODEINDEX_H
+
+#include <stdafx.h>
+#include <unordered_map>
+#include <typeindex>
+
+class SLNode;
+class SLMesh;
+
+//-----------------------------------------------------------------------------
+//! Type test function for the node lookups (e.g. dynamic_cast<T*> != nullptr)
+typedef SLbool (*SLNodeFilter)(SLNode* node);
+//-----------------------------------------------------------------------------
+//! Hashed index of the nodes of a scene by name, type and mesh
+/*!
+SLNodeIndex maps the names, the dynamic types and the meshes of all nodes of a
+scene that have a parent to these nodes. Every SLScene holds one index
+(SLScene::nodeIndex). A node gets indexed by SLNode::parent when it is added
+to a parent and gets removed when it loses its parent or gets deleted.
+Renames and mesh changes are passed on by SLNode::name, SLNode::addMesh and
+SLNode::removeMesh. The type is taken with typeid when the node is added
+because in the constructor of SLNode the dynamic type is not yet known. The
+node keeps it for the removal.
+\n
+The node lists of the maps are updated incrementally: A node is appended to
+its lists and remembers its slot in each list, so that it is removed in
+constant time by moving the last node of the list into its slot. A change of
+the hierarchy only flags the tree order.
+\n
+A lookup with few candidates (e.g. a unique name) checks for each candidate
+with a walk up its parents whether it is below the root. Only the lookups
+with several matches or long lists need the tree order: All nodes then get a
+number in depth first pre-order (SLNode::_indexOrder) and the last number of
+their subtree (SLNode::_indexLast) in one traversal that is only repeated
+after a change of the hierarchy. A long list gets sorted by these numbers
+when it is used, so its matches below a root are found with a binary search.
+\n
+SLNodeIndex::findFirst returns the same node as the recursive tree search
+SLNode::findChildRec: direct children of a node are checked before their
+subtrees. SLNodeIndex::findAll returns the nodes in depth first order like
+SLNode::findChildrenHelper. The lookups are not thread safe because they may
+rebuild the numbering. SLNodeIndex::clear unlinks all nodes at once, so that
+the destructor of SLScene deletes the nodes without removing them one by one.
+*/
+class SLNodeIndex
+{
+    public:
+                        SLNodeIndex     () : _numNodes(0),
+                                             _numAdded(0),
+                                             _orderStamp(1),
+                                             _isOrdered(true) {}
+                       ~SLNodeIndex     () {clear();}
+
+            void        add             (SLNode* node);
+            void        remove          (SLNode* node);
+            void        clear           ();
+            void        invalidate      () {_isOrdered = false;}
+            void        rename          (SLNode* node,
+                                         const SLstring& oldName,
+                                         const SLstring& newName);
+            void        addMesh         (SLNode* node, const SLMesh* mesh);
+            void        removeMesh      (SLNode* node, const SLMesh* mesh);
+
+            SLNode*     findFirst       (SLNode* root,
+                                         const SLstring& name,
+                                         SLbool recursive,
+                                         SLNodeFilter filter);
+            void        findAll         (SLNode* root,
+                                         const SLstring& name,
+                                         SLbool recursive,
+                                         SLNodeFilter filter,
+                                         vector<SLNode*>& found);
+            void        findAll         (SLNode* root,
+                                         const SLMesh* mesh,
+                                         SLbool recursive,
+                                         vector<SLNode*>& found);
+
+            // Getters
+            SLuint      numNodes        () const {return _numNodes;}
+            SLuint      numNames        () const {return (SLuint)_byName.size();}
+            SLuint      numTypes        () const {return (SLuint)_byType.size();}
+
+    private:
+            //! Key kind of a node list that tells which slot of the node to set
+            enum SLListKind {LK_name, LK_type, LK_mesh};
+
+            //! Node list of one key with the order stamp it was sorted with
+            struct SLNodeList
+            {   SLNodeList(SLListKind k = LK_name, const SLMesh* m = nullptr) :
+                    kind(k), mesh(m), sortedStamp(0) {}
+                vector<SLNode*> nodes;      //!< nodes in any order
+                SLListKind      kind;       //!< key kind of the list
+                const SLMesh*   mesh;       //!< mesh key of a mesh list
+                SLuint          sortedStamp;//!< _orderStamp of the sorting (0=unsorted)
+            };
+
+            void        append          (SLNodeList& list, SLNode* node);
+            void        removeAt        (SLNodeList& list, SLuint slot);
+            void        setSlot         (SLNodeList& list, SLuint slot);
+            void        sortList        (SLNodeList& list);
+            void        updateOrder     ();
+            void        numberRec       (SLNode* node, SLuint& order);
+            SLbool      isNumbered      (SLNode* root) const;
+            void        collect         (SLNode* root,
+                                         SLNodeList& list,
+                                         SLbool recursive,
+                                         SLNodeFilter filter,
+                                         vector<SLNode*>& found);
+            void        sortFound       (vector<SLNode*>& found, size_t begin);
+    static  SLbool      isBelow         (const SLNode* node,
+                                         const SLNode* root,
+                                         SLbool recursive);
+    static  SLbool      isBefore        (const SLNode* a, const SLNode* b);
+
+            unordered_map<SLstring, SLNodeList>      _byName;    //!< nodes by name
+            unordered_map<type_index, SLNodeList>    _byType;    //!< nodes by dynamic type
+            unordered_map<const SLMesh*, SLNodeList> _byMesh;    //!< nodes by mesh
+            SLuint                                   _numNodes;  //!< NO. of indexed nodes
+            SLuint                                   _numAdded;  //!< NO. of additions for SLNode::_indexSeq
+            SLuint                                   _orderStamp;//!< stamp of the current numbering
+            SLbool                                   _isOrdered; //!< flag if the numbering is valid
+};
+//-----------------------------------------------------------------------------
+#endif
@@ -29,7 +29,7 @@ class SLObject
             virtual         ~SLObject(){}
             
             // Setters
-            void            name(const SLstring& Name){_name = Name;}
+    virtual void            name(const SLstring& Name){_name = Name;}
             
             // Getters
             const SLstring& name() const {return _name;}
@@ -0,0 +1,77 @@
+//#############################################################################
+//  File:      SLOcclusionCuller.h
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLOCCLUSIONCULLER_H
+#define SLOCCLUSIONCULLER_H
+
+#include <stdafx.h>
+
+class SLMesh;
+class SLAABBox;
+
+//-----------------------------------------------------------------------------
+//! Software rasterized hierarchical depth buffer for occlusion culling
+/*!
+An SLOcclusionCuller rasterizes a small set of occluder meshes on the CPU into
+a low resolution depth buffer (SL_OCCLUSION_BUFFER_W pixels wide). The pixel
+loop processes 4 pixels at once with SSE if available. From this buffer a
+depth pyramid is built where each texel holds the max. (farthest) depth of its
+4 child texels. An AABB is tested by projecting its 8 corners to get its screen
+rectangle and its nearest depth. The rectangle is tested on the pyramid level
+where it covers at most 4x4 texels. If the nearest depth of the AABB is behind
+all texels it is occluded.
+\n
+The depth of a covered pixel is the depth of the occluder at the farthest pixel
+corner, so the depth test is conservative. The coverage is sampled at the pixel
+centers, so occludees that are only visible through gaps smaller than one
+buffer pixel may get culled.
+\n
+The culler is used by SLSceneView::occlusionCull after the frustum culling
+with the largest opaque nodes in view as occluders.
+*/
+class SLOcclusionCuller
+{
+    public:
+                        SLOcclusionCuller   ();
+
+            void        clear               (SLfloat aspectWdivH,
+                                             const SLMat4f& viewProjection);
+            void        rasterize           (SLMesh* mesh,
+                                             SLint lodLevel,
+                                             const SLMat4f& wm,
+                                             SLbool cullBackFaces);
+            void        buildPyramid        ();
+            SLbool      isVisible           (SLAABBox* aabb);
+
+            // Getters
+            SLint       width               () const {return _w;}
+            SLint       height              () const {return _h;}
+            SLuint      numTriangles        () const {return _numTriangles;}
+
+    private:
+            void        rasterizeTriangle   (const SLVec4f* clip,
+                                             SLbool cullBackFaces);
+            void        rasterizeScreen     (SLVec3f v0,
+                                             SLVec3f v1,
+                                             SLVec3f v2,
+                                             SLbool cullBackFaces);
+
+            SLint       _w;                 //!< Width of depth buffer (multiple of 4)
+            SLint       _h;                 //!< Height of depth buffer
+            SLMat4f     _vp;                //!< View projection matrix
+            vector<SLVfloat> _levels;       //!< Depth pyramid (level 0 = full res.)
+            SLVint      _levelW;            //!< Width of each pyramid level
+            SLVint      _levelH;            //!< Height of each pyramid level
+            SLVVec4f    _clipP;             //!< Temp. clip space vertex positions
+            SLVbool     _isClipped;         //!< Flags the transformed vertices of _clipP
+            SLuint      _numTriangles;      //!< NO. of rasterized occluder triangles
+};
+//-----------------------------------------------------------------------------
+#endif
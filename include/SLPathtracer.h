@@ -12,13 +12,25 @@
 
 #include <stdafx.h>
 #include <SLRaytracer.h>
+#include <SLSampler.h>
 
 //-----------------------------------------------------------------------------
 //! Classic Monte Carlo Pathtracing algorithm for real global illumination
+/*!
+Each sample of a pixel traces one path with its own SLSampler of the type set
+with samplerType. The quasi-Monte Carlo sequences (ST_sobol by default)
+converge faster than independent random numbers.
+\n
+For the comparison of the samplers a reference image can be set with
+setReference (the current accumulated image) or loadReference (an HDR image
+saved by saveImage). Then the root mean square error (RMSE) of the linear
+image to the reference is measured after each sample and logged at the end of
+render for 1, 2, 4, ... samples.
+*/
 class SLPathtracer : public SLRaytracer
 {  public:           
                         SLPathtracer();
-                       ~SLPathtracer(){SL_LOG("~SLPathtracer\n");;}
+                       ~SLPathtracer();
             
             // classic ray tracer functions
             SLbool      render      (SLSceneView* sv);
@@ -27,8 +39,26 @@ class SLPathtracer : public SLRaytracer
             SLCol4f     shade       (SLRay* ray, SLCol4f* mat);
             void        saveImage   ();
 
+            // Convergence measurement
+            SLbool      setReference    ();
+            SLbool      loadReference   (SLstring filename);
+            void        clearReference  ();
+
+            // Setters
+            void        samplerType     (SLSamplerType type) {_samplerType = type; state(rtReady);}
+
+            // Getters
+            SLSamplerType samplerType   () const {return _samplerType;}
+            SLImage*    reference       () {return _reference;}
+      const SLVfloat&   rmse            () const {return _rmse;}
+
    private:
-            SLfloat     _gamma;     //!< gamma correction
+            SLfloat     rmseToReference ();
+
+            SLfloat     _gamma;         //!< gamma correction
+            SLSamplerType _samplerType; //!< Type of the sample sequences
+            SLImage*    _reference;     //!< Linear reference image for the RMSE
+            SLVfloat    _rmse;          //!< RMSE to the reference after each sample
 };
 //-----------------------------------------------------------------------------
 #endif
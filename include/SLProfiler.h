@@ -0,0 +1,96 @@
+//#############################################################################
+//  File:      SL/SLProfiler.h
+//  Author:    Marcus Hudritsch
+//  Purpose:   Scoped CPU profiler with per thread ring buffers and Chrome
+//             trace export
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLPROFILER_H
+#define SLPROFILER_H
+
+#include <stdafx.h>
+
+//-----------------------------------------------------------------------------
+//! NO. of events in the ring buffer of each thread (must be a power of 2)
+#define SL_PROFILE_RING_SIZE 65536
+//-----------------------------------------------------------------------------
+//! One measured scope with its name literal and start and end time in ns
+struct SLProfileEvent
+{   const SLchar*   name;       //!< Name of the scope (string literal)
+    SLint64         startNS;    //!< Start time in nanoseconds
+    SLint64         endNS;      //!< End time in nanoseconds
+};
+//-----------------------------------------------------------------------------
+//! Static hierarchical CPU profiler with Chrome trace export
+/*!
+SLProfiler records the start and end time of the scopes that are marked with
+SL_PROFILE_SCOPE. Each thread writes its events without any lock into its own
+ring buffer of SL_PROFILE_RING_SIZE events. The ring buffer of a thread gets
+allocated at its first event and is reused by the next thread after it ended.
+So the worker threads that get started for every ray tracing pass share the
+same few buffers.
+\n
+If the profiler is not enabled a scope costs one relaxed atomic load. With
+SL_NO_PROFILING defined the markers compile to nothing.
+\n
+SLProfiler::exportChromeTrace writes all events recorded since the last start
+in the Trace Event Format of Chrome that can be opened in chrome://tracing or
+in https://ui.perfetto.dev. The nested scopes of a thread are shown as a
+flame graph on the track of the thread.
+*/
+class SLProfiler
+{
+    public:
+    static  void        start               ();
+    static  void        stop                ();
+    static  SLbool      exportChromeTrace   (const SLstring& filename);
+    static  void        threadName          (const SLchar* name);
+    static  void        record              (const SLchar* name,
+                                             SLint64 startNS,
+                                             SLint64 endNS);
+
+    static  SLbool      isEnabled           () {return _isEnabled.load(memory_order_relaxed);}
+    static  SLint64     nowNS               () {return duration_cast<nanoseconds>
+                                                      (steady_clock::now().time_since_epoch()).count()+1;}
+
+    private:
+    static  atomic<bool> _isEnabled;        //!< Flag if events are recorded
+    static  SLint64     _startNS;           //!< Time of the last start
+};
+//-----------------------------------------------------------------------------
+//! Measures the lifetime of its scope if the profiler is enabled
+class SLProfileScope
+{
+    public:
+                        SLProfileScope      (const SLchar* name)
+                        {   _name = name;
+                            _startNS = SLProfiler::isEnabled() ? SLProfiler::nowNS() : 0;
+                        }
+                       ~SLProfileScope      ()
+                        {   if (_startNS)
+                                SLProfiler::record(_name, _startNS, SLProfiler::nowNS());
+                        }
+    private:
+            const SLchar* _name;            //!< Name of the scope (string literal)
+            SLint64     _startNS;           //!< Start time in ns or 0 if disabled
+};
+//-----------------------------------------------------------------------------
+#define SL_PROFILE_CONCAT2(a, b) a##b
+#define SL_PROFILE_CONCAT(a, b)  SL_PROFILE_CONCAT2(a, b)
+
+#ifndef SL_NO_PROFILING
+//! Measures the enclosing scope. The name must be a string literal.
+#define SL_PROFILE_SCOPE(name)  SLProfileScope SL_PROFILE_CONCAT(slProfileScope, __LINE__)(name)
+//! Names the track of the current thread in the trace
+#define SL_PROFILE_THREAD(name) SLProfiler::threadName(name)
+#else
+#define SL_PROFILE_SCOPE(name)
+#define SL_PROFILE_THREAD(name)
+#endif
+//-----------------------------------------------------------------------------
+#endif
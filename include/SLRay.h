@@ -16,6 +16,7 @@
 
 struct SLFace16;
 class  SLNode;
+class  SLSampler;
 
 //-----------------------------------------------------------------------------
 //! SLRayType enumeration for specifying ray type in ray tracing
@@ -30,6 +31,17 @@ Ray class for Ray Tracing. It not only holds informations about the ray itself
 but also about the node hit by the ray. With that information the method 
 reflect calculates a reflected ray and the method transmit calculates a 
 REFRACTED ray.
+\n
+For the mipmapped texture lookup each ray carries a ray cone with the width
+coneWidth at its origin that grows with coneSpread per unit length. Primary
+rays get the angle of one pixel. Reflected and refracted rays continue the cone
+with its width at the hit point and the same spread, which assumes locally flat
+surfaces.
+\n
+In path tracing each ray of a path carries the SLSampler of its pixel sample.
+The Monte Carlo methods get their random numbers with sampleBSDF, sampleChoice
+and sampleLight from the dimensions of the ray depth. Without a sampler they
+use the global random generator rnd01.
 */
 class SLRay
 {  
@@ -65,6 +77,10 @@ class SLRay
     inline  SLbool      hitMatIsReflective  () const;
     inline  SLbool      hitMatIsTransparent () const;
     inline  SLbool      hitMatIsDiffuse     () const;
+    inline  SLfloat     coneWidthAtHit      () const {return coneWidth + coneSpread*length;}
+            SLVec2f     sampleBSDF          () const;
+            SLfloat     sampleChoice        () const;
+            SLVec2f     sampleLight         () const;
             
             // Classic ray members
             SLVec3f     origin;         //!< Vector to the origin of ray in WS
@@ -74,6 +90,8 @@ class SLRay
             SLfloat     length;         //!< length from origin to an intersection
             SLint       depth;          //!< Recursion depth for ray tracing
             SLfloat     contrib;        //!< Current contribution of ray to color
+            SLfloat     coneWidth;      //!< Width of the ray cone at the origin
+            SLfloat     coneSpread;     //!< Growth of the cone width per unit length
             
             // Additional info for intersection 
             SLRayType   type;           //!< PRIMARY, REFLECTED, REFRACTED, SHADOW
@@ -85,6 +103,7 @@ class SLRay
             SLMesh*     srcMesh;        //!< Points to the mesh at ray origin
             SLint       srcTriangle;    //!< Points to the triangle at ray origin
             SLCol4f     backgroundColor;//!< Background color at pixel x,y
+            SLSampler*  sampler;        //!< Sampler of the path (nullptr = rnd01)
 
             // Members set after at intersection
             SLfloat     hitU, hitV;     //!< barycentric coords in hit triangle
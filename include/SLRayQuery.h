@@ -0,0 +1,100 @@
+//#############################################################################
+//  File:      SLRayQuery.h
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLRAYQUERY_H
+#define SLRAYQUERY_H
+
+#include <stdafx.h>
+#include <SLNode.h>
+
+class SLRay;
+
+//-----------------------------------------------------------------------------
+//! Result of a ray query
+struct SLRayHit
+{               SLRayHit() : node(nullptr), mesh(nullptr), triangle(-1),
+                             u(0.0f), v(0.0f), distance(FLT_MAX) {}
+
+    SLNode*     node;       //!< hit node (nullptr if nothing was hit)
+    SLMesh*     mesh;       //!< hit mesh
+    SLint       triangle;   //!< index of the hit triangle in the mesh
+    SLfloat     u, v;       //!< barycentric coords in the hit triangle
+    SLfloat     distance;   //!< distance from the ray origin in WS
+};
+typedef vector<SLRayHit> SLVRayHit;
+//-----------------------------------------------------------------------------
+//! Ray casts against a scenegraph for application code
+/*!
+SLRayQuery casts rays against the meshes below a root node without the ray
+tracing state of SLRay. Only nodes whose layers (see SLNode::layers) match the
+layer mask and that pass the optional node filter are tested. Their children
+are tested anyway. Hidden nodes are skipped with their children.
+\n
+SLRayQuery::raycast returns the closest hit, SLRayQuery::raycastAll the
+closest hit on each hit mesh sorted by distance and SLRayQuery::occluded stops
+at the first hit. The directions get normalized, so all distances are in world
+space units. SLRayQuery::raycastBatch and SLRayQuery::occludedBatch distribute
+many rays over SL::maxThreads() threads. Before a batch the transform store of
+the root gets flushed with SLTransformStore::update and the AABBs below the
+root get updated because their lazy update is not thread safe.
+*/
+class SLRayQuery
+{
+    public:
+                        SLRayQuery      (SLNode* root,
+                                         SLuint layerMask = SL_LAYER_ALL,
+                                         SLNodeFilter filter = nullptr);
+
+            SLbool      raycast         (const SLVec3f& origin,
+                                         const SLVec3f& dir,
+                                         SLRayHit& hit,
+                                         SLfloat maxDist = FLT_MAX) const;
+            SLuint      raycastAll      (const SLVec3f& origin,
+                                         const SLVec3f& dir,
+                                         SLVRayHit& hits,
+                                         SLfloat maxDist = FLT_MAX) const;
+            SLbool      occluded        (const SLVec3f& origin,
+                                         const SLVec3f& dir,
+                                         SLfloat maxDist) const;
+            SLuint      raycastBatch    (const SLVVec3f& origins,
+                                         const SLVVec3f& dirs,
+                                         SLVRayHit& hits,
+                                         SLfloat maxDist = FLT_MAX) const;
+            SLuint      occludedBatch   (const SLVVec3f& origins,
+                                         const SLVVec3f& dirs,
+                                         const SLVfloat& maxDists,
+                                         SLVuchar& isOccluded) const;
+
+            // Setters
+            void        layerMask       (SLuint mask) {_layerMask = mask;}
+            void        filter          (SLNodeFilter filter) {_filter = filter;}
+
+            // Getters
+            SLNode*     root            () const {return _root;}
+            SLuint      layerMask       () const {return _layerMask;}
+            SLNodeFilter filter         () const {return _filter;}
+
+    private:
+            void        initRay         (SLRay* ray,
+                                         const SLVec3f& origin,
+                                         const SLVec3f& dir,
+                                         SLfloat maxDist) const;
+            SLbool      hitRec          (SLNode* node,
+                                         SLRay* ray,
+                                         SLVRayHit* allHits) const;
+            void        runBatch        (SLuint numRays,
+                                         function<void(SLuint first, SLuint end)> job) const;
+
+            SLNode*     _root;          //!< root node of the queried scenegraph
+            SLuint      _layerMask;     //!< layers of the tested nodes
+            SLNodeFilter _filter;       //!< optional filter of the tested nodes
+};
+//-----------------------------------------------------------------------------
+#endif
@@ -37,12 +37,18 @@ struct SLRTAAPixel
 };
 typedef vector<SLRTAAPixel> SLVPixel;
 //-----------------------------------------------------------------------------
+//! Pixel block size of the first coarse pass in progressive ray tracing
+#define SL_RT_PROG_START_BLOCK 8
+//-----------------------------------------------------------------------------
 //! SLRaytracer hold all the methods for Whitted style Ray Tracing.
 /*!      
 SLRaytracer implements the methods render, eyeToPixel, trace and shade for
 classic Whitted style Ray Tracing. This class is a friend class of SLScene and
 can access via the pointer _s all members of SLScene. The scene traversal for
 the ray intersection tests is done within the intersection method of all nodes. 
+In progressive mode (see renderProgressive) the image is first rendered in 
+coarse pixel blocks with low depth and then refined pass by pass within a
+time budget per frame, so that the camera can be moved interactively.
 */
 class SLRaytracer: public SLGLTexture, public SLEventHandler
 {
@@ -53,8 +59,10 @@ class SLRaytracer: public SLGLTexture, public SLEventHandler
             // ray tracer functions
             SLbool      renderClassic   (SLSceneView* sv);
             SLbool      renderDistrib   (SLSceneView* sv);
+            SLbool      renderProgressive(SLSceneView* sv);
             void        renderSlices    (const bool isMainThread);
             void        renderSlicesMS  (const bool isMainThread);
+            void        renderBlocks    (const bool isMainThread);
             SLCol4f     trace           (SLRay* ray);
             SLCol4f     shade           (SLRay* ray);
             void        sampleAAPixels  (const bool isMainThread);
@@ -65,13 +73,16 @@ class SLRaytracer: public SLGLTexture, public SLEventHandler
             SLCol4f     fogBlend        (SLfloat z, SLCol4f color);
             void        printStats      (SLfloat sec);
             void        initStats       (SLint depth);
+            SLbool      viewChanged     ();
             
             // Setters
             void        state           (SLRTState state) {if (_state!=rtBusy) _state=state;}
-            void        maxDepth        (SLint depth)     {_maxDepth = depth; state(rtReady);}
+            void        maxDepth        (SLint depth)     {_maxDepth = depth; _progBlock = 0; state(rtReady);}
             void        distributed     (SLbool distrib)  {_distributed = distrib;}
             void        continuous      (SLbool cont)     {_continuous = cont; state(rtReady);}
             void        aaSamples       (SLint samples)   {_aaSamples = samples; state(rtReady);}
+            void        progressive     (SLbool prog)     {_progressive = prog; _progBlock = 0; state(rtReady);}
+            void        progBudgetMS    (SLfloat ms)      {_progBudgetMS = ms;}
             
             // Getters
             SLRTState   state           () const {return _state;}
@@ -79,6 +90,9 @@ class SLRaytracer: public SLGLTexture, public SLEventHandler
             SLbool      distributed     () const {return _distributed;}
             SLbool      continuous      () const {return _continuous;}
             SLint       aaSamples       () const {return _aaSamples;}
+            SLbool      progressive     () const {return _progressive;}
+            SLint       progBlock       () const {return _progBlock;}
+            SLfloat     progBudgetMS    () const {return _progBudgetMS;}
             SLint       numThreads      () const {return SL::maxThreads();}
             SLint       pcRendered      () const {return _pcRendered;}
             SLfloat     aaThreshold     () const {return _aaThreshold;}
@@ -103,6 +117,7 @@ class SLRaytracer: public SLGLTexture, public SLEventHandler
             SLCol4f     _infoColor;     //!< Original info string color
 
             SLfloat     _pxSize;        //!< Pixel size
+            SLfloat     _pxAngle;       //!< Angle of a pixel seen from the eye
             SLVec3f     _EYE;           //!< Camera position
             SLVec3f     _LA, _LU, _LR;  //!< Camera lookat, lookup, lookright
             SLVec3f     _BL;            //!< Bottom left vector
@@ -112,6 +127,14 @@ class SLRaytracer: public SLGLTexture, public SLEventHandler
             // variables for distributed ray tracing
             SLfloat     _aaThreshold;   //!< threshold for anti aliasing
             SLint       _aaSamples;     //!< SQRT of uneven num. of AA samples
+
+            // variables for progressive interactive ray tracing
+            SLbool      _progressive;   //!< Flag for progressive refinement
+            SLint       _progBlock;     //!< Pixel block size of current pass (0=restart)
+            SLfloat     _progBudgetMS;  //!< Max. time per frame for one pass step
+            SLMat4f     _progVM;        //!< Camera view matrix of current refinement
+            SLfloat     _progFov;       //!< Camera field of view of current refinement
+            SLProjection _progProj;     //!< Camera projection of current refinement
 };
 //-----------------------------------------------------------------------------
 #endif
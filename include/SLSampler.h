@@ -0,0 +1,106 @@
+//#############################################################################
+//  File:      SLSampler.h
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLSAMPLER_H
+#define SLSAMPLER_H
+
+#include <stdafx.h>
+
+//-----------------------------------------------------------------------------
+//! Type of the sample sequence of SLSampler
+enum SLSamplerType
+{   ST_random = 0,      //!< Independent hashed random numbers
+    ST_halton,          //!< Halton sequence with per pixel rotation
+    ST_sobol,           //!< Owen scrambled Sobol sequence per pixel
+    ST_blueNoise        //!< Sobol sequence rotated by a blue noise mask
+};
+//-----------------------------------------------------------------------------
+//! Max. NO. of lights per bounce with own sample dimensions
+#define SL_SAMPLER_MAX_LIGHTS 8
+//-----------------------------------------------------------------------------
+//! Sample generator for one sample of a pixel in path tracing
+/*!
+An SLSampler delivers the 2D samples of one path that starts at the pixel x,y
+as the sample with the index sampleIndex of this pixel. A sample is addressed
+by its dimension pair and can be fetched in any order, so the sampler has no
+state that could run out of sync between the recursion levels.
+\n
+The dimension pairs are assigned by the static functions: The pixel jitter
+gets pair 0. Each bounce (ray depth) then gets its own block of pairs for the
+BSDF direction, the Fresnel choice and each light with its index set with
+SLSampler::light. Lights with an index of SL_SAMPLER_MAX_LIGHTS or more and
+Halton dimensions beyond its prime table get independent random numbers.
+\n
+The sequences:
+<ul>
+<li>ST_random: Independent random numbers from a hash of the pixel, the
+sample index and the dimension. It is the reference for the others.</li>
+<li>ST_halton: The Halton sequence with two primes per pair that gets
+shifted per pixel and dimension with a random Cranley-Patterson
+rotation.</li>
+<li>ST_sobol: The first two dimensions of the Sobol sequence, a (0,2)
+sequence, for each pair. The index is shuffled per pixel and pair and the
+points are Owen scrambled with a hash (Laine-Karras permutation). So every
+pixel and pair gets an independent sequence that keeps the stratification of
+the Sobol sequence for any power of 2 samples.</li>
+<li>ST_blueNoise: The same Owen scrambled Sobol sequence for all pixels that
+gets rotated per pixel by a 64x64 blue noise mask. The error of neighbouring
+pixels is then not correlated, which looks much less noisy at low sample
+counts.</li>
+</ul>
+SLSampler::testConvergence is a self-test of the sequences without a scene:
+It integrates a 4D function with a discontinuity and a known integral over
+the pixel and BSDF pairs of many pixels and logs the root mean square error
+(RMSE) of the pixel estimates for 1, 2, 4, ... samples per pixel. It passes
+if every quasi-Monte Carlo sequence has a lower RMSE than ST_random at the
+largest sample count.
+*/
+class SLSampler
+{
+    public:
+                        SLSampler       (SLSamplerType type,
+                                         SLuint x,
+                                         SLuint y,
+                                         SLuint sampleIndex,
+                                         SLuint seed = 0);
+
+            SLVec2f     get2D           (SLuint pair) const;
+            SLfloat     get1D           (SLuint pair) const {return get2D(pair).x;}
+
+            // Setters
+            void        light           (SLuint index) {_light = index;}
+
+            // Getters
+            SLSamplerType type          () const {return _type;}
+            SLuint      light           () const {return _light;}
+
+            // Dimension pairs of a path
+    static  SLuint      pairPixel       () {return 0;}
+    static  SLuint      pairBSDF        (SLint depth);
+    static  SLuint      pairChoice      (SLint depth);
+    static  SLuint      pairLight       (SLint depth, SLuint light);
+
+    static  const SLchar* typeName      (SLSamplerType type);
+
+            // Convergence self-test
+    static  SLfloat     testRMSE        (SLSamplerType type,
+                                         SLuint numSamples,
+                                         SLuint numPixels = 4096);
+    static  SLbool      testConvergence (SLuint maxSamples = 256);
+
+    private:
+            SLSamplerType _type;        //!< Type of the sequence
+            SLuint      _x, _y;         //!< Pixel position
+            SLuint      _index;         //!< Sample index within the pixel
+            SLuint      _pixelHash;     //!< Hash of the pixel & the seed
+            SLuint      _light;         //!< Index of the sampled light
+};
+//-----------------------------------------------------------------------------
+#endif
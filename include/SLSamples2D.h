@@ -30,9 +30,10 @@ class SLSamples2D
             SLint       samples (){return _samples;}
             SLVec2f     point(SLint x,SLint y){return _points[x*_samplesY + y];}
             SLuint      sizeInBytes() {return (SLuint)(_points.size() * sizeof(SLVec2f));}
+
+    static  SLVec2f     mapSquareToDisc   (SLfloat x, SLfloat y);
    private:
             void        distribConcentric (SLbool evenlyDistributed); 
-            SLVec2f     mapSquareToDisc   (SLfloat x, SLfloat y);
 
             SLint       _samplesX;    //!< No. of samples in x direction
             SLint       _samplesY;    //!< No. of samples in y direction
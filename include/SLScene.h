@@ -21,6 +21,7 @@
 #include <SLGLOculus.h>
 #include <SLAnimManager.h>
 #include <SLAverage.h>
+#include <SLTexResidency.h>
 
 class SLSceneView;
 class SLButton;
@@ -54,8 +55,9 @@ class SLScene: public SLObject
             void            info            (SLSceneView* sv, SLstring infoText, 
                                              SLCol4f color=SLCol4f::WHITE);
             void            stopAnimations  (SLbool stop) {_stopAnimations = stop;}
-            void            infoGL          (SLText* t) {_infoGL = t;}
-            void            infoRT          (SLText* t) {_infoRT = t;}
+            void            fixedTimeStepMS (SLfloat stepMS) {_fixedTimeStepMS = stepMS;
+                                                              _accumulatorMS = 0.0f;}
+            void            maxSubSteps     (SLint maxSteps) {_maxSubSteps = maxSteps;}
             void            infoLoading     (SLText* t) {_infoLoading = t;}
             void            menu2D          (SLButton* b) {_menu2D = b;}
             void            menuGL          (SLButton* b) {_menuGL = b;}
@@ -66,6 +68,9 @@ class SLScene: public SLObject
             void            btnHelp         (SLButton* b) {_btnHelp = b;}
                            
             // Getters
+            SLTransformStore& transforms    () {return _transforms;}
+            SLNodeIndex&    nodeIndex       () {return _nodeIndex;}
+            SLTexResidency& texResidency    () {return _texResidency;}
             SLAnimManager&  animManager     () {return _animManager;}
             SLSceneView*    sv              (SLuint index) {return _sceneViews[index];}
             SLVSceneView&   sceneViews      () {return _sceneViews;}
@@ -90,9 +95,8 @@ class SLScene: public SLObject
             SLstring        infoHelp_en     () const {return _infoHelp_en;}
             SLText*         info            (SLSceneView* sv);
             SLText*         info            () {return _info;}
-            SLText*         infoGL          () {return _infoGL;}
-            SLText*         infoRT          () {return _infoRT;}
             SLText*         infoLoading     () {return _infoLoading;}
+            SLstring        infoLoadingText () const {return _infoLoadingText;}
             SLGLTexture*    texCursor       () {return _texCursor;}
             SLCol4f         globalAmbiLight () const {return _globalAmbiLight;}
             SLVLight&       lights          () {return _lights;}
@@ -110,6 +114,11 @@ class SLScene: public SLObject
             SLNode*         selectedNode    () {return _selectedNode;}
             SLMesh*         selectedMesh    () {return _selectedMesh;}
             SLbool          stopAnimations  () const {return _stopAnimations;}
+            SLfloat         fixedTimeStepMS () const {return _fixedTimeStepMS;}
+            SLint           maxSubSteps     () const {return _maxSubSteps;}
+            SLfloat         simTimeMS       () const {return _simTimeMS;}
+            SLuint          numSimSteps     () const {return _numSimSteps;}
+            SLfloat         interpolationAlpha() const {return _interpolationAlpha;}
             SLGLOculus*     oculus          () {return &_oculus;}   
             SLbool          usesVideoImage  () {return _usesVideoImage;}
             SLGLTexture*    videoTexture    () {return &_videoTexture;}
@@ -119,8 +128,10 @@ class SLScene: public SLObject
             void            init            ();
             void            unInit          ();
             bool            onUpdate        ();
+            SLbool          updateAnimations(SLfloat frameTimeMS);
             void            deleteAllMenus  ();
             SLbool          onCommandAllSV  (const SLCommand cmd);
+            void            loadingProgress (SLstring progressText);
             void            selectNode      (SLNode* nodeToSelect);
             void            selectNodeMesh  (SLNode* nodeToSelect, SLMesh* meshToSelect);
             void            copyVideoImage  (int width, int height, 
@@ -141,6 +152,9 @@ class SLScene: public SLObject
             SLAnimManager   _animManager;       //!< Animation manager instance
             
             SLNode*         _root3D;            //!< Root node for 3D scene
+            SLTransformStore _transforms;       //!< Flattened world transforms of _root3D
+            SLNodeIndex     _nodeIndex;         //!< Hashed index of all nodes with a parent
+            SLTexResidency  _texResidency;      //!< GPU residency of the textures
             SLNode*         _selectedNode;      //!< Pointer to the selected node
             SLMesh*         _selectedMesh;      //!< Pointer to the selected mesh
 
@@ -152,9 +166,8 @@ class SLScene: public SLObject
             SLint           _numProgsPreload;   //!< No. of preloaded shaderProgs
             
             SLText*         _info;              //!< Text node for scene info
-            SLText*         _infoGL;            //!< Root text node for 2D GL stats infos
-            SLText*         _infoRT;            //!< Root text node for 2D RT stats infos
             SLText*         _infoLoading;       //!< Root text node for 2D loading text
+            SLstring        _infoLoadingText;   //!< Progress text of the loading screen
             SLstring        _infoAbout_en;      //!< About info text
             SLstring        _infoCredits_en;    //!< Credits info text
             SLstring        _infoHelp_en;       //!< Help info text
@@ -178,6 +191,12 @@ class SLScene: public SLObject
             SLAvgFloat      _draw2DTimesMS;     //!< Averaged time for 2D drawing in ms
             
             SLbool          _stopAnimations;    //!< Global flag for stopping all animations
+            SLfloat         _fixedTimeStepMS;   //!< Fixed simulation time step in ms (0 = frame time)
+            SLint           _maxSubSteps;       //!< Max. NO. of simulation steps per frame
+            SLfloat         _accumulatorMS;     //!< Frame time not yet simulated in ms
+            SLfloat         _simTimeMS;         //!< Simulated time in ms
+            SLuint          _numSimSteps;       //!< NO. of simulation steps done
+            SLfloat         _interpolationAlpha;//!< Blend factor of the rendered pose
             
             SLGLOculus      _oculus;            //!< Oculus Rift interface
 
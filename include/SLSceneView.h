@@ -22,6 +22,9 @@
 #include <SLDrawBits.h>
 #include <SLGLOculusFB.h>
 #include <SLGLVertexArrayExt.h>
+#include <SLOcclusionCuller.h>
+#include <SLLightClusters.h>
+#include <SLTextBatch.h>
 
 //-----------------------------------------------------------------------------
 class SLCamera;
@@ -113,6 +116,10 @@ class SLSceneView: public SLObject
             // Drawing subroutines
             SLbool          draw3DGL            (SLfloat elapsedTimeSec);
             void            draw3DGLAll         ();
+            void            occlusionCull       ();
+            void            updateLightClusters ();
+            void            updateTexResidency  ();
+            SLbool          usesClusteredLighting();
             void            draw3DGLNodes       (SLVNode &nodes,
                                                  SLbool alphaBlended,
                                                  SLbool depthSorted);
@@ -161,6 +168,7 @@ class SLSceneView: public SLObject
             void            showInfo        (SLbool show) {_showInfo = show;}
             void            showStats       (SLbool show) {_showStats = show;}
             void            gotPainted      (SLbool val) {_gotPainted = val;}
+            void            lodPixelError   (SLfloat px) {_lodPixelError = px;}
 
             // Getters
             SLuint          index           () const {return _index;}
@@ -176,6 +184,8 @@ class SLSceneView: public SLObject
     inline  SLQuat4f        deviceRotation  () const {return _deviceRotation;}
             SLbool          gotPainted      () const {return _gotPainted;}
             SLbool          doFrustumCulling() const {return _doFrustumCulling;}
+            SLbool          doOcclusionCulling() const {return _doOcclusionCulling;}
+            SLbool          doClusteredLighting() const {return _doClusteredLighting;}
             SLbool          hasMultiSampling() const {return _stateGL->hasMultiSampling();}
             SLbool          doMultiSampling () const {return _doMultiSampling;}
             SLbool          doDepthTest     () const {return _doDepthTest;}
@@ -184,8 +194,10 @@ class SLSceneView: public SLObject
             SLbool          showStats       () const {return _showStats;}
             SLbool          showInfo        () const {return _showInfo;}
             SLbool          showMenu        () const {return _showMenu;}
+            SLbool          showLoading     () const {return _showLoading;}
             SLVNode*        blendNodes      () {return &_blendNodes;}
             SLVNode*        opaqueNodes     () {return &_opaqueNodes;}
+            SLTextBatch*    textBatch       () {return &_textBatch;}
             SLRaytracer*    raytracer       () {return &_raytracer;}
             SLPathtracer*   pathtracer      () {return &_pathtracer;}
             SLRenderType      renderType      () const {return _renderType;}
@@ -195,6 +207,8 @@ class SLSceneView: public SLObject
             SLfloat         cullTimeMS      () const {return _cullTimeMS;}
             SLfloat         draw3DTimeMS    () const {return _draw3DTimeMS;}
             SLfloat         draw2DTimeMS    () const {return _draw2DTimeMS;}
+            SLfloat         lodPixelError   () const {return _lodPixelError;}
+            SLVuint&        lodTriangles    () {return _lodTriangles;}
 
     static const SLint      LONGTOUCH_MS;       //!< Milliseconds duration of a long touch event 
 
@@ -211,6 +225,8 @@ class SLSceneView: public SLObject
             SLbool          _doDepthTest;       //!< Flag if depth test is turned on
             SLbool          _doMultiSampling;   //!< Flag if multisampling is on
             SLbool          _doFrustumCulling;  //!< Flag if view frustum culling is on
+            SLbool          _doOcclusionCulling;//!< Flag if occlusion culling is on
+            SLbool          _doClusteredLighting;//!< Flag if clustered lighting is forced on
             SLbool          _waitEvents;        //!< Flag for Event waiting
             SLbool          _usesRotation;      //!< Flag if device rotation is used
             SLDrawBits      _drawBits;          //!< Sceneview level drawing flags
@@ -243,10 +259,17 @@ class SLSceneView: public SLObject
             SLQuat4f        _deviceRotation;    //!< Mobile device rotation as quaternion
 
             SLGLOculusFB    _oculusFB;          //!< Oculus framebuffer
+            SLTextBatch     _textBatch;         //!< Batch for all 2D texts of a frame
+            SLstring        _infoStats;         //!< Statistics text for GL or RT
 			SLbool			_vrMode;			//!< Flag if we're in VR mode (forces camera to stereoD)
 
             SLVNode         _blendNodes;        //!< Vector of blended nodes
             SLVNode         _opaqueNodes;       //!< Vector of opaque nodes
+            SLfloat         _lodPixelError;     //!< Max. projected LOD error in pixels (0=LOD off)
+            SLVuint         _lodTriangles;      //!< NO. of culled triangles per LOD level
+            SLOcclusionCuller _occlusionCuller; //!< CPU depth pyramid for occlusion culling
+            SLint           _numOccluded;       //!< NO. of occluded nodes in last frame
+            SLLightClusters _lightClusters;     //!< Light to cluster assignment for clustered lighting
             
             SLRaytracer     _raytracer;         //!< Whitted style raytracer
             SLbool          _stopRT;            //!< Flag to stop the RT
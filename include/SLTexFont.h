@@ -17,6 +17,14 @@
 #ifndef SLTEXFONT
 #define SLTEXFONT
 
+//-----------------------------------------------------------------------------
+//! Character range of one wrapped text line (see SLTexFont::wrapTextToLines)
+struct SLTexFontLine
+{   SLuint first;       //!< Index of the first character in the text
+    SLuint last;        //!< Index after the last character in the text
+    SLuint numBlanks;   //!< NO. of blanks appended for a line break
+};
+typedef vector<SLTexFontLine> SLVTexFontLine;
 //-----------------------------------------------------------------------------
 //! Texture Font class inherits SLGLTexture for alpha blended font rendering.
 /*!
@@ -49,11 +57,14 @@ public:
     void            create          (const SLuchar *bmp, 
                                       SLint bmpW, SLint bmpH);
                                         
-    SLVec2f         calcTextSize    (SLstring text, 
+    SLVec2f         calcTextSize    (const SLstring& text, 
                                      SLfloat maxWidth = 0.0f, 
                                      SLfloat lineHeightFactor = 1.5f);
     SLVstring       wrapTextToLines (SLstring text,
                                      SLfloat  maxW);
+    void            wrapTextToLines (const SLstring& text,
+                                     SLfloat maxW,
+                                     SLVTexFontLine& lines);
     void            buildTextBuffers(SLGLVertexArray& vao,
                                      SLstring text, 
                                      SLfloat maxWidth = 0.0f,
@@ -0,0 +1,115 @@
+//#############################################################################
+//  File:      SLTexResidency.h
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLTEXRESIDENCY_H
+#define SLTEXRESIDENCY_H
+
+#include <stdafx.h>
+
+class SLGLTexture;
+
+//-----------------------------------------------------------------------------
+//! Default GPU memory budget for textures in bytes
+#if defined(SL_OS_ANDROID) || defined(SL_OS_MACIOS)
+#define SL_TEXRES_DEFAULT_BUDGET (128 * 1024 * 1024)
+#else
+#define SL_TEXRES_DEFAULT_BUDGET (512 * 1024 * 1024)
+#endif
+//-----------------------------------------------------------------------------
+//! Change of the resident base mip level of a texture
+struct SLTexResidencyChange
+{   SLGLTexture*    texture;    //!< Texture to change
+    SLint           level;      //!< New base level or -1 to evict it
+};
+typedef vector<SLTexResidencyChange> SLVTexResidencyChange;
+//-----------------------------------------------------------------------------
+//! Residency policy of the textures on the GPU with a memory budget
+/*!
+SLTexResidency decides which textures stay on the GPU and at which base mip
+level. A texture that drops level L is uploaded from its image downsampled L
+times, so it uses only 1/4^L of the bytes. The class only does the bookkeeping
+and doesn't call OpenGL, so the policy can be tested without a GL context.
+\n
+A texture gets registered with SLTexResidency::add at its first upload and
+reports with SLTexResidency::loaded at which level it got uploaded.
+SLTexResidency::touch is called at every bind. After the culling the scene
+views pass the textures of the visible materials with their projected size in
+pixels to SLTexResidency::use. From this the wanted level is the number of
+levels that are smaller than the size on screen minus SL_TEXRES_LOD_BIAS.
+\n
+SLTexResidency::update is called once per frame by SLScene::onUpdate and
+returns the level changes that SLGLTexture::applyResidency carries out:
+<ul>
+<li>A texture seen in the frame gets its wanted level. At most
+SL_TEXRES_MAX_LOADS textures get a finer level per frame.</li>
+<li>A texture not bound for more than _unseenFrames frames is reduced to
+_unseenLevel.</li>
+<li>If the textures use more than the budget, the textures not bound in the
+frame are evicted least recently used first. If this is not enough, the
+largest seen textures drop a level until they fit into the budget.</li>
+</ul>
+An evicted texture keeps its images on the CPU and gets uploaded again by
+SLGLTexture::bindActive at the coarsest level when it is used again.
+*/
+class SLTexResidency
+{
+    public:
+                        SLTexResidency  ();
+
+            SLint       add             (SLGLTexture* texture,
+                                         SLuint bytes,
+                                         SLint size,
+                                         SLint maxLevel);
+            void        remove          (SLint id);
+            void        loaded          (SLint id, SLint level);
+            void        touch           (SLint id);
+            void        use             (SLint id, SLfloat screenSize);
+            void        update          (SLVTexResidencyChange& changes);
+
+            // Setters
+            void        budget          (SLuint64 bytes) {_budget = bytes;}
+            void        unseenFrames    (SLuint frames) {_unseenFrames = frames;}
+            void        unseenLevel     (SLint level) {_unseenLevel = level;}
+
+            // Getters
+            SLuint64    budget          () const {return _budget;}
+            SLuint64    bytesResident   () const;
+            SLuint      numTextures     () const {return _numTextures;}
+            SLuint      numEvicted      () const {return _numEvicted;}
+            SLuint      numReduced      () const;
+            SLuint      frame           () const {return _frame;}
+            SLint       level           (SLint id) const {return _entries[id].level;}
+            SLint       wantedLevel     (SLint id) const {return _entries[id].wanted;}
+
+    private:
+            //! Bookkeeping of one texture
+            struct SLTexEntry
+            {   SLGLTexture* texture;   //!< Registered texture (nullptr if slot free)
+                SLuint      bytes;      //!< Bytes on the GPU at level 0
+                SLint       size;       //!< Max. of width & height at level 0
+                SLint       maxLevel;   //!< Max. NO. of levels that can be dropped
+                SLint       level;      //!< Resident base level (-1 = not resident)
+                SLint       wanted;     //!< Wanted level in this frame (INT_MAX = not seen)
+                SLuint      lastUsed;   //!< Frame of the last bind
+            };
+
+            SLuint64    bytesAt         (const SLTexEntry& e, SLint level) const;
+
+            vector<SLTexEntry> _entries;//!< Entries indexed by the texture id
+            SLVint      _freeIDs;       //!< Free entries for reuse
+            SLuint      _numTextures;   //!< NO. of registered textures
+            SLuint      _numEvicted;    //!< NO. of evictions since the start
+            SLuint      _frame;         //!< Current frame
+            SLuint64    _budget;        //!< Max. NO. of bytes of all textures
+            SLuint      _unseenFrames;  //!< NO. of frames after which an unbound texture is reduced
+            SLint       _unseenLevel;   //!< Level of textures unbound for _unseenFrames frames
+};
+//-----------------------------------------------------------------------------
+#endif
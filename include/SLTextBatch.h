@@ -0,0 +1,87 @@
+//#############################################################################
+//  File:      SLTextBatch.h
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLTEXTBATCH_H
+#define SLTEXTBATCH_H
+
+#include <stdafx.h>
+#include <SLGLVertexArray.h>
+#include <SLTexFont.h>
+
+//-----------------------------------------------------------------------------
+//! Max. NO. of characters in one text batch (4 vertices each with 16 bit indices)
+#define SL_TEXTBATCH_MAX_CHARS 16384
+//-----------------------------------------------------------------------------
+//! Range of characters in a text batch with the same font and color
+struct SLTextBatchRun
+{   SLTexFont*  font;       //!< Font of the characters
+    SLCol4f     color;      //!< Color of the characters
+    SLuint      first;      //!< Index of the first character in the batch
+    SLuint      num;        //!< NO. of characters
+};
+typedef vector<SLTextBatchRun> SLVTextBatchRun;
+//-----------------------------------------------------------------------------
+//! Batched rendering of all 2D texts of a frame in one persistent VBO
+/*!
+An SLTextBatch collects the character quads of all texts added between begin
+and end into one vertex buffer that persists over frames. The quads are
+transformed on the CPU with the passed model view matrix so that consecutive
+texts with the same font and color are drawn together with one draw call.
+The vertex data of the last upload is kept on the CPU. Only the range of
+vertices that differs from the last frame is uploaded with a sub-range update.
+An unchanged text costs no upload and no memory allocation at all.
+\n
+SLSceneView::draw2DGLAll opens the batch of the scene view. While it is open
+SLText::drawRec adds its text to the batch instead of drawing its own vertex
+array. The batch is flushed once after the info texts and once after the menu
+buttons so that the text is drawn on top of the button rectangles.
+*/
+class SLTextBatch
+{
+    public:
+                        SLTextBatch     ();
+
+            void        begin           ();
+            void        add             (SLTexFont* font,
+                                         const SLstring& text,
+                                         const SLCol4f& color,
+                                         SLfloat maxWidth,
+                                         SLfloat lineHeight,
+                                         const SLMat4f& mv);
+            void        flush           ();
+            void        end             ();
+
+            // Getters
+            SLbool      isOpen          () const {return _isOpen;}
+            SLuint      numChars        () const {return _numChars;}
+            SLuint      numDrawCalls    () const {return _numDrawCalls;}
+            SLuint      numUploadedChars() const {return _numUploaded;}
+
+    private:
+            void        reserve         (SLuint numChars);
+
+            SLGLVertexArray _vao;       //!< Persistent vertex array
+            SLVVec3f    _P;             //!< Vertex positions (4 per char.) as on GPU
+            SLVVec2f    _Tc;            //!< Texture coords. (4 per char.) as on GPU
+            SLVushort   _I;             //!< Indices (6 per char.)
+            SLVTextBatchRun _runs;      //!< Runs of chars. with same font & color
+            SLVTexFontLine _lines;      //!< Temp. line ranges of wrapped text
+            SLbool      _isOpen;        //!< Flag if texts are collected
+            SLbool      _needsGenerate; //!< Flag if the VAO must be regenerated
+            SLuint      _numChars;      //!< NO. of chars. added since begin
+            SLuint      _numFlushedChars;//!< NO. of chars. drawn since begin
+            SLuint      _numFlushedRuns;//!< NO. of runs drawn since begin
+            SLuint      _dirtyMin;      //!< First changed vertex since last upload
+            SLuint      _dirtyMax;      //!< Last changed vertex + 1 since last upload
+            SLuint      _numDrawCalls;  //!< NO. of draw calls since begin
+            SLuint      _numUploaded;   //!< NO. of chars. uploaded since begin
+};
+//-----------------------------------------------------------------------------
+#endif
@@ -0,0 +1,88 @@
+//#############################################################################
+//  File:      SLTransformStore.h
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLTRANSFORMSTORE_H
+#define SLTRANSFORMSTORE_H
+
+#include <stdafx.h>
+
+class SLNode;
+
+//-----------------------------------------------------------------------------
+//! Flattened, depth ordered store of the world transforms of a scenegraph
+/*!
+SLTransformStore holds the nodes of a scenegraph in breadth first order, so
+that all nodes of one depth level are contiguous and every parent comes before
+its children. The world and inverse world matrices are kept in parallel arrays
+(structure of arrays) next to the slot of the parent and the child range of
+each node.
+\n
+SLNode stays the facade: Its transform methods still change SLNode::_om and
+call SLNode::needUpdate. For a node in a store this flags the AABB chain up
+to the root as before but only appends its slot to the dirty list instead of
+flagging the entire subtree recursively.
+SLTransformStore::updateWorld then expands the dirty slots to their subtrees,
+sorts them into depth order and updates the world matrices in one linear pass
+per level that runs with SL::maxThreads() threads for large levels. The
+results are written back to the nodes, so that SLNode::updateAndGetWM and all
+direct users of SLNode::_wm work as before. SLNode::updateAndGetWM flushes a
+pending dirty list, so a world matrix is never stale. This flush writes the
+shared work lists of the store, so code that reads world matrices on several
+threads (e.g. SLRayQuery) must call SLTransformStore::update before.
+\n
+SLTransformStore::update additionally updates the AABBs of all nodes flagged
+by SLNode::needAABBUpdate children first in reverse slot order. So
+SLNode::updateAABBRec finds all children up to date and doesn't descend.
+\n
+Any change of the hierarchy below the root (SLNode::parent or deleting a
+node) invalidates the store. The nodes then use the lazy recursive updates
+until SLScene::onUpdate rebuilds the store with SLTransformStore::build.
+*/
+class SLTransformStore
+{
+    public:
+                        SLTransformStore    ();
+                       ~SLTransformStore    ();
+
+            void        build               (SLNode* root);
+            void        invalidate          ();
+            void        updateWorld         ();
+            void        update              ();
+
+            void        markDirty           (SLint slot) {_dirty.push_back((SLuint)slot);}
+            void        markAABBDirty       (SLint slot) {_dirtyAABB.push_back((SLuint)slot);}
+
+            // Getters
+            SLNode*     root                () const {return _root;}
+            SLuint      numNodes            () const {return (SLuint)_nodes.size();}
+            SLuint      numLevels           () const {return _levels.size() ? (SLuint)_levels.size()-1 : 0;}
+            SLuint      numUpdated          () const {return _numUpdated;}
+      const SLMat4f&    world               (SLuint slot) const {return _world[slot];}
+      const SLMat4f&    worldI              (SLuint slot) const {return _worldI[slot];}
+
+    private:
+            void        updateSlots         (SLuint first, SLuint end);
+
+            SLNode*     _root;              //!< root node of the store (0=invalid)
+            vector<SLNode*> _nodes;         //!< nodes in breadth first order
+            SLVint      _parents;           //!< slot of the parent (-1 for the root)
+            SLVuint     _firstChild;        //!< slot of the first child
+            SLVuint     _numChildren;       //!< NO. of children
+            SLVuint     _levels;            //!< first slot of each depth level + end
+            SLVMat4f    _world;             //!< world matrices
+            SLVMat4f    _worldI;            //!< inverse world matrices
+            SLVuint     _dirty;             //!< slots with a changed object matrix
+            SLVuint     _dirtyAABB;         //!< slots with a changed AABB
+            SLVuint     _work;              //!< dirty slots with their subtrees
+            SLVuchar    _marked;            //!< flags of the slots in _work
+            SLuint      _numUpdated;        //!< NO. of nodes in the last updateWorld
+};
+//-----------------------------------------------------------------------------
+#endif
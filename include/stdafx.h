@@ -36,5 +36,7 @@
 #include <SLUtils.h>
 #include <SLFileSystem.h>
 #include <SLTimer.h>
+#include <SLProfiler.h>
+#include <SLMemPool.h>
 //-----------------------------------------------------------------------------
 #endif
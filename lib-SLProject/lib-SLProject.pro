@@ -51,6 +51,7 @@ HEADERS += \
 ../include/SLAssimpImporter.h \
 ../include/SLAverage.h \
 ../include/SLBackground.h \
+../include/SLBVH.h \
 ../include/SLBox.h \
 ../include/SLButton.h \
 ../include/SLCamera.h \
@@ -74,6 +75,7 @@ HEADERS += \
 ../include/SLGLShader.h \
 ../include/SLGLState.h \
 ../include/SLGLTexture.h \
+../include/SLTexResidency.h \
 ../include/SLGLUniform.h \
 ../include/SLGLVertexArray.h \
 ../include/SLGLVertexArrayExt.h \
@@ -89,6 +91,7 @@ HEADERS += \
 ../include/SLKeyframe.h \
 ../include/SLLens.h \
 ../include/SLLight.h \
+../include/SLLightClusters.h \
 ../include/SLLightRect.h \
 ../include/SLLightSphere.h \
 ../include/SLMat3.h \
@@ -96,24 +99,33 @@ HEADERS += \
 ../include/SLMaterial.h \
 ../include/SLMath.h \
 ../include/SLMesh.h \
+../include/SLMeshCache.h \
 ../include/SLNode.h \
+../include/SLNodeIndex.h \
+../include/SLTransformStore.h \
+../include/SLOcclusionCuller.h \
 ../include/SLObject.h \
 ../include/SLPathtracer.h \
 ../include/SLPlane.h \
 ../include/SLPolygon.h \
 ../include/SLQuat4.h \
 ../include/SLRay.h \
+../include/SLRayQuery.h \
 ../include/SLRaytracer.h \
 ../include/SLRectangle.h \
 ../include/SLRevolver.h \
 ../include/SLSamples2D.h \
+../include/SLSampler.h \
 ../include/SLScene.h \
 ../include/SLSceneView.h \
 ../include/SLSkeleton.h \
 ../include/SLSphere.h \
 ../include/SLTexFont.h \
 ../include/SLText.h \
+../include/SLTextBatch.h \
 ../include/SLTimer.h \
+../include/SLProfiler.h \
+../include/SLMemPool.h \
 ../include/SLUtils.h \
 ../include/SLVec2.h \
 ../include/SLVec3.h \
@@ -130,15 +142,19 @@ source/SL/SLAssimpImporter.cpp \
 source/SL/SLFileSystem.cpp \
 source/SL/SLImage.cpp \
 source/SL/SLImporter.cpp \
+source/SL/SLMeshCache.cpp \
 source/SL/SLInterface.cpp \
 source/SL/SLTexFont.cpp \
 source/SL/SLTimer.cpp \
+source/SL/SLProfiler.cpp \
+source/SL/SLMemPool.cpp \
 source/SLAABBox.cpp \
 source/SLAnimation.cpp \
 source/SLAnimManager.cpp \
 source/SLAnimPlayback.cpp \
 source/SLAnimTrack.cpp \
 source/SLBackground.cpp \
+source/SLBVH.cpp \
 source/SLBox.cpp \
 source/SLButton.cpp \
 source/SLCamera.cpp \
@@ -152,6 +168,7 @@ source/SLGLProgram.cpp \
 source/SLGLShader.cpp \
 source/SLGLState.cpp \
 source/SLGLTexture.cpp \
+source/SLTexResidency.cpp \
 source/SLGLVertexArray.cpp \
 source/SLGLVertexArrayExt.cpp \
 source/SLGLVertexBuffer.cpp \
@@ -162,24 +179,33 @@ source/SLJoint.cpp \
 source/SLKeyframe.cpp \
 source/SLLens.cpp \
 source/SLLight.cpp \
+source/SLLightClusters.cpp \
 source/SLLightRect.cpp \
 source/SLLightSphere.cpp \
 source/SLMaterial.cpp \
 source/SLMesh.cpp \
+source/SLMesh_optimize.cpp \
+source/SLMesh_simplify.cpp \
 source/SLNode.cpp \
+source/SLNodeIndex.cpp \
+source/SLTransformStore.cpp \
+source/SLOcclusionCuller.cpp \
 source/SLPathtracer.cpp \
 source/SLPolygon.cpp \
 source/SLRay.cpp \
+source/SLRayQuery.cpp \
 source/SLRaytracer.cpp \
 source/SLRectangle.cpp \
 source/SLRevolver.cpp \
 source/SLSamples2D.cpp \
+source/SLSampler.cpp \
 source/SLScene.cpp \
 source/SLSceneView.cpp \
 source/SLScene_onLoad.cpp \
 source/SLSkeleton.cpp \
 source/SLSphere.cpp \
-source/SLText.cpp
+source/SLText.cpp \
+source/SLTextBatch.cpp
 
 OTHER_FILES += \
 ../_data/shaders/BumpNormal.frag \
@@ -117,6 +117,24 @@ SLuint SL::maxThreads()
     #endif
 }
 //-----------------------------------------------------------------------------
+//! Flag per thread that is set while a thread executes jobs of a thread pool
+static thread_local SLbool slIsWorkerThread = false;
+//-----------------------------------------------------------------------------
+/*! SL::isWorkerThread returns true if the calling thread executes jobs of a
+thread pool (e.g. SLAssimpImporter::loadParallel). Parallel loops that are
+called from such a job should run serially to avoid nested thread pools.
+*/
+SLbool SL::isWorkerThread()
+{
+    return slIsWorkerThread;
+}
+//-----------------------------------------------------------------------------
+//! Marks or unmarks the calling thread as a worker of a thread pool
+void SL::isWorkerThread(SLbool isWorker)
+{
+    slIsWorkerThread = isWorker;
+}
+//-----------------------------------------------------------------------------
 //! Returns the current working directory
 SLstring SL::getCWD()
 {
@@ -19,6 +19,7 @@
 #include <SLSkeleton.h>
 #include <SLAnimation.h>
 #include <SLGLProgram.h>
+#include <SLMeshCache.h>
 
 // assimp is only included in the source file to not expose it to the rest of the framework
 #include <assimp/Importer.hpp>
@@ -272,6 +273,8 @@ SLNode* SLAssimpImporter::load(SLstring file,           //!< File with path or o
                                SLbool loadMeshesOnly,   //!< Only load nodes with meshes
                                SLuint flags)            //!< Import flags (see assimp/postprocess.h)
 {
+    SL_PROFILE_SCOPE("SLAssimpImporter::load");
+
     // clear the intermediate data
     clear();
 
@@ -285,9 +288,19 @@ SLNode* SLAssimpImporter::load(SLstring file,           //!< File with path or o
         }
     }
 
+    // Try to load the model from the binary mesh cache
+    SLMeshCache cache(file, flags, loadMeshesOnly);
+    if (_useCache)
+    {   if (cache.exists())
+        {   _sceneRoot = cache.load(_meshes);
+            if (_sceneRoot) return _sceneRoot; // with LODs if flagged
+        }
+    }
+
     // Import file with assimp importer
     Assimp::Importer ai;
-    const aiScene* scene = ai.ReadFile(file.c_str(), (SLuint)flags);
+    const aiScene* scene = ai.ReadFile(file.c_str(), (SLuint)flags & ~(SLProcess_SLOptimizeMeshes |
+                                                                            SLProcess_SLGenerateLODs));
     if (!scene)
     {   SLstring msg = "Failed to load file: " + file + "\n" + ai.GetErrorString() + "\n";
         SL_WARN_MSG(msg.c_str());
@@ -300,16 +313,38 @@ SLNode* SLAssimpImporter::load(SLstring file,           //!< File with path or o
     // load skeleton
     loadSkeleton(nullptr, _skeletonRoot);
 
-    // load materials
+    // Fill the texture map with the already existing textures of the scene
+    for (auto tex : SLScene::current->textures())
+        _textureMap[tex->name()] = tex;
+
+    // load materials. New textures are created without loading the images.
     SLstring modelPath = SLUtils::getPath(file);
     SLVMaterial materials;
     for(SLint i = 0; i < (SLint)scene->mNumMaterials; i++)
         materials.push_back(loadMaterial(i, scene->mMaterials[i], modelPath));
 
-    // load meshes & set their material
+    // create the meshes on the GL thread because the ctor adds them to SLScene
+    SLVMesh meshes;
+    for(SLint i = 0; i < (SLint)scene->mNumMeshes; i++)
+        meshes.push_back(createMesh(scene->mMeshes[i]));
+
+    // decode the texture images & copy the mesh data on worker threads
+    for (auto tex : _deferredTextures)
+        _jobs.push_back([tex]() {tex->loadDeferred();});
+    for(SLint i = 0; i < (SLint)scene->mNumMeshes; i++)
+    {   SLMesh* mesh = meshes[i];
+        aiMesh* aiM = scene->mMeshes[i];
+        if (mesh) _jobs.push_back([this, aiM, mesh]() {loadMesh(aiM, mesh);});
+    }
+    loadParallel();
+
+    // load the joints & set the material of the meshes
     std::map<int, SLMesh*> meshMap;  // map from the ai index to our mesh
     for(SLint i = 0; i < (SLint)scene->mNumMeshes; i++)
-    {   SLMesh* mesh = loadMesh(scene->mMeshes[i]);
+    {   SLMesh* mesh = meshes[i];
+        if (mesh && scene->mMeshes[i]->HasBones() && 
+            !loadJoints(scene->mMeshes[i], mesh))
+            mesh = nullptr;
         if (mesh != 0)
         {   mesh->mat = materials[scene->mMeshes[i]->mMaterialIndex];
             _meshes.push_back(mesh);
@@ -317,6 +352,17 @@ SLNode* SLAssimpImporter::load(SLstring file,           //!< File with path or o
         } else SL_LOG("SLAsssimpImporter::load failed: %s\nin path: %s\n", file.c_str(), modelPath.c_str());
     }
 
+    // optimize the meshes for the vertex cache & fetch in parallel
+    if (flags & SLProcess_SLOptimizeMeshes)
+    {   for (auto mesh : _meshes)
+            _jobs.push_back([mesh]() {mesh->optimize(true);});
+        loadParallel();
+    }
+
+    // generate the level of detail meshes in parallel
+    if (flags & SLProcess_SLGenerateLODs)
+        generateLODs();
+
     // load the scene nodes recursively
     _sceneRoot = loadNodesRec(nullptr, scene->mRootNode, meshMap, loadMeshesOnly);
 
@@ -325,6 +371,10 @@ SLNode* SLAssimpImporter::load(SLstring file,           //!< File with path or o
     for (SLint i = 0; i < (SLint)scene->mNumAnimations; i++)
         animations.push_back(loadAnimation(scene->mAnimations[i]));
 
+    // Write the binary mesh cache for models without skeleton & animations
+    if (_useCache && _sceneRoot && !_skeleton && animations.empty())
+        cache.save(_sceneRoot, _meshes, _lodIndices, _lodErrors);
+
     logMessage(LV_minimal, "\n---------------------------\n\n");
 
     return _sceneRoot;
@@ -339,6 +389,104 @@ void SLAssimpImporter::clear()
     _skeletonRoot = nullptr;
     _skeleton = nullptr;
     _skinnedMeshes.clear();
+    _textureMap.clear();
+    _deferredTextures.clear();
+    _jobs.clear();
+    _lodIndices.clear();
+    _lodErrors.clear();
+}
+//-----------------------------------------------------------------------------
+/*!
+SLAssimpImporter::generateLODs simplifies all meshes in parallel jobs and
+adds their LOD index sets afterwards in the main thread (see SLMesh::generateLODs).
+The index sets are kept in _lodIndices & _lodErrors for the mesh cache.
+*/
+void SLAssimpImporter::generateLODs()
+{
+    _lodIndices.assign(_meshes.size(), vector<SLVuint>());
+    _lodErrors.assign(_meshes.size(), SLVfloat());
+
+    for (SLuint i=0; i<_meshes.size(); ++i)
+    {   SLMesh* mesh = _meshes[i];
+        vector<SLVuint>* indices = &_lodIndices[i];
+        SLVfloat* errors = &_lodErrors[i];
+        _jobs.push_back([mesh, indices, errors]() {mesh->simplifyLODs(4, 0.5f, *indices, *errors);});
+    }
+    loadParallel();
+
+    for (SLuint i=0; i<_meshes.size(); ++i)
+        _meshes[i]->addLODs(_lodIndices[i], _lodErrors[i]);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLAssimpImporter::loadParallel executes all functions in the _jobs vector on
+SL::maxThreads() threads. The main thread does the same work and updates the 
+loading screen with the progress. The jobs may not touch any global SLScene
+vector or OpenGL.
+*/
+void SLAssimpImporter::loadParallel()
+{
+    _nextJob = 0;
+    _jobsDone = 0;
+
+    // Bind the job function to be called multithreaded
+    auto runJobsFunction = bind(&SLAssimpImporter::runJobs, this, placeholders::_1);
+
+    // Start additional threads on the runJobs function
+    vector<thread> threads;
+    for (SLuint t=0; t < SL::maxThreads()-1; t++)
+        threads.push_back(thread(runJobsFunction, false));
+
+    // Do the same work in the main thread
+    runJobsFunction(true);
+
+    // Wait for the other threads to finish
+    for(auto& thread : threads) thread.join();
+
+    _jobs.clear();
+}
+//-----------------------------------------------------------------------------
+/*!
+SLAssimpImporter::runJobs executes jobs of the _jobs vector until all are
+taken. Only the main thread updates the loading screen every 250 ms, also 
+while waiting for the last jobs of the other threads.
+*/
+void SLAssimpImporter::runJobs(const bool isMainThread)
+{
+    if (!isMainThread) SL_PROFILE_THREAD("Import Worker");
+    SL_PROFILE_SCOPE("SLAssimpImporter::runJobs");
+
+    // The jobs run serially inside (e.g. the line loops of SLImage)
+    SL::isWorkerThread(true);
+
+    SLScene* s = SLScene::current;
+    SLfloat t1 = s->timeSec();
+    SLuint numJobs = (SLuint)_jobs.size();
+    SLchar progress[100];
+
+    for (SLuint i = _nextJob++; i < numJobs; i = _nextJob++)
+    {   _jobs[i]();
+        _jobsDone++;
+
+        if (isMainThread && s->timeSec() - t1 > 0.25f)
+        {   sprintf(progress, "(%u of %u textures & meshes)", (SLuint)_jobsDone, numJobs);
+            s->loadingProgress(progress);
+            t1 = s->timeSec();
+        }
+    }
+
+    SL::isWorkerThread(false);
+
+    if (isMainThread)
+    {   while (_jobsDone < numJobs)
+        {   this_thread::sleep_for(chrono::milliseconds(20));
+            if (s->timeSec() - t1 > 0.25f)
+            {   sprintf(progress, "(%u of %u textures & meshes)", (SLuint)_jobsDone, numJobs);
+                s->loadingProgress(progress);
+                t1 = s->timeSec();
+            }
+        }
+    }
 }
 //-----------------------------------------------------------------------------
 //! Return an aiNode ptr if name exists, or null if it doesn't
@@ -676,33 +824,37 @@ SLMaterial* SLAssimpImporter::loadMaterial(SLint index,
 }
 //-----------------------------------------------------------------------------
 /*!
-SLAssimpImporter::loadTexture loads the AssImp texture an returns the SLGLTexture
+SLAssimpImporter::loadTexture returns the SLGLTexture for a texture file. 
+Textures with the same file are shared. New textures are created without 
+loading the image. The images are loaded in parallel in loadParallel.
 */
 SLGLTexture* SLAssimpImporter::loadTexture(SLstring& textureFile,
                                            SLTextureType texType)
 {
-    SLVGLTexture& sceneTex = SLScene::current->textures();
-
     // return if a texture with the same file allready exists
-    for (SLint i=0; i<sceneTex.size(); ++i)
-        if (sceneTex[i]->name()==textureFile) 
-            return sceneTex[i];
+    auto it = _textureMap.find(textureFile);
+    if (it != _textureMap.end())
+        return it->second;
 
     // Create the new texture. It is also push back to SLScene::_textures
     SLGLTexture* texture = new SLGLTexture(textureFile,
                                            GL_LINEAR_MIPMAP_LINEAR,
                                            GL_LINEAR,
-                                           texType);
+                                           texType,
+                                           GL_REPEAT,
+                                           GL_REPEAT,
+                                           true);
+    _textureMap[textureFile] = texture;
+    _deferredTextures.push_back(texture);
     return texture;
 }
 
 //-----------------------------------------------------------------------------
 /*!
-SLAssimpImporter::loadMesh creates a new SLMesh an copies the meshs vertex data and
-triangle face indices. Normals & tangents are not loaded. They are calculated
-in SLMesh.
+SLAssimpImporter::createMesh creates a new empty SLMesh if the aiMesh contains
+triangles. The mesh data is loaded afterwards in loadMesh.
 */
-SLMesh* SLAssimpImporter::loadMesh(aiMesh *mesh)
+SLMesh* SLAssimpImporter::createMesh(aiMesh *mesh)
 {
     // Count first the NO. of triangles in the mesh
     SLuint numTriangles = 0;
@@ -717,8 +869,17 @@ SLMesh* SLAssimpImporter::loadMesh(aiMesh *mesh)
     // create a new mesh. 
     // The mesh pointer is added automatically to the SLScene::meshes vector.
     SLstring name = mesh->mName.data;
-    SLMesh *m = new SLMesh(name.empty() ? "Imported Mesh" : name);
-
+    return new SLMesh(name.empty() ? "Imported Mesh" : name);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLAssimpImporter::loadMesh copies the meshs vertex data and triangle face 
+indices into the SLMesh m. Tangents are not loaded. They are calculated in
+SLMesh as well as the normals if they don't exist. This method only touches
+the mesh m and can therefore be called on a worker thread.
+*/
+void SLAssimpImporter::loadMesh(aiMesh *mesh, SLMesh* m)
+{
     // create position & normal vector
     m->P.clear(); m->P.resize(mesh->mNumVertices);
 
@@ -776,55 +937,58 @@ SLMesh* SLAssimpImporter::loadMesh(aiMesh *mesh)
 
     if (!m->N.size())
         m->calcNormals();
+}
+//-----------------------------------------------------------------------------
+/*!
+SLAssimpImporter::loadJoints loads the joint indices & weights of a skinned
+mesh. It must be called on the main thread after loadMesh because it changes
+the joints of the shared skeleton. Returns false if a joint is not found.
+*/
+SLbool SLAssimpImporter::loadJoints(aiMesh *mesh, SLMesh* m)
+{
+    _skinnedMeshes.push_back(m);
+    m->skeleton(_skeleton);
 
-    // load joints
-    if (mesh->HasBones())
-    {
-        _skinnedMeshes.push_back(m);
-        m->skeleton(_skeleton);
+    m->Ji.resize(m->P.size());
+    m->Jw.resize(m->P.size());
+    
+    // make sure to initialize the weights with 0 vectors
+    std::fill(m->Ji.begin(), m->Ji.end(), SLVec4f(0, 0, 0, 0));
+    std::fill(m->Jw.begin(), m->Jw.end(), SLVec4f(0, 0, 0, 0));
 
-        m->Ji.resize(m->P.size());
-        m->Jw.resize(m->P.size());
+    for (SLuint i = 0; i < mesh->mNumBones; i++)
+    {
+        aiBone* joint = mesh->mBones[i];
+        SLJoint* slJoint = _skeleton->getJoint(joint->mName.C_Str());
         
-        // make sure to initialize the weights with 0 vectors
-        std::fill(m->Ji.begin(), m->Ji.end(), SLVec4f(0, 0, 0, 0));
-        std::fill(m->Jw.begin(), m->Jw.end(), SLVec4f(0, 0, 0, 0));
-
-        for (SLuint i = 0; i < mesh->mNumBones; i++)
+        // @todo On OSX it happens from time to time that slJoint is nullptr
+        if (slJoint)
         {
-            aiBone* joint = mesh->mBones[i];
-            SLJoint* slJoint = _skeleton->getJoint(joint->mName.C_Str());
-            
-            // @todo On OSX it happens from time to time that slJoint is nullptr
-            if (slJoint)
+            SLuint jointId = slJoint->id();
+
+            for (SLuint j = 0; j < joint->mNumWeights; j++)
             {
-                SLuint jointId = slJoint->id();
-
-                for (SLuint j = 0; j < joint->mNumWeights; j++)
-                {
-                    // add the weight
-                    SLuint vertId = joint->mWeights[j].mVertexId;
-                    SLfloat weight = joint->mWeights[j].mWeight;
-
-                    m->addWeight(vertId, jointId, weight);
-
-                    // check if the bones max radius changed
-                    // @todo this is very specific to this loaded mesh,
-                    //       when we add a skeleton instances class this radius
-                    //       calculation has to be done on the instance!
-                    slJoint->calcMaxRadius(SLVec3f(mesh->mVertices[vertId].x,
-                                                   mesh->mVertices[vertId].y,
-                                                   mesh->mVertices[vertId].z));
-                }
-            }
-            else
-            {   SL_LOG("Failed to load joint of skeleton in SLAssimpImporter::loadMesh: %s\n", joint->mName.C_Str());
-                return nullptr;
+                // add the weight
+                SLuint vertId = joint->mWeights[j].mVertexId;
+                SLfloat weight = joint->mWeights[j].mWeight;
+
+                m->addWeight(vertId, jointId, weight);
+
+                // check if the bones max radius changed
+                // @todo this is very specific to this loaded mesh,
+                //       when we add a skeleton instances class this radius
+                //       calculation has to be done on the instance!
+                slJoint->calcMaxRadius(SLVec3f(mesh->mVertices[vertId].x,
+                                               mesh->mVertices[vertId].y,
+                                               mesh->mVertices[vertId].z));
             }
         }
-
+        else
+        {   SL_LOG("Failed to load joint of skeleton in SLAssimpImporter::loadJoints: %s\n", joint->mName.C_Str());
+            return false;
+        }
     }
-    return m;
+    return true;
 }
 //-----------------------------------------------------------------------------
 /*!
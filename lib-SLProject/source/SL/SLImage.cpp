@@ -17,14 +17,123 @@
 #include <jpeglib.h>          // JPEG lib
 #include <png.h>              // libpng
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SL_IMAGE_USE_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SL_IMAGE_USE_NEON
+#include <arm_neon.h>
+#endif
+
+//-----------------------------------------------------------------------------
+//! Indices of the r, g, b & a channel in a pixel (-1 if not present)
+/*! For gray formats r, g & b point to the same channel.
+*/
+struct SLImageChannels
+{   SLint r, g, b, a;
+};
+//-----------------------------------------------------------------------------
+//! Returns the channel indices of a pixel format
+static SLImageChannels imageChannels(SLPixelFormat format)
+{
+    switch (format)
+    {   case PF_rgb:
+        case PF_rgb_integer:    return { 0, 1, 2,-1};
+        case PF_bgr:
+        case PF_bgr_integer:    return { 2, 1, 0,-1};
+        case PF_rgba:
+        case PF_rgba_integer:   return { 0, 1, 2, 3};
+        case PF_bgra:
+        case PF_bgra_integer:   return { 2, 1, 0, 3};
+        case PF_rg:
+        case PF_rg_integer:
+        case PF_luminance_alpha:return { 0, 0, 0, 1};
+        case PF_alpha:          return {-1,-1,-1, 0};
+        default:                return { 0, 0, 0,-1};
+    }
+}
+//-----------------------------------------------------------------------------
+// Conversions of one channel value from and to float
+static inline SLfloat channelToFloat(SLubyte v) {return (SLfloat)v * (1.0f/255.0f);}
+static inline SLfloat channelToFloat(SLhalf v)  {return (SLfloat)v;}
+static inline SLfloat channelToFloat(SLfloat v) {return v;}
+static inline void floatToChannel(SLfloat v, SLubyte& c) {c = (SLubyte)(SL_clamp(v, 0.0f, 1.0f)*255.0f + 0.5f);}
+static inline void floatToChannel(SLfloat v, SLhalf& c)  {c = (SLhalf)v;}
+static inline void floatToChannel(SLfloat v, SLfloat& c) {c = v;}
+//-----------------------------------------------------------------------------
+//! Converts num pixels with numCh channels of type T to float colors
+template<class T>
+static void pixelsToFloat(const T* src, SLint num, SLint numCh,
+                          SLImageChannels ch, SLCol4f* dst)
+{
+    for (SLint i=0; i<num; ++i, src+=numCh)
+        dst[i].set(ch.r < 0 ? 0.0f : channelToFloat(src[ch.r]),
+                   ch.g < 0 ? 0.0f : channelToFloat(src[ch.g]),
+                   ch.b < 0 ? 0.0f : channelToFloat(src[ch.b]),
+                   ch.a < 0 ? 1.0f : channelToFloat(src[ch.a]));
+}
+//-----------------------------------------------------------------------------
+//! Converts num float colors to pixels with numCh channels of type T
+/*! Gray formats get the luminance of the color (ITU-R BT.709).
+*/
+template<class T>
+static void floatToPixels(const SLCol4f* src, SLint num, SLint numCh,
+                          SLImageChannels ch, T* dst)
+{
+    SLbool isGray = ch.r == ch.g;
+    for (SLint i=0; i<num; ++i, dst+=numCh)
+    {   const SLCol4f& c = src[i];
+        if (isGray)
+        {   if (ch.r >= 0)
+                floatToChannel(0.2126f*c.r + 0.7152f*c.g + 0.0722f*c.b, dst[ch.r]);
+        } else
+        {   floatToChannel(c.r, dst[ch.r]);
+            floatToChannel(c.g, dst[ch.g]);
+            floatToChannel(c.b, dst[ch.b]);
+        }
+        if (ch.a >= 0) floatToChannel(c.a, dst[ch.a]);
+    }
+}
+//-----------------------------------------------------------------------------
+//! Converts num pixels at src of any data type and format to float colors
+static void pixelsToFloat(const SLubyte* src, SLint num,
+                          SLPixelFormat format, SLPixelDataType dataType,
+                          SLCol4f* dst)
+{
+    SLint numCh = SLImage::numChannels(format);
+    SLImageChannels ch = imageChannels(format);
+    switch (dataType)
+    {   case PD_ubyte: pixelsToFloat(src, num, numCh, ch, dst); break;
+        case PD_half:  pixelsToFloat((const SLhalf*)src, num, numCh, ch, dst); break;
+        case PD_float: pixelsToFloat((const SLfloat*)src, num, numCh, ch, dst); break;
+    }
+}
+//-----------------------------------------------------------------------------
+//! Converts num float colors to pixels of any data type and format at dst
+static void floatToPixels(const SLCol4f* src, SLint num,
+                          SLPixelFormat format, SLPixelDataType dataType,
+                          SLubyte* dst)
+{
+    SLint numCh = SLImage::numChannels(format);
+    SLImageChannels ch = imageChannels(format);
+    switch (dataType)
+    {   case PD_ubyte: floatToPixels(src, num, numCh, ch, dst); break;
+        case PD_half:  floatToPixels(src, num, numCh, ch, (SLhalf*)dst); break;
+        case PD_float: floatToPixels(src, num, numCh, ch, (SLfloat*)dst); break;
+    }
+}
 //-----------------------------------------------------------------------------
 //! Constructor for empty image of a certain format and size
-SLImage::SLImage(SLint width, SLint height, SLPixelFormat format) : SLObject()
+SLImage::SLImage(SLint width,
+                 SLint height,
+                 SLPixelFormat format,
+                 SLPixelDataType dataType) : SLObject()
 {
     _data = 0;
     _width = 0;
     _height = 0;
-    allocate(width, height, format);
+    _dataType = PD_ubyte;
+    allocate(width, height, format, dataType);
 }
 //-----------------------------------------------------------------------------
 //! Contructor for image from file
@@ -34,6 +143,7 @@ SLImage::SLImage(const SLstring  filename) : SLObject(filename)
     _data = 0;
     _width = 0;
     _height = 0;
+    _dataType = PD_ubyte;
     load(filename);
 }
 //-----------------------------------------------------------------------------
@@ -44,6 +154,7 @@ SLImage::SLImage(SLImage &src) : SLObject(src.name())
     _width  = src.width();
     _height = src.height();
     _format = src.format();
+    _dataType = src.dataType();
     _path   = src.path();
     _bytesPerPixel = src.bytesPerPixel();
     _bytesPerLine  = src.bytesPerLine();
@@ -85,19 +196,24 @@ void SLImage::clearData()
 //! Memory allocation function
 /*! It returns true if width or height or the pixelformat has changed
 */
-SLbool SLImage::allocate(SLint width, SLint height, SLPixelFormat pixelFormatGL)
+SLbool SLImage::allocate(SLint width,
+                         SLint height,
+                         SLPixelFormat pixelFormatGL,
+                         SLPixelDataType dataType)
 {
     assert(width>0 && height>0);
 
     // return if essentials are identical
-    if (_data && _width==width && _height==height && _format==pixelFormatGL)
+    if (_data && _width==width && _height==height && 
+        _format==pixelFormatGL && _dataType==dataType)
         return false;
    
     _width  = width;
     _height = height;
     _format = pixelFormatGL;
-    _bytesPerPixel = bytesPerPixel(pixelFormatGL);
-    _bytesPerLine  = bytesPerLine(width, pixelFormatGL);
+    _dataType = dataType;
+    _bytesPerPixel = bytesPerPixel(pixelFormatGL, dataType);
+    _bytesPerLine  = bytesPerLine(width, pixelFormatGL, dataType);
     _bytesPerImage = _bytesPerLine * _height;
    
     delete[] _data;
@@ -108,8 +224,27 @@ SLbool SLImage::allocate(SLint width, SLint height, SLPixelFormat pixelFormatGL)
     return true;
 }
 //-----------------------------------------------------------------------------
-//! Returns the NO. of bytes per pixel for the passed pixel format
-SLint SLImage::bytesPerPixel(SLPixelFormat format)
+//! Returns the NO. of bytes per pixel for the passed pixel format and type
+SLint SLImage::bytesPerPixel(SLPixelFormat format, SLPixelDataType dataType)
+{
+    return numChannels(format) * bytesPerChannel(dataType);
+}
+//-----------------------------------------------------------------------------
+//! Returns the NO. of bytes of one channel for the passed pixel data type
+SLint SLImage::bytesPerChannel(SLPixelDataType dataType)
+{
+    switch (dataType)
+    {   case PD_ubyte: return 1;
+        case PD_half:  return 2;
+        case PD_float: return 4;
+        default:
+            SL_EXIT_MSG("SLImage::bytesPerChannel: unknown pixel data type");
+    }
+    return 0;
+}
+//-----------------------------------------------------------------------------
+//! Returns the NO. of channels per pixel for the passed pixel format
+SLint SLImage::numChannels(SLPixelFormat format)
 {
     switch (format)
     {
@@ -132,15 +267,17 @@ SLint SLImage::bytesPerPixel(SLPixelFormat format)
         case PF_rgba_integer:
         case PF_bgra_integer: return 4;
         default:
-            SL_EXIT_MSG("SLImage::bytesPerPixel: unknown pixel format");
+            SL_EXIT_MSG("SLImage::numChannels: unknown pixel format");
     }
     return 0;
 }
 //-----------------------------------------------------------------------------
 //! Returns the NO. of bytes per image line for the passed pixel format
-SLint SLImage::bytesPerLine(SLint width, SLPixelFormat format)
+SLint SLImage::bytesPerLine(SLint width,
+                            SLPixelFormat format,
+                            SLPixelDataType dataType)
 {
-    SLint bpp = bytesPerPixel(format);
+    SLint bpp = bytesPerPixel(format, dataType);
     SLint bitsPerPixel = bpp * 8;
     SLint bpl = ((width * bitsPerPixel + 31) / 32) * 4;
     return bpl;
@@ -300,7 +437,9 @@ void SLImage::load(const SLstring filename)
     SLstring ext = SLUtils::getFileExt(filename);
     _name = SLUtils::getFileNameWOExt(filename);
     _path = SLUtils::getPath(filename);
+    _dataType = PD_ubyte;
    
+    if (ext=="hdr") {loadHDR(filename); return;}
     if (ext=="jpg") {loadJPG(filename); return;}
     if (ext=="png") {loadPNG(filename); return;}
     if (ext=="bmp") {loadBMP(filename); return;}
@@ -856,6 +995,115 @@ void SLImage::loadTGAcompr(SLstring filename, FILE* fp, sTGA& tga)
     free(colorbuffer);
 }
 //-----------------------------------------------------------------------------
+/*!
+Reads one RGBE scanline of a Radiance HDR file. Scanlines are either flat or
+run length encoded per component (new RLE). The old RLE scheme is not supported.
+*/
+static SLbool readHDRScanline(FILE* fp, SLuchar* scanline, SLint width)
+{
+    SLint c0 = getc(fp);
+    SLint c1 = getc(fp);
+    SLint c2 = getc(fp);
+    SLint c3 = getc(fp);
+    if (c3 == EOF) return false;
+
+    // flat scanline
+    if (width < 8 || width > 0x7fff || c0 != 2 || c1 != 2 || (c2 & 0x80))
+    {   scanline[0] = (SLuchar)c0;
+        scanline[1] = (SLuchar)c1;
+        scanline[2] = (SLuchar)c2;
+        scanline[3] = (SLuchar)c3;
+        return fread(scanline+4, 4, width-1, fp) == (size_t)(width-1);
+    }
+
+    if (((c2 << 8) | c3) != width) return false;
+
+    // run length encoded scanline with the 4 components one after the other
+    for (SLint ch=0; ch<4; ++ch)
+    {   SLint x = 0;
+        while (x < width)
+        {   SLint count = getc(fp);
+            if (count == EOF) return false;
+            if (count > 128)
+            {   count -= 128;
+                SLint value = getc(fp);
+                if (value == EOF || x + count > width) return false;
+                while (count--) scanline[4*x++ + ch] = (SLuchar)value;
+            } else
+            {   if (count == 0 || x + count > width) return false;
+                while (count--)
+                {   SLint value = getc(fp);
+                    if (value == EOF) return false;
+                    scanline[4*x++ + ch] = (SLuchar)value;
+                }
+            }
+        }
+    }
+    return true;
+}
+//-----------------------------------------------------------------------------
+/*!
+Loads a Radiance HDR file (.hdr) with RGBE pixels into a PF_rgb image with
+32-bit float channels. Only the standard orientation -Y h +X w is supported.
+*/
+void SLImage::loadHDR(SLstring filename)
+{
+    FILE* fp = fopen(filename.c_str(), "rb");
+    if (!fp)
+    {   SLstring msg = "SLImage::loadHDR: Failed to open image: " + filename;
+        SL_EXIT_MSG(msg.c_str());
+    }
+
+    // Read the header lines until the empty line
+    SLchar buf[256];
+    if (!fgets(buf, sizeof(buf), fp) || strncmp(buf, "#?", 2) != 0)
+    {   fclose(fp);
+        SLstring msg = "SLImage::loadHDR: No Radiance file: " + filename;
+        SL_EXIT_MSG(msg.c_str());
+    }
+    while (fgets(buf, sizeof(buf), fp) && buf[0] != '\n')
+    {   if (strncmp(buf, "FORMAT=", 7) == 0 && 
+            strncmp(buf, "FORMAT=32-bit_rle_rgbe", 22) != 0)
+        {   fclose(fp);
+            SLstring msg = "SLImage::loadHDR: Only RGBE is supported: " + filename;
+            SL_EXIT_MSG(msg.c_str());
+        }
+    }
+
+    SLint width, height;
+    if (!fgets(buf, sizeof(buf), fp) || 
+        sscanf(buf, "-Y %d +X %d", &height, &width) != 2 ||
+        width <= 0 || height <= 0)
+    {   fclose(fp);
+        SLstring msg = "SLImage::loadHDR: Unsupported resolution line: " + filename;
+        SL_EXIT_MSG(msg.c_str());
+    }
+
+    allocate(width, height, PF_rgb, PD_float);
+
+    // Radiance files start with the top line
+    SLVuchar rgbe(width*4);
+    for (SLint row=0; row<height; ++row)
+    {   if (!readHDRScanline(fp, &rgbe[0], width))
+        {   fclose(fp);
+            SLstring msg = "SLImage::loadHDR: Corrupt scanline in: " + filename;
+            SL_EXIT_MSG(msg.c_str());
+        }
+
+        SLfloat* dst = linef(height-1-row);
+        for (SLint x=0; x<width; ++x, dst+=3)
+        {   SLuchar* p = &rgbe[4*x];
+            if (p[3])
+            {   SLfloat f = (SLfloat)ldexp(1.0, p[3] - (128+8));
+                dst[0] = (p[0] + 0.5f) * f;
+                dst[1] = (p[1] + 0.5f) * f;
+                dst[2] = (p[2] + 0.5f) * f;
+            } else dst[0] = dst[1] = dst[2] = 0.0f;
+        }
+    }
+    fclose(fp);
+}
+//-----------------------------------------------------------------------------
 //! Save as PNG using libPNG. See http://www.libpng.org/pub/png/libpng.html
 void SLImage::savePNG(SLstring filename)
 {  
@@ -863,6 +1111,15 @@ void SLImage::savePNG(SLstring filename)
     {   SLstring msg = "SLGLTexture::savePNG: No data to write for file:" + filename;
         SL_EXIT_MSG(msg.c_str());
     }
+
+    // Float images get tone mapped to 8-bit
+    if (_dataType != PD_ubyte)
+    {   SLImage ldrImg;
+        toneMap(&ldrImg);
+        ldrImg.savePNG(filename);
+        return;
+    }
+
     png_structp png_ptr;
     png_infop   info_ptr;
     png_bytep*  row_ptrs;
@@ -957,6 +1214,51 @@ void SLImage::savePNG(SLstring filename)
     fclose(fp);
 }
 //-----------------------------------------------------------------------------
+/*!
+SLImage::saveHDR saves the image as Radiance HDR file with uncompressed RGBE
+pixels. Images of all data types can be saved. Alpha is ignored.
+*/
+void SLImage::saveHDR(SLstring filename)
+{
+    if (!_data || !_width || !_height)
+    {   SLstring msg = "SLImage::saveHDR: No data to write for file:" + filename;
+        SL_EXIT_MSG(msg.c_str());
+    }
+
+    FILE *fp = fopen(filename.c_str(), "wb");
+    if (!fp)
+    {   SLstring msg = "SLImage::saveHDR: Failed to create file: " + filename;
+        SL_EXIT_MSG(msg.c_str());
+    }
+
+    fprintf(fp, "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y %d +X %d\n", _height, _width);
+
+    SLVCol4f colors(_width);
+    SLVuchar rgbe(_width*4);
+
+    // Radiance files start with the top line
+    for (SLint y=_height-1; y>=0; --y)
+    {   readLine(y, &colors[0]);
+        for (SLint x=0; x<_width; ++x)
+        {   SLCol4f& c = colors[x];
+            SLfloat v = max(max(c.r, c.g), c.b);
+            SLuchar* p = &rgbe[4*x];
+            if (v < 1e-32f)
+                p[0] = p[1] = p[2] = p[3] = 0;
+            else
+            {   SLint e;
+                SLfloat m = frexp(v, &e) * 256.0f / v;
+                p[0] = (SLuchar)(max(c.r, 0.0f) * m);
+                p[1] = (SLuchar)(max(c.g, 0.0f) * m);
+                p[2] = (SLuchar)(max(c.b, 0.0f) * m);
+                p[3] = (SLuchar)(e + 128);
+            }
+        }
+        fwrite(&rgbe[0], 4, _width, fp);
+    }
+    fclose(fp);
+}
+//-----------------------------------------------------------------------------
 //! getPixeli returns the pixel color at the integer pixel coordinate x, y
 SLCol4f SLImage::getPixeli(SLint x, SLint y)
 {
@@ -966,6 +1268,12 @@ SLCol4f SLImage::getPixeli(SLint x, SLint y)
     x %= _width;
     y %= _height;
 
+    if (_dataType != PD_ubyte)
+    {   pixelsToFloat(_data + _bytesPerLine*y + _bytesPerPixel*x, 1,
+                      _format, _dataType, &color);
+        return color;
+    }
+
     switch (_format)
     {   case PF_rgb:
             addr = _bytesPerLine*y + 3*x;
@@ -1059,6 +1367,12 @@ void SLImage::setPixeli(SLint x, SLint y, SLCol4f color)
     if (y<0) y = 0; 
     if (y>=(SLint)_height) y = _height-1; // 0 <= y < _height
    
+    if (_dataType != PD_ubyte)
+    {   floatToPixels(&color, 1, _format, _dataType,
+                      _data + _bytesPerLine*y + _bytesPerPixel*x);
+        return;
+    }
+
     SLubyte* addr;
     SLint R, G, B;
 
@@ -1119,11 +1433,18 @@ void SLImage::setPixeli(SLint x, SLint y, SLCol4f color)
 //! setPixeli sets the RGB pixel color at the integer pixel coordinate x, y
 void SLImage::setPixeliRGB(SLint x, SLint y, SLCol3f color)
 {  
-    assert(_bytesPerPixel==3);
+    assert(numChannels(_format)==3);
     if (x<0) x = 0; 
     if (x>=(SLint)_width)  x = _width -1; // 0 <= x < _width
     if (y<0) y = 0; 
     if (y>=(SLint)_height) y = _height-1; // 0 <= y < _height
+
+    if (_dataType != PD_ubyte)
+    {   SLCol4f c(color.r, color.g, color.b);
+        floatToPixels(&c, 1, _format, _dataType,
+                      _data + _bytesPerLine*y + _bytesPerPixel*x);
+        return;
+    }
    
     SLubyte* addr = _data + _bytesPerLine*y + _bytesPerPixel*x;
     *(addr++) = (SLubyte)(color.r * 255.0f + 0.5f);
@@ -1134,11 +1455,18 @@ void SLImage::setPixeliRGB(SLint x, SLint y, SLCol3f color)
 //! setPixeli sets the RGB pixel color at the integer pixel coordinate x, y
 void SLImage::setPixeliRGB(SLint x, SLint y, SLCol4f color)
 {  
-    assert(_bytesPerPixel==3);
+    assert(numChannels(_format)==3);
     if (x<0) x = 0; 
     if (x>=(SLint)_width)  x = _width -1; // 0 <= x < _width
     if (y<0) y = 0; 
     if (y>=(SLint)_height) y = _height-1; // 0 <= y < _height
+
+    if (_dataType != PD_ubyte)
+    {   SLCol4f c(color.r, color.g, color.b, 1.0f);
+        floatToPixels(&c, 1, _format, _dataType,
+                      _data + _bytesPerLine*y + _bytesPerPixel*x);
+        return;
+    }
    
     SLubyte* addr = _data + _bytesPerLine*y + _bytesPerPixel*x;
     *(addr++) = (SLubyte)(color.r * 255.0f + 0.5f);
@@ -1149,11 +1477,17 @@ void SLImage::setPixeliRGB(SLint x, SLint y, SLCol4f color)
 //! setPixeli sets the RGBA pixel color at the integer pixel coordinate x, y
 void SLImage::setPixeliRGBA(SLint x, SLint y, SLCol4f color)
 {  
-    assert(_bytesPerPixel==4);
+    assert(numChannels(_format)==4);
     if (x<0) x = 0; 
     if (x>=(SLint)_width)  x = _width -1; // 0 <= x < _width
     if (y<0) y = 0; 
     if (y>=(SLint)_height) y = _height-1; // 0 <= y < _height
+
+    if (_dataType != PD_ubyte)
+    {   floatToPixels(&color, 1, _format, _dataType,
+                      _data + _bytesPerLine*y + _bytesPerPixel*x);
+        return;
+    }
    
     SLubyte* addr = _data + _bytesPerLine*y + _bytesPerPixel*x;
     *(addr++) = (SLubyte)(color.r * 255.0f);
@@ -1163,19 +1497,202 @@ void SLImage::setPixeliRGBA(SLint x, SLint y, SLCol4f color)
 }
 //-----------------------------------------------------------------------------
 /*!
+SLImage::readLine converts the pixels of line y to float colors. The colors
+array must hold width() elements. 8-bit channels are mapped to 0-1, half and
+float channels are not clamped. Missing channels are set as in getPixeli.
+*/
+void SLImage::readLine(SLint y, SLCol4f* colors)
+{
+    assert(_data && y>=0 && y<_height && colors);
+    pixelsToFloat(line(y), _width, _format, _dataType, colors);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLImage::writeLine converts width() float colors to the pixels of line y. For
+8-bit images the colors are clamped to 0-1 and rounded.
+*/
+void SLImage::writeLine(SLint y, const SLCol4f* colors)
+{
+    assert(_data && y>=0 && y<_height && colors);
+    floatToPixels(colors, _width, _format, _dataType, line(y));
+}
+//-----------------------------------------------------------------------------
+//! Converts the image in place to the passed channel data type
+void SLImage::convert(SLPixelDataType dataType)
+{
+    if (!_data || dataType == _dataType) return;
+
+    SLImage src(*this);
+    allocate(_width, _height, _format, dataType);
+
+    SLVCol4f colors(_width);
+    for (SLint y=0; y<_height; ++y)
+    {   src.readLine(y, &colors[0]);
+        writeLine(y, &colors[0]);
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+SLImage::toneMap converts the linear colors of the image into the 8-bit RGB
+or RGBA image dstImg for display. The colors are scaled by the exposure,
+compressed with the exponential operator 1 - exp(-c) and gamma corrected.
+*/
+void SLImage::toneMap(SLImage* dstImg, SLfloat exposure, SLfloat gamma)
+{
+    assert(_data && dstImg && dstImg != this);
+
+    SLbool hasAlpha = imageChannels(_format).a >= 0;
+    dstImg->allocate(_width, _height, hasAlpha ? PF_rgba : PF_rgb);
+
+    SLfloat oneOverGamma = 1.0f / gamma;
+    SLVCol4f colors(_width);
+    for (SLint y=0; y<_height; ++y)
+    {   readLine(y, &colors[0]);
+        for (auto& c : colors)
+        {   c.r = pow(1.0f - exp(-c.r*exposure), oneOverGamma);
+            c.g = pow(1.0f - exp(-c.g*exposure), oneOverGamma);
+            c.b = pow(1.0f - exp(-c.b*exposure), oneOverGamma);
+        }
+        dstImg->writeLine(y, &colors[0]);
+    }
+}
+//-----------------------------------------------------------------------------
+//! Min. NO. of pixels of an image to process its lines in parallel
+static const SLint SL_IMAGE_MIN_PARALLEL_PIXELS = 256*256;
+//! NO. of lines a thread takes at once
+static const SLint SL_IMAGE_LINES_PER_JOB = 16;
+//! NO. of fractional bits of the fixed point filter weights
+static const SLint SL_IMAGE_FIXED_BITS = 14;
+static const SLint SL_IMAGE_FIXED_ONE  = 1 << SL_IMAGE_FIXED_BITS;
+static const SLint SL_IMAGE_FIXED_HALF = 1 << (SL_IMAGE_FIXED_BITS-1);
+//! Lanczos-2 kernel for a 2:1 reduction in fixed point (sums up to 16384)
+static const SLshort SL_IMAGE_DOWN_KERNEL[6] = {-675, 1875, 6992, 6992, 1875, -675};
+//-----------------------------------------------------------------------------
+/*!
+Calls job for all lines from 0 to numLines-1. Images with more than
+SL_IMAGE_MIN_PARALLEL_PIXELS pixels are processed on SL::maxThreads() threads
+that take SL_IMAGE_LINES_PER_JOB lines at once. The main thread does the same
+work. The job may only write into its own line. If the caller is already a
+worker of a thread pool (e.g. an image loaded by the importer jobs) the lines
+are processed serially.
+*/
+static void forEachLine(SLint numLines, SLint numPixels, function<void(SLint)> job)
+{
+    SLint numThreads = numPixels < SL_IMAGE_MIN_PARALLEL_PIXELS ? 1 :
+                       SL::isWorkerThread() ? 1 :
+                       min((SLint)SL::maxThreads(), 
+                           (numLines + SL_IMAGE_LINES_PER_JOB-1) / SL_IMAGE_LINES_PER_JOB);
+    if (numThreads <= 1)
+    {   for (SLint y=0; y<numLines; ++y) job(y);
+        return;
+    }
+
+    atomic<SLint> nextLine(0);
+    auto runJobs = [&]()
+    {   for (;;)
+        {   SLint first = nextLine.fetch_add(SL_IMAGE_LINES_PER_JOB);
+            if (first >= numLines) break;
+            SLint last = min(first + SL_IMAGE_LINES_PER_JOB, numLines);
+            for (SLint y=first; y<last; ++y) job(y);
+        }
+    };
+
+    // Start additional threads and do the same work in the main thread
+    vector<thread> threads;
+    for (SLint t=0; t < numThreads-1; t++)
+        threads.push_back(thread(runJobs));
+    runJobs();
+    for(auto& thread : threads) thread.join();
+}
+//-----------------------------------------------------------------------------
+//! Rounds a fixed point sum of weighted bytes and clamps it to a byte
+static inline SLubyte fixedToByte(SLint sum)
+{
+    return (SLubyte)SL_clamp((sum + SL_IMAGE_FIXED_HALF) >> SL_IMAGE_FIXED_BITS, 0, 255);
+}
+//-----------------------------------------------------------------------------
+/*!
+Writes n bytes into dst that are the weighted sums of the bytes of the numTaps
+source rows src with the fixed point weights w. The sums are accumulated in
+32-bit integers. With SSE2 or NEON 8 bytes are processed at once if all
+weights fit into 16 bits (the SIMD multiplies are 16 x 16 bit). The remaining
+bytes and kernels with larger weights (e.g. the center of a sharpen kernel)
+are calculated with the same integer arithmetic in the scalar loop, so the
+result is bit-exact with the scalar code.
+*/
+static void weightedSum(SLubyte* dst, 
+                        const SLubyte* const* src,
+                        const SLint* w,
+                        SLint numTaps,
+                        SLint n)
+{
+    SLint i = 0;
+
+    #if defined(SL_IMAGE_USE_SSE) || defined(SL_IMAGE_USE_NEON)
+    SLint nSIMD = n;
+    for (SLint t=0; t<numTaps; ++t)
+        if (w[t] < SHRT_MIN || w[t] > SHRT_MAX) nSIMD = 0;
+    #endif
+
+    #if defined(SL_IMAGE_USE_SSE)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi32(SL_IMAGE_FIXED_HALF);
+    for (; i+8 <= nSIMD; i+=8)
+    {   __m128i sumLo = half;
+        __m128i sumHi = half;
+        for (SLint t=0; t<numTaps; ++t)
+        {   __m128i p  = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src[t]+i)), zero);
+            __m128i wt = _mm_set1_epi16((SLshort)w[t]);
+            __m128i lo = _mm_mullo_epi16(p, wt);
+            __m128i hi = _mm_mulhi_epi16(p, wt);
+            sumLo = _mm_add_epi32(sumLo, _mm_unpacklo_epi16(lo, hi));
+            sumHi = _mm_add_epi32(sumHi, _mm_unpackhi_epi16(lo, hi));
+        }
+        sumLo = _mm_srai_epi32(sumLo, SL_IMAGE_FIXED_BITS);
+        sumHi = _mm_srai_epi32(sumHi, SL_IMAGE_FIXED_BITS);
+        __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(sumLo, sumHi), zero);
+        _mm_storel_epi64((__m128i*)(dst+i), bytes);
+    }
+    #elif defined(SL_IMAGE_USE_NEON)
+    const int32x4_t half = vdupq_n_s32(SL_IMAGE_FIXED_HALF);
+    for (; i+8 <= nSIMD; i+=8)
+    {   int32x4_t sumLo = half;
+        int32x4_t sumHi = half;
+        for (SLint t=0; t<numTaps; ++t)
+        {   int16x8_t p = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(src[t]+i)));
+            sumLo = vmlal_n_s16(sumLo, vget_low_s16(p),  (SLshort)w[t]);
+            sumHi = vmlal_n_s16(sumHi, vget_high_s16(p), (SLshort)w[t]);
+        }
+        int16x8_t s16 = vcombine_s16(vqmovn_s32(vshrq_n_s32(sumLo, SL_IMAGE_FIXED_BITS)),
+                                     vqmovn_s32(vshrq_n_s32(sumHi, SL_IMAGE_FIXED_BITS)));
+        vst1_u8(dst+i, vqmovun_s16(s16));
+    }
+    #endif
+
+    for (; i<n; ++i)
+    {   SLint sum = 0;
+        for (SLint t=0; t<numTaps; ++t)
+            sum += w[t] * src[t][i];
+        dst[i] = fixedToByte(sum);
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
 SLImage::Resize does a scaling with bilinear interpolation. The color of the 
 destination pixel is calculated by the summed up color of the 4 underlying 
 source pixels multiplied by their fractional area.
 If a pointer to a new image (dstImg) is supplied the rescale is applied to the
-new image only.
+new image only. The source columns and weights are calculated once per column
+and the lines are processed in parallel for large images.
 */
 void SLImage::resize(SLint width, SLint height, SLImage* dstImg, SLbool invert)
 {  
     assert(_data!=0 && _width>0 && _height>0 && width>0 && height>0);
+    assert(_dataType==PD_ubyte && "SLImage::resize: Only for 8-bit images");
    
     SLint    dstW = width;
     SLint    dstH = height;
-    SLuint   dstBytesPerLine = _bytesPerPixel * width;
+    SLuint   dstBytesPerLine = bytesPerLine(width, _format);
     SLuint   dstBytesPerImage = dstBytesPerLine * height;
    
     // allocate new memory for dstImg or for myself
@@ -1195,10 +1712,9 @@ void SLImage::resize(SLint width, SLint height, SLImage* dstImg, SLbool invert)
     SLfloat  wFac = (SLfloat)srcW / (SLfloat)dstW;
     SLfloat  hFac = (SLfloat)srcH / (SLfloat)dstH;
     SLfloat  wFacHalf = wFac * 0.5f;
-    SLfloat  hFacHalf = wFac * 0.5f;
+    SLfloat  hFacHalf = hFac * 0.5f;
     SLint    srcLineBytes = _bytesPerLine;
-    SLubyte* dstStart = dstData;
-    SLubyte* pDst;
+    SLint    bpp = _bytesPerPixel;
    
     /*
     +---------+---------+
@@ -1213,69 +1729,56 @@ void SLImage::resize(SLint width, SLint height, SLImage* dstImg, SLbool invert)
     |         |         |  
     +---------+---------+ 
     */ 
-   
-    SLubyte* srcLineL, *srcLineU;
-    SLint    iHL, iHU, iWL, iWR;
-    SLfloat  fW, fH = hFac-hFacHalf;
-    SLfloat  wUL, wUR, wLL, wLR;
-      
-    for(SLint h=0; h<dstH; h++, fH+=hFac, dstStart += dstBytesPerLine)
-    {   pDst = dstStart;
-   
-        iHU = min((SLint)(fH+0.5f), srcH-1);
-        iHL = max(iHU-1, 0);
-      
-        srcLineL = _data + iHL * srcLineBytes; 
-        if (iHL==iHU) srcLineU = srcLineL;
-        else srcLineU = srcLineL + srcLineBytes;
-         
-        fW = wFac-wFacHalf;
 
-        for(int w=0; w<dstW; w++, fW+=wFac)
+    // Source rows and fractions of all lines
+    SLVint   iHL(dstH), iHU(dstH);
+    SLVfloat fracY(dstH);
+    SLfloat  fH = hFac-hFacHalf;
+    for (SLint h=0; h<dstH; h++, fH+=hFac)
+    {   iHU[h] = min((SLint)(fH+0.5f), srcH-1);
+        iHL[h] = max(iHU[h]-1, 0);
+        fracY[h] = SL_abs(SL_fract(fH-0.5f));
+    }
+
+    // Source columns and fractions of all columns
+    SLVint   iWL(dstW), iWR(dstW);
+    SLVfloat fracX(dstW);
+    SLfloat  fW = wFac-wFacHalf;
+    for (SLint w=0; w<dstW; w++, fW+=wFac)
+    {   iWR[w] = min((SLint)(fW+0.5f), srcW-1);
+        iWL[w] = max(iWR[w]-1, 0);
+        fracX[w] = SL_abs(SL_fract(fW-0.5f));
+    }
+
+    forEachLine(dstH, dstW*dstH, [&](SLint h)
+    {   SLubyte* pDst = dstData + h*dstBytesPerLine;
+        SLubyte* srcLineL = _data + iHL[h] * srcLineBytes; 
+        SLubyte* srcLineU = iHL[h]==iHU[h] ? srcLineL : srcLineL + srcLineBytes;
+        SLfloat  oneMinusFracY = 1.0f - fracY[h];
+
+        for(SLint w=0; w<dstW; w++)
         {  
-            // calculate 4 pixel pointers
-            iWR = min((SLint)(fW+0.5f), srcW-1);
-            iWL = max(iWR-1, 0);
-         
             // pointers to UpperLeft, UpperRight, LowerLeft & LowerRight pixels
-            SLubyte* pUL = srcLineU + iWL*_bytesPerPixel;
-            SLubyte* pUR = srcLineU + iWR*_bytesPerPixel;
-            SLubyte* pLL = srcLineL + iWL*_bytesPerPixel;
-            SLubyte* pLR = srcLineL + iWR*_bytesPerPixel;
+            SLubyte* pUL = srcLineU + iWL[w]*bpp;
+            SLubyte* pUR = srcLineU + iWR[w]*bpp;
+            SLubyte* pLL = srcLineL + iWL[w]*bpp;
+            SLubyte* pLR = srcLineL + iWR[w]*bpp;
   
-            SLfloat fracX = SL_abs(SL_fract(fW-0.5f));
-            SLfloat fracY = SL_abs(SL_fract(fH-0.5f));
-            SLfloat oneMinusFracX = 1.0f - fracX;
-            SLfloat oneMinusFracY = 1.0f - fracY;
+            SLfloat oneMinusFracX = 1.0f - fracX[w];
          
             // weights = normalized subpixel areas
-            wUR = fracX * fracY;
-            wUL = oneMinusFracX * fracY;
-            wLR = fracX * oneMinusFracY;
-            wLL = oneMinusFracX * oneMinusFracY;
+            SLfloat wUR = fracX[w] * fracY[h];
+            SLfloat wUL = oneMinusFracX * fracY[h];
+            SLfloat wLR = fracX[w] * oneMinusFracY;
+            SLfloat wLL = oneMinusFracX * oneMinusFracY;
          
             // calculate the weighted color for each component of RGBA
-            if (invert)
-            {   for (SLint bpp=0; bpp<_bytesPerPixel; ++bpp)
-                {   SLfloat cUL = (SLfloat)*(pUL++);
-                    SLfloat cUR = (SLfloat)*(pUR++);
-                    SLfloat cLL = (SLfloat)*(pLL++);
-                    SLfloat cLR = (SLfloat)*(pLR++);
-                    SLfloat col = wUL*cUL + wLL*cLL + wUR*cUR + wLR*cLR;
-                    *(pDst++) = 255 - (SLubyte)col;
-                }
-             } else
-             {  for (SLint bpp=0; bpp<_bytesPerPixel; ++bpp)
-                {   SLfloat cUL = (SLfloat)*(pUL++);
-                    SLfloat cUR = (SLfloat)*(pUR++);
-                    SLfloat cLL = (SLfloat)*(pLL++);
-                    SLfloat cLR = (SLfloat)*(pLR++);
-                    SLfloat col = wUL*cUL + wLL*cLL + wUR*cUR + wLR*cLR;
-                    *(pDst++) = (SLubyte)col;
-                }
+            for (SLint c=0; c<bpp; ++c)
+            {   SLfloat col = wUL*pUL[c] + wLL*pLL[c] + wUR*pUR[c] + wLR*pLR[c];
+                *(pDst++) = invert ? 255 - (SLubyte)col : (SLubyte)col;
             }
         }
-    }
+    });
    
     if (!dstImg)
     {   delete[] _data;   // release old memory
@@ -1287,189 +1790,176 @@ void SLImage::resize(SLint width, SLint height, SLImage* dstImg, SLbool invert)
     }
 }
 //-----------------------------------------------------------------------------
+/*!
+SLImage::downsample writes the image with half the width and height into
+dstImg. This is the filter for the creation of mipmap levels. Each destination
+pixel is the weighted sum of 6x6 source pixels with the separable 6-tap
+Lanczos-2 kernel for a 2:1 reduction (SL_IMAGE_DOWN_KERNEL). It keeps more
+sharpness than the box or bilinear filter of resize without aliasing. Source
+pixels outside the image are clamped to the border. Odd sizes are rounded down.
+\n
+8-bit images are filtered in fixed point first vertically with the SIMD line
+sum and then horizontally. The result is bit-exact with the scalar fallback.
+Half and float images are filtered in float.
+*/
+void SLImage::downsample(SLImage* dstImg)
+{
+    assert(_data && dstImg && dstImg != this);
+
+    SLint dstW = max(_width/2, 1);
+    SLint dstH = max(_height/2, 1);
+    SLint bpp  = _bytesPerPixel;
+    dstImg->allocate(dstW, dstH, _format, _dataType);
+
+    // Source index of tap t for the destination index d
+    auto srcIndex = [](SLint d, SLint t, SLint srcSize)
+    {   return SL_clamp(2*d - 2 + t, 0, srcSize-1);
+    };
+
+    if (_dataType == PD_ubyte)
+    {   SLint weights[6];
+        for (SLint t=0; t<6; ++t) weights[t] = SL_IMAGE_DOWN_KERNEL[t];
+
+        forEachLine(dstH, dstW*dstH, [&](SLint y)
+        {   // vertical pass over the full source line width
+            const SLubyte* rows[6];
+            for (SLint t=0; t<6; ++t)
+                rows[t] = line(srcIndex(y, t, _height));
+            SLVuchar tmp(_width*bpp);
+            weightedSum(&tmp[0], rows, weights, 6, _width*bpp);
+
+            // horizontal pass with the same fixed point arithmetic
+            SLubyte* dst = dstImg->line(y);
+            for (SLint x=0; x<dstW; ++x)
+            {   for (SLint c=0; c<bpp; ++c)
+                {   SLint sum = 0;
+                    for (SLint t=0; t<6; ++t)
+                        sum += weights[t] * tmp[srcIndex(x, t, _width)*bpp + c];
+                    *(dst++) = fixedToByte(sum);
+                }
+            }
+        });
+    } else
+    {   SLfloat weights[6];
+        for (SLint t=0; t<6; ++t) 
+            weights[t] = (SLfloat)SL_IMAGE_DOWN_KERNEL[t] / SL_IMAGE_FIXED_ONE;
+
+        forEachLine(dstH, dstW*dstH, [&](SLint y)
+        {   SLVCol4f src(_width), tmp(_width, SLCol4f(0,0,0,0)), dst(dstW);
+            for (SLint t=0; t<6; ++t)
+            {   readLine(srcIndex(y, t, _height), &src[0]);
+                for (SLint x=0; x<_width; ++x)
+                    tmp[x] += src[x] * weights[t];
+            }
+            for (SLint x=0; x<dstW; ++x)
+            {   dst[x].set(0,0,0,0);
+                for (SLint t=0; t<6; ++t)
+                    dst[x] += tmp[srcIndex(x, t, _width)] * weights[t];
+            }
+            dstImg->writeLine(y, &dst[0]);
+        });
+    }
+}
+//-----------------------------------------------------------------------------
 //! Flip Y coordiantes used to make JPEGs from top-left to bottom-left images.
+/*! The lines are swapped in place.
+*/
 void SLImage::flipY()
 {  
     if (_data && _width > 0 && _height > 0)
-    {  
-        // allocate new memory
-        SLubyte* pDst = new SLubyte[_bytesPerImage];
-        if (!pDst) 
-            SL_EXIT_MSG("SLImage::flipY(): Out of memory.");
-      
-        SLubyte* pSrcBot = _data;
-        SLubyte* pDstTop = pDst + _bytesPerImage - _bytesPerLine;
-      
-        // copy lines
-        for (SLint h=0; h<_height; ++h)
-        {   memcpy(pDstTop, pSrcBot, _bytesPerLine);   
-            pSrcBot += _bytesPerLine;
-            pDstTop -= _bytesPerLine;
-        }
-      
-        delete[] _data;   // release old memory
-        _data = pDst;     // assign new memory
+    {   forEachLine(_height/2, _width*_height, [&](SLint h)
+        {   swap_ranges(line(h), line(h) + _bytesPerLine, line(_height-1-h));
+        });
     }
 }
 //-----------------------------------------------------------------------------
-//! Applies a convolution filter with the 3x3 filter kernel k passed as float k[9]
+/*!
+Applies a convolution filter with the 3x3 filter kernel k passed as float k[9].
+The kernel gets normalized by the sum of its elements. k[0-2] weight the line
+above, k[3-5] the same line and k[6-8] the line below. Pixels outside the image
+are clamped to the border. The filter is calculated in fixed point with the
+SIMD line sum for the inner pixels, line by line in parallel for large images.
+*/
 void SLImage::convolve3x3(SLfloat* k)
 {
     assert(_data!=0 && _width>0 && _height>0 && k);
+    assert(_dataType==PD_ubyte && "SLImage::convolve3x3: Only for 8-bit images");
 
     // allocate new memory for dstImg or for myself
-    SLubyte* dstData;
-    {   dstData = new SLubyte[_bytesPerImage];
-        if (!dstData) 
-        {  SL_EXIT_MSG("SLImage::resize: Out of memory.");
-        }
+    SLubyte* dstData = new SLubyte[_bytesPerImage];
+    if (!dstData) 
+    {  SL_EXIT_MSG("SLImage::convolve3x3: Out of memory.");
     }
 
-    // Sum kernel elements so can gen normalized variables
+    // Normalized fixed point weights that sum up exactly to one
     SLfloat s = k[0]+k[1]+k[2]+k[3]+k[4]+k[5]+k[6]+k[7]+k[8];
-    k[0]/=s; k[1]/=s; k[2]/=s;
-    k[3]/=s; k[4]/=s; k[5]/=s;
-    k[6]/=s; k[7]/=s; k[8]/=s;
+    if (SL_abs(s) < FLT_EPSILON) s = 1.0f;
+    // Normalized weights can be 2 or more (e.g. sharpen) and need 32 bits.
+    SLint weights[9];
+    SLint sumW = 0;
+    for (SLint i=0; i<9; ++i)
+    {   weights[i] = (SLint)floor(k[i] / s * SL_IMAGE_FIXED_ONE + 0.5f);
+        sumW += weights[i];
+    }
+    if (SL_abs(s - 1.0f) > FLT_EPSILON || sumW != SL_IMAGE_FIXED_ONE)
+        weights[4] += SL_IMAGE_FIXED_ONE - sumW;
 
     SLint bpp = _bytesPerPixel;
     SLint bpl = _bytesPerLine;
-   
-    // concolve the image except the border
-    SLint offC[9] = {-bpp+bpl, +bpl, bpp+bpl,
-                     -bpp    , 0   , bpp    ,
-                     -bpp-bpl, -bpl, bpp-bpl};
-    SLubyte* srcLine = _data   + _bytesPerLine + _bytesPerPixel;
-    SLubyte* dstLine = dstData + _bytesPerLine + _bytesPerPixel;
-    SLubyte* src, *dst;
-
-    for(SLint h=1; h<_height-1; ++h)
-    {   src = srcLine;
-        dst = dstLine;
-        for(SLint w=1; w<_width-1; ++w)
-        {   for (SLint p=0; p<_bytesPerPixel; ++p)
-            {  *dst = SLubyte(*(src+offC[0])*k[0] + *(src+offC[1])*k[1] + *(src+offC[2])*k[2] +
-                            *(src+offC[3])*k[3] + *(src+offC[4])*k[4] + *(src+offC[5])*k[5] +
-                            *(src+offC[6])*k[6] + *(src+offC[7])*k[7] + *(src+offC[8])*k[8]);
-            src++;
-            dst++;
-            }
-        }
-        srcLine+=_bytesPerLine;
-        dstLine+=_bytesPerLine;
-    }
-   
-    // concolve the bottom border
-    SLint offB[9] = {-bpp+bpl, +bpl, bpp+bpl,
-                     -bpp    , 0   , bpp    ,
-                     -bpp    , 0   , bpp    };
-    src = _data   + _bytesPerPixel;
-    dst = dstData + _bytesPerPixel;
-    for(SLint w=1; w<_width-1; ++w)
-    {   for (SLint p=0; p<_bytesPerPixel; ++p)
-        {   *dst = SLubyte(*(src+offB[0])*k[0] + *(src+offB[1])*k[1] + *(src+offB[2])*k[2] +
-                           *(src+offB[3])*k[3] + *(src+offB[4])*k[4] + *(src+offB[5])*k[5] +
-                           *(src+offB[6])*k[6] + *(src+offB[7])*k[7] + *(src+offB[8])*k[8]);
-            src++;
-            dst++;
-        }
-    }
-   
-    // concolve the top border
-    SLint offT[9] = {-bpp    , 0   , bpp,
-                    -bpp    , 0   , bpp    ,
-                    -bpp-bpl, -bpl, bpp-bpl};
-    src = _data   + _bytesPerImage - _bytesPerLine + _bytesPerPixel;
-    dst = dstData + _bytesPerImage - _bytesPerLine + _bytesPerPixel;
-    for(SLint w=1; w<_width-1; ++w)
-    {   for (SLint p=0; p<_bytesPerPixel; ++p)
-        {   *dst = SLubyte(*(src+offT[0])*k[0] + *(src+offT[1])*k[1] + *(src+offT[2])*k[2] +
-                           *(src+offT[3])*k[3] + *(src+offT[4])*k[4] + *(src+offT[5])*k[5] +
-                           *(src+offT[6])*k[6] + *(src+offT[7])*k[7] + *(src+offT[8])*k[8]);
-            src++;
-            dst++;
-        }
-    }
-   
-    // concolve the left border
-    SLint offL[9] = {+bpl, +bpl, bpp+bpl,
-                        0  , 0   , bpp    ,
-                    -bpl, -bpl, bpp-bpl};
-    srcLine = _data   + _bytesPerLine;
-    dstLine = dstData + _bytesPerLine;
-    for(SLint h=1; h<_height-1; ++h)
-    {   src = srcLine;
-        dst = dstLine;
-        for (SLint p=0; p<_bytesPerPixel; ++p)
-        {   *dst = SLubyte(*(src+offL[0])*k[0] + *(src+offL[1])*k[1] + *(src+offL[2])*k[2] +
-                           *(src+offL[3])*k[3] + *(src+offL[4])*k[4] + *(src+offL[5])*k[5] +
-                           *(src+offL[6])*k[6] + *(src+offL[7])*k[7] + *(src+offL[8])*k[8]);
-            src++;
-            dst++;
+    SLint numBytes = _width * bpp;
+
+    forEachLine(_height, _width*_height, [&](SLint h)
+    {   const SLubyte* rowA = line(min(h+1, _height-1));
+        const SLubyte* rowM = line(h);
+        const SLubyte* rowB = line(max(h-1, 0));
+        SLubyte* dst = dstData + h*bpl;
+
+        // inner pixels
+        if (_width > 2)
+        {   const SLubyte* rows[9] = {rowA, rowA+bpp, rowA+2*bpp,
+                                      rowM, rowM+bpp, rowM+2*bpp,
+                                      rowB, rowB+bpp, rowB+2*bpp};
+            weightedSum(dst+bpp, rows, weights, 9, numBytes-2*bpp);
         }
-        srcLine+=_bytesPerLine;
-        dstLine+=_bytesPerLine;
-    }
-   
-    // concolve the right border
-    SLint offR[9] = {-bpp+bpl, +bpl, +bpl,
-                    -bpp    , 0   ,   0 ,
-                    -bpp-bpl, -bpl, -bpl};
-    srcLine = _data   + _bytesPerLine + _bytesPerLine - _bytesPerPixel;
-    dstLine = dstData + _bytesPerLine + _bytesPerLine - _bytesPerPixel;
-    for(SLint h=1; h<_height-1; ++h)
-    {   src = srcLine;
-        dst = dstLine;
-        for (SLint p=0; p<_bytesPerPixel; ++p)
-        {   *dst = SLubyte(*(src+offR[0])*k[0] + *(src+offR[1])*k[1] + *(src+offR[2])*k[2] +
-                           *(src+offR[3])*k[3] + *(src+offR[4])*k[4] + *(src+offR[5])*k[5] +
-                           *(src+offR[6])*k[6] + *(src+offR[7])*k[7] + *(src+offR[8])*k[8]);
-            src++;
-            dst++;
+
+        // left & right border pixel with clamped columns
+        for (SLint x : {0, _width-1})
+        {   SLint xm = max(x-1, 0)*bpp;
+            SLint x0 = x*bpp;
+            SLint xp = min(x+1, _width-1)*bpp;
+            for (SLint c=0; c<bpp; ++c)
+            {   SLint sum = weights[0]*rowA[xm+c] + weights[1]*rowA[x0+c] + weights[2]*rowA[xp+c] +
+                            weights[3]*rowM[xm+c] + weights[4]*rowM[x0+c] + weights[5]*rowM[xp+c] +
+                            weights[6]*rowB[xm+c] + weights[7]*rowB[x0+c] + weights[8]*rowB[xp+c];
+                dst[x0+c] = fixedToByte(sum);
+            }
         }
-        srcLine+=_bytesPerLine;
-        dstLine+=_bytesPerLine;
-    }
-   
-    // copy the 4 corners
-    src = _data;
-    dst = dstData;
-    for (SLint p=0; p<_bytesPerPixel; ++p) *dst++ = *src++;
-   
-    src = _data   + _bytesPerLine - _bytesPerPixel;
-    dst = dstData + _bytesPerLine - _bytesPerPixel;
-    for (SLint p=0; p<_bytesPerPixel; ++p) *dst++ = *src++;
-   
-    src = _data   + _bytesPerImage - _bytesPerLine;
-    dst = dstData + _bytesPerImage - _bytesPerLine;
-    for (SLint p=0; p<_bytesPerPixel; ++p) *dst++ = *src++;
-   
-    src = _data   + _bytesPerImage - _bytesPerPixel;
-    dst = dstData + _bytesPerImage - _bytesPerPixel;
-    for (SLint p=0; p<_bytesPerPixel; ++p) *dst++ = *src++;
-   
+    });
    
     delete[] _data;   // release old memory
     _data = dstData;  // assign new memory
 }
 //-----------------------------------------------------------------------------
 //! Fills the image with a certain color
-void SLImage::fill(
-SLubyte r, SLubyte g, SLubyte b, SLubyte a)
+void SLImage::fill(SLubyte r, SLubyte g, SLubyte b, SLubyte a)
 {  
-    SLubyte* srcLine = _data;
-    SLubyte* src;
-    SLubyte  rgba[4];
-   
-    rgba[0] = r; rgba[1] = g; rgba[2] = b; rgba[3] = a;
-   
-    for(SLint h=0; h<_height-1; ++h, srcLine+=_bytesPerLine)
-    {   src = srcLine;
-        for(SLint w=0; w<_width-1; ++w)
-        {   for (SLint p=0; p<_bytesPerPixel; ++p)
-            {   *src = rgba[p];
-                src++;
-            }
-        }
+    if (!_data) return;
+
+    if (_dataType != PD_ubyte)
+    {   SLVCol4f colors(_width, SLCol4f(r/255.0f, g/255.0f, b/255.0f, a/255.0f));
+        forEachLine(_height, _width*_height, [&](SLint h)
+        {   writeLine(h, &colors[0]);
+        });
+        return;
     }
+
+    // Fill the first line and copy it to all others
+    SLubyte rgba[4] = {r, g, b, a};
+    for (SLint w=0; w<_width; ++w)
+        memcpy(_data + w*_bytesPerPixel, rgba, _bytesPerPixel);
+
+    forEachLine(_height-1, _width*_height, [&](SLint h)
+    {   memcpy(line(h+1), _data, _bytesPerLine);
+    });
 }
 //-----------------------------------------------------------------------------
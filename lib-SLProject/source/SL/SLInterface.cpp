@@ -201,10 +201,9 @@ changes it's size.
 */
 void slResize(int sceneViewIndex, int width, int height)
 {
-    SLResizeEvent* e = new SLResizeEvent;
-    e->svIndex = sceneViewIndex;
-    e->width = width;
-    e->height = height;
+    SLInputEvent e(SLInputEvent::Resize, sceneViewIndex);
+    e.resize.width = width;
+    e.resize.height = height;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -214,12 +213,11 @@ void slResize(int sceneViewIndex, int width, int height)
 void slMouseDown(int sceneViewIndex, SLMouseButton button, 
                  int xpos, int ypos, SLKey modifier) 
 {  
-    SLMouseEvent* e = new SLMouseEvent(SLInputEvent::MouseDown);
-    e->svIndex = sceneViewIndex;
-    e->button = button;
-    e->x = xpos;
-    e->y = ypos;
-    e->modifier = modifier;
+    SLInputEvent e(SLInputEvent::MouseDown, sceneViewIndex);
+    e.mouse.button = button;
+    e.mouse.x = xpos;
+    e.mouse.y = ypos;
+    e.mouse.modifier = modifier;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -228,10 +226,9 @@ void slMouseDown(int sceneViewIndex, SLMouseButton button,
 */
 void slMouseMove(int sceneViewIndex, int x, int y)
 {  
-    SLMouseEvent* e = new SLMouseEvent(SLInputEvent::MouseMove);
-    e->svIndex = sceneViewIndex;
-    e->x = x;
-    e->y = y;
+    SLInputEvent e(SLInputEvent::MouseMove, sceneViewIndex);
+    e.mouse.x = x;
+    e.mouse.y = y;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -241,12 +238,11 @@ void slMouseMove(int sceneViewIndex, int x, int y)
 void slMouseUp(int sceneViewIndex, SLMouseButton button, 
                int xpos, int ypos, SLKey modifier) 
 {  
-    SLMouseEvent* e = new SLMouseEvent(SLInputEvent::MouseUp);
-    e->svIndex = sceneViewIndex;
-    e->button = button;
-    e->x = xpos;
-    e->y = ypos;
-    e->modifier = modifier;
+    SLInputEvent e(SLInputEvent::MouseUp, sceneViewIndex);
+    e.mouse.button = button;
+    e.mouse.x = xpos;
+    e.mouse.y = ypos;
+    e.mouse.modifier = modifier;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -256,12 +252,11 @@ void slMouseUp(int sceneViewIndex, SLMouseButton button,
 void slDoubleClick(int sceneViewIndex, SLMouseButton button, 
                    int xpos, int ypos, SLKey modifier) 
 {  
-    SLMouseEvent* e = new SLMouseEvent(SLInputEvent::MouseDoubleClick);
-    e->svIndex = sceneViewIndex;
-    e->button = button;
-    e->x = xpos;
-    e->y = ypos;
-    e->modifier = modifier;
+    SLInputEvent e(SLInputEvent::MouseDoubleClick, sceneViewIndex);
+    e.mouse.button = button;
+    e.mouse.x = xpos;
+    e.mouse.y = ypos;
+    e.mouse.modifier = modifier;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -270,10 +265,9 @@ void slDoubleClick(int sceneViewIndex, SLMouseButton button,
 */
 void slLongTouch(int sceneViewIndex, int xpos, int ypos) 
 {  
-    SLMouseEvent* e = new SLMouseEvent(SLInputEvent::LongTouch);
-    e->svIndex = sceneViewIndex;
-    e->x = xpos;
-    e->y = ypos;
+    SLInputEvent e(SLInputEvent::LongTouch, sceneViewIndex);
+    e.mouse.x = xpos;
+    e.mouse.y = ypos;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -283,12 +277,11 @@ devices.
 */
 void slTouch2Down(int sceneViewIndex, int xpos1, int ypos1, int xpos2, int ypos2) 
 {  
-    SLTouchEvent* e = new SLTouchEvent(SLInputEvent::Touch2Down);
-    e->svIndex = sceneViewIndex;
-    e->x1 = xpos1;
-    e->y1 = ypos1;
-    e->x2 = xpos2;
-    e->y2 = ypos2;
+    SLInputEvent e(SLInputEvent::Touch2Down, sceneViewIndex);
+    e.touch.x1 = xpos1;
+    e.touch.y1 = ypos1;
+    e.touch.x2 = xpos2;
+    e.touch.y2 = ypos2;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -297,12 +290,11 @@ void slTouch2Down(int sceneViewIndex, int xpos1, int ypos1, int xpos2, int ypos2
 */
 void slTouch2Move(int sceneViewIndex, int xpos1, int ypos1, int xpos2, int ypos2) 
 {  
-    SLTouchEvent* e = new SLTouchEvent(SLInputEvent::Touch2Move);
-    e->svIndex = sceneViewIndex;
-    e->x1 = xpos1;
-    e->y1 = ypos1;
-    e->x2 = xpos2;
-    e->y2 = ypos2;
+    SLInputEvent e(SLInputEvent::Touch2Move, sceneViewIndex);
+    e.touch.x1 = xpos1;
+    e.touch.y1 = ypos1;
+    e.touch.x2 = xpos2;
+    e.touch.y2 = ypos2;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -312,12 +304,11 @@ devices.
 */
 void slTouch2Up(int sceneViewIndex, int xpos1, int ypos1, int xpos2, int ypos2) 
 {
-    SLTouchEvent* e = new SLTouchEvent(SLInputEvent::Touch2Up);
-    e->svIndex = sceneViewIndex;
-    e->x1 = xpos1;
-    e->y1 = ypos1;
-    e->x2 = xpos2;
-    e->y2 = ypos2;
+    SLInputEvent e(SLInputEvent::Touch2Up, sceneViewIndex);
+    e.touch.x1 = xpos1;
+    e.touch.y1 = ypos1;
+    e.touch.x2 = xpos2;
+    e.touch.y2 = ypos2;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -326,10 +317,9 @@ void slTouch2Up(int sceneViewIndex, int xpos1, int ypos1, int xpos2, int ypos2)
 */
 void slMouseWheel(int sceneViewIndex, int pos, SLKey modifier)
 {  
-    SLMouseEvent* e = new SLMouseEvent(SLInputEvent::MouseWheel);
-    e->svIndex = sceneViewIndex;
-    e->y = pos;
-    e->modifier = modifier;
+    SLInputEvent e(SLInputEvent::MouseWheel, sceneViewIndex);
+    e.mouse.y = pos;
+    e.mouse.modifier = modifier;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -338,10 +328,9 @@ void slMouseWheel(int sceneViewIndex, int pos, SLKey modifier)
 */
 void slKeyPress(int sceneViewIndex, SLKey key, SLKey modifier) 
 {  
-    SLKeyEvent* e = new SLKeyEvent(SLInputEvent::KeyDown);
-    e->svIndex = sceneViewIndex;
-    e->key = key;
-    e->modifier = modifier;
+    SLInputEvent e(SLInputEvent::KeyDown, sceneViewIndex);
+    e.key.key = key;
+    e.key.modifier = modifier;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -350,10 +339,9 @@ void slKeyPress(int sceneViewIndex, SLKey key, SLKey modifier)
 */
 void slKeyRelease(int sceneViewIndex, SLKey key, SLKey modifier) 
 {  
-    SLKeyEvent* e = new SLKeyEvent(SLInputEvent::KeyUp);
-    e->svIndex = sceneViewIndex;
-    e->key = key;
-    e->modifier = modifier;
+    SLInputEvent e(SLInputEvent::KeyUp, sceneViewIndex);
+    e.key.key = key;
+    e.key.modifier = modifier;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -363,9 +351,8 @@ void slKeyRelease(int sceneViewIndex, SLKey key, SLKey modifier)
 */
 void slCharInput(int sceneViewIndex, unsigned int character)
 {
-    SLCharInputEvent* e = new SLCharInputEvent();
-    e->svIndex = sceneViewIndex;
-    e->character = character;
+    SLInputEvent e(SLInputEvent::CharacterInput, sceneViewIndex);
+    e.character.character = character;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -374,9 +361,8 @@ void slCharInput(int sceneViewIndex, unsigned int character)
 */
 void slCommand(int sceneViewIndex, SLCommand command) 
 {  
-    SLCommandEvent* e = new SLCommandEvent;
-    e->svIndex = sceneViewIndex;
-    e->cmd = command;
+    SLInputEvent e(SLInputEvent::Command, sceneViewIndex);
+    e.command.cmd = command;
     
     SLInputManager::instance().queueEvent(e);
 }
@@ -394,12 +380,11 @@ which the yaw angle is set to zero by subtracting the average yaw in this time.
 void slRotationPYR(int sceneViewIndex, 
                    float pitchRAD, float yawRAD, float rollRAD)
 {
-    SLRotationEvent* e = new SLRotationEvent(SLInputEvent::DeviceRotationPYR);
-    e->svIndex = sceneViewIndex;
-    e->x = pitchRAD;
-    e->y = yawRAD;
-    e->z = rollRAD;
-    e->w = 3.0f;
+    SLInputEvent e(SLInputEvent::DeviceRotationPYR, sceneViewIndex);
+    e.rotation.x = pitchRAD;
+    e.rotation.y = yawRAD;
+    e.rotation.z = rollRAD;
+    e.rotation.w = 3.0f;
 
     SLInputManager::instance().queueEvent(e);
 }
@@ -409,12 +394,11 @@ void slRotationPYR(int sceneViewIndex,
 void slRotationQUAT(int sceneViewIndex, 
                     float quatX, float quatY, float quatZ, float quatW)
 {
-    SLRotationEvent* e = new SLRotationEvent(SLInputEvent::DeviceRotationPYR);
-    e->svIndex = sceneViewIndex;
-    e->x = quatX;
-    e->y = quatY;
-    e->z = quatZ;
-    e->w = quatW;
+    SLInputEvent e(SLInputEvent::DeviceRotationPYR, sceneViewIndex);
+    e.rotation.x = quatX;
+    e.rotation.y = quatY;
+    e.rotation.z = quatZ;
+    e.rotation.w = quatW;
 
     SLInputManager::instance().queueEvent(e);
 }
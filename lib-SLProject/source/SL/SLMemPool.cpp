@@ -0,0 +1,161 @@
+//#############################################################################
+//  File:      SL/SLMemPool.cpp
+//  Author:    Marcus Hudritsch
+//  Purpose:   Chunked memory pool for the many small scenegraph objects
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLMemPool.h>
+
+//-----------------------------------------------------------------------------
+//! Alignment of the blocks in bytes
+static const size_t SL_MEMPOOL_ALIGN = 16;
+//-----------------------------------------------------------------------------
+//! Returns the list of all pools. It is never deleted like the pools.
+static vector<SLMemPool*>& memPools()
+{
+    static vector<SLMemPool*>* pools = new vector<SLMemPool*>;
+    return *pools;
+}
+static mutex memPoolsMutex;  //!< Guards the list of all pools
+//-----------------------------------------------------------------------------
+SLMemPool::SLMemPool(const SLchar* name, size_t blockSize)
+{
+    assert(blockSize > 0);
+    _name = name;
+    _blockSize = (SL_max(blockSize, sizeof(SLFreeBlock)) + SL_MEMPOOL_ALIGN-1) &
+                 ~(SL_MEMPOOL_ALIGN-1);
+    _blocksPerChunk = SL_max((SLuint)(SL_MEMPOOL_CHUNK_BYTES / _blockSize), 1u);
+    _freeList = nullptr;
+    _numAllocs = 0;
+    _numLive = 0;
+
+    lock_guard<mutex> lock(memPoolsMutex);
+    memPools().push_back(this);
+}
+//-----------------------------------------------------------------------------
+//! Allocates a new chunk and puts all its blocks into the free list
+void SLMemPool::addChunk()
+{
+    SLuchar* chunk = (SLuchar*)::operator new(_blocksPerChunk * _blockSize);
+    _chunks.push_back(chunk);
+
+    // Link the blocks in address order
+    for (SLint i = (SLint)_blocksPerChunk-1; i >= 0; --i)
+    {   SLFreeBlock* block = (SLFreeBlock*)(chunk + i * _blockSize);
+        block->next = _freeList;
+        _freeList = block;
+    }
+}
+//-----------------------------------------------------------------------------
+//! Returns a free block and adds a chunk if no block is free
+void* SLMemPool::allocate()
+{
+    lock_guard<mutex> lock(_mutex);
+    if (!_freeList) addChunk();
+
+    SLFreeBlock* block = _freeList;
+    _freeList = block->next;
+    _numAllocs++;
+    _numLive++;
+    return block;
+}
+//-----------------------------------------------------------------------------
+//! Puts the block back into the free list
+void SLMemPool::deallocate(void* block)
+{
+    assert(block);
+    lock_guard<mutex> lock(_mutex);
+    assert(_numLive > 0);
+    SLFreeBlock* free = (SLFreeBlock*)block;
+    free->next = _freeList;
+    _freeList = free;
+    _numLive--;
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns all chunks without any block in use to the system and returns their
+number. Without any block in use all chunks are freed at once. Otherwise the
+free blocks are counted per chunk and the free list is rebuilt from the blocks
+of the kept chunks.
+*/
+SLuint SLMemPool::release()
+{
+    lock_guard<mutex> lock(_mutex);
+    SLuint numChunks = (SLuint)_chunks.size();
+    if (!numChunks) return 0;
+
+    if (_numLive == 0)
+    {   for (auto chunk : _chunks) ::operator delete(chunk);
+        _chunks.clear();
+        _freeList = nullptr;
+        return numChunks;
+    }
+
+    // Count the free blocks of each chunk
+    std::sort(_chunks.begin(), _chunks.end());
+    auto chunkOf = [&](SLFreeBlock* block)
+    {   auto c = std::upper_bound(_chunks.begin(), _chunks.end(), (SLuchar*)block);
+        return (SLuint)(c - _chunks.begin()) - 1;
+    };
+    SLVuint numFree(numChunks, 0);
+    for (SLFreeBlock* b = _freeList; b; b = b->next)
+        numFree[chunkOf(b)]++;
+
+    // Keep the free blocks of the chunks in use
+    SLFreeBlock* kept = nullptr;
+    for (SLFreeBlock* b = _freeList; b; )
+    {   SLFreeBlock* next = b->next;
+        if (numFree[chunkOf(b)] < _blocksPerChunk)
+        {   b->next = kept;
+            kept = b;
+        }
+        b = next;
+    }
+    _freeList = kept;
+
+    // Delete the empty chunks
+    SLuint numReleased = 0;
+    vector<SLuchar*> chunks;
+    for (SLuint c = 0; c < numChunks; ++c)
+    {   if (numFree[c] == _blocksPerChunk)
+        {   ::operator delete(_chunks[c]);
+            numReleased++;
+        } else chunks.push_back(_chunks[c]);
+    }
+    _chunks.swap(chunks);
+    return numReleased;
+}
+//-----------------------------------------------------------------------------
+//! Releases the empty chunks of all pools and returns their NO.
+SLuint SLMemPool::releaseAll()
+{
+    lock_guard<mutex> lock(memPoolsMutex);
+    SLuint numReleased = 0;
+    for (auto pool : memPools())
+        numReleased += pool->release();
+    return numReleased;
+}
+//-----------------------------------------------------------------------------
+//! Sums up the allocations, the blocks in use and the chunk bytes of all pools
+void SLMemPool::statsAll(SLuint& numAllocs, SLuint& numLive, SLuint& numBytes)
+{
+    numAllocs = numLive = numBytes = 0;
+    lock_guard<mutex> lock(memPoolsMutex);
+    for (auto pool : memPools())
+    {   lock_guard<mutex> poolLock(pool->_mutex);
+        numAllocs += pool->_numAllocs;
+        numLive   += pool->_numLive;
+        numBytes  += pool->numBytes();
+    }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,580 @@
+//#############################################################################
+//  File:      SL/SLMeshCache.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLMeshCache.h>
+#include <SLScene.h>
+#include <SLMaterial.h>
+#include <SLGLTexture.h>
+#include <type_traits>
+
+#ifndef SL_OS_WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//-----------------------------------------------------------------------------
+//! Default cache directory. If empty the cache file is beside the model file.
+SLstring SLMeshCache::cacheDir = "";
+//-----------------------------------------------------------------------------
+//! Magic number at the beginning of every cache file ("SLMC")
+static const SLuint SL_MESHCACHE_MAGIC = 0x434D4C53;
+//-----------------------------------------------------------------------------
+//! FNV-1a 64 bit hash of a memory block continuing from hash h
+static SLuint64 fnv1a64(const SLuchar* data, size_t size, SLuint64 h)
+{
+    for (size_t i=0; i<size; ++i)
+    {   h ^= data[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+//-----------------------------------------------------------------------------
+//! Sequential binary writer into a std::ofstream
+class SLMeshCacheWriter
+{
+    public:
+        SLMeshCacheWriter(ofstream& os) : _os(os) {}
+
+        template<typename T>
+        void value(const T& v) {_os.write((const char*)&v, sizeof(T));}
+
+        void string(const SLstring& s)
+        {   value((SLuint)s.size());
+            _os.write(s.c_str(), s.size());
+        }
+
+        template<typename T>
+        void vector(const std::vector<T>& v)
+        {   value((SLuint)v.size());
+            if (v.size()) _os.write((const char*)&v[0], v.size()*sizeof(T));
+        }
+
+    private:
+        ofstream& _os;
+};
+//-----------------------------------------------------------------------------
+//! Sequential binary reader on a memory block (e.g. a memory mapped file)
+/*! Scalars and vectors of scalars are copied with memcpy. The SLVec and SLMat4
+types are not trivially copyable (they have user defined assignments) and are
+copied component by component from the same packed layout the writer stores.
+*/
+class SLMeshCacheReader
+{
+    public:
+        SLMeshCacheReader(const SLuchar* data, size_t size) :
+            _p(data), _end(data+size), _ok(true) {}
+
+        SLbool ok() const {return _ok;}
+
+        template<typename T>
+        T value()
+        {   T v = T();
+            if (fits(sizeof(T)))
+            {   copy(v, _p);
+                _p += sizeof(T);
+            }
+            return v;
+        }
+
+        SLstring string()
+        {   SLuint n = value<SLuint>();
+            if (!fits(n)) return SLstring();
+            SLstring s((const char*)_p, n);
+            _p += n;
+            return s;
+        }
+
+        template<typename T>
+        void vector(std::vector<T>& v)
+        {   SLuint n = value<SLuint>();
+            if (!fits((size_t)n*sizeof(T))) return;
+            v.resize(n);
+            if (n) copyN(&v[0], _p, n, std::is_trivially_copyable<T>());
+            _p += n*sizeof(T);
+        }
+
+    private:
+        //! Bulk copy of trivially copyable elements
+        template<typename T>
+        static void copyN(T* dst, const SLuchar* src, SLuint n, std::true_type)
+        {   memcpy(dst, src, n*sizeof(T));
+        }
+
+        //! Element wise copy of the SLVec & SLMat4 types
+        template<typename T>
+        static void copyN(T* dst, const SLuchar* src, SLuint n, std::false_type)
+        {   for (SLuint i=0; i<n; ++i, src += sizeof(T))
+                copy(dst[i], src);
+        }
+
+        template<typename T>
+        static void copy(T& v, const SLuchar* src)
+        {   static_assert(std::is_trivially_copyable<T>::value,
+                          "SLMeshCacheReader: type needs a field wise copy");
+            memcpy(&v, src, sizeof(T));
+        }
+
+        template<typename T>
+        static void copy(SLVec2<T>& v, const SLuchar* src)
+        {   static_assert(sizeof(v) == 2*sizeof(T), "SLVec2 is not packed");
+            copy(v.x, src);
+            copy(v.y, src + sizeof(T));
+        }
+
+        template<typename T>
+        static void copy(SLVec3<T>& v, const SLuchar* src)
+        {   static_assert(sizeof(v) == 3*sizeof(T), "SLVec3 is not packed");
+            copy(v.x, src);
+            copy(v.y, src + sizeof(T));
+            copy(v.z, src + 2*sizeof(T));
+        }
+
+        template<typename T>
+        static void copy(SLVec4<T>& v, const SLuchar* src)
+        {   static_assert(sizeof(v) == 4*sizeof(T), "SLVec4 is not packed");
+            copy(v.x, src);
+            copy(v.y, src + sizeof(T));
+            copy(v.z, src + 2*sizeof(T));
+            copy(v.w, src + 3*sizeof(T));
+        }
+
+        template<typename T>
+        static void copy(SLMat4<T>& m, const SLuchar* src)
+        {   static_assert(sizeof(m) == 16*sizeof(T), "SLMat4 is not packed");
+            T a[16];
+            memcpy(a, src, sizeof(a));
+            m.setMatrix(a);
+        }
+
+    private:
+        SLbool fits(size_t n)
+        {   if (!_ok || (size_t)(_end-_p) < n) _ok = false;
+            return _ok;
+        }
+
+        const SLuchar*  _p;     //!< current read position
+        const SLuchar*  _end;   //!< end of the memory block
+        SLbool          _ok;    //!< false after a read past the end
+};
+//-----------------------------------------------------------------------------
+//! The constructor only stores the parameters. The key is built in init.
+SLMeshCache::SLMeshCache(SLstring modelFile,
+                         SLuint importFlags,
+                         SLbool loadMeshesOnly)
+{
+    _modelFile  = modelFile;
+    _flags      = importFlags;
+    _meshesOnly = loadMeshesOnly;
+    _key        = 0;
+}
+//-----------------------------------------------------------------------------
+/*! Builds once the cache key out of the model file content, the import flags,
+the loadMeshesOnly flag and the format version. The key is also part of the 
+cache file name.
+*/
+void SLMeshCache::init()
+{
+    if (!_cacheFile.empty()) return;
+
+    SLuint64 h = hashFile(_modelFile);
+    SLuint params[3] = {_flags, (SLuint)_meshesOnly, SL_MESHCACHE_VERSION};
+    _key = fnv1a64((const SLuchar*)params, sizeof(params), h);
+
+    SLchar keyStr[20];
+    sprintf(keyStr, "%016llx", (unsigned long long)_key);
+
+    SLstring dir = cacheDir.empty() ? SLUtils::getPath(_modelFile) : cacheDir;
+    _cacheFile = dir + SLUtils::getFileName(_modelFile) + "." + keyStr + ".slmc";
+}
+//-----------------------------------------------------------------------------
+//! Returns the FNV-1a hash over the full content of a file
+SLuint64 SLMeshCache::hashFile(const SLstring& pathFilename)
+{
+    SLuint64 h = 0xcbf29ce484222325ULL;
+    ifstream is(pathFilename.c_str(), ios::binary);
+    if (!is.is_open()) return h;
+
+    SLVuchar buffer(1 << 20);
+    while (is)
+    {   is.read((char*)&buffer[0], buffer.size());
+        h = fnv1a64(&buffer[0], (size_t)is.gcount(), h);
+    }
+    return h;
+}
+//-----------------------------------------------------------------------------
+//! Returns true if the cache file for the model and flags exists
+SLbool SLMeshCache::exists()
+{
+    init();
+    return SLFileSystem::fileExists(_cacheFile);
+}
+//-----------------------------------------------------------------------------
+/*! SLMeshCache::save writes the node tree below root with all meshes of the
+meshes vector and their materials into the cache file. lodIndices and
+lodErrors hold per mesh the LOD index sets of SLMesh::simplifyLODs. They can
+be empty if no LODs were generated. Returns false if the file can't be
+written or if a mesh is bound to a skeleton.
+*/
+SLbool SLMeshCache::save(SLNode* root, SLVMesh& meshes,
+                         const vector<vector<SLVuint>>& lodIndices,
+                         const vector<SLVfloat>& lodErrors)
+{
+    if (!root) return false;
+    init();
+
+    // Collect unique materials and mesh indices
+    SLVMaterial materials;
+    std::map<SLMaterial*, SLuint> matIndex;
+    std::map<SLMesh*, SLuint> meshIndex;
+    for (SLuint i=0; i<meshes.size(); ++i)
+    {   if (meshes[i]->skeleton()) return false;
+        meshIndex[meshes[i]] = i;
+        if (meshes[i]->mat && !matIndex.count(meshes[i]->mat))
+        {   matIndex[meshes[i]->mat] = (SLuint)materials.size();
+            materials.push_back(meshes[i]->mat);
+        }
+    }
+
+    // Collect nodes in depth first order with their parent index
+    SLVNode nodes;
+    SLVint  parents;
+    std::vector<pair<SLNode*,SLint>> stack;
+    stack.push_back(make_pair(root, -1));
+    while (!stack.empty())
+    {   SLNode* node = stack.back().first;
+        parents.push_back(stack.back().second);
+        stack.pop_back();
+        SLint index = (SLint)nodes.size();
+        nodes.push_back(node);
+        for (auto it = node->children().rbegin(); it != node->children().rend(); ++it)
+            stack.push_back(make_pair(*it, index));
+    }
+
+    ofstream os(_cacheFile.c_str(), ios::binary);
+    if (!os.is_open())
+    {   SL_LOG("SLMeshCache: Failed to write %s\n", _cacheFile.c_str());
+        return false;
+    }
+
+    SLMeshCacheWriter w(os);
+
+    // Header
+    w.value(SL_MESHCACHE_MAGIC);
+    w.value((SLuint)SL_MESHCACHE_VERSION);
+    w.value(_key);
+    w.value((SLuint)materials.size());
+    w.value((SLuint)meshes.size());
+    w.value((SLuint)nodes.size());
+
+    // Materials with texture file names
+    for (auto mat : materials)
+    {   w.string(mat->name());
+        w.value(mat->ambient());
+        w.value(mat->diffuse());
+        w.value(mat->specular());
+        w.value(mat->emission());
+        w.value(mat->shininess());
+        w.value(mat->kr());
+        w.value(mat->kt());
+        w.value(mat->kn());
+        w.value((SLuint)mat->textures().size());
+        for (auto tex : mat->textures())
+        {   w.string(tex->name());
+            w.value((SLint)tex->texType());
+        }
+    }
+
+    // Meshes with all vertex attributes and indices
+    for (SLuint m=0; m<meshes.size(); ++m)
+    {   SLMesh* mesh = meshes[m];
+        w.string(mesh->name());
+        w.value(mesh->mat ? (SLint)matIndex[mesh->mat] : (SLint)-1);
+        w.value((SLint)mesh->primitive());
+        w.vector(mesh->P);
+        w.vector(mesh->N);
+        w.vector(mesh->Tc);
+        w.vector(mesh->C);
+        w.vector(mesh->T);
+        w.vector(mesh->Ji);
+        w.vector(mesh->Jw);
+        w.vector(mesh->I16);
+        w.vector(mesh->I32);
+
+        // LOD index sets in the vertex numbering of the mesh
+        SLbool hasLODs = m < lodIndices.size() && m < lodErrors.size();
+        SLuint numLODs = hasLODs ? (SLuint)lodIndices[m].size() : 0;
+        w.value(numLODs);
+        for (SLuint l=0; l<numLODs; ++l)
+            w.vector(lodIndices[m][l]);
+        if (numLODs) w.vector(lodErrors[m]);
+    }
+
+    // Nodes with parent index, local transform and mesh indices
+    for (SLuint i=0; i<nodes.size(); ++i)
+    {   w.string(nodes[i]->name());
+        w.value(parents[i]);
+        w.value(nodes[i]->om());
+        SLVuint meshIDs;
+        for (auto mesh : nodes[i]->meshes())
+            if (meshIndex.count(mesh))
+                meshIDs.push_back(meshIndex[mesh]);
+        w.vector(meshIDs);
+    }
+
+    os.close();
+    SL_LOG("SLMeshCache: Saved %s\n", _cacheFile.c_str());
+    return true;
+}
+//-----------------------------------------------------------------------------
+//! Texture of a material as read from a cache file
+struct SLMeshCacheTex
+{
+    SLstring        file;       //!< texture file name
+    SLTextureType   type;       //!< texture type
+};
+//-----------------------------------------------------------------------------
+//! Material as read from a cache file
+struct SLMeshCacheMat
+{
+    SLstring        name;
+    SLCol4f         ambient, diffuse, specular, emission;
+    SLfloat         shininess, kr, kt, kn;
+    vector<SLMeshCacheTex> textures;
+};
+//-----------------------------------------------------------------------------
+//! Mesh data as read from a cache file
+struct SLMeshCacheMesh
+{
+    SLstring        name;
+    SLint           matID;
+    SLint           primitive;
+    SLVVec3f        P, N;
+    SLVVec2f        Tc;
+    SLVCol4f        C;
+    SLVVec4f        T, Ji, Jw;
+    SLVushort       I16;
+    SLVuint         I32;
+    vector<SLVuint> lodIndices;
+    SLVfloat        lodErrors;
+};
+//-----------------------------------------------------------------------------
+//! Node as read from a cache file
+struct SLMeshCacheNode
+{
+    SLstring        name;
+    SLint           parent;     //!< index of the parent node or -1
+    SLMat4f         om;         //!< object matrix
+    SLVuint         meshIDs;    //!< indices into the meshes
+};
+//-----------------------------------------------------------------------------
+/*! SLMeshCache::load memory maps the cache file and creates the materials,
+meshes and nodes. The meshes are added to the meshes vector. Returns the root
+node or nullptr if the file doesn't exist or is invalid. A corrupt or
+truncated file leaves the scene untouched.
+*/
+SLNode* SLMeshCache::load(SLVMesh& meshes)
+{
+    init();
+
+    // Map the file into memory
+    const SLuchar* data = nullptr;
+    size_t size = 0;
+
+    #ifdef SL_OS_WINDOWS
+    SLVuchar buffer;
+    ifstream is(_cacheFile.c_str(), ios::binary|ios::ate);
+    if (!is.is_open()) return nullptr;
+    size = (size_t)is.tellg();
+    buffer.resize(size);
+    is.seekg(0);
+    if (size) is.read((char*)&buffer[0], size);
+    data = size ? &buffer[0] : nullptr;
+    #else
+    int fd = open(_cacheFile.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {   size = (size_t)st.st_size;
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        data = (map == MAP_FAILED) ? nullptr : (const SLuchar*)map;
+    }
+    close(fd);
+    #endif
+
+    if (!data) return nullptr;
+
+    SLMeshCacheReader r(data, size);
+    SLNode* root = nullptr;
+
+    // Check header
+    SLuint magic    = r.value<SLuint>();
+    SLuint version  = r.value<SLuint>();
+    SLuint64 key    = r.value<SLuint64>();
+    SLuint numMats  = r.value<SLuint>();
+    SLuint numMeshes= r.value<SLuint>();
+    SLuint numNodes = r.value<SLuint>();
+
+    if (r.ok() &&
+        magic == SL_MESHCACHE_MAGIC &&
+        version == SL_MESHCACHE_VERSION &&
+        key == _key)
+    {
+        // The whole file is read into local containers first. Nothing is
+        // created in the scene before the file is known to be complete.
+        // The counts of a corrupt header may be huge, so the containers
+        // only grow with the data that is really read.
+        vector<SLMeshCacheMat> mats;
+        for (SLuint i=0; i<numMats && r.ok(); ++i)
+        {   mats.push_back(SLMeshCacheMat());
+            SLMeshCacheMat& mat = mats.back();
+            mat.name      = r.string();
+            mat.ambient   = r.value<SLCol4f>();
+            mat.diffuse   = r.value<SLCol4f>();
+            mat.specular  = r.value<SLCol4f>();
+            mat.emission  = r.value<SLCol4f>();
+            mat.shininess = r.value<SLfloat>();
+            mat.kr        = r.value<SLfloat>();
+            mat.kt        = r.value<SLfloat>();
+            mat.kn        = r.value<SLfloat>();
+            SLuint numTex = r.value<SLuint>();
+            for (SLuint t=0; t<numTex && r.ok(); ++t)
+            {   SLMeshCacheTex tex;
+                tex.file = r.string();
+                tex.type = (SLTextureType)r.value<SLint>();
+                mat.textures.push_back(tex);
+            }
+        }
+
+        vector<SLMeshCacheMesh> cachedMeshes;
+        for (SLuint i=0; i<numMeshes && r.ok(); ++i)
+        {   cachedMeshes.push_back(SLMeshCacheMesh());
+            SLMeshCacheMesh& m = cachedMeshes.back();
+            m.name      = r.string();
+            m.matID     = r.value<SLint>();
+            m.primitive = r.value<SLint>();
+            r.vector(m.P);
+            r.vector(m.N);
+            r.vector(m.Tc);
+            r.vector(m.C);
+            r.vector(m.T);
+            r.vector(m.Ji);
+            r.vector(m.Jw);
+            r.vector(m.I16);
+            r.vector(m.I32);
+            SLuint numLODs = r.value<SLuint>();
+            if (numLODs && r.ok())
+            {   for (SLuint l=0; l<numLODs && r.ok(); ++l)
+                {   m.lodIndices.push_back(SLVuint());
+                    r.vector(m.lodIndices.back());
+                }
+                r.vector(m.lodErrors);
+                if (m.lodErrors.size() != numLODs)
+                {   m.lodIndices.clear();
+                    m.lodErrors.clear();
+                }
+            }
+        }
+
+        vector<SLMeshCacheNode> cachedNodes;
+        for (SLuint i=0; i<numNodes && r.ok(); ++i)
+        {   cachedNodes.push_back(SLMeshCacheNode());
+            SLMeshCacheNode& n = cachedNodes.back();
+            n.name   = r.string();
+            n.parent = r.value<SLint>();
+            n.om     = r.value<SLMat4f>();
+            r.vector(n.meshIDs);
+        }
+
+        if (r.ok() && cachedNodes.size())
+        {
+            // Materials. They are added to SLScene::_materials in the ctor
+            SLVMaterial materials;
+            SLVGLTexture& sceneTex = SLScene::current->textures();
+            for (auto& m : mats)
+            {   SLMaterial* mat = new SLMaterial(m.name.c_str());
+                mat->ambient(m.ambient);
+                mat->diffuse(m.diffuse);
+                mat->specular(m.specular);
+                mat->emission(m.emission);
+                mat->shininess(m.shininess);
+                mat->kr(m.kr);
+                mat->kt(m.kt);
+                mat->kn(m.kn);
+                for (auto& t : m.textures)
+                {   SLGLTexture* texture = nullptr;
+                    for (auto tex : sceneTex)
+                        if (tex->name() == t.file) {texture = tex; break;}
+                    if (!texture)
+                        texture = new SLGLTexture(t.file,
+                                                  GL_LINEAR_MIPMAP_LINEAR,
+                                                  GL_LINEAR,
+                                                  t.type);
+                    mat->textures().push_back(texture);
+                }
+                materials.push_back(mat);
+            }
+
+            // Meshes. They are added to SLScene::_meshes in the ctor
+            SLVMesh loadedMeshes;
+            for (auto& m : cachedMeshes)
+            {   SLMesh* mesh = new SLMesh(m.name);
+                mesh->mat = (m.matID >= 0 && m.matID < (SLint)materials.size()) ?
+                            materials[m.matID] : nullptr;
+                mesh->primitive((SLGLPrimitiveType)m.primitive);
+                mesh->P.swap(m.P);
+                mesh->N.swap(m.N);
+                mesh->Tc.swap(m.Tc);
+                mesh->C.swap(m.C);
+                mesh->T.swap(m.T);
+                mesh->Ji.swap(m.Ji);
+                mesh->Jw.swap(m.Jw);
+                mesh->I16.swap(m.I16);
+                mesh->I32.swap(m.I32);
+
+                // The LOD index sets share the vertices of the mesh
+                if (m.lodIndices.size())
+                    mesh->addLODs(m.lodIndices, m.lodErrors);
+                loadedMeshes.push_back(mesh);
+            }
+
+            // Nodes in depth first order
+            SLVNode nodes;
+            for (auto& n : cachedNodes)
+            {   SLNode* node = new SLNode(n.name);
+                node->om(n.om);
+                for (auto id : n.meshIDs)
+                    if (id < loadedMeshes.size())
+                        node->addMesh(loadedMeshes[id]);
+                if (n.parent >= 0 && n.parent < (SLint)nodes.size())
+                    nodes[n.parent]->addChild(node);
+                nodes.push_back(node);
+            }
+
+            root = nodes[0];
+            meshes.insert(meshes.end(), loadedMeshes.begin(), loadedMeshes.end());
+        } else
+            SL_LOG("SLMeshCache: Corrupt cache file %s\n", _cacheFile.c_str());
+    }
+
+    #ifndef SL_OS_WINDOWS
+    munmap((void*)data, size);
+    #endif
+
+    if (root) SL_LOG("SLMeshCache: Loaded %s\n", _cacheFile.c_str());
+    return root;
+}
+//-----------------------------------------------------------------------------
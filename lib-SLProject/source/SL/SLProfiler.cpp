@@ -0,0 +1,210 @@
+//#############################################################################
+//  File:      SL/SLProfiler.cpp
+//  Author:    Marcus Hudritsch
+//  Purpose:   Scoped CPU profiler with per thread ring buffers and Chrome
+//             trace export
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLProfiler.h>
+#include <mutex>
+
+//-----------------------------------------------------------------------------
+atomic<bool> SLProfiler::_isEnabled(false);
+SLint64      SLProfiler::_startNS = 0;
+//-----------------------------------------------------------------------------
+//! Event ring buffer of one thread. Only the owning thread writes into it.
+struct SLProfileThread
+{   SLProfileThread() : numEvents(0), inUse(true), name(nullptr)
+    {   events.resize(SL_PROFILE_RING_SIZE);
+    }
+    vector<SLProfileEvent> events;  //!< Ring buffer of events
+    atomic<SLuint64> numEvents;     //!< NO. of events ever written
+    SLbool          inUse;          //!< Flag if a running thread owns it
+    const SLchar*   name;           //!< Name of the thread (string literal)
+};
+//-----------------------------------------------------------------------------
+static mutex                     profileMutex;   //!< Guards the thread list
+static vector<SLProfileThread*>  profileThreads; //!< Buffers of all threads
+//-----------------------------------------------------------------------------
+//! Thread local handle that releases the buffer when its thread ends
+struct SLProfileThreadHandle
+{   SLProfileThreadHandle() : thread(nullptr) {}
+   ~SLProfileThreadHandle()
+    {   if (thread)
+        {   lock_guard<mutex> lock(profileMutex);
+            thread->inUse = false;
+        }
+    }
+    SLProfileThread* thread;
+};
+static thread_local SLProfileThreadHandle profileHandle;
+//-----------------------------------------------------------------------------
+//! Deletes the buffers at program exit
+struct SLProfileThreadDeleter
+{  ~SLProfileThreadDeleter()
+    {   for (auto t : profileThreads) delete t;
+        profileThreads.clear();
+    }
+};
+static SLProfileThreadDeleter profileDeleter;
+//-----------------------------------------------------------------------------
+/*!
+Returns the buffer of the calling thread. At the first call of a thread a
+released buffer of an ended thread is reused or a new one is created.
+*/
+static SLProfileThread* profileThread()
+{
+    if (profileHandle.thread) return profileHandle.thread;
+
+    lock_guard<mutex> lock(profileMutex);
+    for (auto t : profileThreads)
+    {   if (!t->inUse)
+        {   t->inUse = true;
+            t->name = nullptr;
+            profileHandle.thread = t;
+            return t;
+        }
+    }
+    profileHandle.thread = new SLProfileThread;
+    profileThreads.push_back(profileHandle.thread);
+    return profileHandle.thread;
+}
+//-----------------------------------------------------------------------------
+//! Appends the string with the JSON special characters escaped
+static void profileEscape(SLstring& out, const SLchar* str)
+{
+    for (const SLchar* c = str; *c; ++c)
+    {   if (*c == '"' || *c == '\\') out += '\\';
+        if ((SLuchar)*c >= 0x20) out += *c;
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+SLProfiler::start starts the recording. Only events that start after this call
+get exported. The calling thread is named "Main".
+*/
+void SLProfiler::start()
+{
+    _startNS = nowNS();
+    _isEnabled.store(true);
+    threadName("Main");
+}
+//-----------------------------------------------------------------------------
+//! SLProfiler::stop stops the recording. Running scopes still get recorded.
+void SLProfiler::stop()
+{
+    _isEnabled.store(false);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLProfiler::threadName sets the name of the track of the calling thread in the
+trace. It is ignored if the profiler is not enabled so that no buffer gets
+allocated for threads that are never measured.
+*/
+void SLProfiler::threadName(const SLchar* name)
+{
+    if (!isEnabled()) return;
+    SLProfileThread* t = profileThread();
+    lock_guard<mutex> lock(profileMutex);
+    t->name = name;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLProfiler::record writes an event into the ring buffer of the calling thread.
+The slot is written before the event counter gets published with release
+semantics, so no lock is needed. If the ring is full the oldest events get
+overwritten.
+*/
+void SLProfiler::record(const SLchar* name, SLint64 startNS, SLint64 endNS)
+{
+    SLProfileThread* t = profileThread();
+    SLuint64 i = t->numEvents.load(memory_order_relaxed);
+    SLProfileEvent& e = t->events[i & (SL_PROFILE_RING_SIZE-1)];
+    e.name = name;
+    e.startNS = startNS;
+    e.endNS = endNS;
+    t->numEvents.store(i+1, memory_order_release);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLProfiler::exportChromeTrace writes the events of all threads recorded since
+the last start as complete events ("ph":"X") in the Chrome Trace Event Format.
+Each thread buffer is one track. The export can be called while recording:
+Events that might have been overwritten during the copy get dropped.
+*/
+SLbool SLProfiler::exportChromeTrace(const SLstring& filename)
+{
+    FILE* fp = fopen(filename.c_str(), "w");
+    if (!fp)
+    {   SL_LOG("SLProfiler::exportChromeTrace: Can't open %s\n", filename.c_str());
+        return false;
+    }
+
+    lock_guard<mutex> lock(profileMutex);
+    vector<SLProfileEvent> events;
+    SLstring json;
+    json.reserve(1024*1024);
+    json += "{\"traceEvents\":[\n";
+    SLbool isFirst = true;
+    SLchar buf[256];
+    SLuint numExported = 0;
+
+    for (SLuint tid=0; tid<profileThreads.size(); ++tid)
+    {   SLProfileThread* t = profileThreads[tid];
+
+        // Copy the valid part of the ring
+        SLuint64 n1 = t->numEvents.load(memory_order_acquire);
+        SLuint64 first = n1 > SL_PROFILE_RING_SIZE ? n1 - SL_PROFILE_RING_SIZE : 0;
+        events.clear();
+        for (SLuint64 i=first; i<n1; ++i)
+            events.push_back(t->events[i & (SL_PROFILE_RING_SIZE-1)]);
+
+        // The writer may have overwritten the oldest slots in the meantime
+        SLuint64 n2 = t->numEvents.load(memory_order_acquire);
+        SLuint64 valid = n2 >= SL_PROFILE_RING_SIZE ? n2 - SL_PROFILE_RING_SIZE + 1 : 0;
+        SLuint64 skip = valid > first ? valid - first : 0;
+
+        // Thread name as meta data event
+        sprintf(buf, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                isFirst ? "" : ",\n", tid);
+        json += buf;
+        if (t->name) profileEscape(json, t->name);
+        else
+        {   sprintf(buf, "Thread %u", tid);
+            json += buf;
+        }
+        json += "\"}}";
+        isFirst = false;
+
+        for (SLuint64 i=skip; i<events.size(); ++i)
+        {   SLProfileEvent& e = events[(size_t)i];
+            if (e.startNS < _startNS) continue;
+            json += ",\n{\"name\":\"";
+            profileEscape(json, e.name);
+            sprintf(buf, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    tid,
+                    (double)(e.startNS - _startNS) * 0.001,
+                    (double)(e.endNS - e.startNS) * 0.001);
+            json += buf;
+            numExported++;
+        }
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    fwrite(json.c_str(), 1, json.length(), fp);
+    fclose(fp);
+
+    SL_LOG("Profile with %u events saved: %s\n", numExported, filename.c_str());
+    return true;
+}
+//-----------------------------------------------------------------------------
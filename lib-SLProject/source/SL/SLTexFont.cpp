@@ -169,7 +169,7 @@ void SLTexFont::create(const SLuchar *bmp, SLint bmpW, SLint bmpH)
 max. width is passed text is first wrapped into multiple lines. For mulitline
 text the line height is calculate as the font height * lineHeightFactor.
 */
-SLVec2f SLTexFont::calcTextSize(SLstring text,
+SLVec2f SLTexFont::calcTextSize(const SLstring& text,
                                 SLfloat  maxWidth,
                                 SLfloat  lineHeightFactor)
 {     
@@ -178,10 +178,13 @@ SLVec2f SLTexFont::calcTextSize(SLstring text,
     if (maxWidth > 0.0f)
     {  
         SLfloat maxX = FLT_MIN;
-        SLVstring lines = wrapTextToLines(text, maxWidth);
-        for (SLuint i=0; i<lines.size(); ++i)
-        {   SLVec2f size = calcTextSize(lines[i]);
-            if (size.x > maxX) maxX = size.x;
+        SLVTexFontLine lines;
+        wrapTextToLines(text, maxWidth, lines);
+        for (auto& line : lines)
+        {   SLfloat lineX = (SLfloat)line.numBlanks * chars[' '].width;
+            for (SLuint i=line.first; i<line.last; ++i)
+                lineX += chars[(SLuchar)text[i]].width;
+            if (lineX > maxX) maxX = lineX;
         }
         size.x = maxX;
         size.y = (SLfloat)(lines.size()-1) * (SLfloat)charsHeight * lineHeightFactor;
@@ -205,14 +208,33 @@ The sum of all characters in lines must be equal to the length of the input text
 SLVstring SLTexFont::wrapTextToLines(SLstring text, // text to wrap
                                      SLfloat  maxW) // max. width in pixels               
 {  
-    SLVstring   lines;
-    SLint       numLines = 1;
+    SLVTexFontLine ranges;
+    wrapTextToLines(text, maxW, ranges);
+
+    SLVstring lines;
+    for (auto& r : ranges)
+        lines.push_back(text.substr(r.first, r.last-r.first) + 
+                        SLstring(r.numBlanks, ' '));
+    return lines;
+}
+//-----------------------------------------------------------------------------
+/*! 
+Wraps the text to a max. with of maxW and returns the character ranges of the
+lines. A line break (\\n) is replaced by 2 blanks so that the sum of all
+characters in lines is equal to the length of the input text. This version
+does not allocate any strings and is used by SLTextBatch.
+*/
+void SLTexFont::wrapTextToLines(const SLstring& text,   // text to wrap
+                                SLfloat maxW,           // max. width in pixels
+                                SLVTexFontLine& lines)  // line ranges
+{  
     SLfloat     curX = 0.0f;
-    SLfloat     maxX = FLT_MIN;
     SLfloat     xBlank = 0.0f;
     SLuint      iBlank = 0;
     SLuint      iLineStart = 0;
     SLuint      len = (SLuint)text.length();
+
+    lines.clear();
    
     // Loop through each character of text
     for (SLuint i=0; i<len; ++i)
@@ -220,9 +242,7 @@ SLVstring SLTexFont::wrapTextToLines(SLstring text, // text to wrap
       
         if (c=='\\' && i<len-1 && text[i+1]=='n')
         {   i++;
-            if (curX > maxX) maxX = curX;
-            lines.push_back(text.substr(iLineStart, i-iLineStart-1)+"  ");
-            numLines++;
+            lines.push_back({iLineStart, i-1, 2});
             iLineStart = i+1;
             curX = 0.0f;
         }
@@ -240,25 +260,18 @@ SLVstring SLTexFont::wrapTextToLines(SLstring text, // text to wrap
             if (curX > maxW) 
             {  // wrap at last blank
                 if (xBlank > 0.0f)
-                {   // keep greatest line width
-                    if (xBlank > maxX) maxX = xBlank;
-                    curX = curX - xBlank - chars[' '].width;
-                    lines.push_back(text.substr(iLineStart, iBlank-iLineStart+1));
+                {   curX = curX - xBlank - chars[' '].width;
+                    lines.push_back({iLineStart, iBlank+1, 0});
                     iLineStart = iBlank + 1;
                 } else // wrap in the word
-                {   if (curX - chars[c].width > maxX) 
-                        maxX = curX - chars[c].width;
-                    lines.push_back(text.substr(iLineStart, i-iLineStart));
+                {   lines.push_back({iLineStart, i, 0});
                     curX = chars[c].width;
                     iLineStart = i+1;
                 }
-                numLines++;
             }
         }
     }
-    SLstring newLine = text.substr(iLineStart, len-iLineStart);
-    lines.push_back(newLine);
-    return lines;
+    lines.push_back({iLineStart, len, 0});
 }
 //-----------------------------------------------------------------------------
 /*! 
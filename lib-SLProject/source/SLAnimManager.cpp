@@ -37,6 +37,8 @@ void SLAnimManager::clear()
 
     for (auto skeleton : _skeletons) delete skeleton;
     _skeletons.clear();
+
+    _poses.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -92,6 +94,7 @@ SLAnimPlayback* SLAnimManager::getNodeAnimPlayack(const SLstring& name)
 //! Advances the time of all enabled animation plays.
 SLbool SLAnimManager::update(SLfloat elapsedTimeSec)
 {
+    SL_PROFILE_SCOPE("SLAnimManager::update");
     SLbool updated = false;
 
     // advance time for node animations and apply them
@@ -120,6 +123,113 @@ SLbool SLAnimManager::update(SLfloat elapsedTimeSec)
     return updated;
 }
 
+//-----------------------------------------------------------------------------
+/*! Decomposes an object matrix without shear into translation, rotation and
+scale. Returns false for a degenerated matrix with a zero scale.
+*/
+static SLbool decomposeTRS(const SLMat4f& om, 
+                           SLVec3f& t, SLQuat4f& q, SLVec3f& s)
+{
+    SLMat3f r(om.mat3());
+    t = om.translation();
+    s.set(om.axisX().length(), om.axisY().length(), om.axisZ().length());
+    if (s.x < FLT_EPSILON || s.y < FLT_EPSILON || s.z < FLT_EPSILON)
+        return false;
+    if (r.det() < 0.0f) s.x = -s.x; // mirroring
+    for (SLint row=0; row<3; ++row)
+    {   r(row,0) /= s.x;
+        r(row,1) /= s.y;
+        r(row,2) /= s.z;
+    }
+    q.fromMat3(r);
+    return true;
+}
+//-----------------------------------------------------------------------------
+/*! Saves the object matrices of the nodes of all enabled node animations and
+of all skeleton joints before the last animation step of a frame.
+*/
+void SLAnimManager::storePreviousPose()
+{
+    _poses.clear();
+    SLAnimPose pose;
+    pose.isMoving = false;
+
+    pose.skeleton = nullptr;
+    for (auto it : _nodeAnimPlaybacks)
+    {   if (it.second->enabled())
+        {   for (auto track : it.second->parentAnimation()->nodeAnimTracks())
+            {   pose.node = track.second->animatedNode();
+                if (pose.node)
+                {   pose.prevOM = pose.currOM = pose.node->om();
+                    _poses.push_back(pose);
+                }
+            }
+        }
+    }
+
+    for (auto skeleton : _skeletons)
+    {   pose.skeleton = skeleton;
+        for (auto joint : skeleton->joints())
+        {   pose.node = joint;
+            pose.prevOM = pose.currOM = joint->om();
+            _poses.push_back(pose);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+/*! Sets the object matrices of all animated nodes that moved in the last step
+to the interpolation between the previous and the current pose. Translation
+and scale are interpolated linearly and the rotation spherically. Skeletons
+with moving joints are flagged as changed for the skinning.
+@param  alpha   interpolation factor between 0 (previous) and 1 (current)
+@return true if any node got interpolated
+*/
+SLbool SLAnimManager::interpolatePose(SLfloat alpha)
+{
+    SLbool interpolated = false;
+
+    for (auto& pose : _poses)
+    {   pose.currOM = pose.node->om();
+        pose.isMoving = memcmp(pose.prevOM.m(), pose.currOM.m(), 16*sizeof(SLfloat)) != 0;
+        if (!pose.isMoving) continue;
+
+        SLVec3f t0, t1, s0, s1;
+        SLQuat4f q0, q1;
+        if (!decomposeTRS(pose.prevOM, t0, q0, s0) ||
+            !decomposeTRS(pose.currOM, t1, q1, s1))
+            continue;
+
+        SLMat4f om = q0.slerp(q1, alpha).toMat4();
+        om.scale(s0 + (s1 - s0) * alpha);
+        om.translation(t0 + (t1 - t0) * alpha);
+        pose.node->om(om);
+
+        if (pose.skeleton) pose.skeleton->changed(true);
+        interpolated = true;
+    }
+
+    return interpolated;
+}
+
+//-----------------------------------------------------------------------------
+/*! Puts back the object matrices of the last animation step on all nodes that
+got interpolated for rendering. Returns true if any node was changed.
+*/
+SLbool SLAnimManager::restoreCurrentPose()
+{
+    SLbool restored = false;
+    for (auto& pose : _poses)
+    {   if (pose.isMoving)
+        {   pose.node->om(pose.currOM);
+            if (pose.skeleton) pose.skeleton->changed(true);
+            pose.isMoving = false;
+            restored = true;
+        }
+    }
+    return restored;
+}
+
 //-----------------------------------------------------------------------------
 //! Draws the animation visualizations.
 void SLAnimManager::drawVisuals(SLSceneView* sv)
@@ -0,0 +1,420 @@
+//#############################################################################
+//  File:      SLBVH.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLBVH.h>
+#include <SLNode.h>
+#include <SLRay.h>
+
+//-----------------------------------------------------------------------------
+//! NO. of bins for the SAH split search
+static const SLint  SL_BVH_NUM_BINS = 16;
+//! Cost of a node traversal relative to a triangle test
+static const SLfloat SL_BVH_TRAVERSAL_COST = 1.0f;
+//! Min. NO. of triangles to refit the leaves with additional threads
+static const SLuint SL_BVH_MIN_PARALLEL_TRIS = 16384;
+//! NO. of leaves a thread refits at once
+static const SLuint SL_BVH_LEAVES_PER_JOB = 256;
+//-----------------------------------------------------------------------------
+//! Returns half the surface area of an AABB
+static inline SLfloat halfArea(const SLVec3f& minV, const SLVec3f& maxV)
+{
+    SLVec3f d = maxV - minV;
+    return d.x*d.y + d.y*d.z + d.z*d.x;
+}
+//-----------------------------------------------------------------------------
+SLBVH::SLBVH(SLMesh* m) : SLAccelStruct(m)
+{
+    _voxelCnt = 0;
+    _voxelCntEmpty = 0;
+    _voxelMaxTria = 0;
+    _voxelAvgTria = 0;
+    _numTriangles = 0;
+    _buildCost = 0;
+    _cost = 0;
+    _numRefits = 0;
+    _numBuilds = 0;
+}
+//-----------------------------------------------------------------------------
+//! Returns the vertex index of a corner of the triangle t
+inline SLuint SLBVH::triIndex(SLuint t, SLuint corner) const
+{
+    return _m->I16.size() ? _m->I16[t*3+corner] : _m->I32[t*3+corner];
+}
+//-----------------------------------------------------------------------------
+//! Deletes the entire tree
+void SLBVH::deleteAll()
+{
+    _voxelCnt      = 0;
+    _voxelCntEmpty = 0;
+    _voxelMaxTria  = 0;
+    _voxelAvgTria  = 0;
+
+    _nodes.clear();
+    _leaves.clear();
+    _triangles.clear();
+    _numRefits = 0;
+
+    disposeBuffers();
+}
+//-----------------------------------------------------------------------------
+/*!
+SLBVH::build builds the tree top-down. The triangles of a node are sorted into
+SL_BVH_NUM_BINS bins along the longest axis of their centers and the split
+between two bins with the lowest SAH cost is taken. A node becomes a leaf if
+splitting costs more than testing its triangles and it has no more than
+SL_BVH_MAX_LEAF_TRIS triangles.
+*/
+void SLBVH::build(SLVec3f minV, SLVec3f maxV)
+{
+    SL_PROFILE_SCOPE("SLBVH::build");
+    assert(_m->I16.size() || _m->I32.size());
+
+    deleteAll();
+
+    _minV = minV;
+    _maxV = maxV;
+    _numTriangles = _m->numI() / 3;
+    _numBuilds++;
+    if (_numTriangles == 0) return;
+
+    // Bounds and centers of all triangles
+    SLVVec3f triMin(_numTriangles), triMax(_numTriangles), center(_numTriangles);
+    for (SLuint t=0; t<_numTriangles; ++t)
+    {   SLVec3f A = _m->finalP(triIndex(t,0));
+        SLVec3f B = _m->finalP(triIndex(t,1));
+        SLVec3f C = _m->finalP(triIndex(t,2));
+        triMin[t] = A; triMin[t].setMin(B); triMin[t].setMin(C);
+        triMax[t] = A; triMax[t].setMax(B); triMax[t].setMax(C);
+        center[t] = (triMin[t] + triMax[t]) * 0.5f;
+    }
+    _triangles.resize(_numTriangles);
+    for (SLuint t=0; t<_numTriangles; ++t) _triangles[t] = t;
+
+    struct SLBVHBuildJob {SLuint node, first, count, depth;};
+    vector<SLBVHBuildJob> jobs;
+    _nodes.reserve(2 * (_numTriangles / 2 + 1));
+    _nodes.push_back(SLBVHNode());
+    jobs.push_back({0, 0, _numTriangles, 1});
+
+    SLuint  binCount[SL_BVH_NUM_BINS];
+    SLVec3f binMin[SL_BVH_NUM_BINS], binMax[SL_BVH_NUM_BINS];
+    SLfloat rightArea[SL_BVH_NUM_BINS];
+    SLuint  rightCount[SL_BVH_NUM_BINS];
+
+    while (!jobs.empty())
+    {   SLBVHBuildJob job = jobs.back();
+        jobs.pop_back();
+        SLuint* tris = &_triangles[job.first];
+
+        // Bounds of the triangles and of their centers
+        SLVec3f bMin( FLT_MAX, FLT_MAX, FLT_MAX), cMin( FLT_MAX, FLT_MAX, FLT_MAX);
+        SLVec3f bMax(-FLT_MAX,-FLT_MAX,-FLT_MAX), cMax(-FLT_MAX,-FLT_MAX,-FLT_MAX);
+        for (SLuint i=0; i<job.count; ++i)
+        {   bMin.setMin(triMin[tris[i]]);
+            bMax.setMax(triMax[tris[i]]);
+            cMin.setMin(center[tris[i]]);
+            cMax.setMax(center[tris[i]]);
+        }
+        _nodes[job.node].min = bMin;
+        _nodes[job.node].max = bMax;
+
+        // Find the split with the lowest SAH cost along the longest axis
+        SLVec3f cSize = cMax - cMin;
+        SLint axis = cSize.x > cSize.y ? (cSize.x > cSize.z ? 0 : 2) :
+                                         (cSize.y > cSize.z ? 1 : 2);
+        SLint bestSplit = -1;
+        SLfloat bestCost = (SLfloat)job.count;
+        SLfloat parentArea = halfArea(bMin, bMax);
+        SLfloat binScale = cSize.comp[axis] > 0.0f ?
+                           (SLfloat)SL_BVH_NUM_BINS / cSize.comp[axis] : 0.0f;
+
+        auto binOf = [&](SLuint t)
+        {   SLint b = (SLint)((center[t].comp[axis] - cMin.comp[axis]) * binScale);
+            return b < SL_BVH_NUM_BINS-1 ? b : SL_BVH_NUM_BINS-1;
+        };
+
+        if (job.count > 1 && binScale > 0.0f && parentArea > 0.0f &&
+            job.depth < SL_BVH_MAX_DEPTH)
+        {   for (SLint b=0; b<SL_BVH_NUM_BINS; ++b)
+            {   binCount[b] = 0;
+                binMin[b].set( FLT_MAX, FLT_MAX, FLT_MAX);
+                binMax[b].set(-FLT_MAX,-FLT_MAX,-FLT_MAX);
+            }
+            for (SLuint i=0; i<job.count; ++i)
+            {   SLint b = binOf(tris[i]);
+                binCount[b]++;
+                binMin[b].setMin(triMin[tris[i]]);
+                binMax[b].setMax(triMax[tris[i]]);
+            }
+
+            // Sweep from the right and store the area & count right of each split
+            SLVec3f rMin( FLT_MAX, FLT_MAX, FLT_MAX), rMax(-FLT_MAX,-FLT_MAX,-FLT_MAX);
+            SLuint  rCount = 0;
+            for (SLint b=SL_BVH_NUM_BINS-1; b>0; --b)
+            {   rMin.setMin(binMin[b]);
+                rMax.setMax(binMax[b]);
+                rCount += binCount[b];
+                rightArea[b-1]  = rCount ? halfArea(rMin, rMax) : 0.0f;
+                rightCount[b-1] = rCount;
+            }
+
+            // Sweep from the left and evaluate the split after each bin
+            SLVec3f lMin( FLT_MAX, FLT_MAX, FLT_MAX), lMax(-FLT_MAX,-FLT_MAX,-FLT_MAX);
+            SLuint  lCount = 0;
+            for (SLint b=0; b<SL_BVH_NUM_BINS-1; ++b)
+            {   lMin.setMin(binMin[b]);
+                lMax.setMax(binMax[b]);
+                lCount += binCount[b];
+                if (lCount == 0 || rightCount[b] == 0) continue;
+                SLfloat cost = SL_BVH_TRAVERSAL_COST +
+                               (halfArea(lMin, lMax) * lCount +
+                                rightArea[b] * rightCount[b]) / parentArea;
+                if (cost < bestCost)
+                {   bestCost = cost;
+                    bestSplit = b;
+                }
+            }
+
+            // Big nodes get split even if the SAH says otherwise
+            if (bestSplit < 0 && job.count > SL_BVH_MAX_LEAF_TRIS)
+            {   lCount = 0;
+                for (SLint b=0; b<SL_BVH_NUM_BINS-1 && bestSplit < 0; ++b)
+                {   lCount += binCount[b];
+                    if (lCount >= job.count/2 && rightCount[b] > 0) bestSplit = b;
+                }
+            }
+        }
+
+        if (bestSplit < 0)
+        {   // Make a leaf
+            _nodes[job.node].first = job.first;
+            _nodes[job.node].count = job.count;
+            _leaves.push_back(job.node);
+            continue;
+        }
+
+        // Partition the triangles and create the two children
+        SLuint* mid = std::partition(tris, tris + job.count,
+                                     [&](SLuint t) {return binOf(t) <= bestSplit;});
+        SLuint numLeft = (SLuint)(mid - tris);
+        SLuint left = (SLuint)_nodes.size();
+        _nodes.push_back(SLBVHNode());
+        _nodes.push_back(SLBVHNode());
+        _nodes[job.node].first = left;
+        _nodes[job.node].count = 0;
+        jobs.push_back({left+1, job.first+numLeft, job.count-numLeft, job.depth+1});
+        jobs.push_back({left,   job.first,         numLeft,           job.depth+1});
+    }
+
+    _buildCost = _cost = refitInnerNodes();
+
+    // Statistics with the leaves as voxels
+    _voxelCnt = (SLuint)_leaves.size();
+    _voxelCntEmpty = 0;
+    for (auto l : _leaves)
+        _voxelMaxTria = SL_max(_voxelMaxTria, _nodes[l].count);
+    _voxelAvgTria = (SLfloat)_numTriangles / (SLfloat)_voxelCnt;
+}
+//-----------------------------------------------------------------------------
+//! Updates the bounds of the leaves in the range [firstLeaf, endLeaf)
+void SLBVH::refitLeaves(SLuint firstLeaf, SLuint endLeaf)
+{
+    for (SLuint l=firstLeaf; l<endLeaf; ++l)
+    {   SLBVHNode& node = _nodes[_leaves[l]];
+        SLVec3f bMin( FLT_MAX, FLT_MAX, FLT_MAX);
+        SLVec3f bMax(-FLT_MAX,-FLT_MAX,-FLT_MAX);
+        for (SLuint i=node.first; i<node.first+node.count; ++i)
+        {   for (SLuint c=0; c<3; ++c)
+            {   SLVec3f P = _m->finalP(triIndex(_triangles[i], c));
+                bMin.setMin(P);
+                bMax.setMax(P);
+            }
+        }
+        node.min = bMin;
+        node.max = bMax;
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+Updates the bounds of the inner nodes bottom-up. Because the children are
+stored after their parent a backwards walk visits them first. Returns the SAH
+cost of the tree relative to the surface of the root.
+*/
+SLfloat SLBVH::refitInnerNodes()
+{
+    SLfloat cost = 0.0f;
+    for (SLint i=(SLint)_nodes.size()-1; i>=0; --i)
+    {   SLBVHNode& node = _nodes[i];
+        if (node.count == 0)
+        {   const SLBVHNode& l = _nodes[node.first];
+            const SLBVHNode& r = _nodes[node.first+1];
+            node.min = l.min; node.min.setMin(r.min);
+            node.max = l.max; node.max.setMax(r.max);
+            cost += SL_BVH_TRAVERSAL_COST * halfArea(node.min, node.max);
+        } else
+            cost += node.count * halfArea(node.min, node.max);
+    }
+    SLfloat rootArea = halfArea(_nodes[0].min, _nodes[0].max);
+    return rootArea > 0.0f ? cost / rootArea : cost;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLBVH::refit updates the bounds of all nodes with the current vertex positions
+of the mesh. The leaves are distributed in jobs of SL_BVH_LEAVES_PER_JOB on
+SL::maxThreads() threads. Returns false if the tree wasn't built yet, the
+NO. of triangles changed or the SAH cost grew more than SL_BVH_REBUILD_RATIO.
+*/
+SLbool SLBVH::refit()
+{
+    if (_nodes.empty() || _numTriangles != _m->numI() / 3)
+        return false;
+
+    SL_PROFILE_SCOPE("SLBVH::refit");
+
+    SLuint numLeaves = (SLuint)_leaves.size();
+    SLuint numThreads = _numTriangles < SL_BVH_MIN_PARALLEL_TRIS ? 1 :
+                        SL_min(SL::maxThreads(), numLeaves / SL_BVH_LEAVES_PER_JOB + 1);
+    if (numThreads <= 1)
+        refitLeaves(0, numLeaves);
+    else
+    {   atomic<SLuint> nextLeaf(0);
+        auto runJobs = [&]()
+        {   for (SLuint l = nextLeaf.fetch_add(SL_BVH_LEAVES_PER_JOB);
+                 l < numLeaves;
+                 l = nextLeaf.fetch_add(SL_BVH_LEAVES_PER_JOB))
+                refitLeaves(l, SL_min(l + SL_BVH_LEAVES_PER_JOB, numLeaves));
+        };
+
+        // Start additional threads and do the same work in the main thread
+        vector<thread> threads;
+        for (SLuint t=0; t < numThreads-1; t++)
+            threads.push_back(thread(runJobs));
+        runJobs();
+        for(auto& thread : threads) thread.join();
+    }
+
+    _cost = refitInnerNodes();
+    _minV = _nodes[0].min;
+    _maxV = _nodes[0].max;
+    _numRefits++;
+    disposeBuffers();
+
+    return _cost <= _buildCost * SL_BVH_REBUILD_RATIO;
+}
+//-----------------------------------------------------------------------------
+//! Updates the statistics in the parent node with the leaves as voxels
+void SLBVH::updateStats(SLNodeStats &stats)
+{
+    stats.numVoxels     += _voxelCnt;
+    stats.numVoxEmpty   += _voxelCntEmpty;
+
+    stats.numBytesAccel += sizeof(SLBVH);
+    stats.numBytesAccel += SL_sizeOfVector(_nodes);
+    stats.numBytesAccel += SL_sizeOfVector(_leaves);
+    stats.numBytesAccel += SL_sizeOfVector(_triangles);
+
+    stats.numVoxMaxTria = SL_max(_voxelMaxTria, stats.numVoxMaxTria);
+}
+//-----------------------------------------------------------------------------
+//! SLBVH::draw draws the AABBs of the leaves
+void SLBVH::draw(SLSceneView*)
+{
+    if (_leaves.empty()) return;
+
+    if (!_vao.id())
+    {   SLVVec3f P;
+        P.reserve(_leaves.size() * 24);
+
+        for (auto l : _leaves)
+        {   const SLVec3f& a = _nodes[l].min;
+            const SLVec3f& b = _nodes[l].max;
+            SLVec3f c[8] = {SLVec3f(a.x,a.y,a.z), SLVec3f(b.x,a.y,a.z),
+                            SLVec3f(b.x,a.y,b.z), SLVec3f(a.x,a.y,b.z),
+                            SLVec3f(a.x,b.y,a.z), SLVec3f(b.x,b.y,a.z),
+                            SLVec3f(b.x,b.y,b.z), SLVec3f(a.x,b.y,b.z)};
+            for (SLint i=0; i<4; ++i)
+            {   P.push_back(c[i]);   P.push_back(c[(i+1)%4]);   // bottom
+                P.push_back(c[i+4]); P.push_back(c[(i+1)%4+4]); // top
+                P.push_back(c[i]);   P.push_back(c[i+4]);       // sides
+            }
+        }
+        _vao.generateVertexPos(&P);
+    }
+
+    _vao.drawArrayAsColored(PT_lines, SLCol4f::CYAN);
+}
+//-----------------------------------------------------------------------------
+/*!
+Ray mesh intersection by a depth first traversal with an explicit stack. The
+nearer child gets visited first and nodes that start behind the closest hit
+found so far are skipped. The AABB test is the slab test of SLAABBox::isHitInOS.
+*/
+SLbool SLBVH::intersect(SLRay* ray, SLNode* node)
+{
+    // Check first if the AABB is hit at all
+    if (!node->aabb()->isHitInOS(ray)) return false;
+
+    SLbool wasHit = false;
+
+    if (_nodes.empty())
+    {   // not enough triangles for a tree > check them all
+        for (SLuint t = 0; t<_m->numI(); t += 3)
+            if (_m->hitTriangleOS(ray, node, t)) wasHit = true;
+        return wasHit;
+    }
+
+    const SLVec3f& O = ray->originOS;
+    const SLVec3f& invD = ray->invDirOS;
+
+    // Returns the entry distance into the AABB of a node or FLT_MAX on a miss
+    auto hitNode = [&](const SLBVHNode& n)
+    {   SLfloat tx1 = (n.min.x - O.x) * invD.x, tx2 = (n.max.x - O.x) * invD.x;
+        SLfloat ty1 = (n.min.y - O.y) * invD.y, ty2 = (n.max.y - O.y) * invD.y;
+        SLfloat tz1 = (n.min.z - O.z) * invD.z, tz2 = (n.max.z - O.z) * invD.z;
+        SLfloat tmin = SL_max(SL_min(tx1,tx2), SL_min(ty1,ty2), SL_min(tz1,tz2));
+        SLfloat tmax = SL_min(SL_max(tx1,tx2), SL_max(ty1,ty2), SL_max(tz1,tz2));
+        return (tmax >= tmin && tmax > 0.0f && tmin < ray->length) ? tmin : FLT_MAX;
+    };
+
+    struct SLBVHStackEntry {SLuint node; SLfloat t;};
+    SLBVHStackEntry stack[SL_BVH_MAX_DEPTH * 2];
+    SLint top = 0;
+    stack[top++] = {0, 0.0f};
+
+    while (top > 0)
+    {   SLBVHStackEntry e = stack[--top];
+        if (e.t >= ray->length) continue;
+        const SLBVHNode& n = _nodes[e.node];
+
+        if (n.count)
+        {   for (SLuint i=n.first; i<n.first+n.count; ++i)
+                if (_m->hitTriangleOS(ray, node, _triangles[i] * 3))
+                    wasHit = true;
+            if (wasHit && ray->isShaded()) return true;
+        } else
+        {   SLfloat tl = hitNode(_nodes[n.first]);
+            SLfloat tr = hitNode(_nodes[n.first+1]);
+            if (tl <= tr)
+            {   if (tr < FLT_MAX) stack[top++] = {n.first+1, tr};
+                if (tl < FLT_MAX) stack[top++] = {n.first,   tl};
+            } else
+            {   if (tl < FLT_MAX) stack[top++] = {n.first,   tl};
+                if (tr < FLT_MAX) stack[top++] = {n.first+1, tr};
+            }
+        }
+    }
+    return wasHit;
+}
+//-----------------------------------------------------------------------------
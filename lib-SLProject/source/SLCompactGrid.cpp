@@ -114,6 +114,7 @@ their paper "Compact, Fast and Robust Grids for Ray Tracing".
 */
 void SLCompactGrid::build (SLVec3f minV, SLVec3f maxV)
 {
+    SL_PROFILE_SCOPE("SLCompactGrid::build");
     assert(_m->I16.size() || _m->I32.size());
 
     deleteAll();
@@ -17,6 +17,7 @@
 #include <SLScene.h>
 #include <SLGLProgram.h>
 #include <SLGLShader.h>
+#include <SLLightClusters.h>
 
 //-----------------------------------------------------------------------------
 //! Default path for shader files used when only filename is passed in load.
@@ -34,8 +35,10 @@ SLGLProgram::SLGLProgram(SLstring vertShaderFile,
     _objectGL = 0;
 
     // optional load vertex and/or fragment shaders
-    addShader(new SLGLShader(defaultPath+vertShaderFile, ST_vertex));
-    addShader(new SLGLShader(defaultPath+fragShaderFile, ST_fragment));
+    if (!vertShaderFile.empty())
+        addShader(new SLGLShader(defaultPath+vertShaderFile, ST_vertex));
+    if (!fragShaderFile.empty())
+        addShader(new SLGLShader(defaultPath+fragShaderFile, ST_fragment));
 
     // Add pointer to the global resource vectors for deallocation
     SLScene::current->programs().push_back(this);
@@ -136,6 +139,16 @@ void SLGLProgram::init()
         }
     } else SL_EXIT_MSG("No successufully compiled shaders attached!");
     
+    // Bind the standard attributes to the same locations in all programs so
+    // that a vertex array object can be drawn with any of them
+    glBindAttribLocation(_objectGL, AT_position,    "a_position");
+    glBindAttribLocation(_objectGL, AT_normal,      "a_normal");
+    glBindAttribLocation(_objectGL, AT_texCoord,    "a_texCoord");
+    glBindAttribLocation(_objectGL, AT_tangent,     "a_tangent");
+    glBindAttribLocation(_objectGL, AT_jointWeight, "a_jointWeights");
+    glBindAttribLocation(_objectGL, AT_jointIndex,  "a_jointIds");
+    glBindAttribLocation(_objectGL, AT_color,       "a_color");
+
     int linked;
     glLinkProgram(_objectGL);
     GET_GL_ERROR;
@@ -190,6 +203,16 @@ void SLGLProgram::beginUse(SLMaterial* mat)
         SLint loc = uniform4fv("u_globalAmbient",  1,  (SLfloat*) _stateGL->globalAmbient());
         loc = uniform1i("u_numLightsUsed", _stateGL->numLightsUsed);
         
+        // 2a: Clustered lighting gets the lights from the cluster textures
+        SLLightClusters* clusters = _stateGL->lightClusters;
+        if (clusters && clusters->usesProgram(this))
+        {   clusters->setUniforms(this);
+            loc = uniform4fv("u_matAmbient",     1,  (SLfloat*)&_stateGL->matAmbient);
+            loc = uniform4fv("u_matDiffuse",     1,  (SLfloat*)&_stateGL->matDiffuse);
+            loc = uniform4fv("u_matSpecular",    1,  (SLfloat*)&_stateGL->matSpecular);
+            loc = uniform4fv("u_matEmissive",    1,  (SLfloat*)&_stateGL->matEmissive);
+            loc = uniform1f ("u_matShininess",                  _stateGL->matShininess);
+        } else
         if (_stateGL->numLightsUsed > 0)
         {   SLint nL = SL_MAX_LIGHTS;
             _stateGL->calcLightPosVS(_stateGL->numLightsUsed);
@@ -35,7 +35,8 @@ SLGLShader::SLGLShader(SLstring filename, SLShaderType shaderType)
     _file = filename;
    
     // Only load file at this moment, don't compile it.
-    load(filename);
+    // Without filename the code gets passed with loadFromMemory.
+    if (!filename.empty()) load(filename);
 }
 //-----------------------------------------------------------------------------
 //! SLGLShader::load loads a shader file into string _shaderSource
@@ -89,6 +89,7 @@ void SLGLState::initAll()
     fogColor = SLCol4f::BLACK;
    
     globalAmbientLight.set(0.2f,0.2f,0.2f,0.0f);
+    lightClusters = nullptr;
    
     _glVersion      = SLstring((char*)glGetString(GL_VERSION));
     _glVersionNO    = getGLVersionNO();
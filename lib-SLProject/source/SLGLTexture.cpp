@@ -15,6 +15,7 @@
 
 #include <SLGLTexture.h>
 #include <SLScene.h>
+#include <SLTexResidency.h>
 
 //-----------------------------------------------------------------------------
 //! Default path for texture files used when only filename is passed in load.
@@ -39,21 +40,30 @@ SLGLTexture::SLGLTexture()
     _resizeToPow2 = false;
     _autoCalcTM3D = false;
     _bytesOnGPU   = 0;
+    _lodLevel     = 0;
+    _residencyID  = -1;
+    _residency    = nullptr;
+    _mipsCPUValid = false;
 }
 //-----------------------------------------------------------------------------
-//! ctor 2D textures with internal image allocation
+/*! ctor 2D textures with internal image allocation. If deferLoad is true
+the image file is not yet loaded. It must be loaded with loadDeferred before
+the texture is built. This allows the image decoding on a worker thread.
+*/
 SLGLTexture::SLGLTexture(SLstring  filename,
                          SLint     min_filter,
                          SLint     mag_filter,
                          SLTextureType type,
                          SLint     wrapS,
-                         SLint     wrapT) : SLObject(filename)
+                         SLint     wrapT,
+                         SLbool    deferLoad) : SLObject(filename)
 {  
     assert(filename!="");
     _stateGL = SLGLState::getInstance();
     _texType = type==TT_unknown ? detectType(filename) : type;
 
-    load(filename);
+    if (!deferLoad)
+        load(filename);
    
     _min_filter   = min_filter;
     _mag_filter   = mag_filter;
@@ -65,7 +75,11 @@ SLGLTexture::SLGLTexture(SLstring  filename,
     _resizeToPow2 = false;
     _autoCalcTM3D = false;
     _needsUpdate  = false;
+    _mipsCPUValid = false;
     _bytesOnGPU   = 0;
+    _lodLevel     = 0;
+    _residencyID  = -1;
+    _residency    = nullptr;
    
     // Add pointer to the global resource vectors for deallocation
     SLScene::current->textures().push_back(this);
@@ -97,7 +111,11 @@ SLGLTexture::SLGLTexture(SLVstring files,
     _resizeToPow2 = false;
     _autoCalcTM3D = true;
     _needsUpdate  = false;
+    _mipsCPUValid = false;
     _bytesOnGPU   = 0;
+    _lodLevel     = 0;
+    _residencyID  = -1;
+    _residency    = nullptr;
 
     // Add pointer to the global resource vectors for deallocation
     SLScene::current->textures().push_back(this);
@@ -134,7 +152,11 @@ SLGLTexture::SLGLTexture(SLstring  filenameXPos,
     _resizeToPow2 = false;
     _autoCalcTM3D = false;
     _needsUpdate  = false;
+    _mipsCPUValid = false;
     _bytesOnGPU   = 0;
+    _lodLevel     = 0;
+    _residencyID  = -1;
+    _residency    = nullptr;
 
     SLScene::current->textures().push_back(this);
 }
@@ -151,6 +173,13 @@ void SLGLTexture::clearData()
 
     numBytesInTextures -= _bytesOnGPU;
 
+    if (_residency)
+    {   _residency->remove(_residencyID);
+        _residency = nullptr;
+        _residencyID = -1;
+    }
+    _lodLevel = 0;
+
     for (SLint i=0; i<_images.size(); ++i)
     {   delete _images[i];
         _images[i] = 0;
@@ -160,6 +189,8 @@ void SLGLTexture::clearData()
     _texName = 0;
     _bytesOnGPU = 0;
     _vaoSprite.clearAttribs();
+    _mipsCPU.clear();
+    _mipsCPUValid = false;
 }
 //-----------------------------------------------------------------------------
 //! Loads the texture, converts color depth & applies the mirroring
@@ -177,6 +208,17 @@ void SLGLTexture::load(SLstring filename)
     _images.push_back(new SLImage(filename));
 }
 //-----------------------------------------------------------------------------
+/*! Loads the image of a texture that was constructed with deferLoad=true.
+This method touches only the image data of this texture and can therefore be
+called from any thread. The OpenGL upload is still done in build on the GL
+thread.
+*/
+void SLGLTexture::loadDeferred()
+{
+    if (_images.size()==0)
+        load(_name);
+}
+//-----------------------------------------------------------------------------
 void SLGLTexture::setVideoImage(SLstring videoImageFile)
 {
      load(videoImageFile);
@@ -220,10 +262,32 @@ SLbool SLGLTexture::copyVideoImage(SLint width,
     if (needsRebuild)
         build();
     
+    _mipsCPUValid = false;
     _needsUpdate = true;
     return needsRebuild;
 }
 //-----------------------------------------------------------------------------
+/*!
+Returns the OpenGL internal format for an image. 8-bit images use the pixel
+format. Half and float images need a sized float format (not on ES2).
+*/
+static SLint texInternalFormat(SLImage* img)
+{
+    #ifndef SL_GLES2
+    SLbool isHalf = img->dataType() == PD_half;
+    if (img->dataType() != PD_ubyte)
+    {   switch (img->format())
+        {   case PF_red:  return isHalf ? GL_R16F    : GL_R32F;
+            case PF_rg:   return isHalf ? GL_RG16F   : GL_RG32F;
+            case PF_rgb:  return isHalf ? GL_RGB16F  : GL_RGB32F;
+            case PF_rgba: return isHalf ? GL_RGBA16F : GL_RGBA32F;
+            default: break;
+        }
+    }
+    #endif
+    return img->format();
+}
+//-----------------------------------------------------------------------------
 /*! 
 Builds an OpenGL texture object with the according OpenGL commands.
 This texture creation must be done only once when a valid OpenGL rendering
@@ -241,6 +305,8 @@ void SLGLTexture::build(SLint texID)
     if (_texName) 
     {   glDeleteTextures(1, &_texName);
         _texName = 0;
+        numBytesInTextures -= _bytesOnGPU;
+        _bytesOnGPU = 0;
     }
     
     // get max texture size
@@ -330,19 +396,28 @@ void SLGLTexture::build(SLint texID)
     // Build textures
     if (_target == GL_TEXTURE_2D)
     {
+        // Drop the finest mip levels as decided by the residency manager
+        SLImage* img = _images[0];
+        SLImage  reduced[2];
+        _lodLevel = SL_min(_lodLevel, maxLodLevel());
+        for (SLint l=0; l<_lodLevel; ++l)
+        {   img->downsample(&reduced[l & 1]);
+            img = &reduced[l & 1];
+        }
+
         //////////////////////////////////////////
         glTexImage2D(GL_TEXTURE_2D,
                      0, 
-                     _images[0]->format(),
-                     _images[0]->width(),
-                     _images[0]->height(),
+                     texInternalFormat(img),
+                     img->width(),
+                     img->height(),
                      0,
-                     _images[0]->format(),
-                     GL_UNSIGNED_BYTE, 
-                     (GLvoid*)_images[0]->data());
+                     img->format(),
+                     img->dataType(), 
+                     (GLvoid*)img->data());
         //////////////////////////////////////////
 
-        _bytesOnGPU += _images[0]->bytesPerImage();
+        _bytesOnGPU += img->bytesPerImage();
         
         if (_min_filter>=GL_NEAREST_MIPMAP_NEAREST)
         {   if (_stateGL->glIsES2() || 
@@ -350,7 +425,7 @@ void SLGLTexture::build(SLint texID)
                 _stateGL->glVersionNOf() >= 3.0)
                 glGenerateMipmap(GL_TEXTURE_2D);
             else
-                build2DMipmaps(GL_TEXTURE_2D, 0);
+                build2DMipmaps(GL_TEXTURE_2D, img);
 
             // Mipmaps use 1/3 more memory on GPU
             _bytesOnGPU = (SLuint)((SLfloat)_bytesOnGPU * 1.333333333f);
@@ -365,19 +440,18 @@ void SLGLTexture::build(SLint texID)
             //////////////////////////////////////////////
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X+i,
                          0, 
-                         _images[i]->format(),
+                         texInternalFormat(_images[i]),
                          _images[i]->width(),
                          _images[i]->height(),
                          0,
                          _images[i]->format(),
-                         GL_UNSIGNED_BYTE,
+                         _images[i]->dataType(),
                          (GLvoid*)_images[i]->data());
             //////////////////////////////////////////////
 
             _bytesOnGPU += _images[0]->bytesPerImage();
         }
 
-        numBytesInTextures += _bytesOnGPU;
         if (_min_filter>=GL_NEAREST_MIPMAP_NEAREST)
         {
             glGenerateMipmap(GL_TEXTURE_2D);
@@ -385,6 +459,7 @@ void SLGLTexture::build(SLint texID)
             // Mipmaps use 1/3 more memory on GPU
             _bytesOnGPU = (SLuint)((SLfloat)_bytesOnGPU * 1.333333333f);
         }
+        numBytesInTextures += _bytesOnGPU;
     }
     #ifndef SL_GLES2
     else if (_target == GL_TEXTURE_3D)
@@ -403,13 +478,13 @@ void SLGLTexture::build(SLint texID)
         /////////////////////////////////////////////////////
         glTexImage3D(GL_TEXTURE_3D,
                      0,                     //Mipmap level,
-                     _images[0]->format(),  //Internal format
+                     texInternalFormat(_images[0]), //Internal format
                      _images[0]->width(),
                      _images[0]->height(),
                      (SLsizei)_images.size(),
                      0,                     //Border
                      _images[0]->format(),  //Format
-                     GL_UNSIGNED_BYTE,      //Data type
+                     _images[0]->dataType(),//Data type
                      &buffer[0]);
         /////////////////////////////////////////////////////
         
@@ -417,6 +492,19 @@ void SLGLTexture::build(SLint texID)
     }
     #endif
 
+    // Register the texture at the residency manager of the scene. Fonts and
+    // the video texture are not managed.
+    SLScene* s = SLScene::current;
+    if (!_residency && s && _texType != TT_font && this != s->videoTexture())
+    {   _residency = &s->texResidency();
+        _residencyID = _residency->add(this,
+                                       _bytesOnGPU << (2*_lodLevel),
+                                       SL_max(_images[0]->width(), _images[0]->height()),
+                                       maxLodLevel());
+    }
+    if (_residency)
+        _residency->loaded(_residencyID, _lodLevel);
+
     GET_GL_ERROR;
 }
 //-----------------------------------------------------------------------------
@@ -432,6 +520,7 @@ void SLGLTexture::bindActive(SLint texID)
    
     // if texture not exists build it
     if (!_texName) build(texID);
+    else if (_residency) _residency->touch(_residencyID);
    
     if (_texName)
     {   _stateGL->activeTexture(GL_TEXTURE0 + texID);
@@ -449,6 +538,46 @@ void SLGLTexture::bindActive(SLint texID)
 }
 //-----------------------------------------------------------------------------
 /*!
+Returns the max. NO. of finest mip levels that the residency manager may drop.
+Only mipmapped 2D textures can be reduced and their base level keeps at least
+SL_TEX_MIN_LOD_SIZE texels in both directions.
+*/
+SLint SLGLTexture::maxLodLevel()
+{
+    if (_target != GL_TEXTURE_2D ||
+        _min_filter < GL_NEAREST_MIPMAP_NEAREST ||
+        _images.size() == 0) return 0;
+
+    SLint level = 0;
+    SLint size = SL_min(_images[0]->width(), _images[0]->height());
+    while ((size >> (level+1)) >= SL_TEX_MIN_LOD_SIZE) level++;
+    return level;
+}
+//-----------------------------------------------------------------------------
+/*!
+Carries out a change of the residency manager SLTexResidency: With a level of
+-1 the texture gets deleted on the GPU but keeps its images. It gets uploaded
+again at the coarsest level at its next bindActive. Otherwise a resident
+texture gets uploaded again with the passed NO. of dropped mip levels.
+*/
+void SLGLTexture::applyResidency(SLint level)
+{
+    if (level < 0)
+    {   if (_texName)
+        {   glDeleteTextures(1, &_texName);
+            _texName = 0;
+            numBytesInTextures -= _bytesOnGPU;
+            _bytesOnGPU = 0;
+        }
+        _lodLevel = maxLodLevel();
+    } else
+    {   _lodLevel = level;
+        if (_texName) build();
+    }
+    GET_GL_ERROR;
+}
+//-----------------------------------------------------------------------------
+/*!
 Fully updates the OpenGL internal texture data by the image data 
 */
 void SLGLTexture::fullUpdate()
@@ -465,7 +594,7 @@ void SLGLTexture::fullUpdate()
                             _images[0]->width(),
                             _images[0]->height(),
                             _images[0]->format(),
-                            GL_UNSIGNED_BYTE, 
+                            _images[0]->dataType(), 
                             (GLvoid*)_images[0]->data());
             /////////////////////////////////////////////
             
@@ -553,6 +682,125 @@ SLCol4f SLGLTexture::getTexelf(SLfloat s, SLfloat t)
                                       (SLint)(t*_images[0]->height()));
 }
 //-----------------------------------------------------------------------------
+/*!
+getTexelf with a footprint returns the mipmap filtered color at s & t for ray
+tracing. The footprint is the width of the area seen by the ray in texture
+coordinates. The mipmap level is the log2 of the footprint size in texels of
+the base level. With GL_LINEAR_MIPMAP_LINEAR or anisotropic filtering the two
+nearest levels are bilinearly filtered and interpolated (trilinear filtering).
+Textures without a mipmap minification filter and 3D or cube map textures are
+looked up unfiltered by getTexelf(s, t).
+*/
+SLCol4f SLGLTexture::getTexelf(SLfloat s, SLfloat t, SLfloat footprint)
+{
+    if (_min_filter < GL_NEAREST_MIPMAP_NEAREST || 
+        _target != GL_TEXTURE_2D || _images.size() != 1)
+        return getTexelf(s, t);
+
+    if (!_mipsCPUValid.load(memory_order_acquire))
+        buildMipmapsCPU();
+
+    // transform tex coords with the texture matrix
+    SLfloat sizeS = SL_abs(_tm.m(0)) * _mipsCPU[0].width;
+    SLfloat sizeT = SL_abs(_tm.m(5)) * _mipsCPU[0].height;
+    s = s * _tm.m(0) + _tm.m(12);
+    t = t * _tm.m(5) + _tm.m(13);
+
+    // Level of detail of the footprint in texels
+    SLfloat texels = footprint * SL_max(sizeS, sizeT);
+    SLfloat maxLevel = (SLfloat)(_mipsCPU.size()-1);
+    SLfloat lod = texels > 1.0f ? SL_min(log2(texels), maxLevel) : 0.0f;
+
+    if (_min_filter == GL_NEAREST_MIPMAP_NEAREST || 
+        _min_filter == GL_LINEAR_MIPMAP_NEAREST)
+        return getTexelMip((SLint)(lod + 0.5f), s, t);
+
+    SLint   level = (SLint)lod;
+    SLfloat frac  = lod - (SLfloat)level;
+    SLCol4f c0 = getTexelMip(level, s, t);
+    if (frac < 0.001f) return c0;
+    return c0 + (getTexelMip(level+1, s, t) - c0) * frac;
+}
+//-----------------------------------------------------------------------------
+/*!
+getTexelMip returns the bilinear filtered texel of a CPU mipmap level at the
+transformed texture coordinates s & t with the texture wrapping applied.
+*/
+SLCol4f SLGLTexture::getTexelMip(SLint level, SLfloat s, SLfloat t)
+{
+    const SLTexMipLevel& mip = _mipsCPU[level];
+
+    SLfloat xf = s * mip.width  - 0.5f;
+    SLfloat yf = t * mip.height - 0.5f;
+    SLfloat x0f = floor(xf);
+    SLfloat y0f = floor(yf);
+    SLfloat fx = xf - x0f;
+    SLfloat fy = yf - y0f;
+    SLint   x0 = (SLint)x0f, x1 = x0 + 1;
+    SLint   y0 = (SLint)y0f, y1 = y0 + 1;
+
+    if (_wrap_s == GL_REPEAT)
+    {   x0 = ((x0 % mip.width) + mip.width) % mip.width;
+        x1 = x1 % mip.width; if (x1 < 0) x1 += mip.width;
+    } else
+    {   x0 = SL_clamp(x0, 0, mip.width-1);
+        x1 = SL_clamp(x1, 0, mip.width-1);
+    }
+    if (_wrap_t == GL_REPEAT)
+    {   y0 = ((y0 % mip.height) + mip.height) % mip.height;
+        y1 = y1 % mip.height; if (y1 < 0) y1 += mip.height;
+    } else
+    {   y0 = SL_clamp(y0, 0, mip.height-1);
+        y1 = SL_clamp(y1, 0, mip.height-1);
+    }
+
+    SLCol4f cB = mip.texel(x0, y0) + (mip.texel(x1, y0) - mip.texel(x0, y0)) * fx;
+    SLCol4f cT = mip.texel(x0, y1) + (mip.texel(x1, y1) - mip.texel(x0, y1)) * fx;
+    return cB + (cT - cB) * fy;
+}
+//-----------------------------------------------------------------------------
+/*!
+buildMipmapsCPU builds the CPU mipmap pyramid of the first image down to 1x1
+texels. The levels are calculated with SLImage::downsample and converted to
+float texels in the tiled layout of SLTexMipLevel. It is called by the first
+ray tracing thread that needs it. The other threads wait on the mutex.
+*/
+void SLGLTexture::buildMipmapsCPU()
+{
+    lock_guard<mutex> lock(_mipsCPUMutex);
+    if (_mipsCPUValid.load(memory_order_acquire)) return;
+    SL_PROFILE_SCOPE("SLGLTexture::buildMipmapsCPU");
+
+    _mipsCPU.clear();
+    SLImage  levelImgs[2];
+    SLImage* img = _images[0];
+    SLVCol4f line;
+
+    for (SLint level=0; ; ++level)
+    {   _mipsCPU.push_back(SLTexMipLevel());
+        SLTexMipLevel& mip = _mipsCPU.back();
+        mip.width  = img->width();
+        mip.height = img->height();
+        mip.tilesX = (mip.width + SL_TEX_TILE_SIZE-1) >> SL_TEX_TILE_BITS;
+        SLint tilesY = (mip.height + SL_TEX_TILE_SIZE-1) >> SL_TEX_TILE_BITS;
+        mip.texels.resize(mip.tilesX*tilesY*SL_TEX_TILE_SIZE*SL_TEX_TILE_SIZE);
+
+        line.resize(mip.width);
+        for (SLint y=0; y<mip.height; ++y)
+        {   img->readLine(y, &line[0]);
+            for (SLint x=0; x<mip.width; ++x)
+                mip.texels[mip.index(x, y)] = line[x];
+        }
+
+        if (mip.width == 1 && mip.height == 1) break;
+        SLImage* next = &levelImgs[level & 1];
+        img->downsample(next);
+        img = next;
+    }
+
+    _mipsCPUValid.store(true, memory_order_release);
+}
+//-----------------------------------------------------------------------------
 /*! 
 dsdt calculates the partial derivation (gray value slope) at s,t for bump
 mapping either from a height map or a normal map
@@ -610,49 +858,47 @@ SLuint SLGLTexture::nextPowerOf2(SLuint num)
     return nextPow2;
 }
 //-----------------------------------------------------------------------------
-void SLGLTexture::build2DMipmaps(SLint target, SLuint index)
+/*!
+SLGLTexture::build2DMipmaps uploads the image as base level and creates all
+sub levels on the CPU with SLImage::downsample.
+*/
+void SLGLTexture::build2DMipmaps(SLint target, SLImage* img)
 {  
     // Create the base level mipmap
     SLint level = 0;   
     glTexImage2D(target, 
                  level, 
-                 _images[index]->bytesPerPixel(),
-                 _images[index]->width(),
-                 _images[index]->height(), 0,
-                 _images[index]->format(),
-                 GL_UNSIGNED_BYTE, 
-                 (GLvoid*)_images[index]->data());
+                 texInternalFormat(img),
+                 img->width(),
+                 img->height(), 0,
+                 img->format(),
+                 img->dataType(), 
+                 (GLvoid*)img->data());
     GET_GL_ERROR;
     
-    // working copy of the base mipmap   
-    SLImage img2(*_images[index]);
-   
-    // create half sized sub level mipmaps
-    while(img2.width() > 1 || img2.height() > 1 )
+    // create half sized sub level mipmaps alternating between 2 images
+    SLImage  levelImgs[2];
+    SLImage* src = img;
+    while(src->width() > 1 || src->height() > 1 )
     {   level++;
-        img2.resize(max(img2.width() >>1,(SLuint)1),
-                    max(img2.height()>>1,(SLuint)1));
-      
-        //SLfloat gauss[9] = {1.0f, 2.0f, 1.0f,
-        //                    2.0f, 4.0f, 2.0f,
-        //                    1.0f, 2.0f, 1.0f};
-
-        //img2.convolve3x3(gauss);
+        SLImage* dst = &levelImgs[level & 1];
+        src->downsample(dst);
 
         // Debug output
         //SLchar filename[255];
-        //sprintf(filename,"%s_L%d_%dx%d.png", _name.c_str(), level, img2.width(), img2.height());
-        //img2.savePNG(filename);
+        //sprintf(filename,"%s_L%d_%dx%d.png", _name.c_str(), level, dst->width(), dst->height());
+        //dst->savePNG(filename);
       
         glTexImage2D(target, 
                      level, 
-                     img2.bytesPerPixel(),
-                     img2.width(), 
-                     img2.height(), 0,
-                     img2.format(),
-                     GL_UNSIGNED_BYTE, 
-                     (GLvoid*)img2.data());
+                     texInternalFormat(dst),
+                     dst->width(), 
+                     dst->height(), 0,
+                     dst->format(),
+                     dst->dataType(), 
+                     (GLvoid*)dst->data());
         GET_GL_ERROR;
+        src = dst;
     }
 }
 //-----------------------------------------------------------------------------
@@ -52,6 +52,7 @@ void SLGLVertexArray::deleteGL()
         _idVBOIndices = 0;
         SLGLVertexBuffer::totalBufferCount--;
         SLGLVertexBuffer::totalBufferSize -= _numIndices * SLGLVertexBuffer::sizeOfType(_indexDataType);
+        SLGLVertexBuffer::totalBufferSizeFloat -= _numIndices * SLGLVertexBuffer::sizeOfType(_indexDataType);
     }
 }
 
@@ -70,14 +71,40 @@ void SLGLVertexArray::setAttrib(SLGLAttributeType type,
                                 SLint location, 
                                 void* dataPointer,
                                 SLbool convertToHalf)
+{   
+    if (type == AT_position && convertToHalf)
+        SL_EXIT_MSG("The position attribute should be from float data type.");
+
+    setAttrib(type, elementSize, location, dataPointer, convertToHalf ? AE_half : AE_float);
+}
+//-----------------------------------------------------------------------------
+/*! Defines a vertex attribute with a specific encoding in the VBO. Half float
+attributes are stored in the separate half float VBO. All other encodings are
+stored in the float VBO. Encodings that are not supported by the OpenGL
+version fall back to the next bigger one.
+*/
+void SLGLVertexArray::setAttrib(SLGLAttributeType type, 
+                                SLint elementSize,
+                                SLint location, 
+                                void* dataPointer,
+                                SLGLAttributeEncoding encoding)
 {   assert(dataPointer);
     assert(elementSize);
 
     if (type == AT_position && location == -1)
         SL_EXIT_MSG("The position attribute has no variable location.");
 
-    if (type == AT_position && convertToHalf)
-        SL_EXIT_MSG("The position attribute should be from float data type.");
+    if (encoding == AE_half && !_hasGL3orGreater)
+        encoding = AE_float;
+
+    // Packed 10-10-10-2 needs OpenGL 3.3 or OpenGL ES 3.0
+    #ifdef GL_INT_2_10_10_10_REV
+    if (encoding == AE_snorm10 && (!_hasGL3orGreater || elementSize < 3))
+        encoding = AE_snorm16;
+    #else
+    if (encoding == AE_snorm10)
+        encoding = AE_snorm16;
+    #endif
 
     if (_VBOf.attribIndex(type) >= 0 || _VBOh.attribIndex(type) >= 0)
         SL_EXIT_MSG("Attribute type already exists.");
@@ -87,9 +114,14 @@ void SLGLVertexArray::setAttrib(SLGLAttributeType type,
     va.elementSize = elementSize;
     va.dataPointer = dataPointer;
     va.location = location;
+    va.offsetBytes = 0;
     va.bufferSizeBytes = 0;
+    va.encoding = encoding;
+    va.convertToHalf = encoding == AE_half;
+    va.quantMin.set(0,0,0,0);
+    va.quantRange.set(1,1,1,1);
 
-    if (convertToHalf && _hasGL3orGreater)
+    if (encoding == AE_half)
          _VBOh.attribs().push_back(va);
     else _VBOf.attribs().push_back(va);
 }
@@ -118,10 +150,14 @@ void SLGLVertexArray::setIndices(SLuint numIndices,
 /*! Updates the specified vertex attribute. This works only for sequential 
 attributes and not for interleaved attributes. This is used e.g. for meshes
 with vertex skinning. See SLMesh::draw where we have joint attributes.
+If numVertices is greater zero only the range of vertices starting at
+firstVertex is uploaded (see SLTextBatch).
 */
 void SLGLVertexArray::updateAttrib(SLGLAttributeType type, 
                                    SLint elementSize,
-                                   void* dataPointer)
+                                   void* dataPointer,
+                                   SLuint firstVertex,
+                                   SLuint numVertices)
 {   
     assert(dataPointer && "No data pointer passed");
     assert(elementSize > 0 && elementSize < 5 && "Element size invalid");
@@ -142,9 +178,9 @@ void SLGLVertexArray::updateAttrib(SLGLAttributeType type,
 
     // update the appropriate VBO
     if (indexf>-1) 
-        _VBOf.updateAttrib(type, elementSize, dataPointer);
+        _VBOf.updateAttrib(type, elementSize, dataPointer, firstVertex, numVertices);
     if (indexh>-1) 
-        _VBOh.updateAttrib(type, elementSize, dataPointer);
+        _VBOh.updateAttrib(type, elementSize, dataPointer, firstVertex, numVertices);
 
     #ifndef SL_GLES2
     if (_hasGL3orGreater)
@@ -156,6 +192,34 @@ void SLGLVertexArray::updateAttrib(SLGLAttributeType type,
     #endif
 }
 //-----------------------------------------------------------------------------
+/*! Starts the update of the float attributes of a VAO that was generated with
+the usage BU_stream. Between beginUpdate and endUpdate the float attributes
+can be written at the pointer returned by attribData without an intermediate
+copy (see SLGLVertexBuffer::beginUpdate and SLMesh::transformSkin). Returns
+false if the attributes can't be written directly. Attributes without a
+pointer must be updated with updateAttrib after endUpdate.
+*/
+SLbool SLGLVertexArray::beginUpdate()
+{
+    #ifndef SL_GLES2
+    if (_hasGL3orGreater && _idVAO)
+        glBindVertexArray(_idVAO);
+    #endif
+
+    return _VBOf.beginUpdate() != nullptr;
+}
+//-----------------------------------------------------------------------------
+//! Ends the update started with beginUpdate
+void SLGLVertexArray::endUpdate()
+{
+    _VBOf.endUpdate();
+
+    #ifndef SL_GLES2
+    if (_hasGL3orGreater)
+        glBindVertexArray(0);
+    #endif
+}
+//-----------------------------------------------------------------------------
 /*! Generates the OpenGL objects for the vertex array (if available) and the 
 vertex buffer object. If the input data is an interleaved array (all attribute
 data pointer where identical) also the output buffer will be generated as an
@@ -229,6 +293,7 @@ void SLGLVertexArray::generate(SLuint numVertices,
                      GL_STATIC_DRAW);
         SLGLVertexBuffer::totalBufferCount++;
         SLGLVertexBuffer::totalBufferSize += _numIndices * typeSize;
+        SLGLVertexBuffer::totalBufferSizeFloat += _numIndices * typeSize;
     }
 
     if (_hasGL3orGreater)
@@ -275,7 +340,7 @@ void SLGLVertexArray::drawElementsAs(SLGLPrimitiveType primitiveType,
     glDrawElements(primitiveType, 
                    numIndexes, 
                    _indexDataType, 
-                   (void*)(indexOffset*indexTypeSize));
+                   (void*)(uintptr_t)(indexOffset*indexTypeSize));
     ////////////////////////////////////////////////////
     
     GET_GL_ERROR;
@@ -330,3 +395,21 @@ void SLGLVertexArray::drawArrayAs(SLGLPrimitiveType primitiveType,
     #endif
 }
 //-----------------------------------------------------------------------------
+/*! Returns the matrix that maps an attribute with AE_unorm16 encoding from the
+normalized range [0,1] back to its original range. For all other encodings the
+identity matrix is returned. The range is calculated in generate.
+*/
+SLMat4f SLGLVertexArray::dequantMatrix(SLGLAttributeType type)
+{
+    SLMat4f m;
+    SLint index = _VBOf.attribIndex(type);
+    if (index >= 0)
+    {   SLGLAttribute& a = _VBOf.attribs()[index];
+        if (a.encoding == AE_unorm16)
+        {   m.translate(a.quantMin.x, a.quantMin.y, a.quantMin.z);
+            m.scale(a.quantRange.x, a.quantRange.y, a.quantRange.z);
+        }
+    }
+    return m;
+}
+//-----------------------------------------------------------------------------
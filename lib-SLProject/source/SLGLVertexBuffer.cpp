@@ -19,9 +19,91 @@
 #include <SLScene.h>
 #include <half.hpp>
 
+#if defined(__F16C__) || defined(__AVX2__)
+#define SL_VBO_USE_F16C
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define SL_VBO_USE_NEON
+#include <arm_neon.h>
+#endif
+
 //-----------------------------------------------------------------------------
 SLuint SLGLVertexBuffer::totalBufferSize  = 0;
 SLuint SLGLVertexBuffer::totalBufferCount = 0;
+SLuint SLGLVertexBuffer::totalBufferSizeFloat = 0;
+//-----------------------------------------------------------------------------
+//! Min. NO. of vertices to pack the vertex data in parallel
+static const SLuint SL_VBO_MIN_PARALLEL_VERTICES = 65536;
+//! NO. of vertices a thread packs at once
+static const SLuint SL_VBO_VERTICES_PER_JOB = 16384;
+//-----------------------------------------------------------------------------
+/*!
+Calls job with ranges of vertices [first, last) that cover all numVertices
+vertices. Large ranges are processed on SL::maxThreads() threads that take
+SL_VBO_VERTICES_PER_JOB vertices at once. The main thread does the same work.
+*/
+static void forEachVertexRange(SLuint numVertices, 
+                               function<void(SLuint, SLuint)> job)
+{
+    SLuint numJobs = (numVertices + SL_VBO_VERTICES_PER_JOB-1) / SL_VBO_VERTICES_PER_JOB;
+    SLuint numThreads = numVertices < SL_VBO_MIN_PARALLEL_VERTICES ? 1 : 
+                        min(SL::maxThreads(), numJobs);
+    if (numThreads <= 1)
+    {   job(0, numVertices);
+        return;
+    }
+
+    atomic<SLuint> nextJob(0);
+    auto runJobs = [&]()
+    {   for (SLuint j = nextJob++; j < numJobs; j = nextJob++)
+        {   SLuint first = j * SL_VBO_VERTICES_PER_JOB;
+            job(first, min(first + SL_VBO_VERTICES_PER_JOB, numVertices));
+        }
+    };
+
+    // Start additional threads and do the same work in the main thread
+    vector<thread> threads;
+    for (SLuint t=0; t < numThreads-1; t++)
+        threads.push_back(thread(runJobs));
+    runJobs();
+    for(auto& thread : threads) thread.join();
+}
+//-----------------------------------------------------------------------------
+/*!
+Converts num floats to half floats. With F16C or NEON 4 values are converted
+with one instruction. All paths round to the nearest half float with ties to
+even (see HALF_ROUND_TIES_TO_EVEN in SL.h), so every platform uploads the
+same vertex data.
+*/
+static void floatsToHalfs(const SLfloat* src, SLhalf* dst, SLuint num)
+{
+    SLuint i = 0;
+
+    #if defined(SL_VBO_USE_F16C)
+    for (; i+4 <= num; i+=4)
+        _mm_storel_epi64((__m128i*)(dst+i), 
+                         _mm_cvtps_ph(_mm_loadu_ps(src+i), _MM_FROUND_TO_NEAREST_INT));
+    #elif defined(SL_VBO_USE_NEON)
+    for (; i+4 <= num; i+=4)
+        vst1_u16((uint16_t*)(dst+i), vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src+i))));
+    #endif
+
+    for (; i<num; ++i)
+        dst[i] = half_cast<half, std::round_to_nearest>(src[i]);
+}
+//-----------------------------------------------------------------------------
+/*!
+Copies the elements [first, last) of one attribute with N bytes per element
+into the interleaved buffer dst with the stride strideBytes. The fixed size
+lets the compiler replace the memcpy by a few moves.
+*/
+template<SLuint N>
+static void copyStrided(SLuchar* dst, const SLuchar* src, 
+                        SLuint strideBytes, SLuint first, SLuint last)
+{
+    for (SLuint v=first; v<last; ++v)
+        memcpy(dst + v*strideBytes, src + v*N, N);
+}
 //-----------------------------------------------------------------------------
 //! Constructor initializing with default values
 SLGLVertexBuffer::SLGLVertexBuffer()
@@ -29,9 +111,14 @@ SLGLVertexBuffer::SLGLVertexBuffer()
     _id = 0;
     _numVertices = 0;
     _sizeBytes = 0;
+    _sizeBytesFloat = 0;
     _outputInterleaved = false;
     _usage = BU_stream;
     _dataType = BT_float;
+    _ringSize = 1;
+    _ringIndex = 0;
+    _mapped = nullptr;
+    for (SLint r=0; r<SL_VBO_RING_SIZE; ++r) _ringFences[r] = nullptr;
 }
 //-----------------------------------------------------------------------------
 /*! Deletes the OpenGL objects for the vertex array and the vertex buffer.
@@ -40,11 +127,23 @@ The vector _attribs with the attribute information is not cleared.
 void SLGLVertexBuffer::deleteGL()
 {  
     if (_id)
-    {   glDeleteBuffers(1, &_id);
+    {   
+        #ifndef SL_GLES2
+        for (SLint r=0; r<SL_VBO_RING_SIZE; ++r)
+        {   if (_ringFences[r]) glDeleteSync((GLsync)_ringFences[r]);
+            _ringFences[r] = nullptr;
+        }
+        #endif
+        glDeleteBuffers(1, &_id);
         _id = 0;
         totalBufferCount--;
-        totalBufferSize -= _sizeBytes;
+        totalBufferSize -= _sizeBytes * _ringSize;
+        totalBufferSizeFloat -= _sizeBytesFloat;
     }
+    _ringSize = 1;
+    _ringIndex = 0;
+    _mapped = nullptr;
+    _staging.clear();
 }
 //-----------------------------------------------------------------------------
 void SLGLVertexBuffer::clear(SLGLBufferType dataType) 
@@ -65,10 +164,15 @@ SLint SLGLVertexBuffer::attribIndex(SLGLAttributeType type)
 /*! Updates the specified vertex attribute. This works only for sequential 
 attributes and not for interleaved attributes. This is used e.g. for meshes
 with vertex skinning. See SLMesh::draw where we have joint attributes.
+If numVertices is greater zero only the range of vertices starting at
+firstVertex is uploaded with glBufferSubData. In a ring buffer the data is
+written into the region that is currently used for drawing.
 */
 void SLGLVertexBuffer::updateAttrib(SLGLAttributeType type, 
                                     SLint elementSize,
-                                    void* dataPointer)
+                                    void* dataPointer,
+                                    SLuint firstVertex,
+                                    SLuint numVertices)
 {   
     assert(dataPointer && "No data pointer passed");
     assert(elementSize > 0 && elementSize < 5 && "Element size invalid");
@@ -81,6 +185,12 @@ void SLGLVertexBuffer::updateAttrib(SLGLAttributeType type,
         SL_EXIT_MSG("Attribute element size differs.");
     if (_outputInterleaved)
         SL_EXIT_MSG("Interleaved buffers can't be updated.");
+    if (numVertices == 0)
+    {   firstVertex = 0;
+        numVertices = _numVertices;
+    }
+    if (firstVertex + numVertices > _numVertices)
+        SL_EXIT_MSG("Vertex range exceeds the VBO.");
 
     // Generate the vertex buffer object if there is none
     if (index && !_id)
@@ -89,24 +199,16 @@ void SLGLVertexBuffer::updateAttrib(SLGLAttributeType type,
     
     _attribs[index].dataPointer = dataPointer;
 
-    /////////////////////////
-    // Convert to Half Floats
-    /////////////////////////
-
-    SLVhalf halfs;
-
-    if (_dataType == BT_half)
-    {   
-        // Create a new array on the heap that must be deleted after glBufferData
-        SLint numHalfs = _numVertices * _attribs[index].elementSize;
-        halfs.resize(numHalfs);
+    ///////////////////////////////////////////////////
+    // Encode to half floats or normalized integers
+    // The range of AE_unorm16 attributes is not changed
+    ///////////////////////////////////////////////////
 
-        // Convert all float to half floats
-        for (SLint h=0; h<numHalfs; ++h)
-            halfs[h] = half_cast<half>(((SLfloat*)_attribs[index].dataPointer)[h]);
+    SLVuchar encoded;
 
-        // Replace the data pointer
-        _attribs[index].dataPointer = &halfs[0];
+    if (_attribs[index].encoding != AE_float)
+    {   encode(_attribs[index], encoded, false);
+        _attribs[index].dataPointer = &encoded[0];
     }
     
 
@@ -114,19 +216,22 @@ void SLGLVertexBuffer::updateAttrib(SLGLAttributeType type,
     // copy sub-data into existing buffer object
     ////////////////////////////////////////////
 
+    SLuint elementSizeBytes = sizeOfElement(_attribs[index]);
+
     glBindBuffer(GL_ARRAY_BUFFER, _id);
     glBufferSubData(GL_ARRAY_BUFFER,
-                    _attribs[index].offsetBytes,
-                    _attribs[index].bufferSizeBytes,
-                    _attribs[index].dataPointer);
+                    _attribs[index].offsetBytes + firstVertex*elementSizeBytes +
+                    _ringIndex*_sizeBytes,
+                    numVertices*elementSizeBytes,
+                    (SLuchar*)_attribs[index].dataPointer + firstVertex*elementSizeBytes);
     
 
     ///////////////////////////////////
-    // Delete the converted half floats
+    // Delete the encoded attribute data
     ///////////////////////////////////
 
-    if (_dataType == BT_half)
-    {   halfs.clear();
+    if (_attribs[index].encoding != AE_float)
+    {   encoded.clear();
         _attribs[index].dataPointer = 0;
     }
 
@@ -194,17 +299,23 @@ void SLGLVertexBuffer::generate(SLuint numVertices,
         }
     }
 
+    // Interleaved input data can not be encoded
+    if (inputIsInterleaved)
+        for (auto& a : _attribs)
+            a.encoding = AE_float;
+
     ///////////////////////////////////////////////////////
     // Calculate total VBO size & attribute stride & offset
     ///////////////////////////////////////////////////////
 
     _sizeBytes = 0;
+    _sizeBytesFloat = 0;
     _strideBytes = 0;
 
     if (inputIsInterleaved)
     {   _outputInterleaved = true;
         for (SLint i=0; i<_attribs.size(); ++i) 
-        {   SLuint elementSizeBytes = _attribs[i].elementSize * sizeOfType(_dataType);
+        {   SLuint elementSizeBytes = sizeOfElement(_attribs[i]);
             _attribs[i].offsetBytes = _strideBytes;
             _attribs[i].bufferSizeBytes = elementSizeBytes * _numVertices;
             _sizeBytes += _attribs[i].bufferSizeBytes;
@@ -214,7 +325,7 @@ void SLGLVertexBuffer::generate(SLuint numVertices,
     else // input is in separate attribute data blocks
     {
         for (SLint i=0; i<_attribs.size(); ++i) 
-        {   SLuint elementSizeBytes = _attribs[i].elementSize * sizeOfType(_dataType);
+        {   SLuint elementSizeBytes = sizeOfElement(_attribs[i]);
             if (_outputInterleaved)
                  _attribs[i].offsetBytes = _strideBytes;
             else _attribs[i].offsetBytes = _sizeBytes;
@@ -224,23 +335,22 @@ void SLGLVertexBuffer::generate(SLuint numVertices,
         }
     }
 
+    for (auto a : _attribs)
+        _sizeBytesFloat += a.elementSize * sizeof(SLfloat) * _numVertices;
 
-    /////////////////////////
-    // Convert to Half Floats
-    /////////////////////////
 
-    if (_dataType == BT_half)
-    {   for (SLint i=0; i < _attribs.size(); ++i)
-        {   // Create a new array on the heap that must be deleted after glBufferData
-            SLint numHalfs = _numVertices * _attribs[i].elementSize;
-            SLhalf* pHalfs = new SLhalf[numHalfs];
+    ////////////////////////////////////////////////
+    // Encode to half floats or normalized integers
+    ////////////////////////////////////////////////
 
-            // Convert all float to half floats
-            for (SLint h=0; h<numHalfs; ++h)
-                pHalfs[h] = half_cast<half>(((SLfloat*)_attribs[i].dataPointer)[h]);
+    vector<SLVuchar> encoded(_attribs.size());
+
+    for (SLint i=0; i < _attribs.size(); ++i)
+    {   if (_attribs[i].encoding != AE_float)
+        {   encode(_attribs[i], encoded[i], true);
 
             // Replace the data pointer
-            _attribs[i].dataPointer = pHalfs;
+            _attribs[i].dataPointer = &encoded[i][0];
         }
     }
 
@@ -253,18 +363,9 @@ void SLGLVertexBuffer::generate(SLuint numVertices,
     {
         for (auto a : _attribs)
         {   
+            // Sets the vertex attribute data pointer to its corresponding GLSL variable
             if (a.location > -1)
-            {   // Sets the vertex attribute data pointer to its corresponding GLSL variable
-                glVertexAttribPointer(a.location, 
-                                      a.elementSize, 
-                                      _dataType,
-                                      GL_FALSE, 
-                                      _strideBytes,
-                                      (void*)a.offsetBytes);
-        
-                // Tell the attribute to be an array attribute instead of a state variable
-                glEnableVertexAttribArray(a.location);
-            }
+                attribPointer(a);
         }
 
         // generate the interleaved VBO buffer on the GPU
@@ -277,32 +378,29 @@ void SLGLVertexBuffer::generate(SLuint numVertices,
             SLVuchar data; 
             data.resize(_sizeBytes);
 
-            for (auto a : _attribs)
-            {   
-                SLuint elementSizeBytes = a.elementSize * sizeOfType(_dataType);
-
-                // Copy attributes interleaved
-                for (SLuint v = 0; v < _numVertices; ++v)
-                {   SLuint iDst = v * _strideBytes + a.offsetBytes;
-                    SLuint iSrc = v * elementSizeBytes;
-                    for (SLuint b = 0; b < elementSizeBytes; ++b)
-                        data[iDst+b] = ((SLuchar*)a.dataPointer)[iSrc+b];
+            // Copy the attributes interleaved in vertex ranges
+            forEachVertexRange(_numVertices, [&](SLuint first, SLuint last)
+            {   for (auto& a : _attribs)
+                {   SLuchar* dst = &data[a.offsetBytes];
+                    SLuchar* src = (SLuchar*)a.dataPointer;
+                    switch (sizeOfElement(a))
+                    {   case  4: copyStrided< 4>(dst, src, _strideBytes, first, last); break;
+                        case  8: copyStrided< 8>(dst, src, _strideBytes, first, last); break;
+                        case 12: copyStrided<12>(dst, src, _strideBytes, first, last); break;
+                        case 16: copyStrided<16>(dst, src, _strideBytes, first, last); break;
+                        default: 
+                        {   SLuint n = sizeOfElement(a);
+                            for (SLuint v=first; v<last; ++v)
+                                memcpy(dst + v*_strideBytes, src + v*n, n);
+                        }
+                    }
                 }
+            });
 
+            // Sets the vertex attribute data pointer to its corresponding GLSL variable
+            for (auto a : _attribs)
                 if (a.location > -1)
-                {   // Sets the vertex attribute data pointer to its corresponding GLSL variable
-                    glVertexAttribPointer(a.location, 
-                                          a.elementSize, 
-                                          _dataType,
-                                          GL_FALSE, 
-                                          _strideBytes,
-                                          (void*)a.offsetBytes);
-        
-                    // Tell the attribute to be an array attribute instead of a state variable
-                    glEnableVertexAttribArray(a.location);
-
-                }
-            }
+                    attribPointer(a);
 
             // generate the interleaved VBO buffer on the GPU
             glBufferData(GL_ARRAY_BUFFER, _sizeBytes, &data[0], _usage);
@@ -322,15 +420,7 @@ void SLGLVertexBuffer::generate(SLuint numVertices,
                                     a.dataPointer);
         
                     // Sets the vertex attribute data pointer to its corresponding GLSL variable
-                    glVertexAttribPointer(a.location, 
-                                          a.elementSize, 
-                                          _dataType,
-                                          GL_FALSE, 
-                                          0,
-                                          (void*)a.offsetBytes);
-        
-                    // Tell the attribute to be an array attribute instead of a state variable
-                    glEnableVertexAttribArray(a.location);
+                    attribPointer(a);
                 }
             }
         }
@@ -338,17 +428,23 @@ void SLGLVertexBuffer::generate(SLuint numVertices,
 
     totalBufferCount++;
     totalBufferSize += _sizeBytes;
+    totalBufferSizeFloat += _sizeBytesFloat;
+
+    // Keep a CPU copy for streamed updates without buffer mapping
+    if (_usage == BU_stream && !_outputInterleaved && !hasRingSupport())
+    {   _staging.resize(_sizeBytes);
+        for (auto a : _attribs)
+            memcpy(&_staging[a.offsetBytes], a.dataPointer, a.bufferSizeBytes);
+    }
 
 
     ///////////////////////////////////
-    // Delete the converted half floats
+    // Delete the encoded attribute data
     ///////////////////////////////////
 
-    if (_dataType == BT_half)
-    {   for (SLint i=0; i < _attribs.size(); ++i)
-        {   delete[] _attribs[i].dataPointer;
+    for (SLint i=0; i < _attribs.size(); ++i)
+    {   if (_attribs[i].encoding != AE_float)
             _attribs[i].dataPointer = 0;
-        }
     }
     
     #ifdef _GLDEBUG
@@ -356,6 +452,134 @@ void SLGLVertexBuffer::generate(SLuint numVertices,
     #endif
 }
 //-----------------------------------------------------------------------------
+/*! Starts the update of a sequential VBO with the usage BU_stream and returns
+the pointer to the first byte of the writable vertex data. The float
+attributes can be written directly at SLGLVertexBuffer::attribData. Parts that
+are not written keep their data. With ring support the region after the one
+used for drawing is mapped unsynchronized. Before, a fence is set for the
+drawing region and the fence of the next region is waited for, which only
+blocks if the GPU is more than SL_VBO_RING_SIZE-1 updates behind. Without ring
+support the CPU copy of the buffer is returned. It returns nullptr if the VBO
+can't be streamed. endUpdate must be called in any case.
+*/
+SLuchar* SLGLVertexBuffer::beginUpdate()
+{
+    assert(!_mapped && "SLGLVertexBuffer::beginUpdate: endUpdate is missing");
+    if (!_id || _usage != BU_stream || _outputInterleaved) 
+        return nullptr;
+
+    #ifndef SL_GLES2
+    if (hasRingSupport())
+    {   if (_ringSize == 1) createRing();
+        glBindBuffer(GL_ARRAY_BUFFER, _id);
+
+        // Fence the region that was used for drawing since the last update
+        if (_ringFences[_ringIndex]) 
+            glDeleteSync((GLsync)_ringFences[_ringIndex]);
+        _ringFences[_ringIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        // Wait until the GPU has finished reading the next region
+        _ringIndex = (_ringIndex + 1) % _ringSize;
+        if (_ringFences[_ringIndex])
+        {   GLsync fence = (GLsync)_ringFences[_ringIndex];
+            GLenum result;
+            do result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            while (result == GL_TIMEOUT_EXPIRED);
+            glDeleteSync(fence);
+            _ringFences[_ringIndex] = nullptr;
+        }
+
+        _mapped = (SLuchar*)glMapBufferRange(GL_ARRAY_BUFFER, 
+                                             _ringIndex*_sizeBytes, 
+                                             _sizeBytes,
+                                             GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        #ifdef _GLDEBUG
+        GET_GL_ERROR;
+        #endif
+        return _mapped;
+    }
+    #endif
+
+    if (_staging.size())
+        _mapped = &_staging[0];
+    return _mapped;
+}
+//-----------------------------------------------------------------------------
+/*! Ends the update started with beginUpdate. A ring buffer gets unmapped and
+the attribute pointers are moved to the written region. For this the VAO must
+be bound. The CPU copy is uploaded with glBufferData so that the driver can
+orphan the storage that is still in use by the GPU.
+*/
+void SLGLVertexBuffer::endUpdate()
+{
+    if (!_id) return;
+    glBindBuffer(GL_ARRAY_BUFFER, _id);
+
+    if (_ringSize > 1)
+    {   
+        #ifndef SL_GLES2
+        if (_mapped) glUnmapBuffer(GL_ARRAY_BUFFER);
+        #endif
+        for (auto& a : _attribs)
+            if (a.location > -1)
+                attribPointer(a);
+    } else if (_mapped)
+        glBufferData(GL_ARRAY_BUFFER, _sizeBytes, _mapped, _usage);
+
+    _mapped = nullptr;
+
+    #ifdef _GLDEBUG
+    GET_GL_ERROR;
+    #endif
+}
+//-----------------------------------------------------------------------------
+/*! Returns the pointer to the data of a float attribute in the region that is
+written between beginUpdate and endUpdate or nullptr if the attribute is not
+stored as float in this buffer.
+*/
+void* SLGLVertexBuffer::attribData(SLGLAttributeType type)
+{
+    SLint index = attribIndex(type);
+    if (!_mapped || index < 0 || _attribs[index].encoding != AE_float)
+        return nullptr;
+    return _mapped + _attribs[index].offsetBytes;
+}
+//-----------------------------------------------------------------------------
+/*! Reallocates the VBO with SL_VBO_RING_SIZE regions and copies the vertex
+data into each region on the GPU.
+*/
+void SLGLVertexBuffer::createRing()
+{
+    #ifndef SL_GLES2
+    GLuint ringID;
+    glGenBuffers(1, &ringID);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ringID);
+    glBufferData(GL_COPY_WRITE_BUFFER, SL_VBO_RING_SIZE * _sizeBytes, nullptr, _usage);
+    glBindBuffer(GL_COPY_READ_BUFFER, _id);
+    for (SLuint r=0; r<SL_VBO_RING_SIZE; ++r)
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            0, r * _sizeBytes, _sizeBytes);
+    glDeleteBuffers(1, &_id);
+
+    _id = ringID;
+    _ringSize = SL_VBO_RING_SIZE;
+    _ringIndex = 0;
+    totalBufferSize += (SL_VBO_RING_SIZE-1) * _sizeBytes;
+    #endif
+}
+//-----------------------------------------------------------------------------
+//! Returns true if buffer mapping, copies and fences are available
+SLbool SLGLVertexBuffer::hasRingSupport()
+{
+    #ifdef SL_GLES2
+    return false;
+    #else
+    SLGLState* stateGL = SLGLState::getInstance();
+    return stateGL->glIsES3() || 
+           (!stateGL->glIsES2() && stateGL->glVersionNOf() >= 3.2f);
+    #endif
+}
+//-----------------------------------------------------------------------------
 /*! This method is only used by SLGLVertexArray drawing methods for OpenGL
 contexts prior to 3.0 where vertex array objects did not exist. This is the 
 additional overhead that had to be done per draw call.
@@ -367,19 +591,9 @@ void SLGLVertexBuffer::bindAndEnableAttrib()
         glBindBuffer(GL_ARRAY_BUFFER, _id);
 
         for (auto a : _attribs)
-        {   if (a.location > -1)
-            {
-                // Sets the vertex attribute data pointer to its corresponding GLSL variable
-                glVertexAttribPointer(a.location, 
-                                        a.elementSize,
-                                        _dataType, 
-                                        GL_FALSE, 
-                                        _strideBytes, 
-                                        (void*)a.offsetBytes);
-
-                // Tell the attribute to be an array attribute instead of a state variable
-                glEnableVertexAttribArray(a.location);
-            }
+        {   // Sets the vertex attribute data pointer to its corresponding GLSL variable
+            if (a.location > -1)
+                attribPointer(a);
         }
     }
 }
@@ -410,3 +624,157 @@ SLint SLGLVertexBuffer::sizeOfType(SLGLBufferType type)
     return 0;
 }
 //-----------------------------------------------------------------------------
+/*! Returns the size in bytes of one element of an attribute in the buffer.
+Attributes with an odd number of 16 bit components and all 8 bit attributes
+are padded to keep the elements 4 byte aligned.
+*/
+SLint SLGLVertexBuffer::sizeOfElement(const SLGLAttribute& a)
+{
+    switch (a.encoding)
+    {   case AE_float:   return a.elementSize * sizeof(SLfloat);
+        case AE_half:    return a.elementSize * sizeof(SLhalf);
+        case AE_unorm16: 
+        case AE_snorm16: return ((a.elementSize + 1) & ~1) * sizeof(SLushort);
+        case AE_unorm8:  return 4;
+        case AE_snorm10: return 4;
+        default: SL_EXIT_MSG("Invalid attribute encoding");
+    }
+    return 0;
+}
+//-----------------------------------------------------------------------------
+/*! Encodes the float data of the attribute into the byte vector data with the
+attributes encoding. For AE_unorm16 the min. value and the range per component
+are calculated if calcRange is true. Otherwise the previous range is used and
+values outside are clamped.
+*/
+void SLGLVertexBuffer::encode(SLGLAttribute& a, 
+                              SLVuchar& data,
+                              SLbool calcRange)
+{
+    SLfloat* src = (SLfloat*)a.dataPointer;
+    SLint    n = a.elementSize;
+    SLint    esize = sizeOfElement(a);
+    data.resize(_numVertices * esize);
+    memset(&data[0], 0, data.size());
+
+    switch (a.encoding)
+    {   
+        case AE_half:
+        {   SLhalf* dst = (SLhalf*)&data[0];
+            forEachVertexRange(_numVertices, [&](SLuint first, SLuint last)
+            {   floatsToHalfs(src + first*n, dst + first*n, (last-first)*n);
+            });
+            break;
+        }
+        case AE_unorm16:
+        {   if (calcRange)
+            {   SLVec4f maxV;
+                for (SLint c=0; c < n; ++c)
+                {   a.quantMin.comp[c] = FLT_MAX;
+                    maxV.comp[c] = -FLT_MAX;
+                }
+                for (SLuint v=0; v < _numVertices; ++v)
+                {   for (SLint c=0; c < n; ++c)
+                    {   SLfloat f = src[v*n + c];
+                        if (f < a.quantMin.comp[c]) a.quantMin.comp[c] = f;
+                        if (f > maxV.comp[c]) maxV.comp[c] = f;
+                    }
+                }
+                for (SLint c=0; c < 4; ++c)
+                {   if (c < n)
+                    {   a.quantRange.comp[c] = maxV.comp[c] - a.quantMin.comp[c];
+                        if (a.quantRange.comp[c] <= 0.0f) a.quantRange.comp[c] = 1.0f;
+                    } else
+                    {   a.quantMin.comp[c] = 0.0f;
+                        a.quantRange.comp[c] = 1.0f;
+                    }
+                }
+            }
+            
+            SLint stride = esize / sizeof(SLushort);
+            SLushort* dst = (SLushort*)&data[0];
+            forEachVertexRange(_numVertices, [&](SLuint first, SLuint last)
+            {   for (SLuint v=first; v < last; ++v)
+                {   for (SLint c=0; c < n; ++c)
+                    {   SLfloat f = (src[v*n + c] - a.quantMin.comp[c]) / a.quantRange.comp[c];
+                        dst[v*stride + c] = (SLushort)(SL_clamp(f, 0.0f, 1.0f) * 65535.0f + 0.5f);
+                    }
+                }
+            });
+            break;
+        }
+        case AE_snorm16:
+        {   SLint stride = esize / sizeof(SLshort);
+            SLshort* dst = (SLshort*)&data[0];
+            forEachVertexRange(_numVertices, [&](SLuint first, SLuint last)
+            {   for (SLuint v=first; v < last; ++v)
+                    for (SLint c=0; c < n; ++c)
+                        dst[v*stride + c] = (SLshort)floor(SL_clamp(src[v*n + c], -1.0f, 1.0f) * 32767.0f + 0.5f);
+            });
+            break;
+        }
+        case AE_unorm8:
+        {   SLuchar* dst = &data[0];
+            forEachVertexRange(_numVertices, [&](SLuint first, SLuint last)
+            {   for (SLuint v=first; v < last; ++v)
+                    for (SLint c=0; c < n; ++c)
+                        dst[v*4 + c] = (SLuchar)(SL_clamp(src[v*n + c], 0.0f, 1.0f) * 255.0f + 0.5f);
+            });
+            break;
+        }
+        case AE_snorm10:
+        {   SLuint* dst = (SLuint*)&data[0];
+            forEachVertexRange(_numVertices, [&](SLuint first, SLuint last)
+            {   for (SLuint v=first; v < last; ++v)
+                {   SLfloat* f = &src[v*n];
+                    SLint x = (SLint)floor(SL_clamp(f[0], -1.0f, 1.0f) * 511.0f + 0.5f);
+                    SLint y = (SLint)floor(SL_clamp(f[1], -1.0f, 1.0f) * 511.0f + 0.5f);
+                    SLint z = (SLint)floor(SL_clamp(f[2], -1.0f, 1.0f) * 511.0f + 0.5f);
+                    SLint w = n > 3 ? (SLint)floor(SL_clamp(f[3], -1.0f, 1.0f) + 0.5f) : 0;
+                    dst[v] = ((SLuint)x & 0x3FF)         | 
+                             (((SLuint)y & 0x3FF) << 10) | 
+                             (((SLuint)z & 0x3FF) << 20) | 
+                             (((SLuint)w & 0x3)   << 30);
+                }
+            });
+            break;
+        }
+        default: memcpy(&data[0], src, data.size());
+    }
+}
+//-----------------------------------------------------------------------------
+/*! Sets the vertex attribute pointer with the GL data type of the attributes
+encoding and enables the vertex attribute array. All integer encodings are
+passed as normalized so that they arrive as floats in the shader.
+*/
+void SLGLVertexBuffer::attribPointer(SLGLAttribute& a)
+{
+    GLenum    type = GL_FLOAT;
+    GLboolean normalized = GL_TRUE;
+    GLint     size = a.elementSize;
+
+    switch (a.encoding)
+    {   case AE_float:   type = GL_FLOAT; normalized = GL_FALSE; break;
+        case AE_half:    type = GL_HALF_FLOAT; normalized = GL_FALSE; break;
+        case AE_unorm16: type = GL_UNSIGNED_SHORT; break;
+        case AE_snorm16: type = GL_SHORT; break;
+        case AE_unorm8:  type = GL_UNSIGNED_BYTE; break;
+        #ifdef GL_INT_2_10_10_10_REV
+        case AE_snorm10: type = GL_INT_2_10_10_10_REV; size = 4; break;
+        #endif
+        default: SL_EXIT_MSG("Attribute encoding not supported");
+    }
+
+    SLint stride = _outputInterleaved ? _strideBytes : sizeOfElement(a);
+
+    glVertexAttribPointer(a.location, 
+                          size, 
+                          type,
+                          normalized, 
+                          stride,
+                          (void*)(size_t)(a.offsetBytes + _ringIndex*_sizeBytes));
+        
+    // Tell the attribute to be an array attribute instead of a state variable
+    glEnableVertexAttribArray(a.location);
+}
+//-----------------------------------------------------------------------------
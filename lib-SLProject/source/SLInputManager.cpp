@@ -27,6 +27,17 @@ SLInputManager& SLInputManager::instance()
     return _instance;
 }
 
+//-----------------------------------------------------------------------------
+/*! The constructor marks all slots of the event ring as free for the first
+round. */
+SLInputManager::SLInputManager() : _tail(0), _head(0),
+                                   _numQueued(0), _numDropped(0),
+                                   _numCoalesced(0), _maxFill(0)
+{
+    for (SLuint i=0; i<SL_INPUT_QUEUE_SIZE; ++i)
+        _slots[i].seq.store(i, memory_order_relaxed);
+}
+
 //-----------------------------------------------------------------------------
 /*! Sends any queued up system event's to their correct receiver and
 polls all activated SLInputDevices. 
@@ -55,59 +66,127 @@ SLbool SLInputManager::pollEvents()
 }
 
 //-----------------------------------------------------------------------------
-/*! Add a new SLInputEvent to the event queue. The queue will be emtied when
-a call to SLInputManager::pollEvents is made. The passed in SLInputEvents have 
-to be dynamically allocated by the user, the deallocation is handled by the
-SLInputManager */
-void SLInputManager::queueEvent(const SLInputEvent* e)
+/*! Copies an SLInputEvent into the event ring. The ring will be emptied when
+a call to SLInputManager::pollEvents is made. queueEvent may be called from any
+thread. A producer claims the slot at the tail if its sequence number shows
+that the consumer has freed it in the last round. The event is published by
+setting the sequence number to the position + 1 with release semantics. If
+the ring is full the event gets dropped and false is returned. */
+SLbool SLInputManager::queueEvent(const SLInputEvent& e)
 {
-    _systemEvents.push(e);
+    SLuint pos = _tail.load(memory_order_relaxed);
+    SLInputEventSlot* slot;
+
+    for (;;)
+    {   slot = &_slots[pos & (SL_INPUT_QUEUE_SIZE-1)];
+        SLint diff = (SLint)(slot->seq.load(memory_order_acquire) - pos);
+        if (diff == 0)
+        {   // slot is free: try to claim it
+            if (_tail.compare_exchange_weak(pos, pos+1, memory_order_relaxed))
+                break;
+        } else
+        if (diff < 0)
+        {   // slot still holds the event of the last round: ring is full
+            _numDropped.fetch_add(1, memory_order_relaxed);
+            return false;
+        } else pos = _tail.load(memory_order_relaxed);
+    }
+
+    slot->event = e;
+    slot->seq.store(pos+1, memory_order_release);
+
+    // Statistics
+    _numQueued.fetch_add(1, memory_order_relaxed);
+    SLuint fill = pos + 1 - _head.load(memory_order_relaxed);
+    SLuint maxFill = _maxFill.load(memory_order_relaxed);
+    while (fill > maxFill && fill <= SL_INPUT_QUEUE_SIZE &&
+           !_maxFill.compare_exchange_weak(maxFill, fill, memory_order_relaxed));
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/*! Returns the oldest published event without removing it or a null pointer if
+there is none. Only the consumer thread may call it. The event stays valid
+until the next popEvent. */
+const SLInputEvent* SLInputManager::peekEvent()
+{
+    SLuint pos = _head.load(memory_order_relaxed);
+    SLInputEventSlot& slot = _slots[pos & (SL_INPUT_QUEUE_SIZE-1)];
+    if (slot.seq.load(memory_order_acquire) != pos+1) return nullptr;
+    return &slot.event;
+}
+
+//-----------------------------------------------------------------------------
+/*! Copies the oldest published event out of the ring and frees its slot for
+the next round by setting the sequence number to the position + ring size.
+Only the consumer thread may call it. */
+SLbool SLInputManager::popEvent(SLInputEvent& e)
+{
+    SLuint pos = _head.load(memory_order_relaxed);
+    SLInputEventSlot& slot = _slots[pos & (SL_INPUT_QUEUE_SIZE-1)];
+    if (slot.seq.load(memory_order_acquire) != pos+1) return false;
+
+    e = slot.event;
+    slot.seq.store(pos + SL_INPUT_QUEUE_SIZE, memory_order_release);
+    _head.store(pos+1, memory_order_relaxed);
+    return true;
 }
 
 //-----------------------------------------------------------------------------
 /*! Work off any queued up input event's and notify the correct receiver.
+Successive MouseMove or Touch2Move events of the same scene view are coalesced
+into the latest one because only the latest position matters. At most one ring
+full of events is worked off per call so that a producer that queues faster
+than we dispatch can't block the frame.
 @note   this is similar to the Qt QObject::event function.*/
 SLbool SLInputManager::processQueuedEvents()
 {
-    SLQInputEvent& q = _systemEvents;
-
     // flag if an event has been consumed by a receiver
     SLbool eventConsumed = false;
+    SLInputEvent e;
 
-    while (!q.empty())
+    for (SLuint n=0; n<SL_INPUT_QUEUE_SIZE && popEvent(e); ++n)
     {
-        const SLInputEvent* e = q.front();
-        q.pop();
+        // Coalesce successive move events
+        if (e.type == SLInputEvent::MouseMove ||
+            e.type == SLInputEvent::Touch2Move)
+        {   const SLInputEvent* next;
+            while ((next = peekEvent()) && 
+                   next->type == e.type && 
+                   next->svIndex == e.svIndex)
+            {   popEvent(e);
+                _numCoalesced.fetch_add(1, memory_order_relaxed);
+            }
+        }
 
-        SLSceneView* sv = SLScene::current->sv(e->svIndex);
+        SLSceneView* sv = SLScene::current->sv(e.svIndex);
         
         if (sv)
-        {   switch (e->type)
+        {   switch (e.type)
             {
-                case SLInputEvent::Command:            { const SLCommandEvent* ce = (const SLCommandEvent*)e; eventConsumed |= sv->onCommand(ce->cmd); } break;
+                case SLInputEvent::Command:            eventConsumed |= sv->onCommand(e.command.cmd); break;
 
-                case SLInputEvent::MouseMove:          { const SLMouseEvent* me = (const SLMouseEvent*)e; eventConsumed |= sv->onMouseMove(me->x, me->y); } break;
-                case SLInputEvent::MouseDown:          { const SLMouseEvent* me = (const SLMouseEvent*)e; eventConsumed |= sv->onMouseDown(me->button, me->x, me->y, me->modifier); } break;
-                case SLInputEvent::MouseUp:            { const SLMouseEvent* me = (const SLMouseEvent*)e; eventConsumed |= sv->onMouseUp(me->button, me->x, me->y, me->modifier); } break;
-                case SLInputEvent::MouseDoubleClick:   { const SLMouseEvent* me = (const SLMouseEvent*)e; eventConsumed |= sv->onDoubleClick(me->button, me->x, me->y, me->modifier); } break;
-                case SLInputEvent::MouseWheel:         { const SLMouseEvent* me = (const SLMouseEvent*)e; eventConsumed |= sv->onMouseWheel(me->y, me->modifier); } break;
-                case SLInputEvent::LongTouch:          { const SLMouseEvent* me = (const SLMouseEvent*)e; eventConsumed |= sv->onLongTouch(me->x, me->y); } break;
+                case SLInputEvent::MouseMove:          eventConsumed |= sv->onMouseMove(e.mouse.x, e.mouse.y); break;
+                case SLInputEvent::MouseDown:          eventConsumed |= sv->onMouseDown(e.mouse.button, e.mouse.x, e.mouse.y, e.mouse.modifier); break;
+                case SLInputEvent::MouseUp:            eventConsumed |= sv->onMouseUp(e.mouse.button, e.mouse.x, e.mouse.y, e.mouse.modifier); break;
+                case SLInputEvent::MouseDoubleClick:   eventConsumed |= sv->onDoubleClick(e.mouse.button, e.mouse.x, e.mouse.y, e.mouse.modifier); break;
+                case SLInputEvent::MouseWheel:         eventConsumed |= sv->onMouseWheel(e.mouse.y, e.mouse.modifier); break;
+                case SLInputEvent::LongTouch:          eventConsumed |= sv->onLongTouch(e.mouse.x, e.mouse.y); break;
 
-                case SLInputEvent::Touch2Move:         { const SLTouchEvent* te = (const SLTouchEvent*)e; eventConsumed |= sv->onTouch2Move(te->x1, te->y1, te->x2, te->y2); } break;
-                case SLInputEvent::Touch2Down:         { const SLTouchEvent* te = (const SLTouchEvent*)e; eventConsumed |= sv->onTouch2Down(te->x1, te->y1, te->x2, te->y2); } break;
-                case SLInputEvent::Touch2Up:           { const SLTouchEvent* te = (const SLTouchEvent*)e; eventConsumed |= sv->onTouch2Up(te->x1, te->y1, te->x2, te->y2); } break;
+                case SLInputEvent::Touch2Move:         eventConsumed |= sv->onTouch2Move(e.touch.x1, e.touch.y1, e.touch.x2, e.touch.y2); break;
+                case SLInputEvent::Touch2Down:         eventConsumed |= sv->onTouch2Down(e.touch.x1, e.touch.y1, e.touch.x2, e.touch.y2); break;
+                case SLInputEvent::Touch2Up:           eventConsumed |= sv->onTouch2Up(e.touch.x1, e.touch.y1, e.touch.x2, e.touch.y2); break;
 
-                case SLInputEvent::KeyDown:            { const SLKeyEvent* ke = (const SLKeyEvent*)e; eventConsumed |= sv->onKeyPress(ke->key, ke->modifier); } break;
-                case SLInputEvent::KeyUp:              { const SLKeyEvent* ke = (const SLKeyEvent*)e; eventConsumed |= sv->onKeyRelease(ke->key, ke->modifier); } break;
+                case SLInputEvent::KeyDown:            eventConsumed |= sv->onKeyPress(e.key.key, e.key.modifier); break;
+                case SLInputEvent::KeyUp:              eventConsumed |= sv->onKeyRelease(e.key.key, e.key.modifier); break;
 
-                case SLInputEvent::Resize:             { const SLResizeEvent* re = (const SLResizeEvent*)e; sv->onResize(re->width, re->height); } break;
+                case SLInputEvent::Resize:             sv->onResize(e.resize.width, e.resize.height); break;
 
-                case SLInputEvent::DeviceRotationPYR:  { const SLRotationEvent* re = (const SLRotationEvent*)e; sv->onRotationPYR(re->x, re->y, re->z, 3.0f); } break;
-                case SLInputEvent::DeviceRotationQUAT: { const SLRotationEvent* re = (const SLRotationEvent*)e; sv->onRotationQUAT(re->x, re->y, re->z, re->w); } break;
+                case SLInputEvent::DeviceRotationPYR:  sv->onRotationPYR(e.rotation.x, e.rotation.y, e.rotation.z, 3.0f); break;
+                case SLInputEvent::DeviceRotationQUAT: sv->onRotationQUAT(e.rotation.x, e.rotation.y, e.rotation.z, e.rotation.w); break;
+                default: break;
             }
         }
-
-        delete e;
     }
 
     return eventConsumed;
@@ -0,0 +1,686 @@
+//#############################################################################
+//  File:      SLLightClusters.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLLightClusters.h>
+#include <SLGLProgram.h>
+#include <SLGLGenericProgram.h>
+#include <SLGLShader.h>
+#include <SLGLState.h>
+#include <SLScene.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SL_CLUSTER_USE_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SL_CLUSTER_USE_NEON
+#include <arm_neon.h>
+#endif
+
+//-----------------------------------------------------------------------------
+//! Light intensity below which a light doesn't influence a cluster
+static const SLfloat SL_CLUSTER_LIGHT_THRESHOLD = 1.0f / 256.0f;
+//! NO. of RGBA texels with the parameters of one light
+static const SLint   SL_CLUSTER_LIGHT_TEXELS = 6;
+//! Width of the light index texture
+static const SLint   SL_CLUSTER_INDEX_TEX_W = 1024;
+//! Max. width of the cluster grid texture (NO. of tiles)
+static const SLint   SL_CLUSTER_MAX_TILES = 4096;
+//! Min. NO. of light cluster tests to start additional threads
+static const SLuint  SL_CLUSTER_MIN_PARALLEL_TESTS = 65536;
+//-----------------------------------------------------------------------------
+/*! Vertex shader of the clustered Blinn-Phong programs. The define
+SL_CLUSTER_TEXTURE gets prepended for the textured variant. The shader code
+contains no comments because some GLSL compilers can't handle them.
+*/
+static const SLchar* clusterVertShader =
+"attribute vec4 a_position;\n"
+"attribute vec3 a_normal;\n"
+"uniform mat4 u_mvMatrix;\n"
+"uniform mat3 u_nMatrix;\n"
+"uniform mat4 u_mvpMatrix;\n"
+"varying vec3 v_P_VS;\n"
+"varying vec3 v_N_VS;\n"
+"#ifdef SL_CLUSTER_TEXTURE\n"
+"attribute vec2 a_texCoord;\n"
+"uniform mat4 u_tMatrix;\n"
+"varying vec2 v_texCoord;\n"
+"#endif\n"
+"\n"
+"void main()\n"
+"{\n"
+"    v_P_VS = vec3(u_mvMatrix * a_position);\n"
+"    v_N_VS = vec3(u_nMatrix * a_normal);\n"
+"#ifdef SL_CLUSTER_TEXTURE\n"
+"    v_texCoord = (u_tMatrix * vec4(a_texCoord, 0.0, 1.0)).xy;\n"
+"#endif\n"
+"    gl_Position = u_mvpMatrix * a_position;\n"
+"}\n";
+//-----------------------------------------------------------------------------
+/*! Fragment shader of the clustered Blinn-Phong programs. It finds the
+cluster of the fragment and evaluates the lights of the cluster with the same
+Blinn-Phong model as PerPixBlinn.frag. The 6 texels of a light i in row i of
+u_clusterLights are: position, ambient, diffuse, specular, spot direction with
+the cosine of the cutoff (-2 for point lights) and the attenuation factors
+with the spot exponent.
+*/
+static const SLchar* clusterFragShader =
+"#ifdef GL_ES\n"
+"precision highp float;\n"
+"precision highp int;\n"
+"precision highp sampler2D;\n"
+"precision highp usampler2D;\n"
+"#endif\n"
+"varying vec3 v_P_VS;\n"
+"varying vec3 v_N_VS;\n"
+"#ifdef SL_CLUSTER_TEXTURE\n"
+"varying vec2 v_texCoord;\n"
+"uniform sampler2D u_texture0;\n"
+"#endif\n"
+"uniform vec4  u_globalAmbient;\n"
+"uniform vec4  u_matAmbient;\n"
+"uniform vec4  u_matDiffuse;\n"
+"uniform vec4  u_matSpecular;\n"
+"uniform vec4  u_matEmissive;\n"
+"uniform float u_matShininess;\n"
+"uniform sampler2D  u_clusterLights;\n"
+"uniform usampler2D u_clusterGrid;\n"
+"uniform usampler2D u_clusterIndices;\n"
+"uniform ivec3 u_clusterSize;\n"
+"uniform float u_clusterTileSize;\n"
+"uniform float u_clusterNear;\n"
+"uniform float u_clusterScale;\n"
+"\n"
+"void main()\n"
+"{\n"
+"    vec3 N = normalize(v_N_VS);\n"
+"    vec3 E = normalize(-v_P_VS);\n"
+"    vec4 Ia = vec4(0.0);\n"
+"    vec4 Id = vec4(0.0);\n"
+"    vec4 Is = vec4(0.0);\n"
+"\n"
+"    ivec2 tile = clamp(ivec2(gl_FragCoord.xy / u_clusterTileSize), ivec2(0), u_clusterSize.xy - 1);\n"
+"    int slice = int(log(max(-v_P_VS.z, u_clusterNear) / u_clusterNear) * u_clusterScale);\n"
+"    slice = clamp(slice, 0, u_clusterSize.z - 1);\n"
+"    uvec2 range = texelFetch(u_clusterGrid, ivec2(tile.x + tile.y*u_clusterSize.x, slice), 0).xy;\n"
+"    int indexTexW = textureSize(u_clusterIndices, 0).x;\n"
+"\n"
+"    for (int i = 0; i < int(range.y); ++i)\n"
+"    {   int k = int(range.x) + i;\n"
+"        int l = int(texelFetch(u_clusterIndices, ivec2(k % indexTexW, k / indexTexW), 0).r);\n"
+"        vec4 pos  = texelFetch(u_clusterLights, ivec2(0, l), 0);\n"
+"        vec4 ambi = texelFetch(u_clusterLights, ivec2(1, l), 0);\n"
+"        vec4 diff = texelFetch(u_clusterLights, ivec2(2, l), 0);\n"
+"        vec4 spec = texelFetch(u_clusterLights, ivec2(3, l), 0);\n"
+"        vec4 spot = texelFetch(u_clusterLights, ivec2(4, l), 0);\n"
+"        vec4 att  = texelFetch(u_clusterLights, ivec2(5, l), 0);\n"
+"\n"
+"        vec3 L = pos.xyz - v_P_VS;\n"
+"        float dist = length(L);\n"
+"        L /= dist;\n"
+"        vec3 H = normalize(L + E);\n"
+"        float diffFactor = max(dot(N, L), 0.0);\n"
+"        float specFactor = 0.0;\n"
+"        if (diffFactor != 0.0)\n"
+"            specFactor = pow(max(dot(N, H), 0.0), u_matShininess);\n"
+"\n"
+"        float spotAtt = 1.0;\n"
+"        if (spot.w > -1.5)\n"
+"        {   float spotDot = dot(-L, spot.xyz);\n"
+"            if (spotDot < spot.w) spotAtt = 0.0;\n"
+"            else spotAtt = max(pow(spotDot, att.w), 0.0);\n"
+"        }\n"
+"\n"
+"        float lightAtt = 1.0 / (att.x + att.y*dist + att.z*dist*dist);\n"
+"        Ia += lightAtt * ambi;\n"
+"        Id += lightAtt * spotAtt * diff * diffFactor;\n"
+"        Is += lightAtt * spotAtt * spec * specFactor;\n"
+"    }\n"
+"\n"
+"#ifdef SL_CLUSTER_TEXTURE\n"
+"    gl_FragColor = (u_globalAmbient + u_matEmissive + Ia*u_matAmbient + Id*u_matDiffuse) *\n"
+"                   texture2D(u_texture0, v_texCoord) + Is*u_matSpecular;\n"
+"#else\n"
+"    gl_FragColor = u_globalAmbient + u_matEmissive + Ia*u_matAmbient + Id*u_matDiffuse + Is*u_matSpecular;\n"
+"#endif\n"
+"    gl_FragColor.a = u_matDiffuse.a;\n"
+"}\n";
+//-----------------------------------------------------------------------------
+SLLightClusters::SLLightClusters()
+{
+    _numX = 0;
+    _numY = 0;
+    _numZ = 0;
+    _tileSize = SL_CLUSTER_TILE_SIZE;
+    _near = 0.0f;
+    _far = 0.0f;
+    _sliceScale = 0.0f;
+    _viewportW = 0;
+    _viewportH = 0;
+    _numLights = 0;
+    _maxPerCluster = 0;
+    _texLights = 0;
+    _texGrid = 0;
+    _texIndices = 0;
+    _texLightsH = 0;
+    _texIndicesH = 0;
+}
+//-----------------------------------------------------------------------------
+SLLightClusters::~SLLightClusters()
+{
+    deleteGL();
+}
+//-----------------------------------------------------------------------------
+//! SLLightClusters::deleteGL deletes the data textures
+void SLLightClusters::deleteGL()
+{
+    if (_texLights)  glDeleteTextures(1, &_texLights);
+    if (_texGrid)    glDeleteTextures(1, &_texGrid);
+    if (_texIndices) glDeleteTextures(1, &_texIndices);
+    _texLights = 0;
+    _texGrid = 0;
+    _texIndices = 0;
+    _texLightsH = 0;
+    _texIndicesH = 0;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLLightClusters::buildBounds sets up the cluster grid for the viewport and
+calculates the view space AABB of each cluster. The 4 corners of a tile are
+unprojected to rays from the near to the far plane. The AABB of a cluster is
+the box around the 8 points where these rays cross the depth planes of its
+slice. This works for perspective and orthographic projections.
+*/
+void SLLightClusters::buildBounds(const SLMat4f& projection,
+                                  SLint viewportW,
+                                  SLint viewportH,
+                                  SLfloat clipNear,
+                                  SLfloat clipFar)
+{
+    _projection = projection;
+    _viewportW = viewportW;
+    _viewportH = viewportH;
+    _near = clipNear;
+    _far = clipFar;
+
+    // The grid texture holds all tiles of a slice in one row
+    _tileSize = SL_CLUSTER_TILE_SIZE;
+    while (((viewportW + _tileSize-1) / _tileSize) *
+           ((viewportH + _tileSize-1) / _tileSize) > SL_CLUSTER_MAX_TILES)
+        _tileSize *= 2;
+
+    _numX = (viewportW + _tileSize-1) / _tileSize;
+    _numY = (viewportH + _tileSize-1) / _tileSize;
+    _numZ = SL_CLUSTER_SLICES;
+    _sliceScale = (SLfloat)_numZ / log(clipFar / clipNear);
+
+    // Rays through the tile corners as points on the near & far plane
+    SLMat4f invP = projection.inverse();
+    SLint numCX = _numX + 1;
+    SLint numCY = _numY + 1;
+    SLVVec3f rayN(numCX*numCY), rayF(numCX*numCY);
+    for (SLint y=0; y<numCY; ++y)
+    {   for (SLint x=0; x<numCX; ++x)
+        {   SLfloat ndcX = 2.0f * (SLfloat)min(x*_tileSize, viewportW) / (SLfloat)viewportW - 1.0f;
+            SLfloat ndcY = 2.0f * (SLfloat)min(y*_tileSize, viewportH) / (SLfloat)viewportH - 1.0f;
+            SLVec4f n = invP * SLVec4f(ndcX, ndcY, -1.0f, 1.0f);
+            SLVec4f f = invP * SLVec4f(ndcX, ndcY,  1.0f, 1.0f);
+            rayN[y*numCX + x].set(n.x/n.w, n.y/n.w, n.z/n.w);
+            rayF[y*numCX + x].set(f.x/f.w, f.y/f.w, f.z/f.w);
+        }
+    }
+
+    _boundsMin.resize(numClusters());
+    _boundsMax.resize(numClusters());
+    for (SLint z=0; z<_numZ; ++z)
+    {   SLfloat depth[2] = {clipNear * pow(clipFar/clipNear, (SLfloat) z   /(SLfloat)_numZ),
+                            clipNear * pow(clipFar/clipNear, (SLfloat)(z+1)/(SLfloat)_numZ)};
+        for (SLint y=0; y<_numY; ++y)
+        {   for (SLint x=0; x<_numX; ++x)
+            {   SLVec3f mn( FLT_MAX,  FLT_MAX,  FLT_MAX);
+                SLVec3f mx(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+                for (SLint c=0; c<4; ++c)
+                {   SLint i = (y + (c>>1))*numCX + x + (c&1);
+                    SLVec3f dir = rayF[i] - rayN[i];
+                    for (SLint d=0; d<2; ++d)
+                    {   SLfloat t = (-depth[d] - rayN[i].z) / dir.z;
+                        SLVec3f p = rayN[i] + dir*t;
+                        mn.set(min(mn.x, p.x), min(mn.y, p.y), min(mn.z, p.z));
+                        mx.set(max(mx.x, p.x), max(mx.y, p.y), max(mx.z, p.z));
+                    }
+                }
+                SLuint c = (SLuint)((z*_numY + y)*_numX + x);
+                _boundsMin[c] = mn;
+                _boundsMax[c] = mx;
+            }
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+SLLightClusters::assign assigns the view space lights to the clusters of the
+viewport. The cluster bounds are only rebuilt if the projection, the viewport
+or the clipping planes changed. The light indices refer to the passed vector.
+*/
+void SLLightClusters::assign(const SLMat4f& projection,
+                             SLint viewportW,
+                             SLint viewportH,
+                             SLfloat clipNear,
+                             SLfloat clipFar,
+                             const SLVClusterLight& lights)
+{
+    assert(viewportW > 0 && viewportH > 0 && clipNear > 0.0f && clipFar > clipNear);
+
+    if (viewportW != _viewportW || viewportH != _viewportH ||
+        clipNear != _near || clipFar != _far ||
+        memcmp(projection.m(), _projection.m(), 16*sizeof(SLfloat)) != 0)
+        buildBounds(projection, viewportW, viewportH, clipNear, clipFar);
+
+    _numLights = (SLuint)lights.size();
+    _grid.assign(numClusters()*2, 0);
+    _sliceIndices.resize(_numZ);
+
+    // Assign the depth slices in parallel
+    SLint numThreads = _numLights * numClusters() < SL_CLUSTER_MIN_PARALLEL_TESTS ? 1 :
+                       min((SLint)SL::maxThreads(), _numZ);
+    if (numThreads <= 1)
+    {   for (SLint z=0; z<_numZ; ++z) assignSlice(z, lights);
+    } else
+    {   atomic<SLint> nextSlice(0);
+        auto runJobs = [&]()
+        {   for (SLint z = nextSlice++; z < _numZ; z = nextSlice++)
+                assignSlice(z, lights);
+        };
+
+        // Start additional threads and do the same work in the main thread
+        vector<thread> threads;
+        for (SLint t=0; t < numThreads-1; t++)
+            threads.push_back(thread(runJobs));
+        runJobs();
+        for(auto& thread : threads) thread.join();
+    }
+
+    // Concatenate the index lists of the slices
+    SLuint numIndices = 0;
+    for (auto& slice : _sliceIndices) numIndices += (SLuint)slice.size();
+    _indices.resize(numIndices);
+
+    SLuint base = 0;
+    SLuint clustersPerSlice = (SLuint)(_numX*_numY);
+    _maxPerCluster = 0;
+    for (SLint z=0; z<_numZ; ++z)
+    {   SLVuint& slice = _sliceIndices[z];
+        if (slice.size())
+            memcpy(&_indices[base], &slice[0], slice.size()*sizeof(SLuint));
+        for (SLuint c=z*clustersPerSlice; c<(z+1)*clustersPerSlice; ++c)
+        {   _grid[c*2] += base;
+            _maxPerCluster = max(_maxPerCluster, _grid[c*2+1]);
+        }
+        base += (SLuint)slice.size();
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+SLLightClusters::assignSlice tests the lights that overlap the depth range of
+slice z against all its clusters. The sphere of influence is tested against
+the cluster AABB for 4 lights at once. Spot lights with a cutoff below 90
+degrees are then tested with their cone against the bounding sphere of the
+cluster. The indices of the lights of the slice are written into
+_sliceIndices[z] and the local offset & count of each cluster into _grid.
+*/
+void SLLightClusters::assignSlice(SLint z, const SLVClusterLight& lights)
+{
+    SLVuint& out = _sliceIndices[z];
+    out.clear();
+
+    SLfloat d0 = _near * pow(_far/_near, (SLfloat) z   /(SLfloat)_numZ);
+    SLfloat d1 = _near * pow(_far/_near, (SLfloat)(z+1)/(SLfloat)_numZ);
+
+    // Collect the candidate lights of the slice as structure of arrays
+    SLVuint  cand;
+    SLVfloat cx, cy, cz, cr2;
+    for (SLuint i=0; i<lights.size(); ++i)
+    {   const SLClusterLight& l = lights[i];
+        if (-l.posVS.z + l.radius < d0 || -l.posVS.z - l.radius > d1) continue;
+        cand.push_back(i);
+        cx.push_back(l.posVS.x);
+        cy.push_back(l.posVS.y);
+        cz.push_back(l.posVS.z);
+        cr2.push_back(l.radius < FLT_MAX ? l.radius*l.radius : FLT_MAX);
+    }
+
+    SLuint clustersPerSlice = (SLuint)(_numX*_numY);
+    SLuint firstCluster = z*clustersPerSlice;
+    if (cand.empty())
+    {   for (SLuint c=firstCluster; c<firstCluster+clustersPerSlice; ++c)
+            _grid[c*2] = _grid[c*2+1] = 0;
+        return;
+    }
+
+    // Pad to a multiple of 4 with lights that never pass the test
+    while (cand.size() % 4)
+    {   cand.push_back(0);
+        cx.push_back(0.0f); cy.push_back(0.0f); cz.push_back(0.0f);
+        cr2.push_back(-1.0f);
+    }
+    SLuint numCand = (SLuint)cand.size();
+
+    for (SLuint c=firstCluster; c<firstCluster+clustersPerSlice; ++c)
+    {   const SLVec3f& mn = _boundsMin[c];
+        const SLVec3f& mx = _boundsMax[c];
+        SLuint first = (SLuint)out.size();
+
+        for (SLuint i=0; i<numCand; i+=4)
+        {   // Squared distance of the light positions to the AABB
+            SLint mask = 0;
+            #if defined(SL_CLUSTER_USE_SSE)
+            __m128 zero = _mm_setzero_ps();
+            __m128 px = _mm_loadu_ps(&cx[i]);
+            __m128 py = _mm_loadu_ps(&cy[i]);
+            __m128 pz = _mm_loadu_ps(&cz[i]);
+            __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(mn.x), px),
+                                              _mm_sub_ps(px, _mm_set1_ps(mx.x))), zero);
+            __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(mn.y), py),
+                                              _mm_sub_ps(py, _mm_set1_ps(mx.y))), zero);
+            __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(mn.z), pz),
+                                              _mm_sub_ps(pz, _mm_set1_ps(mx.z))), zero);
+            __m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx,dx), _mm_mul_ps(dy,dy)), _mm_mul_ps(dz,dz));
+            mask = _mm_movemask_ps(_mm_cmple_ps(d2, _mm_loadu_ps(&cr2[i])));
+            #elif defined(SL_CLUSTER_USE_NEON)
+            float32x4_t zero = vdupq_n_f32(0.0f);
+            float32x4_t px = vld1q_f32(&cx[i]);
+            float32x4_t py = vld1q_f32(&cy[i]);
+            float32x4_t pz = vld1q_f32(&cz[i]);
+            float32x4_t dx = vmaxq_f32(vmaxq_f32(vsubq_f32(vdupq_n_f32(mn.x), px),
+                                                 vsubq_f32(px, vdupq_n_f32(mx.x))), zero);
+            float32x4_t dy = vmaxq_f32(vmaxq_f32(vsubq_f32(vdupq_n_f32(mn.y), py),
+                                                 vsubq_f32(py, vdupq_n_f32(mx.y))), zero);
+            float32x4_t dz = vmaxq_f32(vmaxq_f32(vsubq_f32(vdupq_n_f32(mn.z), pz),
+                                                 vsubq_f32(pz, vdupq_n_f32(mx.z))), zero);
+            float32x4_t d2 = vmlaq_f32(vmlaq_f32(vmulq_f32(dx,dx), dy,dy), dz,dz);
+            uint32x4_t  in = vcleq_f32(d2, vld1q_f32(&cr2[i]));
+            mask = (vgetq_lane_u32(in,0) & 1)        | (vgetq_lane_u32(in,1) & 1) << 1 |
+                   (vgetq_lane_u32(in,2) & 1) << 2   | (vgetq_lane_u32(in,3) & 1) << 3;
+            #else
+            for (SLuint k=0; k<4; ++k)
+            {   SLfloat dx = max(max(mn.x - cx[i+k], cx[i+k] - mx.x), 0.0f);
+                SLfloat dy = max(max(mn.y - cy[i+k], cy[i+k] - mx.y), 0.0f);
+                SLfloat dz = max(max(mn.z - cz[i+k], cz[i+k] - mx.z), 0.0f);
+                if (dx*dx + dy*dy + dz*dz <= cr2[i+k]) mask |= 1 << k;
+            }
+            #endif
+            if (!mask) continue;
+
+            for (SLuint k=0; k<4; ++k)
+            {   if (!(mask & (1 << k))) continue;
+                const SLClusterLight& l = lights[cand[i+k]];
+
+                // Cone test against the bounding sphere of the cluster
+                if (l.spotCutoff < 90.0f)
+                {   SLVec3f center = (mn + mx) * 0.5f;
+                    SLfloat radius = (mx - mn).length() * 0.5f;
+                    SLVec3f V = center - l.posVS;
+                    SLfloat lenSq = V.dot(V);
+                    SLfloat v1 = V.dot(l.dirVS);
+                    SLfloat cosA = cos(l.spotCutoff * SL_DEG2RAD);
+                    SLfloat sinA = sin(l.spotCutoff * SL_DEG2RAD);
+                    SLfloat distClosest = cosA*sqrt(max(lenSq - v1*v1, 0.0f)) - v1*sinA;
+                    if (distClosest > radius || v1 < -radius || v1 > radius + l.radius)
+                        continue;
+                }
+                out.push_back(cand[i+k]);
+            }
+        }
+        _grid[c*2]   = first;
+        _grid[c*2+1] = (SLuint)out.size() - first;
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+SLLightClusters::clusterIndex returns the cluster of a fragment at the pixel
+position (origin bottom left as gl_FragCoord) with the view space depth zVS.
+It does the same calculation as the clustered fragment shader.
+*/
+SLint SLLightClusters::clusterIndex(SLfloat pixelX,
+                                    SLfloat pixelY,
+                                    SLfloat zVS) const
+{
+    SLint x = SL_clamp((SLint)(pixelX / (SLfloat)_tileSize), 0, _numX-1);
+    SLint y = SL_clamp((SLint)(pixelY / (SLfloat)_tileSize), 0, _numY-1);
+    SLint z = (SLint)(log(max(-zVS, _near) / _near) * _sliceScale);
+    z = SL_clamp(z, 0, _numZ-1);
+    return (z*_numY + y)*_numX + x;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLLightClusters::lightRadius returns the distance at which the attenuated
+intensity of the light drops below SL_CLUSTER_LIGHT_THRESHOLD. It solves
+I / (kc + kl*d + kq*d^2) = threshold for d. Lights without attenuation have
+an unlimited range (FLT_MAX) and lights that never reach the threshold 0.
+*/
+SLfloat SLLightClusters::lightRadius(SLLight* light)
+{
+    SLCol4f a = light->ambient();
+    SLCol4f d = light->diffuse();
+    SLCol4f s = light->specular();
+    SLfloat I = max(max(max(a.r, a.g), max(a.b, d.r)),
+                    max(max(d.g, d.b), max(max(s.r, s.g), s.b)));
+    if (I <= 0.0f) return 0.0f;
+    if (!light->isAttenuated()) return FLT_MAX;
+
+    SLfloat kc = light->kc();
+    SLfloat kl = light->kl();
+    SLfloat kq = light->kq();
+    SLfloat c = kc - I / SL_CLUSTER_LIGHT_THRESHOLD;
+    if (c >= 0.0f) return 0.0f;
+    if (kq > 0.0f) return (-kl + sqrt(kl*kl - 4.0f*kq*c)) / (2.0f*kq);
+    if (kl > 0.0f) return -c / kl;
+    return FLT_MAX;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLLightClusters::update transforms the lights that are on into view space,
+assigns them to the clusters and uploads the light parameters and the
+cluster lists into the data textures. At most SL_CLUSTER_MAX_LIGHTS lights
+are used.
+*/
+void SLLightClusters::update(SLVLight& lights,
+                             const SLMat4f& view,
+                             const SLMat4f& projection,
+                             SLint viewportW,
+                             SLint viewportH,
+                             SLfloat clipNear,
+                             SLfloat clipFar)
+{
+    SL_PROFILE_SCOPE("SLLightClusters::update");
+
+    _lights.clear();
+    _lightData.clear();
+    for (auto light : lights)
+    {   if (!light->on()) continue;
+        if (_lights.size() >= SL_CLUSTER_MAX_LIGHTS) break;
+
+        SLfloat radius = lightRadius(light);
+        if (radius <= 0.0f) continue;
+
+        SLClusterLight l;
+        l.posVS = view * light->positionWS();
+        l.dirVS = view.mat3() * light->spotDirWS();
+        l.dirVS.normalize();
+        l.radius = radius;
+        l.spotCutoff = light->spotCutoff();
+        _lights.push_back(l);
+
+        SLCol4f a = light->ambient();
+        SLCol4f d = light->diffuse();
+        SLCol4f s = light->specular();
+        SLfloat cosCut = l.spotCutoff < 180.0f ? light->spotCosCut() : -2.0f;
+        SLfloat texels[SL_CLUSTER_LIGHT_TEXELS*4] =
+                {l.posVS.x, l.posVS.y, l.posVS.z, 1.0f,
+                 a.r, a.g, a.b, a.a,
+                 d.r, d.g, d.b, d.a,
+                 s.r, s.g, s.b, s.a,
+                 l.dirVS.x, l.dirVS.y, l.dirVS.z, cosCut,
+                 light->kc(), light->kl(), light->kq(), light->spotExponent()};
+        _lightData.insert(_lightData.end(), texels, texels + SL_CLUSTER_LIGHT_TEXELS*4);
+    }
+
+    assign(projection, viewportW, viewportH, clipNear, clipFar, _lights);
+    upload();
+}
+//-----------------------------------------------------------------------------
+/*!
+SLLightClusters::upload copies the light parameters, the cluster ranges and
+the light indices into the data textures. The light and the index texture only
+get reallocated if they have to grow.
+*/
+void SLLightClusters::upload()
+{
+    #ifndef SL_GLES2
+    SLGLState* stateGL = SLGLState::getInstance();
+
+    if (!_texLights)
+    {   glGenTextures(1, &_texLights);
+        glGenTextures(1, &_texGrid);
+        glGenTextures(1, &_texIndices);
+        for (auto tex : {_texLights, _texGrid, _texIndices})
+        {   stateGL->bindTexture(GL_TEXTURE_2D, tex);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+    }
+
+    // Light parameters with one row per light
+    stateGL->activeTexture(GL_TEXTURE0 + SL_CLUSTER_TEX_UNIT);
+    stateGL->bindTexture(GL_TEXTURE_2D, _texLights);
+    SLint numL = (SLint)_lights.size();
+    if (numL > _texLightsH || !_texLightsH)
+    {   _texLightsH = 16;
+        while (_texLightsH < numL) _texLightsH *= 2;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, SL_CLUSTER_LIGHT_TEXELS, _texLightsH,
+                     0, GL_RGBA, GL_FLOAT, nullptr);
+    }
+    if (numL)
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, SL_CLUSTER_LIGHT_TEXELS, numL,
+                        GL_RGBA, GL_FLOAT, &_lightData[0]);
+
+    // Offset & count of each cluster with one row per depth slice
+    stateGL->activeTexture(GL_TEXTURE0 + SL_CLUSTER_TEX_UNIT + 1);
+    stateGL->bindTexture(GL_TEXTURE_2D, _texGrid);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32UI, _numX*_numY, _numZ,
+                 0, GL_RG_INTEGER, GL_UNSIGNED_INT, &_grid[0]);
+
+    // Light indices in rows of SL_CLUSTER_INDEX_TEX_W
+    stateGL->activeTexture(GL_TEXTURE0 + SL_CLUSTER_TEX_UNIT + 2);
+    stateGL->bindTexture(GL_TEXTURE_2D, _texIndices);
+    SLint numI = (SLint)_indices.size();
+    SLint rows = (numI + SL_CLUSTER_INDEX_TEX_W-1) / SL_CLUSTER_INDEX_TEX_W;
+    if (rows > _texIndicesH || !_texIndicesH)
+    {   _texIndicesH = 16;
+        while (_texIndicesH < rows) _texIndicesH *= 2;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, SL_CLUSTER_INDEX_TEX_W, _texIndicesH,
+                     0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    }
+    SLint fullRows = numI / SL_CLUSTER_INDEX_TEX_W;
+    SLint rest = numI % SL_CLUSTER_INDEX_TEX_W;
+    if (fullRows)
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, SL_CLUSTER_INDEX_TEX_W, fullRows,
+                        GL_RED_INTEGER, GL_UNSIGNED_INT, &_indices[0]);
+    if (rest)
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, fullRows, rest, 1,
+                        GL_RED_INTEGER, GL_UNSIGNED_INT, &_indices[fullRows*SL_CLUSTER_INDEX_TEX_W]);
+    GET_GL_ERROR;
+    #endif
+}
+//-----------------------------------------------------------------------------
+//! SLLightClusters::setUniforms binds the data textures & passes the grid
+void SLLightClusters::setUniforms(SLGLProgram* sp)
+{
+    SLGLState* stateGL = SLGLState::getInstance();
+    stateGL->activeTexture(GL_TEXTURE0 + SL_CLUSTER_TEX_UNIT);
+    stateGL->bindTexture(GL_TEXTURE_2D, _texLights);
+    stateGL->activeTexture(GL_TEXTURE0 + SL_CLUSTER_TEX_UNIT + 1);
+    stateGL->bindTexture(GL_TEXTURE_2D, _texGrid);
+    stateGL->activeTexture(GL_TEXTURE0 + SL_CLUSTER_TEX_UNIT + 2);
+    stateGL->bindTexture(GL_TEXTURE_2D, _texIndices);
+
+    sp->uniform1i("u_clusterLights",  SL_CLUSTER_TEX_UNIT);
+    sp->uniform1i("u_clusterGrid",    SL_CLUSTER_TEX_UNIT + 1);
+    sp->uniform1i("u_clusterIndices", SL_CLUSTER_TEX_UNIT + 2);
+    sp->uniform3i("u_clusterSize", _numX, _numY, _numZ);
+    sp->uniform1f("u_clusterTileSize", (SLfloat)_tileSize);
+    sp->uniform1f("u_clusterNear", _near);
+    sp->uniform1f("u_clusterScale", _sliceScale);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLLightClusters::program returns the clustered variant of the standard
+Blinn-Phong programs or the passed program if it has no clustered variant.
+*/
+SLGLProgram* SLLightClusters::program(SLGLProgram* sp)
+{
+    SLScene* s = SLScene::current;
+    if (sp == s->programs(SP_perVrtBlinn) || sp == s->programs(SP_perPixBlinn))
+        return s->programs(SP_perPixBlinnClustered);
+    if (sp == s->programs(SP_perVrtBlinnTex) || sp == s->programs(SP_perPixBlinnTex))
+        return s->programs(SP_perPixBlinnTexClustered);
+    return sp;
+}
+//-----------------------------------------------------------------------------
+//! Returns true if the passed program evaluates the lights from the clusters
+SLbool SLLightClusters::usesProgram(SLGLProgram* sp)
+{
+    SLScene* s = SLScene::current;
+    return sp == s->programs(SP_perPixBlinnClustered) ||
+           sp == s->programs(SP_perPixBlinnTexClustered);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLLightClusters::createProgram creates the clustered Blinn-Phong program with
+or without texture. The shader code is compiled in with the library and not
+loaded from the shader directory.
+*/
+SLGLProgram* SLLightClusters::createProgram(SLbool withTexture)
+{
+    SLstring define = withTexture ? "#define SL_CLUSTER_TEXTURE\n" : "";
+    SLstring name = withTexture ? "PerPixBlinnTexClustered" : "PerPixBlinnClustered";
+
+    SLGLShader* vert = new SLGLShader("", ST_vertex);
+    vert->name(name + ".vert");
+    vert->loadFromMemory(define + clusterVertShader);
+
+    SLGLShader* frag = new SLGLShader("", ST_fragment);
+    frag->name(name + ".frag");
+    frag->loadFromMemory(define + clusterFragShader);
+
+    SLGLProgram* sp = new SLGLGenericProgram("", "");
+    sp->addShader(vert);
+    sp->addShader(frag);
+    return sp;
+}
+//-----------------------------------------------------------------------------
+//! Returns true if OpenGL supports the integer textures of the clustered path
+SLbool SLLightClusters::isSupported()
+{
+    #ifdef SL_GLES2
+    return false;
+    #else
+    SLGLState* stateGL = SLGLState::getInstance();
+    return stateGL->glIsES3() ||
+           (!stateGL->glIsES2() && stateGL->glVersionNOf() >= 3.0f);
+    #endif
+}
+//-----------------------------------------------------------------------------
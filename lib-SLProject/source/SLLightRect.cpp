@@ -21,8 +21,6 @@
 #include <SLMaterial.h>
 #include <SLMesh.h>
 
-extern SLfloat rnd01();
-
 //-----------------------------------------------------------------------------
 SLLightRect::SLLightRect(SLfloat w, SLfloat h, SLbool hasMesh) :
               SLNode("LightRect")
@@ -55,8 +53,9 @@ emissive mat.
 */
 void SLLightRect::init()
 {  
-    // Check if OpenGL lights are available
-    if (SLScene::current->lights().size() >= SL_MAX_LIGHTS) 
+    // Only the first SL_MAX_LIGHTS lights are passed as uniforms. All lights
+    // are used by the clustered lighting.
+    if (SLScene::current->lights().size() >= SL_CLUSTER_MAX_LIGHTS) 
         SL_EXIT_MSG("Max. NO. of lights is exceeded!");
 
     // Add the light to the lights vector of the scene
@@ -67,7 +66,7 @@ void SLLightRect::init()
    
     // Set the OpenGL light states
     setState();
-    _stateGL->numLightsUsed = (SLint)SLScene::current->lights().size();
+    _stateGL->numLightsUsed = min((SLint)SLScene::current->lights().size(), SL_MAX_LIGHTS);
    
     // Set emissive light material to the lights diffuse color
     if (_meshes.size() > 0)
@@ -85,7 +84,7 @@ void SLLightRect::drawRec(SLSceneView* sv)
     {  
         // Set the OpenGL light states
         setState();
-        _stateGL->numLightsUsed = (SLint)SLScene::current->lights().size();
+        _stateGL->numLightsUsed = min((SLint)SLScene::current->lights().size(), SL_MAX_LIGHTS);
    
         // Set emissive light material to the lights diffuse color
         if (_meshes.size() > 0)
@@ -129,7 +128,7 @@ void SLLightRect::drawMeshes(SLSceneView* sv)
     {  
         // Set the OpenGL light states
         setState();
-        _stateGL->numLightsUsed = (SLint)SLScene::current->lights().size();
+        _stateGL->numLightsUsed = min((SLint)SLScene::current->lights().size(), SL_MAX_LIGHTS);
    
         // Set emissive light material to the lights diffuse color
         if (_meshes.size() > 0)
@@ -258,8 +257,9 @@ SLfloat SLLightRect::shadowTestMC(SLRay* ray, // ray of hit point
 {
     SLVec3f SP; // vector hit point to sample point in world coords
 
-    SLfloat randX = rnd01();
-    SLfloat randY = rnd01();
+    SLVec2f rand = ray->sampleLight();
+    SLfloat randX = rand.x;
+    SLfloat randY = rand.y;
 
     // choose random point on rect as sample
     SP.set(updateAndGetWM().multVec(SLVec3f((randX*_width)-(_width*0.5f), (randY*_height)-(_height*0.5f), 0)) - ray->hitPoint);
@@ -280,7 +280,7 @@ SLfloat SLLightRect::shadowTestMC(SLRay* ray, // ray of hit point
 */
 void SLLightRect::setState()
 {  
-    if (_id!=-1) 
+    if (_id!=-1 && _id < SL_MAX_LIGHTS) 
     {   _stateGL->lightIsOn[_id]       = _on;
         _stateGL->lightPosWS[_id]      = positionWS();           
         _stateGL->lightDirWS[_id]      = spotDirWS();           
@@ -69,8 +69,9 @@ emissive mat.
 */
 void SLLightSphere::init()
 {  
-    // Check if OpenGL lights are available
-    if (SLScene::current->lights().size() >= SL_MAX_LIGHTS) 
+    // Only the first SL_MAX_LIGHTS lights are passed as uniforms. All lights
+    // are used by the clustered lighting.
+    if (SLScene::current->lights().size() >= SL_CLUSTER_MAX_LIGHTS) 
         SL_EXIT_MSG("Max. NO. of lights is exceeded!");
 
     // Add the light to the lights array of the scene
@@ -81,7 +82,7 @@ void SLLightSphere::init()
    
     // Set the OpenGL light states
     setState();
-    _stateGL->numLightsUsed = (SLint)SLScene::current->lights().size();
+    _stateGL->numLightsUsed = min((SLint)SLScene::current->lights().size(), SL_MAX_LIGHTS);
    
     // Set emissive light material to the lights diffuse color
     if (_meshes.size() > 0)
@@ -122,7 +123,7 @@ void SLLightSphere::drawMeshes(SLSceneView* sv)
     {  
         // Set the OpenGL light states
         SLLightSphere::setState();
-        _stateGL->numLightsUsed = (SLint)SLScene::current->lights().size();
+        _stateGL->numLightsUsed = min((SLint)SLScene::current->lights().size(), SL_MAX_LIGHTS);
    
         // Set emissive light material to the lights diffuse color
         if (_meshes.size() > 0)
@@ -222,6 +223,9 @@ SLfloat SLLightSphere::shadowTest(SLRay* ray,         // ray of hit point
 SLLightSphere::shadowTest returns 0.0 if the hit point is completely shaded and
 1.0 if it is 100% lighted. A return value inbetween is calculate by the ratio
 of the shadow rays not blocked to the total number of casted shadow rays.
+If the ray carries the SLSampler of a path, only one shadow ray is cast to a
+point on the light disc from the sampler. The path tracer averages them over
+the samples per pixel.
 */
 SLfloat SLLightSphere::shadowTestMC(SLRay* ray,         // ray of hit point
                                     const SLVec3f& L,   // vector from hit point to light
@@ -270,6 +274,20 @@ SLfloat SLLightSphere::shadowTestMC(SLRay* ray,         // ray of hit point
         LightY *= _radius;
         LightX *= _radius;
 
+        // One shadow ray to the disc position of the path sample
+        if (ray->sampler)
+        {
+            SLVec2f sample(ray->sampleLight());
+            SLVec2f discPos(SLSamples2D::mapSquareToDisc(sample.x, sample.y));
+            SLVec3f LDisc(C + discPos.x*LightX + discPos.y*LightY - ray->hitPoint);
+            SLfloat discDist = LDisc.length();
+            LDisc /= discDist;
+
+            SLRay shadowRay(discDist, LDisc, ray);
+            SLScene::current->root3D()->hitRec(&shadowRay);
+            return shadowRay.length < discDist ? 0.0f : 1.0f;
+        }
+
         // Loop over radius r and angle phi of light circle
         for (SLint iR = _samples.samplesX() - 1; iR >= 0; --iR)
         {
@@ -313,7 +331,7 @@ SLfloat SLLightSphere::shadowTestMC(SLRay* ray,         // ray of hit point
 */
 void SLLightSphere::setState()
 {  
-    if (_id!=-1) 
+    if (_id!=-1 && _id < SL_MAX_LIGHTS) 
     {   _stateGL->lightIsOn[_id]       = _on;
         _stateGL->lightPosWS[_id]      = positionWS();
         _stateGL->lightDirWS[_id]      = spotDirWS();           
@@ -37,6 +37,7 @@ SLMaterial::SLMaterial(const SLchar* name,
     _emission.set(0,0,0,0);
     _shininess = shininess;
     _program = 0;
+    _activeProgram = 0;
    
     _kr = kr;
     _kt = kt;
@@ -70,6 +71,7 @@ SLMaterial::SLMaterial(const SLchar* name,
     if (texture4) _textures.push_back(texture4);
    
     _program = shaderProg;
+    _activeProgram = 0;
    
     _kr = 0.0f;
     _kt = 0.0f;
@@ -91,6 +93,7 @@ SLMaterial::SLMaterial(SLCol4f uniformColor, const SLchar* name)
     _shininess = 125;
    
     _program = SLScene::current->programs(SP_colorUniform);
+    _activeProgram = 0;
    
     _kr = 0.0f;
     _kt = 0.0f;
@@ -117,8 +120,8 @@ void SLMaterial::activate(SLGLState* state, SLDrawBits drawBits)
     SLScene* s = SLScene::current;
 
     // Deactivate shader program of the current active material
-    if (current && current->program())
-        current->program()->endShader();
+    if (current && current->activeProgram())
+        current->activeProgram()->endShader();
 
     // Set this material as the current material
     current = this;
@@ -130,6 +133,9 @@ void SLMaterial::activate(SLGLState* state, SLDrawBits drawBits)
         else program(s->programs(SP_perVrtBlinn));
     }
 
+    // Use the clustered variant of the standard lighting programs
+    _activeProgram = state->lightClusters ? state->lightClusters->program(_program) : _program;
+
     // Check if shader had compile error and the error texture should be shown
     if (_program && _program->name().find("ErrorTex")!=string::npos)
     {   _textures.clear();
@@ -153,7 +159,7 @@ void SLMaterial::activate(SLGLState* state, SLDrawBits drawBits)
     }
 
     // Activate the shader program now
-    program()->beginUse(this);
+    _activeProgram->beginUse(this);
 }
 //-----------------------------------------------------------------------------
 /*! 
@@ -20,10 +20,21 @@
 #include <SLSceneView.h>
 #include <SLCamera.h>
 #include <SLCompactGrid.h>
+#include <SLBVH.h>
 #include <SLLightSphere.h>
 #include <SLLightRect.h>
 #include <SLSkeleton.h>
 #include <SLGLProgram.h>
+#include <SLBox.h>
+#include <SLPolygon.h>
+#include <SLRectangle.h>
+#include <SLTriangle.h>
+#include <SLGrid.h>
+#include <SLSphere.h>
+#include <SLCone.h>
+#include <SLCylinder.h>
+#include <SLDisk.h>
+#include <SLLens.h>
 
 //-----------------------------------------------------------------------------
 /*! 
@@ -39,6 +50,7 @@ SLMesh::SLMesh(SLstring name) : SLObject(name)
     _finalP = &P;
     _finalN = &N;
     _useHalf = false;
+    _useQuant = false;
     minP.set( FLT_MAX,  FLT_MAX,  FLT_MAX);
     maxP.set(-FLT_MAX, -FLT_MAX, -FLT_MAX);
    
@@ -60,7 +72,29 @@ deallocated when the scene is disposed in SLScene::unInit().
 */
 SLMesh::~SLMesh()
 {  
-    deleteData();    
+    deleteData();
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns the block size of the SLMesh memory pool. The primitives are created
+as often as plain meshes and are only a few bytes larger. So the blocks get
+the size of the largest of them and all share the pool. Other subclasses
+are allocated on the heap.
+*/
+size_t SLMesh::poolBlockSize()
+{
+    size_t size = sizeof(SLMesh);
+    size = SL_max(size, sizeof(SLBox));
+    size = SL_max(size, sizeof(SLPolygon));
+    size = SL_max(size, sizeof(SLRectangle));
+    size = SL_max(size, sizeof(SLTriangle));
+    size = SL_max(size, sizeof(SLGrid));
+    size = SL_max(size, sizeof(SLSphere));
+    size = SL_max(size, sizeof(SLCone));
+    size = SL_max(size, sizeof(SLCylinder));
+    size = SL_max(size, sizeof(SLDisk));
+    size = SL_max(size, sizeof(SLLens));
+    return size;
 }
 //-----------------------------------------------------------------------------
 //! SLMesh::deleteData deletes all mesh data and vbo's
@@ -75,6 +109,9 @@ void SLMesh::deleteData()
     Jw.clear();
     I16.clear();
     I32.clear();
+    _lodI.clear();
+    _lodStart.clear();
+    _lodErrors.clear();
 
     _jointMatrices.clear();
     skinnedP.clear();
@@ -125,14 +162,14 @@ Optionally you can draw the normals and/or the uniform grid voxels.
 1) Apply the drawing bits<br>
 2) Apply the uniform variables to the shader<br>
 2a) Activate a shader program if it is not yet in use and apply all its material parameters.<br>
-2b) Pass the modelview and modelview-projection matrix to the shader.<br>
-2c) If needed build and pass the inverse modelview and the normal matrix.<br>
-2d) If the mesh has a skeleton and HW skinning is applied pass the joint matrices.<br>
-3) Generate Vertex Array Object once<br>
-4) Finally do the draw call<br>
-5) Draw optional normals & tangents<br>
-6) Draw optional acceleration structure<br>
-7) Draw selected mesh with points<br>
+2b) Generate Vertex Array Object once<br>
+2c) Pass the modelview and modelview-projection matrix to the shader.<br>
+2d) If needed build and pass the inverse modelview and the normal matrix.<br>
+2e) If the mesh has a skeleton and HW skinning is applied pass the joint matrices.<br>
+3) Finally do the draw call<br>
+4) Draw optional normals & tangents<br>
+5) Draw optional acceleration structure<br>
+6) Draw selected mesh with points<br>
 </p>
 Please view also the full process of rendering <a href="md_on_paint.html"><b>one frame</b></a>
 */
@@ -180,12 +217,68 @@ void SLMesh::draw(SLSceneView* sv, SLNode* node)
         if (mat != SLMaterial::current || SLMaterial::current->program()==nullptr)
             mat->activate(_stateGL, *node->drawBits());
             
-        // 2.b) Pass the matrices to the shader program
-        SLGLProgram* sp = SLMaterial::current->program();
-        sp->uniformMatrix4fv("u_mvMatrix",    1, (SLfloat*)&_stateGL->modelViewMatrix);
-        sp->uniformMatrix4fv("u_mvpMatrix",   1, (SLfloat*)_stateGL->mvpMatrix());
+        SLGLProgram* sp = SLMaterial::current->activeProgram();
+
+        // 2.b) Generate Vertex Array Object once
+        if (!_vao.id())
+        {   
+            // Skinned meshes get updated and are therefore never quantized
+            if (_useQuant && !Ji.size())
+            {   // Texture coords. need the texture matrix for dequantization
+                SLbool hasTM = sp->getUniformLocation("u_tMatrix") >= 0;
+                                _vao.setAttrib(AT_position,    sp->getAttribLocation("a_position"), _finalP, AE_unorm16);
+                if (N.size())   _vao.setAttrib(AT_normal,      sp->getAttribLocation("a_normal"), _finalN, AE_snorm10);
+                if (Tc.size())  _vao.setAttrib(AT_texCoord,    sp->getAttribLocation("a_texCoord"), &Tc, hasTM ? AE_unorm16 : AE_half);
+                if (C.size())   _vao.setAttrib(AT_color,       sp->getAttribLocation("a_color"), &C, AE_unorm8);
+                if (T.size())   _vao.setAttrib(AT_tangent,     sp->getAttribLocation("a_tangent"), &T, AE_snorm10);
+            } else
+            {                   _vao.setAttrib(AT_position,    sp->getAttribLocation("a_position"), _finalP);
+                if (N.size())   _vao.setAttrib(AT_normal,      sp->getAttribLocation("a_normal"), _finalN, _useHalf);
+                if (Tc.size())  _vao.setAttrib(AT_texCoord,    sp->getAttribLocation("a_texCoord"), &Tc, _useHalf);
+                if (C.size())   _vao.setAttrib(AT_color,       sp->getAttribLocation("a_color"), &C, _useHalf);
+                if (T.size())   _vao.setAttrib(AT_tangent,     sp->getAttribLocation("a_tangent"), &T, _useHalf);
+                if (Ji.size())  _vao.setAttrib(AT_jointIndex,  sp->getAttribLocation("a_jointIds"), &Ji, _useHalf);
+                if (Jw.size())  _vao.setAttrib(AT_jointWeight, sp->getAttribLocation("a_jointWeights"), &Jw, _useHalf);
+            }
+
+            // The LOD index sets follow the full index set in one buffer
+            SLVushort allI16;
+            SLVuint   allI32;
+            if (_lodI.empty())
+            {   if (I16.size()) _vao.setIndices(&I16);
+                if (I32.size()) _vao.setIndices(&I32);
+            } else
+            if (I16.size() && I16.size() + _lodI.size() <= 65535)
+            {   allI16.reserve(I16.size() + _lodI.size());
+                allI16.insert(allI16.end(), I16.begin(), I16.end());
+                for (auto i : _lodI) allI16.push_back((SLushort)i);
+                _vao.setIndices(&allI16);
+            } else
+            {   allI32.reserve(numI() + _lodI.size());
+                if (I16.size())
+                     allI32.insert(allI32.end(), I16.begin(), I16.end());
+                else allI32.insert(allI32.end(), I32.begin(), I32.end());
+                allI32.insert(allI32.end(), _lodI.begin(), _lodI.end());
+                _vao.setIndices(&allI32);
+            }
+            _vao.generate((SLuint)P.size(), Ji.size() ? BU_stream : BU_static, !Ji.size());
+        }
 
-        // 2.c) Build & pass inverse, normal & texture matrix only if needed
+        // 2.c) Pass the matrices to the shader program
+        if (_useQuant)
+        {   // Quantized positions are mapped back to object space first
+            SLMat4f mv(_stateGL->modelViewMatrix);
+            mv.multiply(_vao.dequantMatrix(AT_position));
+            SLMat4f mvp(_stateGL->projectionMatrix);
+            mvp.multiply(mv);
+            sp->uniformMatrix4fv("u_mvMatrix",    1, (SLfloat*)&mv);
+            sp->uniformMatrix4fv("u_mvpMatrix",   1, (SLfloat*)&mvp);
+        } else
+        {   sp->uniformMatrix4fv("u_mvMatrix",    1, (SLfloat*)&_stateGL->modelViewMatrix);
+            sp->uniformMatrix4fv("u_mvpMatrix",   1, (SLfloat*)_stateGL->mvpMatrix());
+        }
+
+        // 2.d) Build & pass inverse, normal & texture matrix only if needed
         SLint locIM = sp->getUniformLocation("u_invMvMatrix");
         SLint locNM = sp->getUniformLocation("u_nMatrix");
         SLint locTM = sp->getUniformLocation("u_tMatrix");
@@ -207,10 +300,14 @@ void SLMesh::draw(SLSceneView* sv, SLNode* node)
         {   if (mat->has3DTexture() && mat->textures()[0]->autoCalcTM3D())
                  calcTex3DMatrix(node);
             else _stateGL->textureMatrix = mat->textures()[0]->tm();
-            sp->uniformMatrix4fv(locTM, 1, (SLfloat*)&_stateGL->textureMatrix);
+            if (_useQuant)
+            {   SLMat4f tm(_stateGL->textureMatrix);
+                tm.multiply(_vao.dequantMatrix(AT_texCoord));
+                sp->uniformMatrix4fv(locTM, 1, (SLfloat*)&tm);
+            } else sp->uniformMatrix4fv(locTM, 1, (SLfloat*)&_stateGL->textureMatrix);
         }
 
-        // 2.d) Do GPU skinning for animated meshes
+        // 2.e) Do GPU skinning for animated meshes
         if (_skeleton && Ji.size() && Jw.size() && _skinMethod == SM_hardware)
         {
             if (!_jointMatrices.size())
@@ -240,32 +337,18 @@ void SLMesh::draw(SLSceneView* sv, SLNode* node)
             sp->uniformMatrix4fv(locBM, _skeleton->numJoints(), (SLfloat*)&_jointMatrices[0], false);
         }
 
-        ///////////////////////////////////////
-        // 3) Generate Vertex Array Object once
-        ///////////////////////////////////////
-
-        if (!_vao.id())
-        {                   _vao.setAttrib(AT_position,    sp->getAttribLocation("a_position"), _finalP);
-            if (N.size())   _vao.setAttrib(AT_normal,      sp->getAttribLocation("a_normal"), _finalN, _useHalf);
-            if (Tc.size())  _vao.setAttrib(AT_texCoord,    sp->getAttribLocation("a_texCoord"), &Tc, _useHalf);
-            if (C.size())   _vao.setAttrib(AT_color,       sp->getAttribLocation("a_color"), &C, _useHalf);
-            if (T.size())   _vao.setAttrib(AT_tangent,     sp->getAttribLocation("a_tangent"), &T, _useHalf);
-            if (Ji.size())  _vao.setAttrib(AT_jointIndex,  sp->getAttribLocation("a_jointIds"), &Ji, _useHalf);
-            if (Jw.size())  _vao.setAttrib(AT_jointWeight, sp->getAttribLocation("a_jointWeights"), &Jw, _useHalf);
-            if (I16.size()) _vao.setIndices(&I16);
-            if (I32.size()) _vao.setIndices(&I32);
-            _vao.generate((SLuint)P.size(), Ji.size() ? BU_stream : BU_static, !Ji.size());
-        }
-
         ///////////////////////////////
-        // 4): Finally do the draw call
+        // 3): Finally do the draw call
         ///////////////////////////////
 
-        _vao.drawElementsAs(primitiveType);
+        SLint level = validLOD(node->lodLevel());
+        if (level)
+             _vao.drawElementsAs(primitiveType, lodNumI(level), numI() + _lodStart[level-1]);
+        else _vao.drawElementsAs(primitiveType, numI());
 
 
         //////////////////////////////////////
-        // 5) Draw optional normals & tangents
+        // 4) Draw optional normals & tangents
         //////////////////////////////////////
 
         // All helper lines must be drawn without blending
@@ -308,7 +391,7 @@ void SLMesh::draw(SLSceneView* sv, SLNode* node)
         }
         
         //////////////////////////////////////////
-        // 6) Draw optional acceleration structure
+        // 5) Draw optional acceleration structure
         //////////////////////////////////////////
 
         if (_accelStruct) 
@@ -322,7 +405,7 @@ void SLMesh::draw(SLSceneView* sv, SLNode* node)
         }
 
         ////////////////////////////////////
-        // 7: Draw selected mesh with points
+        // 6: Draw selected mesh with points
         ////////////////////////////////////
       
         if (SLScene::current->selectedMesh())
@@ -388,6 +471,7 @@ void SLMesh::addStats(SLNodeStats &stats)
     if (I16.size())
          stats.numBytes += (SLuint)(I16.size()*sizeof(SLushort));
     else stats.numBytes += (SLuint)(I32.size()*sizeof(SLuint));
+    if (_lodI.size()) stats.numBytes += SL_sizeOfVector(_lodI);
 
     stats.numMeshes++;
     if (_primitive==PT_triangles) stats.numTriangles += numI()/3;
@@ -536,13 +620,17 @@ void SLMesh::buildAABB(SLAABBox &aabb, SLMat4f wmNode)
 }
 //-----------------------------------------------------------------------------
 /*! SLMesh::updateAccelStruct rebuilds the acceleration structure if the dirty
-flag is set. This can happen for mesh animations.
+flag is set. This can happen for mesh animations. Skinned meshes get an SLBVH
+that is only refit to the skinned vertices as long as its quality allows it.
+All other meshes get an SLCompactGrid.
 */
 void SLMesh::updateAccelStruct()
 {
     if (!_accelStructOutOfDate)
         return;
 
+    SL_PROFILE_SCOPE("SLMesh::updateAccelStruct");
+
     calcMinMax();
 
     // Add half a percent in each direction to avoid zero size dimensions
@@ -552,10 +640,14 @@ void SLMesh::updateAccelStruct()
     maxP += addon;
 
     if (_accelStruct == nullptr && _primitive == PT_triangles)
-        _accelStruct = new SLCompactGrid(this);
+    {   if (_skeleton)
+             _accelStruct = new SLBVH(this);
+        else _accelStruct = new SLCompactGrid(this);
+    }
 
     if (_accelStruct && numI() > 15)
-    {   _accelStruct->build(minP, maxP);
+    {   if (!_accelStruct->refit())
+            _accelStruct->build(minP, maxP);
         _accelStructOutOfDate = false;
     }
 }
@@ -871,10 +963,32 @@ void SLMesh::useHalfFloats(SLbool useHalf)
     _useHalf = useHalf;
 }
 //-----------------------------------------------------------------------------
+//! Flags the mesh to store its attributes in compact quantized encodings.
+/*! With this flag set to true, the vertex attributes are stored in the VBO as:
+- P: 3 x 16 bit normalized relative to the AABB of the mesh (8 bytes instead of 12)
+- N & T: 10-10-10-2 bit packed normalized ints (4 bytes instead of 12 or 16)
+- Tc: 2 x 16 bit normalized relative to the texture coord. range (4 instead of 8)
+- C: 4 x 8 bit normalized (4 bytes instead of 16)
+\n
+The dequantization of the positions is applied to the modelview and the
+modelview-projection matrix and the one of the texture coordinates to the
+texture matrix in SLMesh::draw. The attribute data on the CPU side stays in
+float and is still used for ray tracing. Skinned meshes are not quantized.
+The precision of the positions is 1/65535 of the mesh size.
+*/
+void SLMesh::useQuantization(SLbool useQuant)
+{
+    _useQuant = useQuant;
+}
+//-----------------------------------------------------------------------------
 /*!
 SLMesh::preShade calculates the rest of the intersection information 
 after the final hit point is determined. Should be called just before the 
 shading when the final intersection point of the closest triangle was found.
+The color texture is looked up mipmapped with the footprint of the ray cone:
+The cone width at the hit point divided by the cosine of the incident angle
+is scaled by the ratio of the texture coordinate area to the world space area
+of the triangle.
 */
 void SLMesh::preShade(SLRay* ray)
 {
@@ -912,7 +1026,23 @@ void SLMesh::preShade(SLRay* ray)
     {   SLVec2f Tu(Tc[iB] - Tc[iA]);
         SLVec2f Tv(Tc[iC] - Tc[iA]);
         SLVec2f tc(Tc[iA] + ray->hitU*Tu + ray->hitV*Tv);
-        ray->hitTexCol.set(textures[0]->getTexelf(tc.x,tc.y));
+
+        // footprint of the ray cone in texture coordinates
+        SLfloat footprint = 0.0f;
+        SLfloat coneWidth = ray->coneWidthAtHit();
+        if (coneWidth > 0.0f)
+        {   const SLMat4f& wm = ray->hitNode->updateAndGetWM();
+            SLVec3f A(wm.multVec(finalP(iA)));
+            SLVec3f e1(wm.multVec(finalP(iB)) - A);
+            SLVec3f e2(wm.multVec(finalP(iC)) - A);
+            SLfloat areaWS = (e1^e2).length();
+            SLfloat areaTC = SL_abs(Tu.x*Tv.y - Tu.y*Tv.x);
+            SLfloat cosTheta = SL_max(SL_abs(ray->dir * ray->hitNormal), 0.05f);
+            if (areaWS > FLT_EPSILON)
+                footprint = coneWidth / cosTheta * sqrt(areaTC / areaWS);
+        }
+
+        ray->hitTexCol.set(textures[0]->getTexelf(tc.x, tc.y, footprint));
       
         // bump mapping
         if (textures.size() > 1)
@@ -1018,9 +1148,14 @@ each vertex and normal by max. four joints of the skeleton. Each joint has
 a weight and an index. After the transform the VBO have to be updated.
 This skinning process can also be done (a lot faster) on the GPU.
 This software skinning is also needed for ray or path tracing.  
+The skinned float positions and normals are written in the same loop directly
+into the streamed VBO (see SLGLVertexArray::beginUpdate). Attributes that
+can't be written directly are uploaded with updateAttrib afterwards.
 */
 void SLMesh::transformSkin()
 {   
+    SL_PROFILE_SCOPE("SLMesh::transformSkin");
+
     // create the secondary buffers for P and N once   
     if (!skinnedP.size())
     {   skinnedP.resize(P.size());
@@ -1051,12 +1186,20 @@ void SLMesh::transformSkin()
     
     // flag acceleration structure to be rebuilt
     _accelStructOutOfDate = true;
+
+    // get the pointers to write directly into the VBO
+    SLVec3f* vboP = nullptr;
+    SLVec3f* vboN = nullptr;
+    if (_vao.id() && _vao.beginUpdate())
+    {   vboP = (SLVec3f*)_vao.attribData(AT_position);
+        if (N.size()) vboN = (SLVec3f*)_vao.attribData(AT_normal);
+    }
         
     // iterate over all vertices and write to new buffers
     for (SLuint i = 0; i < P.size(); ++i)
     {
-        skinnedP[i] = SLVec3f::ZERO;
-        if (N.size()) skinnedN[i] = SLVec3f::ZERO;
+        SLVec3f skinP = SLVec3f::ZERO;
+        SLVec3f skinN = SLVec3f::ZERO;
 
         // array form for easier iteration
         SLfloat jointWeights[4] = {Jw[i].x, Jw[i].y, Jw[i].z, Jw[i].w};
@@ -1071,9 +1214,9 @@ void SLMesh::transformSkin()
             {
                 const SLMat4f& jm = _jointMatrices[jointIndices[j]];
                 SLVec4f tempPos = jm * P[i];
-                skinnedP[i].x += tempPos.x * jointWeights[j];
-                skinnedP[i].y += tempPos.y * jointWeights[j];
-                skinnedP[i].z += tempPos.z * jointWeights[j];
+                skinP.x += tempPos.x * jointWeights[j];
+                skinP.y += tempPos.y * jointWeights[j];
+                skinP.z += tempPos.z * jointWeights[j];
 
                 if (N.size()) 
                 {   // Build the 3x3 submatrix in GLSL 110 (= mat3 jt3 = mat3(jt))
@@ -1081,19 +1224,25 @@ void SLMesh::transformSkin()
                     // The inverse transpose can be ignored as long as we only have
                     // rotation and uniform scaling in the 3x3 submatrix.
                     SLMat3f jnm = jm.mat3();
-                    skinnedN[i] += jnm * N[i] * jointWeights[j];
+                    skinN += jnm * N[i] * jointWeights[j];
                 }
             }
         }
+
+        skinnedP[i] = skinP;
+        if (vboP) vboP[i] = skinP;
+        if (N.size()) 
+        {   skinnedN[i] = skinN;
+            if (vboN) vboN[i] = skinN;
+        }
     }  
 
-    // update or create buffers
+    // finish the direct update and upload the rest
     if (_vao.id())
-    {
-        _vao.updateAttrib(AT_position, _finalP);
-        if (N.size()) _vao.updateAttrib(AT_normal, _finalN);
+    {   _vao.endUpdate();
+        if (!vboP) _vao.updateAttrib(AT_position, _finalP);
+        if (N.size() && !vboN) _vao.updateAttrib(AT_normal, _finalN);
     }
-    
 }
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,371 @@
+//#############################################################################
+//  File:      SLMesh_optimize.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLMesh.h>
+
+//-----------------------------------------------------------------------------
+//! Size of the simulated post transform vertex cache for the optimization
+static const SLint SL_VCACHE_SIZE = 32;
+//-----------------------------------------------------------------------------
+//! Reorders the vector v so that the new element i is the old element remap[i]
+template<typename T>
+static void reorderVector(vector<T>& v, const SLVuint& newToOld)
+{
+    if (v.empty()) return;
+    vector<T> tmp(newToOld.size());
+    for (SLuint i=0; i<newToOld.size(); ++i)
+        tmp[i] = v[newToOld[i]];
+    v.swap(tmp);
+}
+//-----------------------------------------------------------------------------
+//! Copies the raw bytes of element i of the vector v to dst and advances dst
+template<typename T>
+static void appendKey(SLuchar*& dst, const vector<T>& v, SLuint i)
+{
+    if (v.empty()) return;
+    memcpy(dst, &v[i], sizeof(T));
+    dst += sizeof(T);
+}
+//-----------------------------------------------------------------------------
+/*! Returns all triangle indices as 32 bit vector out of I16 or I32.
+*/
+SLVuint SLMesh::getIndices32()
+{
+    if (I32.size()) return I32;
+    return SLVuint(I16.begin(), I16.end());
+}
+//-----------------------------------------------------------------------------
+/*! Sets the indices either to I16 if the number of vertices allows it or to
+I32 otherwise.
+*/
+void SLMesh::setIndices(const SLVuint& indices)
+{
+    I16.clear();
+    I32.clear();
+    if (P.size() < 65536)
+         I16.assign(indices.begin(), indices.end());
+    else I32 = indices;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLMesh::calcACMR returns the average cache miss ratio (ACMR) of the triangle
+order for a simulated FIFO post transform vertex cache of size cacheSize.
+The ACMR is the number of transformed vertices per triangle. It is in the
+range of 0.5 (best) to 3.0 (worst).
+*/
+SLfloat SLMesh::calcACMR(SLuint cacheSize)
+{
+    SLuint numI = this->numI();
+    if (numI < 3) return 0.0f;
+    return (SLfloat)calcCacheMisses(cacheSize) / (SLfloat)(numI/3);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLMesh::calcATVR returns the average transform to vertex ratio (ATVR) for a
+simulated FIFO post transform vertex cache of size cacheSize. The ATVR is the
+number of transformed vertices per vertex. The optimum is 1.0.
+*/
+SLfloat SLMesh::calcATVR(SLuint cacheSize)
+{
+    if (P.size() == 0) return 0.0f;
+    return (SLfloat)calcCacheMisses(cacheSize) / (SLfloat)P.size();
+}
+//-----------------------------------------------------------------------------
+//! Returns the number of cache misses of a simulated FIFO vertex cache
+SLuint SLMesh::calcCacheMisses(SLuint cacheSize)
+{
+    SLVuint indices = getIndices32();
+    SLVuint timeStamp(P.size(), 0);
+    SLuint  time = cacheSize + 1;
+    SLuint  misses = 0;
+
+    // A vertex is in the FIFO if it was inserted within the last cacheSize misses
+    for (auto i : indices)
+    {   if (time - timeStamp[i] > cacheSize)
+        {   timeStamp[i] = time++;
+            misses++;
+        }
+    }
+    return misses;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLMesh::weldVertices merges all vertices that have bitwise identical
+attributes (P, N, Tc, C, T, Ji & Jw) and remaps the indices. The vertices are
+hashed into an open addressing table so that the pass is linear in time.
+Returns the number of removed vertices.
+*/
+SLuint SLMesh::weldVertices()
+{
+    SLuint numV = (SLuint)P.size();
+    if (numV == 0) return 0;
+
+    // Build the key bytes of all vertices into one flat vector
+    size_t stride = (P.size()  ? sizeof(SLVec3f) : 0) +
+                    (N.size()  ? sizeof(SLVec3f) : 0) +
+                    (Tc.size() ? sizeof(SLVec2f) : 0) +
+                    (C.size()  ? sizeof(SLCol4f) : 0) +
+                    (T.size()  ? sizeof(SLVec4f) : 0) +
+                    (Ji.size() ? sizeof(SLVec4f) : 0) +
+                    (Jw.size() ? sizeof(SLVec4f) : 0);
+    SLVuchar keys(numV * stride);
+    SLuchar* dst = &keys[0];
+    for (SLuint i=0; i<numV; ++i)
+    {   appendKey(dst, P,  i);
+        appendKey(dst, N,  i);
+        appendKey(dst, Tc, i);
+        appendKey(dst, C,  i);
+        appendKey(dst, T,  i);
+        appendKey(dst, Ji, i);
+        appendKey(dst, Jw, i);
+    }
+
+    // Open addressing hash table with a power of 2 size
+    SLuint tableSize = 1;
+    while (tableSize < numV*2) tableSize <<= 1;
+    SLVuint table(tableSize, UINT_MAX);
+
+    SLVuint oldToNew(numV);
+    SLVuint newToOld;
+    newToOld.reserve(numV);
+
+    for (SLuint i=0; i<numV; ++i)
+    {   // FNV-1a hash of the vertex key
+        const SLuchar* key = &keys[i*stride];
+        SLuint h = 2166136261u;
+        for (size_t b=0; b<stride; ++b) {h ^= key[b]; h *= 16777619u;}
+
+        SLuint slot = h & (tableSize-1);
+        while (table[slot] != UINT_MAX && 
+               memcmp(&keys[table[slot]*stride], key, stride) != 0)
+            slot = (slot+1) & (tableSize-1);
+
+        if (table[slot] == UINT_MAX)
+        {   table[slot] = i;
+            oldToNew[i] = (SLuint)newToOld.size();
+            newToOld.push_back(i);
+        } else oldToNew[i] = oldToNew[table[slot]];
+    }
+
+    SLuint removed = numV - (SLuint)newToOld.size();
+    if (removed == 0) return 0;
+
+    // Remap the indices & compact the attributes
+    SLVuint indices = getIndices32();
+    for (auto& i : indices) i = oldToNew[i];
+    reorderAttributes(newToOld);
+    setIndices(indices);
+    return removed;
+}
+//-----------------------------------------------------------------------------
+//! Reorders all vertex attribute vectors. Vertex i gets the old vertex newToOld[i]
+void SLMesh::reorderAttributes(const SLVuint& newToOld)
+{
+    reorderVector(P,  newToOld);
+    reorderVector(N,  newToOld);
+    reorderVector(Tc, newToOld);
+    reorderVector(C,  newToOld);
+    reorderVector(T,  newToOld);
+    reorderVector(Ji, newToOld);
+    reorderVector(Jw, newToOld);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLMesh::optimizeVertexCache reorders the triangles for a better post transform
+vertex cache usage with the linear speed algorithm of Tom Forsyth
+(https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html).
+The triangle with the highest score of its vertices is emitted next. The
+vertex score depends on its position in a simulated LRU cache and on the
+number of its remaining triangles.
+*/
+void SLMesh::optimizeVertexCache()
+{
+    if (_primitive != PT_triangles) return;
+
+    SLVuint indices = getIndices32();
+    SLuint numV = (SLuint)P.size();
+    SLuint numT = (SLuint)indices.size() / 3;
+    if (numT == 0) return;
+
+    const SLfloat cacheDecayPower = 1.5f;
+    const SLfloat lastTriScore = 0.75f;
+    const SLfloat valenceBoostScale = 2.0f;
+    const SLfloat valenceBoostPower = 0.5f;
+
+    // Build vertex to triangle adjacency
+    SLVuint numTriOfVert(numV, 0);
+    for (auto i : indices) numTriOfVert[i]++;
+    SLVuint triOffset(numV+1, 0);
+    for (SLuint v=0; v<numV; ++v) triOffset[v+1] = triOffset[v] + numTriOfVert[v];
+    SLVuint triList(indices.size());
+    SLVuint fill(triOffset.begin(), triOffset.end()-1);
+    for (SLuint t=0; t<numT; ++t)
+        for (SLuint k=0; k<3; ++k)
+            triList[fill[indices[t*3+k]]++] = t;
+
+    SLVuint remainingTris(numTriOfVert);
+    SLVint  cachePos(numV, -1);
+    SLVfloat vertScore(numV, 0.0f);
+    SLVfloat triScore(numT, 0.0f);
+    SLVbool triEmitted(numT, false);
+
+    auto calcVertScore = [&](SLuint v) -> SLfloat
+    {   if (remainingTris[v] == 0) return -1.0f;
+        SLfloat score = 0.0f;
+        SLint pos = cachePos[v];
+        if (pos >= 0)
+        {   if (pos < 3) score = lastTriScore;
+            else
+            {   SLfloat scaler = 1.0f / (SL_VCACHE_SIZE - 3);
+                score = 1.0f - (pos - 3) * scaler;
+                score = pow(score, cacheDecayPower);
+            }
+        }
+        score += valenceBoostScale * pow((SLfloat)remainingTris[v], -valenceBoostPower);
+        return score;
+    };
+
+    for (SLuint v=0; v<numV; ++v) vertScore[v] = calcVertScore(v);
+    for (SLuint t=0; t<numT; ++t)
+        triScore[t] = vertScore[indices[t*3]] +
+                      vertScore[indices[t*3+1]] +
+                      vertScore[indices[t*3+2]];
+
+    SLVuint newIndices;
+    newIndices.reserve(indices.size());
+    vector<SLint> cache;            // LRU cache with the most recent vertex first
+    cache.reserve(SL_VCACHE_SIZE + 3);
+    SLint bestTri = -1;
+    SLuint nextLinearTri = 0;       // fallback search position
+
+    for (SLuint emitted=0; emitted<numT; ++emitted)
+    {
+        // Fallback: take the next not emitted triangle in linear order
+        if (bestTri < 0)
+        {   while (triEmitted[nextLinearTri]) nextLinearTri++;
+            bestTri = (SLint)nextLinearTri;
+        }
+
+        // Emit the best triangle
+        triEmitted[bestTri] = true;
+        for (SLuint k=0; k<3; ++k)
+        {   SLuint v = indices[bestTri*3+k];
+            newIndices.push_back(v);
+
+            // remove triangle from the vertex triangle list
+            SLuint* begin = &triList[triOffset[v]];
+            SLuint* end = begin + remainingTris[v];
+            SLuint* it = std::find(begin, end, (SLuint)bestTri);
+            if (it != end) {*it = *(end-1); remainingTris[v]--;}
+
+            // move vertex to the front of the LRU cache
+            auto pos = std::find(cache.begin(), cache.end(), (SLint)v);
+            if (pos != cache.end()) cache.erase(pos);
+            cache.insert(cache.begin(), (SLint)v);
+        }
+
+        // Update cache positions & scores of the vertices in the cache
+        for (SLuint c=0; c<cache.size(); ++c)
+        {   SLint v = cache[c];
+            cachePos[v] = c < (SLuint)SL_VCACHE_SIZE ? (SLint)c : -1;
+            vertScore[v] = calcVertScore(v);
+        }
+
+        // Update the triangle scores & find the best triangle in the cache
+        SLfloat bestScore = -1.0f;
+        bestTri = -1;
+        for (SLuint c=0; c<cache.size(); ++c)
+        {   SLint v = cache[c];
+            for (SLuint i=0; i<remainingTris[v]; ++i)
+            {   SLuint t = triList[triOffset[v]+i];
+                triScore[t] = vertScore[indices[t*3]] +
+                              vertScore[indices[t*3+1]] +
+                              vertScore[indices[t*3+2]];
+                if (triScore[t] > bestScore)
+                {   bestScore = triScore[t];
+                    bestTri = (SLint)t;
+                }
+            }
+        }
+
+        // Shrink the cache to its size
+        if (cache.size() > (SLuint)SL_VCACHE_SIZE)
+            cache.resize(SL_VCACHE_SIZE);
+    }
+
+    setIndices(newIndices);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLMesh::optimizeVertexFetch reorders all vertex attributes in the order of
+their first usage by the triangle indices. This improves the memory locality
+of the vertex fetch. Unused vertices are removed.
+*/
+void SLMesh::optimizeVertexFetch()
+{
+    SLVuint indices = getIndices32();
+    SLuint numV = (SLuint)P.size();
+    if (indices.empty()) return;
+
+    SLVuint oldToNew(numV, UINT_MAX);
+    SLVuint newToOld;
+    newToOld.reserve(numV);
+
+    for (auto& i : indices)
+    {   if (oldToNew[i] == UINT_MAX)
+        {   oldToNew[i] = (SLuint)newToOld.size();
+            newToOld.push_back(i);
+        }
+        i = oldToNew[i];
+    }
+
+    reorderAttributes(newToOld);
+    setIndices(indices);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLMesh::optimize runs the full optimization pass: vertex welding, vertex cache
+reordering of the triangles, vertex fetch reordering and the selection of 16
+bit indices if less than 65536 vertices remain. If printStats is true the
+ACMR and ATVR before and after the optimization are logged. The pass must be
+done before the mesh is drawn the first time and before LODs are added,
+because the LOD index sets refer to the vertex order. For skinned meshes it
+must be done after the joint weights are set.
+*/
+void SLMesh::optimize(SLbool printStats)
+{
+    assert(_lodI.empty() && "Optimize the mesh before adding LODs");
+    if (_primitive != PT_triangles || P.empty() || numI() == 0) return;
+
+    SLuint  numV0  = (SLuint)P.size();
+    SLfloat acmr0  = printStats ? calcACMR(SL_VCACHE_SIZE) : 0.0f;
+    SLfloat atvr0  = printStats ? calcATVR(SL_VCACHE_SIZE) : 0.0f;
+    SLbool  was32  = I32.size() > 0;
+
+    weldVertices();
+    optimizeVertexCache();
+    optimizeVertexFetch();
+
+    _accelStructOutOfDate = true;
+
+    if (printStats)
+        SL_LOG("SLMesh::optimize %s: Verts: %u->%u, ACMR: %4.2f->%4.2f, ATVR: %4.2f->%4.2f, Idx: %d->%d bit\n",
+               _name.c_str(),
+               numV0, (SLuint)P.size(),
+               acmr0, calcACMR(SL_VCACHE_SIZE),
+               atvr0, calcATVR(SL_VCACHE_SIZE),
+               was32 ? 32 : 16, I32.size() ? 32 : 16);
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,410 @@
+//#############################################################################
+//  File:      SLMesh_simplify.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLMesh.h>
+#include <queue>
+
+//-----------------------------------------------------------------------------
+//! Weight of the boundary edge planes that keep open borders in place
+static const double SL_SIMPLIFY_BOUNDARY_WEIGHT = 10.0;
+//-----------------------------------------------------------------------------
+//! Min. cosine between a triangle normal before and after a collapse
+static const double SL_SIMPLIFY_MIN_COS = 0.25;
+//-----------------------------------------------------------------------------
+//! Symmetric 4x4 error quadric of Garland & Heckbert
+struct SLQuadric
+{
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+    double w; //!< sum of the plane weights
+
+    SLQuadric() {a2=ab=ac=ad=b2=bc=bd=c2=cd=d2=w=0.0;}
+
+    //! Adds the plane ax+by+cz+d=0 with a weight
+    void addPlane(double a, double b, double c, double d, double weight)
+    {   a2 += weight*a*a; ab += weight*a*b; ac += weight*a*c; ad += weight*a*d;
+        b2 += weight*b*b; bc += weight*b*c; bd += weight*b*d;
+        c2 += weight*c*c; cd += weight*c*d;
+        d2 += weight*d*d;
+        w  += weight;
+    }
+
+    void add(const SLQuadric& q)
+    {   a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+        w  += q.w;
+    }
+
+    //! Returns the weighted sum of squared distances of p to all planes
+    double error(const SLVec3f& p) const
+    {   double x = p.x, y = p.y, z = p.z;
+        double e = a2*x*x + 2*ab*x*y + 2*ac*x*z + 2*ad*x
+                   + b2*y*y + 2*bc*y*z + 2*bd*y
+                   + c2*z*z + 2*cd*z
+                   + d2;
+        return e > 0.0 ? e : 0.0;
+    }
+};
+//-----------------------------------------------------------------------------
+//! Edge collapse candidate in the priority queue
+struct SLEdgeCollapse
+{
+    double cost;      //!< quadric error of the collapse
+    SLfloat  error;     //!< approx. geometric error in object space
+    SLuint   from;      //!< position that is removed
+    SLuint   to;        //!< position that remains
+    SLuint   verFrom;   //!< version of the from position at push time
+    SLuint   verTo;     //!< version of the to position at push time
+
+    //! Reversed order for a min. heap in std::priority_queue
+    bool operator<(const SLEdgeCollapse& other) const {return cost > other.cost;}
+};
+//-----------------------------------------------------------------------------
+/*!
+SLMesh::simplifyLODs calculates the triangle indices of up to numLODs levels
+of detail with the quadric error metric simplification of Garland & Heckbert.
+Each level has ratio times the triangles of the previous level. All levels are
+taken as snapshots from one single simplification run, so the error quadrics
+always refer to the original surface. The returned indices refer to the
+vertices of this mesh. lodErrors gets the max. geometric error per level.
+\n
+The collapses are done on unique positions so that vertices that are only
+split by their attributes (e.g. on texture seams or flat shading) collapse
+together. A vertex is always collapsed onto one of its edge neighbors so that
+no new attribute values have to be interpolated. Collapses that would flip a
+triangle are rejected and open borders are held in place by additional planes
+perpendicular to the border edges.
+\n
+This method doesn't touch the scene and can be called in a worker thread.
+The LOD index sets are added to the mesh with SLMesh::addLODs.
+*/
+void SLMesh::simplifyLODs(SLuint numLODs,
+                          SLfloat ratio,
+                          vector<SLVuint>& lodIndices,
+                          SLVfloat& lodErrors)
+{
+    lodIndices.clear();
+    lodErrors.clear();
+    if (_primitive != PT_triangles || Ji.size() || !numLODs) return;
+    if (ratio <= 0.0f || ratio >= 1.0f) return;
+
+    SLVuint  tri    = getIndices32();
+    SLuint   numV   = (SLuint)P.size();
+    SLuint   numT   = (SLuint)tri.size() / 3;
+    if (numT < 4) return;
+
+    ///////////////////////////////////////////////////////
+    // 1) Find unique positions by sorting the vertex order
+    ///////////////////////////////////////////////////////
+
+    SLVuint order(numV);
+    for (SLuint i=0; i<numV; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [this](SLuint a, SLuint b)
+    {   if (P[a].x != P[b].x) return P[a].x < P[b].x;
+        if (P[a].y != P[b].y) return P[a].y < P[b].y;
+        return P[a].z < P[b].z;
+    });
+
+    SLVuint posOf(numV);    // position id of each vertex
+    SLVuint posVert;        // representative vertex of each position
+    for (SLuint i=0; i<numV; ++i)
+    {   if (i==0 || P[order[i]] != P[order[i-1]])
+            posVert.push_back(order[i]);
+        posOf[order[i]] = (SLuint)posVert.size()-1;
+    }
+    SLuint numPos = (SLuint)posVert.size();
+    auto pos = [&](SLuint p) -> const SLVec3f& {return P[posVert[p]];};
+
+    ///////////////////////////////////////////////////////
+    // 2) Build triangle lists per position & the quadrics
+    ///////////////////////////////////////////////////////
+
+    vector<SLbool>    alive(numT, true);
+    vector<SLVuint>   posTris(numPos);
+    vector<SLQuadric> Q(numPos);
+    vector<SLuint64>  edges;    // position edge key (min<<32 | max)
+    SLuint            numAlive = 0;
+
+    for (SLuint t=0; t<numT; ++t)
+    {   SLuint p0 = posOf[tri[3*t]], p1 = posOf[tri[3*t+1]], p2 = posOf[tri[3*t+2]];
+        if (p0==p1 || p1==p2 || p2==p0)
+        {   alive[t] = false;
+            continue;
+        }
+        numAlive++;
+        posTris[p0].push_back(t);
+        posTris[p1].push_back(t);
+        posTris[p2].push_back(t);
+
+        SLVec3f n; n.cross(pos(p1)-pos(p0), pos(p2)-pos(p0));
+        SLfloat len = n.length();
+        if (len > 0.0f)
+        {   n /= len;
+            double d = -n.dot(pos(p0));
+            double area = 0.5 * len;
+            Q[p0].addPlane(n.x, n.y, n.z, d, area);
+            Q[p1].addPlane(n.x, n.y, n.z, d, area);
+            Q[p2].addPlane(n.x, n.y, n.z, d, area);
+        }
+
+        SLuint p[3] = {p0, p1, p2};
+        for (SLint k=0; k<3; ++k)
+        {   SLuint a = p[k], b = p[(k+1)%3];
+            edges.push_back(((SLuint64)min(a,b) << 32) | max(a,b));
+        }
+    }
+
+    // Edges that are used only once are on an open border
+    std::sort(edges.begin(), edges.end());
+    for (SLuint i=0; i<edges.size(); ++i)
+    {   if ((i > 0 && edges[i]==edges[i-1]) ||
+            (i+1 < edges.size() && edges[i]==edges[i+1])) continue;
+
+        SLuint a = (SLuint)(edges[i] >> 32), b = (SLuint)(edges[i] & 0xFFFFFFFF);
+
+        // find the triangle normal of the border edge
+        SLVec3f n(0,0,0);
+        for (auto t : posTris[a])
+        {   SLuint p0 = posOf[tri[3*t]], p1 = posOf[tri[3*t+1]], p2 = posOf[tri[3*t+2]];
+            if (p0==b || p1==b || p2==b)
+            {   n.cross(pos(p1)-pos(p0), pos(p2)-pos(p0));
+                break;
+            }
+        }
+        SLVec3f e = pos(b) - pos(a);
+        SLVec3f bn; bn.cross(e, n);
+        SLfloat len = bn.length();
+        if (len <= 0.0f) continue;
+        bn /= len;
+        double d = -bn.dot(pos(a));
+        double weight = SL_SIMPLIFY_BOUNDARY_WEIGHT * e.lengthSqr();
+        Q[a].addPlane(bn.x, bn.y, bn.z, d, weight);
+        Q[b].addPlane(bn.x, bn.y, bn.z, d, weight);
+    }
+    edges.clear();
+    edges.shrink_to_fit();
+
+    ///////////////////////////////////////////////////
+    // 3) Fill the priority queue with edge collapses
+    ///////////////////////////////////////////////////
+
+    std::priority_queue<SLEdgeCollapse> heap;
+    SLVuint version(numPos, 0);
+
+    auto pushEdge = [&](SLuint a, SLuint b)
+    {   SLQuadric q = Q[a];
+        q.add(Q[b]);
+        double ea = q.error(pos(a));
+        double eb = q.error(pos(b));
+        SLEdgeCollapse c;
+        if (ea < eb) {c.cost = ea; c.from = b; c.to = a;}
+        else         {c.cost = eb; c.from = a; c.to = b;}
+        c.error = q.w > 0.0 ? (SLfloat)sqrt(c.cost / q.w) : 0.0f;
+        c.verFrom = version[c.from];
+        c.verTo = version[c.to];
+        heap.push(c);
+    };
+
+    for (SLuint t=0; t<numT; ++t)
+    {   if (!alive[t]) continue;
+        SLuint p0 = posOf[tri[3*t]], p1 = posOf[tri[3*t+1]], p2 = posOf[tri[3*t+2]];
+        if (p0 < p1) pushEdge(p0, p1);
+        if (p1 < p2) pushEdge(p1, p2);
+        if (p2 < p0) pushEdge(p2, p0);
+    }
+
+    // Returns true if no triangle around from flips when from moves to to
+    auto canCollapse = [&](SLuint from, SLuint to) -> SLbool
+    {   for (auto t : posTris[from])
+        {   if (!alive[t]) continue;
+            SLuint p[3] = {posOf[tri[3*t]], posOf[tri[3*t+1]], posOf[tri[3*t+2]]};
+            if (p[0]==to || p[1]==to || p[2]==to) continue;
+            SLVec3f v[3] = {pos(p[0]), pos(p[1]), pos(p[2])};
+            SLVec3f nOld; nOld.cross(v[1]-v[0], v[2]-v[0]);
+            for (SLint k=0; k<3; ++k) if (p[k]==from) v[k] = pos(to);
+            SLVec3f nNew; nNew.cross(v[1]-v[0], v[2]-v[0]);
+            if (nOld.dot(nNew) <= SL_SIMPLIFY_MIN_COS * nOld.length() * nNew.length())
+                return false;
+        }
+        return true;
+    };
+
+    ///////////////////////////////////////////////////////
+    // 4) Collapse the cheapest edges & take the snapshots
+    ///////////////////////////////////////////////////////
+
+    SLfloat  maxError = 0.0f;
+    double target = numT;
+    SLuint   lastNumAlive = numAlive;
+    vector<std::pair<SLuint,SLuint>> vertMap;
+    SLVuint neighbors;
+
+    for (SLuint lod=0; lod<numLODs; ++lod)
+    {
+        target *= ratio;
+
+        while (numAlive > target && !heap.empty())
+        {   SLEdgeCollapse c = heap.top();
+            heap.pop();
+
+            if (c.verFrom != version[c.from] || c.verTo != version[c.to]) continue;
+            if (!canCollapse(c.from, c.to)) continue;
+
+            // Kill the triangles on the edge and map their from vertices
+            vertMap.clear();
+            for (auto t : posTris[c.from])
+            {   if (!alive[t]) continue;
+                SLuint vFrom = UINT_MAX, vTo = UINT_MAX;
+                for (SLint k=0; k<3; ++k)
+                {   SLuint v = tri[3*t+k];
+                    if (posOf[v]==c.from) vFrom = v;
+                    if (posOf[v]==c.to) vTo = v;
+                }
+                if (vTo == UINT_MAX) continue;
+                alive[t] = false;
+                numAlive--;
+                vertMap.push_back(std::make_pair(vFrom, vTo));
+            }
+
+            // Move the remaining triangles of from to the position to
+            for (auto t : posTris[c.from])
+            {   if (!alive[t]) continue;
+                for (SLint k=0; k<3; ++k)
+                {   SLuint v = tri[3*t+k];
+                    if (posOf[v] != c.from) continue;
+                    SLuint vNew = posVert[c.to];
+                    for (auto& m : vertMap)
+                        if (m.first == v) {vNew = m.second; break;}
+                    tri[3*t+k] = vNew;
+                }
+                posTris[c.to].push_back(t);
+            }
+            posTris[c.from].clear();
+            posTris[c.from].shrink_to_fit();
+
+            Q[c.to].add(Q[c.from]);
+            version[c.from]++;
+            version[c.to]++;
+            maxError = max(maxError, c.error);
+
+            // Remove the dead triangles & push the new collapse costs
+            SLVuint& tris = posTris[c.to];
+            tris.erase(std::remove_if(tris.begin(), tris.end(),
+                                      [&](SLuint t){return !alive[t];}),
+                       tris.end());
+            neighbors.clear();
+            for (auto t : tris)
+            {   for (SLint k=0; k<3; ++k)
+                {   SLuint p = posOf[tri[3*t+k]];
+                    if (p != c.to && std::find(neighbors.begin(), neighbors.end(), p) == neighbors.end())
+                        neighbors.push_back(p);
+                }
+            }
+            for (auto p : neighbors)
+                pushEdge(c.to, p);
+        }
+
+        // Stop if the simplification couldn't reduce anymore
+        if (numAlive >= lastNumAlive) break;
+        lastNumAlive = numAlive;
+
+        SLVuint indices;
+        indices.reserve(numAlive*3);
+        for (SLuint t=0; t<numT; ++t)
+        {   if (!alive[t]) continue;
+            indices.push_back(tri[3*t]);
+            indices.push_back(tri[3*t+1]);
+            indices.push_back(tri[3*t+2]);
+        }
+        lodIndices.push_back(indices);
+        lodErrors.push_back(maxError);
+
+        if (heap.empty()) break;
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+SLMesh::addLODs stores the index vectors calculated by SLMesh::simplifyLODs
+as LOD levels 1-n of this mesh. The LODs only reference vertices of this mesh,
+so they share its vertex data and vertex buffer. The index sets are appended
+to the index buffer of the mesh that is rebuilt on the next draw.
+*/
+void SLMesh::addLODs(const vector<SLVuint>& lodIndices,
+                     const SLVfloat& lodErrors)
+{
+    assert(lodIndices.size() == lodErrors.size());
+
+    _lodI.clear();
+    _lodStart.clear();
+    _lodErrors = lodErrors;
+
+    for (auto& indices : lodIndices)
+    {   _lodStart.push_back((SLuint)_lodI.size());
+        _lodI.insert(_lodI.end(), indices.begin(), indices.end());
+    }
+    _lodStart.push_back((SLuint)_lodI.size());
+
+    if (_vao.id()) _vao.clearAttribs();
+}
+//-----------------------------------------------------------------------------
+/*!
+SLMesh::generateLODs calculates and creates up to numLODs levels of detail
+with each ratio times the triangles of the previous level. See
+SLMesh::simplifyLODs for the algorithm.
+*/
+void SLMesh::generateLODs(SLuint numLODs, SLfloat ratio)
+{
+    vector<SLVuint> lodIndices;
+    SLVfloat lodErrors;
+    simplifyLODs(numLODs, ratio, lodIndices, lodErrors);
+    addLODs(lodIndices, lodErrors);
+
+    SLstring tris = to_string(numI()/3);
+    for (SLint l=1; l<=(SLint)_lodErrors.size(); ++l)
+        tris += ", " + to_string(lodNumI(l)/3);
+    SL_LOG("LOD triangles of %s: %s\n", name().c_str(), tris.c_str());
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns the NO. of indices of a LOD level. Level 0 is the full mesh.
+*/
+SLuint SLMesh::lodNumI(SLint level)
+{
+    level = validLOD(level);
+    if (level == 0) return numI();
+    return _lodStart[level] - _lodStart[level-1];
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns the max. geometric error in object space of a LOD level.
+*/
+SLfloat SLMesh::lodError(SLint level) const
+{
+    level = validLOD(level);
+    return level ? _lodErrors[level-1] : 0.0f;
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns the indices of a LOD level >= 1 into the vertices of this mesh.
+Level 0 has its indices in I16 or I32.
+*/
+const SLuint* SLMesh::lodIndices(SLint level) const
+{
+    level = validLOD(level);
+    assert(level > 0 && "Level 0 indices are in I16 or I32");
+    return &_lodI[_lodStart[level-1]];
+}
+//-----------------------------------------------------------------------------
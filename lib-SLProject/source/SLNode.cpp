@@ -20,6 +20,11 @@
 #include <SLCamera.h>
 #include <SLLightSphere.h>
 #include <SLLightRect.h>
+#include <SLJoint.h>
+
+//-----------------------------------------------------------------------------
+//! Factor of the max. LOD pixel error below which a coarser LOD is taken
+static const SLfloat SL_LOD_HYSTERESIS = 0.75f;
 
 //-----------------------------------------------------------------------------
 /*! 
@@ -36,8 +41,19 @@ SLNode::SLNode(SLstring name) : SLObject(name)
     _wmN.identity();
     _drawBits.allOff();
     _animation = 0;
+    _lodLevel = 0;
+    _layers = SL_LAYER_DEFAULT;
     _isWMUpToDate = false;
     _isAABBUpToDate = false;
+    _nodeIndex = nullptr;
+    _indexType = nullptr;
+    _indexSeq = 0;
+    _indexNameSlot = 0;
+    _indexTypeSlot = 0;
+    _indexOrder = 0;
+    _indexLast = 0;
+    _store = nullptr;
+    _slot = -1;
 }
 //-----------------------------------------------------------------------------
 /*! 
@@ -54,8 +70,19 @@ SLNode::SLNode(SLMesh* mesh, SLstring name) : SLObject(name)
     _wmN.identity();
     _drawBits.allOff();
     _animation = 0;
+    _lodLevel = 0;
+    _layers = SL_LAYER_DEFAULT;
     _isWMUpToDate = false;
     _isAABBUpToDate = false;
+    _nodeIndex = nullptr;
+    _indexType = nullptr;
+    _indexSeq = 0;
+    _indexNameSlot = 0;
+    _indexTypeSlot = 0;
+    _indexOrder = 0;
+    _indexLast = 0;
+    _store = nullptr;
+    _slot = -1;
     
     addMesh(mesh);
 }
@@ -70,12 +97,38 @@ SLNode::~SLNode()
 {  
     //SL_LOG("~SLNode: %s\n", name().c_str());
 
+    if (_nodeIndex)
+        _nodeIndex->remove(this);
+
+    if (_store)
+        _store->invalidate();
+
     for (auto child : _children) delete child;
     _children.clear();
 
     if (_animation) 
         delete _animation;
 }
+//-----------------------------------------------------------------------------
+/*!
+Returns the block size of the SLNode memory pool. Skinned models create one
+SLJoint per bone, so the joints share the pool with the plain nodes. Cameras,
+lights and texts are rare and are allocated on the heap.
+*/
+size_t SLNode::poolBlockSize()
+{
+    return SL_max(sizeof(SLNode), sizeof(SLJoint));
+}
+//-----------------------------------------------------------------------------
+/*!
+Sets the name and moves the node in the node index to the new name.
+*/
+void SLNode::name(const SLstring& Name)
+{
+    if (_nodeIndex && Name != _name)
+        _nodeIndex->rename(this, _name, Name);
+    _name = Name;
+}
 
 
 
@@ -93,9 +146,10 @@ void SLNode::addMesh(SLMesh* mesh)
 
     // Take over mesh name if node name is default name
     if (_name == "Node" && mesh->name() != "Mesh")
-        _name = mesh->name() + "-Node";
+        name(mesh->name() + "-Node");
 
     _meshes.push_back(mesh);
+    if (_nodeIndex) _nodeIndex->addMesh(this, mesh);
     mesh->init(this);
 }
 //-----------------------------------------------------------------------------
@@ -111,11 +165,12 @@ bool SLNode::insertMesh(SLMesh* insertM, SLMesh* afterM)
     auto found = std::find(_meshes.begin(), _meshes.end(), afterM);
     if (found != _meshes.end())
     {   _meshes.insert(found, insertM);
+        if (_nodeIndex) _nodeIndex->addMesh(this, insertM);
         insertM->init(this);
 
         // Take over mesh name if node name is default name
         if (_name == "Node" && insertM->name() != "Mesh")
-            _name = insertM->name() + "-Node";
+            name(insertM->name() + "-Node");
 
         return true;
     }
@@ -123,12 +178,24 @@ bool SLNode::insertMesh(SLMesh* insertM, SLMesh* afterM)
 }
 //-----------------------------------------------------------------------------
 /*! 
+Removes all meshes.
+*/
+void SLNode::removeMeshes()
+{
+    if (_nodeIndex)
+        for (auto mesh : _meshes)
+            _nodeIndex->removeMesh(this, mesh);
+    _meshes.clear();
+}
+//-----------------------------------------------------------------------------
+/*! 
 Removes the last mesh.
 */
 bool SLNode::removeMesh()
 {
     if (_meshes.size() > 0)
-    {   _meshes.pop_back();
+    {   if (_nodeIndex) _nodeIndex->removeMesh(this, _meshes.back());
+        _meshes.pop_back();
         return true;
     }
     return false;
@@ -142,7 +209,8 @@ bool SLNode::removeMesh(SLMesh* mesh)
     assert(mesh);
     for (SLint i=0; i<_meshes.size(); ++i)
     {   if (_meshes[i]==mesh)
-        {   _meshes.erase(_meshes.begin()+i);
+        {   if (_nodeIndex) _nodeIndex->removeMesh(this, mesh);
+            _meshes.erase(_meshes.begin()+i);
             return true;
         }
     }
@@ -211,6 +279,58 @@ void SLNode::drawMeshes(SLSceneView* sv)
         mesh->draw(sv, this);
 }
 //-----------------------------------------------------------------------------
+/*!
+Selects the level of detail (LOD) of the nodes meshes. The max. geometric
+error of a LOD level is projected to the screen at the nearest distance of the
+nodes AABB. The coarsest level with a projected error below
+SLSceneView::lodPixelError is used. To avoid popping back and forth at the
+switching distance a coarser level is only taken if its error is below
+SL_LOD_HYSTERESIS times the max. pixel error.
+*/
+void SLNode::selectLOD(SLSceneView* sv)
+{
+    SLint maxLevel = 0;
+    for (auto mesh : _meshes)
+        maxLevel = max(maxLevel, mesh->numLODs()-1);
+
+    if (maxLevel == 0 || sv->lodPixelError() <= 0.0f)
+    {   _lodLevel = 0;
+        return;
+    }
+
+    // Object space scale of the world matrix
+    const SLMat4f& wm = updateAndGetWM();
+    SLfloat scale = SLVec3f(wm.m()[0], wm.m()[1], wm.m()[2]).length();
+
+    // Height of the view in world units at the nearest distance of the AABB
+    SLCamera* cam = sv->camera();
+    SLfloat viewH;
+    if (cam->projection() == P_monoOrthographic)
+        viewH = cam->focalDistScrH();
+    else
+    {   SLVec3f eye = cam->updateAndGetWM().translation();
+        SLfloat dist = (_aabb.centerWS() - eye).length() - _aabb.radiusWS();
+        dist = max(dist, cam->clipNear());
+        viewH = 2.0f * dist * tan(cam->fov() * SL_DEG2RAD * 0.5f);
+    }
+    SLfloat pixelsPerOSUnit = scale * (SLfloat)sv->scrH() / viewH;
+
+    // Returns the max. projected error in pixels of a level
+    auto pixelError = [&](SLint level)
+    {   SLfloat error = 0.0f;
+        for (auto mesh : _meshes)
+            error = max(error, mesh->lodError(level));
+        return error * pixelsPerOSUnit;
+    };
+
+    SLfloat maxError = sv->lodPixelError();
+    _lodLevel = min(_lodLevel, maxLevel);
+    while (_lodLevel > 0 && pixelError(_lodLevel) > maxError)
+        _lodLevel--;
+    while (_lodLevel < maxLevel && pixelError(_lodLevel+1) < maxError * SL_LOD_HYSTERESIS)
+        _lodLevel++;
+}
+//-----------------------------------------------------------------------------
 
 
 
@@ -300,18 +420,33 @@ bool SLNode::deleteChild(SLstring name)
 }
 //-----------------------------------------------------------------------------
 /*!
-Searches for all nodes that contain the provided mesh
+Searches for all nodes that contain the provided mesh. The nodes are looked
+up in the node index. The tree is only searched if the children are not
+indexed.
 */
 vector<SLNode*> SLNode::findChildren(const SLMesh* mesh,
                                      SLbool findRecursive)
 {
     vector<SLNode*> list;
-    findChildrenHelper(mesh, list, findRecursive);
-
+    SLNodeIndex* index = childIndex();
+    if (index)
+         index->findAll(this, mesh, findRecursive, list);
+    else findChildrenHelper(mesh, list, findRecursive);
     return list;
 }
 //-----------------------------------------------------------------------------
 /*!
+Returns the node index of the children or nullptr if there are no indexed
+children. The lookups below this node then fall back to the tree search.
+*/
+SLNodeIndex* SLNode::childIndex() const
+{
+    for (auto child : _children)
+        if (child->_nodeIndex) return child->_nodeIndex;
+    return nullptr;
+}
+//-----------------------------------------------------------------------------
+/*!
 Helper function of findChildren for meshes
 */
 void SLNode::findChildrenHelper(const SLMesh* mesh,
@@ -326,6 +461,37 @@ void SLNode::findChildrenHelper(const SLMesh* mesh,
     }
 }
 //-----------------------------------------------------------------------------
+/*!
+Finds a node by a path of node names separated by '/' (e.g. "body/arm/hand").
+Each name is looked up in the direct children of the previous node starting
+with the children of this node. A path starting with '/' is absolute and its
+first name must be the name of the root node of the scenegraph of this node.
+Returns nullptr if a name is not found. If a name is not unique the first
+child in the tree order is taken.
+*/
+SLNode* SLNode::findByPath(const SLstring& path)
+{
+    SLNode* node = this;
+    size_t  start = 0;
+
+    if (path.size() && path[0] == '/')
+    {   while (node->parent()) node = node->parent();
+        size_t end = path.find('/', 1);
+        if (path.substr(1, end - 1) != node->name()) return nullptr;
+        if (end == SLstring::npos) return node;
+        start = end + 1;
+    }
+
+    while (node && start < path.size())
+    {   size_t end = path.find('/', start);
+        if (end == SLstring::npos) end = path.size();
+        if (end > start)
+            node = node->findChild<SLNode>(path.substr(start, end - start), false);
+        start = end + 1;
+    }
+    return node;
+}
+//-----------------------------------------------------------------------------
 
 
 
@@ -352,6 +518,10 @@ void SLNode::cullRec(SLSceneView* sv)
     {  
         for (auto child : _children)
             child->cullRec(sv);
+
+        // Select the level of detail of the meshes
+        if (_meshes.size())
+            selectLOD(sv);
       
         // for leaf nodes add them to the blended or opaque vector
         if (_aabb.hasAlpha())
@@ -501,6 +671,7 @@ SLNode* SLNode::copyRec()
     copy->_isAABBUpToDate = _isWMUpToDate;
     copy->_drawBits = _drawBits;
     copy->_aabb = _aabb;
+    copy->_layers = _layers;
 
     if (_animation) 
          copy->_animation = new SLAnimation(*_animation);
@@ -513,10 +684,26 @@ SLNode* SLNode::copyRec()
 }
 //-----------------------------------------------------------------------------
 /*!
-Sets the parent for this node and updates its depth
+Sets the parent for this node and updates its depth. A node with a parent is
+registered in the node index of the current scene. The dynamic type is taken
+here because it is not yet known in the constructor. Any other change of the
+parent only flags the tree order of the index.
 */
 void SLNode::parent(SLNode* p)
 {
+    // A hierarchy change invalidates the flat transform store
+    if (_store)
+        _store->invalidate();
+    else if (p && p->_store)
+        p->_store->invalidate();
+
+    if (p && !_nodeIndex && SLScene::current)
+        SLScene::current->nodeIndex().add(this);
+    else if (!p && _nodeIndex)
+        _nodeIndex->remove(this);
+    else if (_nodeIndex)
+        _nodeIndex->invalidate();
+
     _parent = p;
 
     if(_parent)
@@ -538,12 +725,19 @@ void SLNode::needUpdate()
 
     _isWMUpToDate = false;
 
+    // flag AABB for an update
+    needAABBUpdate();
+
+    // the transform store updates the subtree and flags its AABBs in its
+    // next pass, so only the world matrix recursion is deferred
+    if (_store)
+    {   _store->markDirty(_slot);
+        return;
+    }
+
     // mark the WM of the children dirty since their parent just changed
     for (auto child : _children)
         child->needUpdate();
-
-    // flag AABB for an update
-    needAABBUpdate();
 }
 //-----------------------------------------------------------------------------
 /*!
@@ -562,6 +756,11 @@ void SLNode::needWMUpdate()
 
     _isWMUpToDate = false;
 
+    if (_store)
+    {   _store->markDirty(_slot);
+        return;
+    }
+
     // mark the WM of the children dirty since their parent just changed
     for (auto child : _children)
         child->needWMUpdate();
@@ -581,6 +780,9 @@ void SLNode::needAABBUpdate()
 
     _isAABBUpToDate = false;
 
+    if (_store)
+        _store->markAABBDirty(_slot);
+
     // flag parent's for an AABB update too since they need to
     // merge the child AABBs
     if (_parent)
@@ -613,9 +815,15 @@ void SLNode::updateWM() const
 /*!
 Will retrieve the current world matrix for this node.
 If the world matrix is out of date it will update it and return a current result.
+For a node in a SLTransformStore this flushes the pending dirty list of the
+store. It is therefore not safe to call it from worker threads as long as the
+dirty list is not empty (call SLTransformStore::update before).
 */
 const SLMat4f& SLNode::updateAndGetWM() const
 {
+    if (_store)
+        _store->updateWorld();
+
     if (!_isWMUpToDate)
         updateWM();
 
@@ -625,9 +833,13 @@ const SLMat4f& SLNode::updateAndGetWM() const
 /*!
 Will retrieve the current world inverse matrix for this node.
 If the world matrix is out of date it will update it and return a current result.
+See SLNode::updateAndGetWM for the use from worker threads.
 */
 const SLMat4f& SLNode::updateAndGetWMI() const
 {
+    if (_store)
+        _store->updateWorld();
+
     if (!_isWMUpToDate)
         updateWM();
 
@@ -637,9 +849,13 @@ const SLMat4f& SLNode::updateAndGetWMI() const
 /*!
 Will retrieve the current world normal matrix for this node.
 If the world matrix is out of date it will update it and return a current result.
+See SLNode::updateAndGetWM for the use from worker threads.
 */
 const SLMat3f& SLNode::updateAndGetWMN() const
 {
+    if (_store)
+        _store->updateWorld();
+
     if (!_isWMUpToDate)
         updateWM();
 
@@ -654,6 +870,11 @@ SLAABBox& SLNode::updateAABBRec()
     if (_isAABBUpToDate)
         return _aabb;
 
+    // Apply pending world matrix changes first. They flag the AABBs of the
+    // moved subtrees, which must be merged below.
+    if (_store)
+        _store->updateWorld();
+
     // empty the AABB (= max negative AABB)
     if (_meshes.size() > 0 || _children.size() > 0)
     {   _aabb.minWS(SLVec3f( FLT_MAX, FLT_MAX, FLT_MAX));
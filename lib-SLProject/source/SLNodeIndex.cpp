@@ -0,0 +1,388 @@
+//#############################################################################
+//  File:      SLNodeIndex.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLNodeIndex.h>
+#include <SLNode.h>
+
+//-----------------------------------------------------------------------------
+//! Max. NO. of candidates that are checked by a walk up their parents
+static const size_t SL_NODEINDEX_MAX_WALK = 16;
+//-----------------------------------------------------------------------------
+//! Returns true if node a comes before node b in depth first pre-order
+SLbool SLNodeIndex::isBefore(const SLNode* a, const SLNode* b)
+{
+    return a->_indexOrder < b->_indexOrder;
+}
+//-----------------------------------------------------------------------------
+//! Returns true if the node is a child or with recursive a descendant of root
+SLbool SLNodeIndex::isBelow(const SLNode* node,
+                            const SLNode* root,
+                            SLbool recursive)
+{
+    if (!recursive) return node->_parent == root;
+    for (const SLNode* p = node->_parent; p; p = p->_parent)
+        if (p == root) return true;
+    return false;
+}
+//-----------------------------------------------------------------------------
+/*!
+Unlinks all nodes and empties the index. The destructor of SLScene calls it
+before the nodes get deleted, so that they don't remove themselves.
+*/
+void SLNodeIndex::clear()
+{
+    for (auto& type : _byType)
+        for (auto node : type.second.nodes)
+        {   node->_nodeIndex = nullptr;
+            node->_indexType = nullptr;
+            node->_indexMeshes.clear();
+        }
+    _byName.clear();
+    _byType.clear();
+    _byMesh.clear();
+    _numNodes = 0;
+    _isOrdered = true;
+}
+//-----------------------------------------------------------------------------
+/*!
+Adds a node with its name, its dynamic type and its meshes. The node is
+appended to the lists and gets numbered with the next ordered lookup.
+*/
+void SLNodeIndex::add(SLNode* node)
+{
+    assert(node && !node->_nodeIndex);
+    node->_nodeIndex = this;
+    node->_indexType = &typeid(*node);
+    node->_indexSeq = _numAdded++;
+
+    auto name = _byName.find(node->name());
+    if (name == _byName.end())
+        name = _byName.emplace(node->name(), SLNodeList(LK_name)).first;
+    append(name->second, node);
+
+    type_index typeKey(*node->_indexType);
+    auto type = _byType.find(typeKey);
+    if (type == _byType.end())
+        type = _byType.emplace(typeKey, SLNodeList(LK_type)).first;
+    append(type->second, node);
+
+    for (auto mesh : node->meshes())
+        addMesh(node, mesh);
+
+    _numNodes++;
+    _isOrdered = false;
+}
+//-----------------------------------------------------------------------------
+/*!
+Removes a node with the name, type and meshes it is indexed with. Each list
+is changed in constant time.
+*/
+void SLNodeIndex::remove(SLNode* node)
+{
+    assert(node && node->_nodeIndex == this);
+
+    auto name = _byName.find(node->name());
+    if (name != _byName.end())
+    {   removeAt(name->second, node->_indexNameSlot);
+        if (name->second.nodes.empty()) _byName.erase(name);
+    }
+
+    auto type = _byType.find(type_index(*node->_indexType));
+    if (type != _byType.end())
+    {   removeAt(type->second, node->_indexTypeSlot);
+        if (type->second.nodes.empty()) _byType.erase(type);
+    }
+
+    while (node->_indexMeshes.size())
+        removeMesh(node, node->_indexMeshes.back().first);
+
+    node->_nodeIndex = nullptr;
+    node->_indexType = nullptr;
+    _numNodes--;
+}
+//-----------------------------------------------------------------------------
+//! Moves a node from the list of its old name to the list of the new name
+void SLNodeIndex::rename(SLNode* node,
+                         const SLstring& oldName,
+                         const SLstring& newName)
+{
+    auto name = _byName.find(oldName);
+    if (name != _byName.end())
+    {   removeAt(name->second, node->_indexNameSlot);
+        if (name->second.nodes.empty()) _byName.erase(name);
+    }
+
+    name = _byName.find(newName);
+    if (name == _byName.end())
+        name = _byName.emplace(newName, SLNodeList(LK_name)).first;
+    append(name->second, node);
+}
+//-----------------------------------------------------------------------------
+//! Adds the node to the list of the mesh if it isn't yet in it
+void SLNodeIndex::addMesh(SLNode* node, const SLMesh* mesh)
+{
+    for (auto& indexed : node->_indexMeshes)
+        if (indexed.first == mesh) return;
+
+    auto nodes = _byMesh.find(mesh);
+    if (nodes == _byMesh.end())
+        nodes = _byMesh.emplace(mesh, SLNodeList(LK_mesh, mesh)).first;
+    node->_indexMeshes.push_back(make_pair(mesh, 0u));
+    append(nodes->second, node);
+}
+//-----------------------------------------------------------------------------
+//! Removes the node from the list of the mesh
+void SLNodeIndex::removeMesh(SLNode* node, const SLMesh* mesh)
+{
+    auto& meshes = node->_indexMeshes;
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {   if (meshes[i].first != mesh) continue;
+
+        SLuint slot = meshes[i].second;
+        meshes[i] = meshes.back();
+        meshes.pop_back();
+
+        auto nodes = _byMesh.find(mesh);
+        if (nodes != _byMesh.end())
+        {   removeAt(nodes->second, slot);
+            if (nodes->second.nodes.empty()) _byMesh.erase(nodes);
+        }
+        return;
+    }
+}
+//-----------------------------------------------------------------------------
+//! Appends the node to the list and stores its slot in the node
+void SLNodeIndex::append(SLNodeList& list, SLNode* node)
+{
+    list.nodes.push_back(node);
+    list.sortedStamp = 0;
+    setSlot(list, (SLuint)list.nodes.size() - 1);
+}
+//-----------------------------------------------------------------------------
+//! Removes the node at the slot by moving the last node of the list into it
+void SLNodeIndex::removeAt(SLNodeList& list, SLuint slot)
+{
+    assert(slot < list.nodes.size());
+    if (slot + 1 < list.nodes.size())
+    {   list.nodes[slot] = list.nodes.back();
+        setSlot(list, slot);
+        list.sortedStamp = 0;
+    }
+    list.nodes.pop_back();
+}
+//-----------------------------------------------------------------------------
+//! Stores the slot in the node at this slot for the key kind of the list
+void SLNodeIndex::setSlot(SLNodeList& list, SLuint slot)
+{
+    SLNode* node = list.nodes[slot];
+    switch (list.kind)
+    {   case LK_name: node->_indexNameSlot = slot; break;
+        case LK_type: node->_indexTypeSlot = slot; break;
+        case LK_mesh:
+            for (auto& indexed : node->_indexMeshes)
+                if (indexed.first == list.mesh) indexed.second = slot;
+            break;
+    }
+}
+//-----------------------------------------------------------------------------
+//! Sorts the list in the current tree order if it isn't yet
+void SLNodeIndex::sortList(SLNodeList& list)
+{
+    updateOrder();
+    if (list.sortedStamp == _orderStamp) return;
+
+    std::sort(list.nodes.begin(), list.nodes.end(), isBefore);
+    for (SLuint i = 0; i < list.nodes.size(); ++i)
+        setSlot(list, i);
+    list.sortedStamp = _orderStamp;
+}
+//-----------------------------------------------------------------------------
+/*!
+Rebuilds the depth first numbering if the hierarchy changed since the last
+ordered lookup. The traversal starts at the parents of the indexed nodes that
+are not indexed themselves (e.g. SLScene::_root3D) in the order in which their
+first child got added, so the numbering does not depend on the hashing.
+The lists only get sorted again when they are used.
+*/
+void SLNodeIndex::updateOrder()
+{
+    if (_isOrdered) return;
+
+    unordered_map<SLNode*, SLuint> firstSeq;
+    for (auto& type : _byType)
+        for (auto node : type.second.nodes)
+            if (node->_parent->_nodeIndex != this)
+            {   auto root = firstSeq.find(node->_parent);
+                if (root == firstSeq.end())
+                     firstSeq.emplace(node->_parent, node->_indexSeq);
+                else root->second = SL_min(root->second, node->_indexSeq);
+            }
+
+    vector<pair<SLuint, SLNode*>> roots;
+    roots.reserve(firstSeq.size());
+    for (auto& root : firstSeq)
+        roots.push_back(make_pair(root.second, root.first));
+    std::sort(roots.begin(), roots.end());
+
+    SLuint order = 0;
+    for (auto& root : roots)
+        numberRec(root.second, order);
+
+    _orderStamp++;
+    _isOrdered = true;
+}
+//-----------------------------------------------------------------------------
+//! Numbers the node & its indexed subtree in depth first pre-order
+void SLNodeIndex::numberRec(SLNode* node, SLuint& order)
+{
+    node->_indexOrder = order++;
+
+    for (auto child : node->_children)
+        if (child->_nodeIndex == this)
+            numberRec(child, order);
+
+    node->_indexLast = order - 1;
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns true if the root got a number: It must be indexed itself or be the
+parent of an indexed node. Otherwise nothing of this index is below it.
+*/
+SLbool SLNodeIndex::isNumbered(SLNode* root) const
+{
+    if (root->_nodeIndex == this) return true;
+    for (auto child : root->_children)
+        if (child->_nodeIndex == this) return true;
+    return false;
+}
+//-----------------------------------------------------------------------------
+/*!
+Appends the nodes of the list that are below the root and pass the filter to
+found. Short lists are checked node by node with a walk up the parents. Long
+lists get sorted in tree order, where the nodes below the root are the range
+with the numbers after the root number up to the last number of its subtree.
+*/
+void SLNodeIndex::collect(SLNode* root,
+                          SLNodeList& list,
+                          SLbool recursive,
+                          SLNodeFilter filter,
+                          vector<SLNode*>& found)
+{
+    if (list.nodes.size() <= SL_NODEINDEX_MAX_WALK)
+    {   for (auto node : list.nodes)
+            if (isBelow(node, root, recursive) && (!filter || filter(node)))
+                found.push_back(node);
+        return;
+    }
+
+    sortList(list);
+    if (!isNumbered(root)) return;
+
+    auto it = std::upper_bound(list.nodes.begin(), list.nodes.end(), root, isBefore);
+    for (; it != list.nodes.end() && (*it)->_indexOrder <= root->_indexLast; ++it)
+    {   if ((recursive || (*it)->_parent == root) && (!filter || filter(*it)))
+            found.push_back(*it);
+    }
+}
+//-----------------------------------------------------------------------------
+//! Sorts the nodes of found from begin on in tree order if there are several
+void SLNodeIndex::sortFound(vector<SLNode*>& found, size_t begin)
+{
+    if (found.size() - begin < 2) return;
+    updateOrder();
+    std::sort(found.begin() + begin, found.end(), isBefore);
+}
+//-----------------------------------------------------------------------------
+/*!
+Appends the nodes with the passed name below the root that pass the type
+filter to found in depth first order. If the name is empty all nodes of the
+types that pass the filter are found. All nodes of a type list have the same
+dynamic type, so the filter is applied once per list.
+*/
+void SLNodeIndex::findAll(SLNode* root,
+                          const SLstring& name,
+                          SLbool recursive,
+                          SLNodeFilter filter,
+                          vector<SLNode*>& found)
+{
+    if (!root) return;
+    size_t numBefore = found.size();
+
+    if (name.size())
+    {   auto nodes = _byName.find(name);
+        if (nodes != _byName.end())
+            collect(root, nodes->second, recursive, filter, found);
+    } else
+    {   for (auto& type : _byType)
+            if (type.second.nodes.size() && filter(type.second.nodes[0]))
+                collect(root, type.second, recursive, nullptr, found);
+    }
+
+    sortFound(found, numBefore);
+}
+//-----------------------------------------------------------------------------
+/*!
+Appends the nodes below the root that contain the mesh to found in depth
+first order.
+*/
+void SLNodeIndex::findAll(SLNode* root,
+                          const SLMesh* mesh,
+                          SLbool recursive,
+                          vector<SLNode*>& found)
+{
+    if (!root) return;
+    size_t numBefore = found.size();
+
+    auto nodes = _byMesh.find(mesh);
+    if (nodes != _byMesh.end())
+        collect(root, nodes->second, recursive, nullptr, found);
+
+    sortFound(found, numBefore);
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns the first node below the root with the name and type that the tree
+search SLNode::findChildRec would return: The direct children of a node are
+checked before the subtrees of the children. A single match is returned
+without the tree order. Out of several matches in depth first order this is a
+direct child of the root if there is one. Otherwise it is the first match in
+the subtree of the child that holds the first match.
+*/
+SLNode* SLNodeIndex::findFirst(SLNode* root,
+                               const SLstring& name,
+                               SLbool recursive,
+                               SLNodeFilter filter)
+{
+    vector<SLNode*> found;
+    findAll(root, name, recursive, filter, found);
+    if (found.empty()) return nullptr;
+    if (found.size() == 1) return found[0];
+
+    size_t  begin = 0, end = found.size();
+    SLNode* parent = root;
+    for (;;)
+    {   for (size_t i=begin; i<end; ++i)
+            if (found[i]->_parent == parent) return found[i];
+
+        // Descend into the child of parent that holds the first match
+        SLNode* child = found[begin];
+        while (child->_parent != parent) child = child->_parent;
+        end = begin;
+        while (end < found.size() && found[end]->_indexOrder <= child->_indexLast)
+            ++end;
+        parent = child;
+    }
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,364 @@
+//#############################################################################
+//  File:      SLOcclusionCuller.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLOcclusionCuller.h>
+#include <SLMesh.h>
+#include <SLAABBox.h>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define SL_OCCLUSION_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+//! Width of the depth buffer in pixels (must be a multiple of 4)
+static const SLint SL_OCCLUSION_BUFFER_W = 256;
+//-----------------------------------------------------------------------------
+SLOcclusionCuller::SLOcclusionCuller()
+{
+    _w = 0;
+    _h = 0;
+    _numTriangles = 0;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLOcclusionCuller::clear resizes the depth buffer for the passed aspect ratio,
+clears it to the far plane and stores the view projection matrix for the
+following rasterization and visibility tests.
+*/
+void SLOcclusionCuller::clear(SLfloat aspectWdivH,
+                              const SLMat4f& viewProjection)
+{
+    _vp = viewProjection;
+    _numTriangles = 0;
+
+    SLint h = (SLint)((SLfloat)SL_OCCLUSION_BUFFER_W / aspectWdivH + 0.5f);
+    h = SL_clamp(h, 1, SL_OCCLUSION_BUFFER_W*4);
+
+    if (_w != SL_OCCLUSION_BUFFER_W || _h != h)
+    {   _w = SL_OCCLUSION_BUFFER_W;
+        _h = h;
+        _levels.clear();
+        _levelW.clear();
+        _levelH.clear();
+
+        SLint lw = _w, lh = _h;
+        for(;;)
+        {   _levels.push_back(SLVfloat(lw*lh));
+            _levelW.push_back(lw);
+            _levelH.push_back(lh);
+            if (lw == 1 && lh == 1) break;
+            lw = (lw+1) / 2;
+            lh = (lh+1) / 2;
+        }
+    }
+
+    std::fill(_levels[0].begin(), _levels[0].end(), 1.0f);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLOcclusionCuller::rasterize transforms the final vertex positions of a
+triangle mesh with the world matrix wm into clip space and rasterizes the
+triangles of the LOD level lodLevel into the level 0 depth buffer. For a LOD
+level > 0 only the vertices it references are transformed. Back faces are
+skipped if cullBackFaces is true so that one sided occluders only occlude what
+OpenGL hides as well.
+*/
+void SLOcclusionCuller::rasterize(SLMesh* mesh,
+                                  SLint lodLevel,
+                                  const SLMat4f& wm,
+                                  SLbool cullBackFaces)
+{
+    if (mesh->primitive() != PT_triangles || !mesh->numI()) return;
+
+    SLMat4f mvp(_vp * wm);
+    SLuint numP = (SLuint)mesh->P.size();
+    SLint  level = mesh->validLOD(lodLevel);
+    SLuint numI = mesh->lodNumI(level);
+    _clipP.resize(numP);
+
+    SLVec4f clip[3];
+    if (level)
+    {   const SLuint* lodI = mesh->lodIndices(level);
+        _isClipped.assign(numP, false);
+        for (SLuint i=0; i<numI; i+=3)
+        {   for (SLint k=0; k<3; ++k)
+            {   SLuint v = lodI[i+k];
+                if (!_isClipped[v])
+                {   _clipP[v] = mvp * SLVec4f(mesh->finalP(v));
+                    _isClipped[v] = true;
+                }
+                clip[k] = _clipP[v];
+            }
+            rasterizeTriangle(clip, cullBackFaces);
+        }
+    } else
+    {   for (SLuint i=0; i<numP; ++i)
+            _clipP[i] = mvp * SLVec4f(mesh->finalP(i));
+
+        for (SLuint i=0; i<numI; i+=3)
+        {   for (SLint k=0; k<3; ++k)
+                clip[k] = _clipP[mesh->I16.size() ? mesh->I16[i+k] : mesh->I32[i+k]];
+            rasterizeTriangle(clip, cullBackFaces);
+        }
+    }
+    _numTriangles += numI / 3;
+}
+//-----------------------------------------------------------------------------
+//! Signed distance of a clip space vertex to the clip plane p (>=0 is inside)
+static inline SLfloat clipDist(const SLVec4f& v, SLint p)
+{
+    switch (p)
+    {   case 0:  return v.w + v.z;  // near
+        case 1:  return v.w + v.x;  // left
+        case 2:  return v.w - v.x;  // right
+        case 3:  return v.w + v.y;  // bottom
+        default: return v.w - v.y;  // top
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+SLOcclusionCuller::rasterizeTriangle clips a clip space triangle against the
+near and the 4 side planes of the frustum and passes the resulting triangle
+fan in screen coordinates to rasterizeScreen. Clipping against the side planes
+keeps the screen coordinates small for the edge functions.
+*/
+void SLOcclusionCuller::rasterizeTriangle(const SLVec4f* clip,
+                                          SLbool cullBackFaces)
+{
+    // Trivial reject and accept with the outcodes of the 3 vertices
+    SLuint outAnd = 0x1F, outOr = 0;
+    for (SLint k=0; k<3; ++k)
+    {   SLuint code = 0;
+        for (SLint p=0; p<5; ++p)
+            if (clipDist(clip[k], p) < 0.0f) code |= 1 << p;
+        outAnd &= code;
+        outOr  |= code;
+    }
+    if (outAnd) return;
+
+    // Sutherland-Hodgman clipping in homogeneous coordinates
+    SLVec4f poly[2][9];
+    SLint   num = 3, cur = 0;
+    for (SLint k=0; k<3; ++k) poly[0][k] = clip[k];
+
+    if (outOr)
+    {   for (SLint p=0; p<5; ++p)
+        {   if (!(outOr & (1 << p))) continue;
+            SLVec4f* in  = poly[cur];
+            SLVec4f* out = poly[1-cur];
+            SLint numOut = 0;
+            for (SLint k=0; k<num; ++k)
+            {   const SLVec4f& a = in[k];
+                const SLVec4f& b = in[(k+1) % num];
+                SLfloat da = clipDist(a, p);
+                SLfloat db = clipDist(b, p);
+                if (da >= 0.0f) out[numOut++] = a;
+                if ((da >= 0.0f) != (db >= 0.0f))
+                {   SLfloat t = da / (da - db);
+                    out[numOut++].set(a.x + t*(b.x-a.x),
+                                      a.y + t*(b.y-a.y),
+                                      a.z + t*(b.z-a.z),
+                                      a.w + t*(b.w-a.w));
+                }
+            }
+            num = numOut;
+            cur = 1-cur;
+            if (num < 3) return;
+        }
+    }
+
+    // Perspective division and viewport transform
+    SLVec3f scr[9];
+    for (SLint k=0; k<num; ++k)
+    {   const SLVec4f& v = poly[cur][k];
+        SLfloat invW = 1.0f / v.w;
+        scr[k].set((v.x*invW*0.5f + 0.5f) * (SLfloat)_w,
+                   (v.y*invW*0.5f + 0.5f) * (SLfloat)_h,
+                   v.z*invW);
+    }
+
+    for (SLint k=1; k<num-1; ++k)
+        rasterizeScreen(scr[0], scr[k], scr[k+1], cullBackFaces);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLOcclusionCuller::rasterizeScreen rasterizes a screen space triangle with
+edge functions sampled at the pixel centers. The depth plane of the triangle
+is evaluated at the farthest pixel corner and clamped to the farthest vertex
+depth. Each covered pixel keeps the nearest depth.
+*/
+void SLOcclusionCuller::rasterizeScreen(SLVec3f v0,
+                                        SLVec3f v1,
+                                        SLVec3f v2,
+                                        SLbool cullBackFaces)
+{
+    SLfloat area = (v1.x-v0.x)*(v2.y-v0.y) - (v2.x-v0.x)*(v1.y-v0.y);
+    if (area < 0.0f)
+    {   if (cullBackFaces) return;
+        std::swap(v1, v2);
+        area = -area;
+    }
+    if (area < FLT_EPSILON) return;
+
+    // Pixel bounding box with the pixel centers inside the triangle bbox
+    SLint minX = max(0,    (SLint)ceil (min(v0.x, min(v1.x, v2.x)) - 0.5f));
+    SLint maxX = min(_w-1, (SLint)floor(max(v0.x, max(v1.x, v2.x)) - 0.5f));
+    SLint minY = max(0,    (SLint)ceil (min(v0.y, min(v1.y, v2.y)) - 0.5f));
+    SLint maxY = min(_h-1, (SLint)floor(max(v0.y, max(v1.y, v2.y)) - 0.5f));
+    if (minX > maxX || minY > maxY) return;
+
+    // Depth plane z = v0.z + dzdx*(x-v0.x) + dzdy*(y-v0.y)
+    SLfloat dzdx = ((v1.z-v0.z)*(v2.y-v0.y) - (v2.z-v0.z)*(v1.y-v0.y)) / area;
+    SLfloat dzdy = ((v2.z-v0.z)*(v1.x-v0.x) - (v1.z-v0.z)*(v2.x-v0.x)) / area;
+    SLfloat zBias = 0.5f * (fabs(dzdx) + fabs(dzdy));
+    SLfloat zMax = max(v0.z, max(v1.z, v2.z));
+
+    // Edge function E_ab(p) = (b.x-a.x)*(p.y-a.y) - (b.y-a.y)*(p.x-a.x)
+    SLfloat dx0 = v0.y-v1.y, dy0 = v1.x-v0.x; // edge v0->v1
+    SLfloat dx1 = v1.y-v2.y, dy1 = v2.x-v1.x; // edge v1->v2
+    SLfloat dx2 = v2.y-v0.y, dy2 = v0.x-v2.x; // edge v2->v0
+
+    // Start at a 4 pixel aligned x for the SIMD loop
+    SLint startX = minX & ~3;
+
+    for (SLint y=minY; y<=maxY; ++y)
+    {   SLfloat px = (SLfloat)startX + 0.5f;
+        SLfloat py = (SLfloat)y + 0.5f;
+        SLfloat e0 = dy0*(py-v0.y) + dx0*(px-v0.x);
+        SLfloat e1 = dy1*(py-v1.y) + dx1*(px-v1.x);
+        SLfloat e2 = dy2*(py-v2.y) + dx2*(px-v2.x);
+        SLfloat z  = v0.z + dzdx*(px-v0.x) + dzdy*(py-v0.y) + zBias;
+        SLfloat* row = &_levels[0][y*_w];
+
+        #ifdef SL_OCCLUSION_USE_SSE
+        const __m128 offs = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 four = _mm_set1_ps(4.0f);
+        __m128 ve0  = _mm_add_ps(_mm_set1_ps(e0), _mm_mul_ps(_mm_set1_ps(dx0), offs));
+        __m128 ve1  = _mm_add_ps(_mm_set1_ps(e1), _mm_mul_ps(_mm_set1_ps(dx1), offs));
+        __m128 ve2  = _mm_add_ps(_mm_set1_ps(e2), _mm_mul_ps(_mm_set1_ps(dx2), offs));
+        __m128 vz   = _mm_add_ps(_mm_set1_ps(z),  _mm_mul_ps(_mm_set1_ps(dzdx), offs));
+        __m128 vx   = _mm_add_ps(_mm_set1_ps((SLfloat)startX), offs);
+        __m128 sx0  = _mm_set1_ps(4.0f*dx0);
+        __m128 sx1  = _mm_set1_ps(4.0f*dx1);
+        __m128 sx2  = _mm_set1_ps(4.0f*dx2);
+        __m128 sz   = _mm_set1_ps(4.0f*dzdx);
+        __m128 vMax = _mm_set1_ps(zMax);
+        __m128 vMinX= _mm_set1_ps((SLfloat)minX);
+        __m128 vMaxX= _mm_set1_ps((SLfloat)maxX);
+
+        for (SLint x=startX; x<=maxX; x+=4)
+        {   __m128 mask = _mm_and_ps(_mm_cmpge_ps(ve0, zero), _mm_cmpge_ps(ve1, zero));
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(ve2, zero));
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(vx, vMinX));
+            mask = _mm_and_ps(mask, _mm_cmple_ps(vx, vMaxX));
+            if (_mm_movemask_ps(mask))
+            {   __m128 old = _mm_loadu_ps(row+x);
+                __m128 dep = _mm_min_ps(old, _mm_min_ps(vz, vMax));
+                _mm_storeu_ps(row+x, _mm_or_ps(_mm_and_ps(mask, dep),
+                                               _mm_andnot_ps(mask, old)));
+            }
+            ve0 = _mm_add_ps(ve0, sx0);
+            ve1 = _mm_add_ps(ve1, sx1);
+            ve2 = _mm_add_ps(ve2, sx2);
+            vz  = _mm_add_ps(vz,  sz);
+            vx  = _mm_add_ps(vx,  four);
+        }
+        #else
+        for (SLint x=startX; x<=maxX; ++x)
+        {   if (x >= minX && e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f)
+                row[x] = min(row[x], min(z, zMax));
+            e0 += dx0;
+            e1 += dx1;
+            e2 += dx2;
+            z  += dzdx;
+        }
+        #endif
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+SLOcclusionCuller::buildPyramid builds the depth pyramid from the level 0
+buffer. Each texel gets the max. depth of its up to 4 child texels. At odd
+sizes the last texel only has the remaining children.
+*/
+void SLOcclusionCuller::buildPyramid()
+{
+    for (SLuint l=1; l<_levels.size(); ++l)
+    {   const SLVfloat& src = _levels[l-1];
+        SLVfloat& dst = _levels[l];
+        SLint srcW = _levelW[l-1], srcH = _levelH[l-1];
+        SLint dstW = _levelW[l],   dstH = _levelH[l];
+
+        for (SLint y=0; y<dstH; ++y)
+        {   SLint y0 = y*2, y1 = min(y*2+1, srcH-1);
+            for (SLint x=0; x<dstW; ++x)
+            {   SLint x0 = x*2, x1 = min(x*2+1, srcW-1);
+                dst[y*dstW+x] = max(max(src[y0*srcW+x0], src[y0*srcW+x1]),
+                                    max(src[y1*srcW+x0], src[y1*srcW+x1]));
+            }
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+SLOcclusionCuller::isVisible tests the world space AABB against the depth
+pyramid. AABBs that intersect the near plane are always visible. The screen
+rectangle of the AABB is tested on the first pyramid level where it covers
+at most 4x4 texels.
+*/
+SLbool SLOcclusionCuller::isVisible(SLAABBox* aabb)
+{
+    if (_levels.empty()) return true;
+
+    SLVec3f minWS = aabb->minWS();
+    SLVec3f maxWS = aabb->maxWS();
+    SLfloat minX =  FLT_MAX, minY =  FLT_MAX, minZ = FLT_MAX;
+    SLfloat maxX = -FLT_MAX, maxY = -FLT_MAX;
+
+    for (SLint i=0; i<8; ++i)
+    {   SLVec4f c = _vp * SLVec4f(i & 1 ? maxWS.x : minWS.x,
+                                  i & 2 ? maxWS.y : minWS.y,
+                                  i & 4 ? maxWS.z : minWS.z);
+        if (c.w <= FLT_EPSILON || c.z < -c.w) return true;
+        SLfloat invW = 1.0f / c.w;
+        SLfloat x = (c.x*invW*0.5f + 0.5f) * (SLfloat)_w;
+        SLfloat y = (c.y*invW*0.5f + 0.5f) * (SLfloat)_h;
+        minX = min(minX, x); maxX = max(maxX, x);
+        minY = min(minY, y); maxY = max(maxY, y);
+        minZ = min(minZ, c.z*invW);
+    }
+
+    // All texels touched by the screen rectangle
+    SLint x0 = max(0,    (SLint)floor(minX));
+    SLint x1 = min(_w-1, (SLint)floor(maxX));
+    SLint y0 = max(0,    (SLint)floor(minY));
+    SLint y1 = min(_h-1, (SLint)floor(maxY));
+    if (x0 > x1 || y0 > y1) return false;
+
+    SLuint l = 0;
+    while (l < _levels.size()-1 &&
+           ((x1 >> l) - (x0 >> l) > 3 || (y1 >> l) - (y0 >> l) > 3)) l++;
+
+    const SLVfloat& depth = _levels[l];
+    SLint w = _levelW[l];
+    for (SLint y=(y0 >> l); y<=(y1 >> l); ++y)
+        for (SLint x=(x0 >> l); x<=(x1 >> l); ++x)
+            if (minZ <= depth[y*w+x]) return true;
+
+    return false;
+}
+//-----------------------------------------------------------------------------
@@ -30,14 +30,21 @@ using namespace std::chrono;
 #include <SLSamples2D.h>
 #include <SLGLProgram.h>
 #include <SLRay.h>
-
-extern SLfloat rnd01();
+#include <SLSampler.h>
 
 //-----------------------------------------------------------------------------
 SLPathtracer::SLPathtracer()
 {  
     name("PathTracer");
     _gamma = 2.2f;
+    _samplerType = ST_sobol;
+    _reference = nullptr;
+}
+//-----------------------------------------------------------------------------
+SLPathtracer::~SLPathtracer()
+{
+    SL_LOG("~SLPathtracer\n");
+    delete _reference;
 }
 
 //-----------------------------------------------------------------------------
@@ -46,6 +53,7 @@ Main render function. The Path Tracing algorithm starts from here
 */
 SLbool SLPathtracer::render(SLSceneView* sv)
 {
+    SL_PROFILE_SCOPE("SLPathtracer::render");
     _sv = sv;
     _state = rtBusy;                    // From here we state the PT as busy
     _stateGL = SLGLState::getInstance();// OpenGL state shortcut
@@ -56,8 +64,16 @@ SLbool SLPathtracer::render(SLSceneView* sv)
 
     prepareImage();
 
-    // Set second image for render update to the same size
-    _images.push_back(new SLImage(_sv->scrW(), _sv->scrH(), PF_rgb));
+    // Set second image with linear float colors for the accumulation
+    if (_images.size() < 2)
+         _images.push_back(new SLImage(_sv->scrW(), _sv->scrH(), PF_rgb, PD_float));
+    else _images[1]->allocate(_sv->scrW(), _sv->scrH(), PF_rgb, PD_float);
+
+    // Measure the RMSE only against a reference of the same size
+    _rmse.clear();
+    SLbool measureRMSE = _reference &&
+                         _reference->width() == _images[1]->width() &&
+                         _reference->height() == _images[1]->height();
 
     // Measure time 
     double t1 = SLScene::current->timeSec();
@@ -66,10 +82,12 @@ SLbool SLPathtracer::render(SLSceneView* sv)
 
     // Do multi threading only in release config
     
-    SL_LOG("\n\nRendering with %d samples", _aaSamples);
+    SL_LOG("\n\nRendering with %d samples of the %s sampler",
+           _aaSamples, SLSampler::typeName(_samplerType));
     SL_LOG("\nCurrent Sample:       ");
     for (int currentSample = 1; currentSample <= _aaSamples; currentSample++)
     {
+        SL_PROFILE_SCOPE("SLPathtracer::sample");
         SL_LOG("\b\b\b\b\b\b%6d", currentSample);
         vector<thread> threads; // vector for additional threads  
         _next = 0;              // init _next=0. _next should be atomic
@@ -83,6 +101,8 @@ SLbool SLPathtracer::render(SLSceneView* sv)
 
         for (auto& thread : threads) thread.join();
 
+        if (measureRMSE) _rmse.push_back(rmseToReference());
+
         _pcRendered = (SLint)((SLfloat)currentSample/(SLfloat)_aaSamples*100.0f);
     }
     
@@ -92,6 +112,15 @@ SLbool SLPathtracer::render(SLSceneView* sv)
 
     SL_LOG("\nTime to render image: %6.3fsec", _renderSec);
 
+    // Log the convergence for each power of 2 samples
+    if (_rmse.size())
+    {   SL_LOG("\nRMSE to reference (samples: RMSE):");
+        for (SLuint n = 1; n <= _rmse.size(); n *= 2)
+            SL_LOG(" %d: %.5f", n, _rmse[n-1]);
+        if (_rmse.size() & (_rmse.size()-1))
+            SL_LOG(" %d: %.5f", (SLint)_rmse.size(), _rmse.back());
+    }
+
     _state = rtFinished;
     return true;
 }
@@ -102,6 +131,9 @@ Renders a slice of 4px width.
 */
 void SLPathtracer::renderSlices(const bool isMainThread, SLint currentSample)
 {
+    if (!isMainThread) SL_PROFILE_THREAD("PT Worker");
+    SL_PROFILE_SCOPE("SLPathtracer::renderSlices");
+
     // Time points
     double t1 = 0;
     const SLfloat oneOverGamma = 1.0f / _gamma;
@@ -119,9 +151,14 @@ void SLPathtracer::renderSlices(const bool isMainThread, SLint currentSample)
             {
                 SLCol4f color(SLCol4f::BLACK);
 
-                // calculate direction for primary ray - scatter with random variables for anti aliasing
+                // sampler for all random numbers of the path of this sample
+                SLSampler sampler(_samplerType, (SLuint)x, y, (SLuint)currentSample-1);
+
+                // calculate direction for primary ray - scatter with the pixel sample for anti aliasing
+                SLVec2f jitter(sampler.get2D(SLSampler::pairPixel()));
                 SLRay primaryRay;
-                setPrimaryRay((SLfloat)(x - rnd01() + 0.5f), (SLfloat)(y - rnd01() + 0.5f), &primaryRay);
+                setPrimaryRay((SLfloat)x - jitter.x + 0.5f, (SLfloat)y - jitter.y + 0.5f, &primaryRay);
+                primaryRay.sampler = &sampler;
 
                 ///////////////////////////////
                 color += trace(&primaryRay, 0);
@@ -144,11 +181,11 @@ void SLPathtracer::renderSlices(const bool isMainThread, SLint currentSample)
                     color += oldColor;
                 }
 
-                color.clampMinMax(0.0f, 1.0f);
-
-                // save image without gamma
+                // save linear image without clamping and gamma
                 _images[1]->setPixeliRGB(x, y, color);
 
+                color.clampMinMax(0.0f, 1.0f);
+
                 // gamma correction
                 color.x = pow((color.x), oneOverGamma);
                 color.y = pow((color.y), oneOverGamma);
@@ -303,7 +340,7 @@ SLCol4f SLPathtracer::trace(SLRay* ray, SLbool em)
         }
 
         // probability of reflection
-        if (rnd01() > (0.25f + 0.5f * schlick))
+        if (ray->sampleChoice() > (0.25f + 0.5f * schlick))
             // scatter toward transmissive direction
             finalColor += ((mat->translucency() + 2.0f) / (mat->translucency() + 1.0f) * (trace(&refracted, 1) & objectColor) * refractionProbability) * scaleBy;
         else
@@ -345,6 +382,7 @@ SLCol4f SLPathtracer::shade(SLRay* ray, SLCol4f* objectColor)
             LdN = L.dot(N);
 
             // check shadow ray if hit point is towards the light
+            if (ray->sampler) ray->sampler->light((SLuint)i);
             lighted = (SLfloat)((LdN > 0) ? light->shadowTestMC(ray, L, lightDist) : 0);
 
             // calculate spot effect if light is a spotlight
@@ -380,11 +418,67 @@ SLCol4f SLPathtracer::shade(SLRay* ray, SLCol4f* objectColor)
     return color;
 }
 //-----------------------------------------------------------------------------
-//! Saves the current PT image as PNG image
+//! Saves the current PT image as PNG image and the linear image as HDR image
 void SLPathtracer::saveImage()
 {   static SLint no = 0;
     SLchar filename[255];  
-    sprintf(filename,"Pathtraced_%d_%d.png", _aaSamples, no++);
+    sprintf(filename,"Pathtraced_%d_%d.png", _aaSamples, no);
     _images[0]->savePNG(filename);
+    if (_images.size() > 1)
+    {   sprintf(filename,"Pathtraced_%d_%d.hdr", _aaSamples, no);
+        _images[1]->saveHDR(filename);
+    }
+    no++;
+}
+//-----------------------------------------------------------------------------
+/*!
+Sets a copy of the current linear image as reference for the RMSE measurement.
+Render it before with many samples. Returns false if there is no image yet.
+*/
+SLbool SLPathtracer::setReference()
+{
+    if (_images.size() < 2) return false;
+    delete _reference;
+    _reference = new SLImage(*_images[1]);
+    state(rtReady);
+    return true;
+}
+//-----------------------------------------------------------------------------
+/*!
+Loads a linear HDR image saved by saveImage as reference for the RMSE
+measurement. Returns false if the file doesn't exist.
+*/
+SLbool SLPathtracer::loadReference(SLstring filename)
+{
+    if (!SLFileSystem::fileExists(filename))
+    {   SL_LOG("SLPathtracer::loadReference: File not found: %s\n", filename.c_str());
+        return false;
+    }
+    delete _reference;
+    _reference = new SLImage(filename);
+    state(rtReady);
+    return true;
+}
+//-----------------------------------------------------------------------------
+//! Deletes the reference image
+void SLPathtracer::clearReference()
+{
+    delete _reference;
+    _reference = nullptr;
+    _rmse.clear();
+}
+//-----------------------------------------------------------------------------
+//! Returns the root mean square error of the linear image to the reference
+SLfloat SLPathtracer::rmseToReference()
+{
+    SLImage* img = _images[1];
+    double sum = 0.0;
+    for (SLint y = 0; y < (SLint)img->height(); ++y)
+    {   for (SLint x = 0; x < (SLint)img->width(); ++x)
+        {   SLCol4f d(img->getPixeli(x, y) - _reference->getPixeli(x, y));
+            sum += d.r*d.r + d.g*d.g + d.b*d.b;
+        }
+    }
+    return (SLfloat)sqrt(sum / (3.0 * img->width() * img->height()));
 }
 //-----------------------------------------------------------------------------
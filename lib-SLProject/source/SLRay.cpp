@@ -14,6 +14,7 @@
 
 #include <SLRay.h>
 #include <SLMesh.h>
+#include <SLSampler.h>
 
 // init static variables
 SLint   SLRay::maxDepth = 0;
@@ -60,9 +61,12 @@ SLRay::SLRay()
     srcNode         = nullptr;
     srcMesh         = nullptr;
     srcTriangle     = -1;
+    sampler         = nullptr;
     x               = -1;
     y               = -1;
     contrib         = 1.0f;
+    coneWidth       = 0.0f;
+    coneSpread      = 0.0f;
     isOutside       = true;
     isInsideVolume  = false;
 }
@@ -86,9 +90,12 @@ SLRay::SLRay(SLVec3f Origin, SLVec3f Dir, SLfloat X, SLfloat Y, SLCol4f backColo
     srcNode         = nullptr;
     srcMesh         = nullptr;
     srcTriangle     = -1;
+    sampler         = nullptr;
     x               = (SLfloat)X;
     y               = (SLfloat)Y;
     contrib         = 1.0f;
+    coneWidth       = 0.0f;
+    coneSpread      = 0.0f;
     isOutside       = true;
     isInsideVolume  = false;
     backgroundColor = backColor;
@@ -116,10 +123,13 @@ SLRay::SLRay(SLfloat distToLight,
     srcNode         = rayFromHitPoint->hitNode;
     srcMesh         = rayFromHitPoint->hitMesh;
     srcTriangle     = rayFromHitPoint->hitTriangle;
+    sampler         = rayFromHitPoint->sampler;
     x               = rayFromHitPoint->x;
     y               = rayFromHitPoint->y;
     backgroundColor = rayFromHitPoint->backgroundColor;
     contrib         = 0.0f;
+    coneWidth       = 0.0f;
+    coneSpread      = 0.0f;
     isOutside       = rayFromHitPoint->isOutside;
     shadowRays++;
 }
@@ -154,9 +164,12 @@ void SLRay::reflect(SLRay* reflected)
     reflected->depth = depth + 1;
     reflected->length = FLT_MAX;
     reflected->contrib = contrib * hitMesh->mat->kr();
+    reflected->coneWidth = coneWidthAtHit();
+    reflected->coneSpread = coneSpread;
     reflected->srcNode = hitNode;
     reflected->srcMesh = hitMesh;
     reflected->srcTriangle = hitTriangle;
+    reflected->sampler = sampler;
     reflected->type = REFLECTED;
     reflected->isOutside = isOutside;
     reflected->x = x;
@@ -272,7 +285,10 @@ void SLRay::refract(SLRay* refracted)
     refracted->srcNode = hitNode;
     refracted->srcMesh = hitMesh;
     refracted->srcTriangle = hitTriangle;
+    refracted->sampler = sampler;
     refracted->depth = depth + 1;
+    refracted->coneWidth = coneWidthAtHit();
+    refracted->coneSpread = coneSpread;
     refracted->x = x;
     refracted->y = y;
     refracted->backgroundColor = backgroundColor;
@@ -304,8 +320,9 @@ bool SLRay::reflectMC(SLRay* reflected,SLMat3f rotMat)
     SLfloat shininess = hitMesh->mat->shininess();
 
     //scatter within specular lobe
-    eta1 = rnd01();
-    eta2 = SL_2PI*rnd01();
+    SLVec2f eta = sampleBSDF();
+    eta1 = eta.x;
+    eta2 = SL_2PI*eta.y;
     SLfloat f1 = sqrt(1.0f-pow(eta1, 2.0f/(shininess+1.0f)));
 
     //tranform to cartesian
@@ -346,8 +363,9 @@ void SLRay::refractMC(SLRay* refracted,SLMat3f rotMat)
     SLfloat translucency = hitMesh->mat->translucency();
 
     //scatter within transmissive lobe
-    eta1 = rnd01();
-    eta2 = SL_2PI*rnd01();
+    SLVec2f eta = sampleBSDF();
+    eta1 = eta.x;
+    eta2 = SL_2PI*eta.y;
     SLfloat f1=sqrt(1.0f-pow(eta1,2.0f/(translucency+1.0f)));
 
     //transform to cartesian
@@ -386,6 +404,7 @@ void SLRay::diffuseMC(SLRay* scattered)
     // for reflectance the start material stays the same
     scattered->srcNode = hitNode;
     scattered->srcMesh = hitMesh;
+    scattered->sampler = sampler;
     scattered->type = REFLECTED;
 
     //calculate rotation matrix
@@ -395,8 +414,9 @@ void SLRay::diffuseMC(SLRay* scattered)
     rotMat.rotation(rotAngle*180.0f/SL_PI, rotAxis);
 
     //cosine distribution
-    eta1 = rnd01();
-    eta2 = SL_2PI*rnd01();
+    SLVec2f eta = sampleBSDF();
+    eta1 = eta.x;
+    eta2 = SL_2PI*eta.y;
     eta1sqrt = sqrt(1-eta1);
     //transform to cartesian
     randVec.set(eta1sqrt * cos(eta2),
@@ -405,3 +425,25 @@ void SLRay::diffuseMC(SLRay* scattered)
 
     scattered->setDir(rotMat*randVec);
 }
+//-----------------------------------------------------------------------------
+//! Returns the 2D sample for the BSDF direction at the hit point
+SLVec2f SLRay::sampleBSDF() const
+{
+    if (!sampler) return SLVec2f(rnd01(), rnd01());
+    return sampler->get2D(SLSampler::pairBSDF(depth));
+}
+//-----------------------------------------------------------------------------
+//! Returns the sample for the choice between reflection & refraction
+SLfloat SLRay::sampleChoice() const
+{
+    if (!sampler) return rnd01();
+    return sampler->get1D(SLSampler::pairChoice(depth));
+}
+//-----------------------------------------------------------------------------
+//! Returns the 2D sample on the light set in the sampler with SLSampler::light
+SLVec2f SLRay::sampleLight() const
+{
+    if (!sampler) return SLVec2f(rnd01(), rnd01());
+    return sampler->get2D(SLSampler::pairLight(depth, sampler->light()));
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,255 @@
+//#############################################################################
+//  File:      SLRayQuery.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLRayQuery.h>
+#include <SLRay.h>
+
+//-----------------------------------------------------------------------------
+//! Min. NO. of rays of a batch to cast them with additional threads
+static const SLuint SL_RAYQUERY_MIN_PARALLEL = 256;
+//! NO. of rays a thread casts at once
+static const SLuint SL_RAYQUERY_RAYS_PER_JOB = 64;
+//-----------------------------------------------------------------------------
+//! Returns the compact hit of a ray after an intersection
+static inline SLRayHit hitOfRay(const SLRay& ray)
+{
+    SLRayHit hit;
+    hit.node     = ray.hitNode;
+    hit.mesh     = ray.hitMesh;
+    hit.triangle = ray.hitTriangle / 3;
+    hit.u        = ray.hitU;
+    hit.v        = ray.hitV;
+    hit.distance = ray.length;
+    return hit;
+}
+//-----------------------------------------------------------------------------
+SLRayQuery::SLRayQuery(SLNode* root, SLuint layerMask, SLNodeFilter filter)
+{
+    assert(root);
+    _root = root;
+    _layerMask = layerMask;
+    _filter = filter;
+}
+//-----------------------------------------------------------------------------
+//! Sets up a ray with a normalized direction and the max. distance
+void SLRayQuery::initRay(SLRay* ray,
+                         const SLVec3f& origin,
+                         const SLVec3f& dir,
+                         SLfloat maxDist) const
+{
+    ray->origin = origin;
+    ray->setDir(dir.normalized());
+    ray->length = maxDist;
+}
+//-----------------------------------------------------------------------------
+/*!
+Tests the meshes of the node if it matches the layer mask and the filter and
+then its children. With allHits the closest hit of each mesh is appended and
+the ray length is reset for the next mesh. Otherwise the ray keeps the closest
+hit. Shadow rays stop at the first hit.
+*/
+SLbool SLRayQuery::hitRec(SLNode* node, SLRay* ray, SLVRayHit* allHits) const
+{
+    if (node->drawBit(SL_DB_HIDDEN))
+        return false;
+
+    if (!node->aabb()->isHitInWS(ray))
+        return false;
+
+    SLbool wasHit = false;
+
+    if (node->meshes().size() > 0 &&
+        (node->layers() & _layerMask) &&
+        (!_filter || _filter(node)))
+    {
+        // transform the ray to object space
+        const SLMat4f& wmI = node->updateAndGetWMI();
+        ray->originOS.set(wmI.multVec(ray->origin));
+        ray->setDirOS(wmI.mat3() * ray->dir);
+
+        for (auto mesh : node->meshes())
+        {   if (allHits)
+            {   SLfloat maxDist = ray->length;
+                if (mesh->hit(ray, node))
+                {   allHits->push_back(hitOfRay(*ray));
+                    wasHit = true;
+                }
+                ray->length = maxDist;
+            } else
+            {   if (mesh->hit(ray, node))
+                    wasHit = true;
+                if (ray->isShaded())
+                    return true;
+            }
+        }
+    }
+
+    for (auto child : node->children())
+    {   if (hitRec(child, ray, allHits))
+            wasHit = true;
+        if (ray->isShaded())
+            return true;
+    }
+
+    return wasHit;
+}
+//-----------------------------------------------------------------------------
+/*!
+Casts a ray and returns true if a mesh was hit closer than maxDist. The
+closest hit is returned in hit.
+*/
+SLbool SLRayQuery::raycast(const SLVec3f& origin,
+                           const SLVec3f& dir,
+                           SLRayHit& hit,
+                           SLfloat maxDist) const
+{
+    SLRay ray;
+    initRay(&ray, origin, dir, maxDist);
+
+    if (hitRec(_root, &ray, nullptr))
+    {   hit = hitOfRay(ray);
+        return true;
+    }
+    hit = SLRayHit();
+    return false;
+}
+//-----------------------------------------------------------------------------
+/*!
+Casts a ray and returns the closest hit of every hit mesh instance sorted by
+distance. Returns the NO. of hits.
+*/
+SLuint SLRayQuery::raycastAll(const SLVec3f& origin,
+                              const SLVec3f& dir,
+                              SLVRayHit& hits,
+                              SLfloat maxDist) const
+{
+    SLRay ray;
+    initRay(&ray, origin, dir, maxDist);
+
+    hits.clear();
+    hitRec(_root, &ray, &hits);
+
+    std::sort(hits.begin(), hits.end(),
+              [](const SLRayHit& a, const SLRayHit& b)
+              {return a.distance < b.distance;});
+
+    return (SLuint)hits.size();
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns true if any mesh is hit closer than maxDist. The traversal stops at
+the first hit.
+*/
+SLbool SLRayQuery::occluded(const SLVec3f& origin,
+                            const SLVec3f& dir,
+                            SLfloat maxDist) const
+{
+    SLRay ray;
+    initRay(&ray, origin, dir, maxDist);
+    ray.type = SHADOW;
+    ray.lightDist = maxDist;
+
+    return hitRec(_root, &ray, nullptr);
+}
+//-----------------------------------------------------------------------------
+/*!
+Runs the job for all rays of a batch. Small batches are run in the calling
+thread. Large batches are split into jobs of SL_RAYQUERY_RAYS_PER_JOB rays for
+SL::maxThreads() threads. Before, the pending transform changes get flushed
+by SLTransformStore::update of the root's store and then the AABBs get
+updated, so that no thread triggers a lazy update that writes shared state.
+*/
+void SLRayQuery::runBatch(SLuint numRays,
+                          function<void(SLuint first, SLuint end)> job) const
+{
+    if (_root->store())
+        _root->store()->update();
+    _root->updateAABBRec();
+
+    SLuint numThreads = numRays < SL_RAYQUERY_MIN_PARALLEL ? 1 :
+                        SL_min(SL::maxThreads(), numRays / SL_RAYQUERY_RAYS_PER_JOB + 1);
+    if (numThreads <= 1)
+        job(0, numRays);
+    else
+    {   atomic<SLuint> nextRay(0);
+        auto runJobs = [&]()
+        {   for (SLuint r = nextRay.fetch_add(SL_RAYQUERY_RAYS_PER_JOB);
+                 r < numRays;
+                 r = nextRay.fetch_add(SL_RAYQUERY_RAYS_PER_JOB))
+                job(r, SL_min(r + SL_RAYQUERY_RAYS_PER_JOB, numRays));
+        };
+
+        // Start additional threads and do the same work in the main thread
+        vector<thread> threads;
+        for (SLuint t=0; t < numThreads-1; t++)
+            threads.push_back(thread(runJobs));
+        runJobs();
+        for(auto& thread : threads) thread.join();
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+Casts a batch of rays. The closest hit of ray i is returned in hits[i] with
+hits[i].node set to nullptr if nothing was hit. Returns the NO. of rays that
+hit something.
+*/
+SLuint SLRayQuery::raycastBatch(const SLVVec3f& origins,
+                                const SLVVec3f& dirs,
+                                SLVRayHit& hits,
+                                SLfloat maxDist) const
+{
+    assert(origins.size() == dirs.size());
+
+    SLuint numRays = (SLuint)origins.size();
+    hits.resize(numRays);
+    atomic<SLuint> numHits(0);
+
+    runBatch(numRays, [&](SLuint first, SLuint end)
+    {   SLuint n = 0;
+        for (SLuint r = first; r < end; ++r)
+            if (raycast(origins[r], dirs[r], hits[r], maxDist)) n++;
+        numHits += n;
+    });
+
+    return numHits;
+}
+//-----------------------------------------------------------------------------
+/*!
+Tests a batch of rays for occlusion within their max. distances. occluded[i]
+is set to 1 if ray i hit something. Returns the NO. of occluded rays.
+*/
+SLuint SLRayQuery::occludedBatch(const SLVVec3f& origins,
+                                 const SLVVec3f& dirs,
+                                 const SLVfloat& maxDists,
+                                 SLVuchar& isOccluded) const
+{
+    assert(origins.size() == dirs.size() && origins.size() == maxDists.size());
+
+    SLuint numRays = (SLuint)origins.size();
+    isOccluded.resize(numRays);
+    atomic<SLuint> numOccluded(0);
+
+    runBatch(numRays, [&](SLuint first, SLuint end)
+    {   SLuint n = 0;
+        for (SLuint r = first; r < end; ++r)
+        {   isOccluded[r] = occluded(origins[r], dirs[r], maxDists[r]) ? 1 : 0;
+            n += isOccluded[r];
+        }
+        numOccluded += n;
+    });
+
+    return numOccluded;
+}
+//-----------------------------------------------------------------------------
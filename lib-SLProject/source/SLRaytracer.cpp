@@ -40,6 +40,11 @@ SLRaytracer::SLRaytracer()
     _maxDepth = 5;
     _aaThreshold = 0.3f; // = 10% color difference
     _aaSamples = 3;
+    _progressive = false;
+    _progBlock = 0;
+    _progBudgetMS = 40.0f;
+    _progFov = 0.0f;
+    _progProj = P_monoPerspective;
    
     // set texture properties
     _min_filter   = GL_NEAREST;
@@ -61,6 +66,7 @@ illumination calculation.
 */
 SLbool SLRaytracer::renderClassic(SLSceneView* sv)
 {
+    SL_PROFILE_SCOPE("SLRaytracer::renderClassic");
     _sv = sv;
     _state = rtBusy;                    // From here we state the RT as busy
     _stateGL = SLGLState::getInstance();// OpenGL state shortcut
@@ -122,6 +128,7 @@ This is the main rendering method for parallel and distributed ray tracing.
 */
 SLbool SLRaytracer::renderDistrib(SLSceneView* sv)
 {
+    SL_PROFILE_SCOPE("SLRaytracer::renderDistrib");
     _sv = sv;
     _state = rtBusy;                    // From here we state the RT as busy
     _stateGL = SLGLState::getInstance();// OpenGL state shortcut
@@ -189,6 +196,149 @@ SLbool SLRaytracer::renderDistrib(SLSceneView* sv)
 }
 //-----------------------------------------------------------------------------
 /*!
+This is the main rendering method for the progressive interactive ray tracing.
+The image is rendered in passes with decreasing pixel block sizes starting with
+SL_RT_PROG_START_BLOCK (1/8 resolution). All passes with blocks bigger than one
+pixel are traced with depth 1 only. Only the final pass traces with the full
+depth. Each call renders as many slices of the current pass as possible within
+_progBudgetMS and returns so that the window events can be processed between
+the frames. The state stays rtReady as long as passes are pending. If the 
+camera view changed since the last call the refinement restarts with the 
+coarsest pass. Antialiasing and lens sampling are not applied in this mode.
+*/
+SLbool SLRaytracer::renderProgressive(SLSceneView* sv)
+{
+    SL_PROFILE_SCOPE("SLRaytracer::renderProgressive");
+    _sv = sv;
+    _state = rtBusy;                    // From here we state the RT as busy
+    _stateGL = SLGLState::getInstance();// OpenGL state shortcut
+
+    // Restart the refinement at the coarsest level
+    if (_progBlock == 0 || viewChanged())
+    {   _pcRendered = 0;
+        _renderSec = 0.0f;
+        _infoText  = SLScene::current->info(_sv)->text();
+        _infoColor = SLScene::current->info(_sv)->color();
+        prepareImage();
+        _progVM   = _cam->updateAndGetVM();
+        _progFov  = _cam->fov();
+        _progProj = _cam->projection();
+        _progBlock = SL_RT_PROG_START_BLOCK;
+        _next = 0;
+    }
+
+    // Coarse passes are done with depth 1 only
+    initStats(_progBlock > 1 ? 1 : _maxDepth);
+   
+    double t1 = SLScene::current->timeSec();
+
+    // Bind render function to be called multithreaded
+    auto renderBlocksFunction = bind(&SLRaytracer::renderBlocks, this, _1);
+
+    vector<thread> threads; // vector for additional threads
+
+    // Start additional threads on the renderBlocks function
+    for (SLuint t=0; t< SL::maxThreads()-1; t++)
+        threads.push_back(thread(renderBlocksFunction, false));
+
+    // Do the same work in the main thread
+    renderBlocksFunction(true);
+
+    // Wait for the other threads to finish
+    for(auto& thread : threads) thread.join();
+
+    _renderSec += (SLfloat)(SLScene::current->timeSec() - t1);
+
+    SLint rows = ((SLint)_images[0]->height() + _progBlock - 1) / _progBlock;
+    
+    if (_next < rows)
+    {   // Pass not finished within the time budget: continue in next frame
+        _pcRendered = (SLint)((SLfloat)_next/(SLfloat)rows*100);
+        _state = rtReady;
+    } else
+    if (_progBlock > 1)
+    {   // Pass finished: continue with the next finer pass in next frame
+        _progBlock >>= 1;
+        _next = 0;
+        _pcRendered = 0;
+        _state = rtReady;
+    } else
+    {   // Final full resolution pass finished
+        _pcRendered = 100;
+        if (_continuous)
+        {   _progBlock = 0;
+            _state = rtReady;
+        } else
+        {   _state = rtFinished;
+            printStats(_renderSec);
+        }
+    }
+    return true;
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns true if the camera view, the projection or the viewport size changed
+since the start of the current progressive refinement.
+*/
+SLbool SLRaytracer::viewChanged()
+{
+    if (_images.size()==0 || !_sv || !_sv->_camera) return true;
+    SLCamera* cam = _sv->_camera;
+
+    return cam != _cam ||
+           memcmp(cam->updateAndGetVM().m(), _progVM.m(), 16*sizeof(SLfloat)) ||
+           cam->fov() != _progFov ||
+           cam->projection() != _progProj ||
+           (SLuint)_sv->scrW() != _images[0]->width() ||
+           (SLuint)_sv->scrH() != _images[0]->height();
+}
+//-----------------------------------------------------------------------------
+/*!
+Renders slices of 4 block rows of the current progressive pass. For every
+block of _progBlock x _progBlock pixels one primary ray is shot through the
+block center and its color is written into all pixels of the block. A thread
+stops taking new slices when the time budget of the frame is exhausted.
+The _next index counts the block rows and is incremented atomically.
+*/
+void SLRaytracer::renderBlocks(const bool isMainThread)
+{
+    if (!isMainThread) SL_PROFILE_THREAD("RT Worker");
+    SL_PROFILE_SCOPE("SLRaytracer::renderBlocks");
+
+    const SLint   block  = _progBlock;
+    const SLint   width  = (SLint)_images[0]->width();
+    const SLint   height = (SLint)_images[0]->height();
+    const SLint   rows   = (height + block - 1) / block;
+    const SLfloat center = (SLfloat)(block-1) * 0.5f;
+    const double  tEnd   = SLScene::current->timeSec() + _progBudgetMS*0.001;
+
+    while (_next < rows && SLScene::current->timeSec() < tEnd)
+    {
+        const SLint minRow = _next.fetch_add(4);
+
+        for (SLint row=minRow; row<minRow+4 && row<rows; ++row)
+        {   SLint y = row * block;
+
+            for (SLint x=0; x<width; x+=block)
+            {
+                SLRay primaryRay;
+                setPrimaryRay(SL_min((SLfloat)x+center, (SLfloat)(width-1)),
+                              SL_min((SLfloat)y+center, (SLfloat)(height-1)),
+                              &primaryRay);
+
+                ///////////////////////////////////
+                SLCol4f color = trace(&primaryRay);
+                ///////////////////////////////////
+
+                for (SLint by=y; by<y+block && by<height; ++by)
+                    for (SLint bx=x; bx<x+block && bx<width; ++bx)
+                        _images[0]->setPixeliRGB(bx, by, color);
+            }
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
 Renders slices of 4 rows until the full width of the image is rendered. This
 method can be called as a function by multiple threads.
 The _next index is used and incremented by every thread. So it should be locked
@@ -198,6 +348,9 @@ main thread is allowed to call a repaint of the image.
 */
 void SLRaytracer::renderSlices(const bool isMainThread)
 {
+    if (!isMainThread) SL_PROFILE_THREAD("RT Worker");
+    SL_PROFILE_SCOPE("SLRaytracer::renderSlices");
+
     // Time points
     double t1 = 0;
 
@@ -251,6 +404,9 @@ main thread is allowed to call a repaint of the image.
 */
 void SLRaytracer::renderSlicesMS(const bool isMainThread)
 {
+    if (!isMainThread) SL_PROFILE_THREAD("RT Worker");
+    SL_PROFILE_SCOPE("SLRaytracer::renderSlicesMS");
+
     // Time points
     double t1 = 0;
 
@@ -286,6 +442,7 @@ void SLRaytracer::renderSlicesMS(const bool isMainThread)
                         lensToFP.normalize();
                         SLCol4f backColor = SLScene::current->background().colorAtPos((SLfloat)x,(SLfloat)y);
                         SLRay primaryRay(lensPos, lensToFP, (SLfloat)x, (SLfloat)y, backColor);
+                        primaryRay.coneSpread = _pxAngle;
                   
                         ////////////////////////////
                         color += trace(&primaryRay);
@@ -388,11 +545,13 @@ void SLRaytracer::setPrimaryRay(SLfloat x, SLfloat y, SLRay* primaryRay)
     if (_cam->projection() == P_monoOrthographic)
     {   primaryRay->setDir(_LA);
         primaryRay->origin = _BL + _pxSize*((SLfloat)x*_LR + (SLfloat)y*_LU);
+        primaryRay->coneWidth = _pxSize;
     } else
     {   SLVec3f primaryDir(_BL + _pxSize*((SLfloat)x*_LR + (SLfloat)y*_LU));
         primaryDir.normalize();
         primaryRay->setDir(primaryDir);
         primaryRay->origin = _EYE;
+        primaryRay->coneSpread = _pxAngle;
     }
 }
 //-----------------------------------------------------------------------------
@@ -546,6 +705,9 @@ main thread is allowed to call a repaint of the image.
 */
 void SLRaytracer::sampleAAPixels(const bool isMainThread)
 {  
+    if (!isMainThread) SL_PROFILE_THREAD("RT Worker");
+    SL_PROFILE_SCOPE("SLRaytracer::sampleAAPixels");
+
     assert(_aaSamples%2==1 && "subSample: maskSize must be uneven");
     double t1 = 0, t2 = 0;
 
@@ -708,6 +870,7 @@ void SLRaytracer::prepareImage()
 
         // calculate the size of a pixel in world coords.
         _pxSize = hw * 2 / _sv->scrW();
+        _pxAngle = 0.0f;
 
         _BL = _EYE - hw*_LR - hh*_LU  +  _pxSize/2*_LR - _pxSize/2*_LU;
     }
@@ -724,6 +887,7 @@ void SLRaytracer::prepareImage()
 
         // calculate the size of a pixel in world coords.
         _pxSize = hw * 2 / _sv->scrW();
+        _pxAngle = _pxSize / _cam->focalDist();
 
         // calculate a vector to the center (C) of the bottom left (BL) pixel
         SLVec3f C  = _LA * _cam->focalDist();
@@ -747,8 +911,8 @@ void SLRaytracer::prepareImage()
         _images[0]->allocate(_sv->scrW(), _sv->scrH(), PF_rgb);
     }
    
-    // Fill image black for single RT
-    if (!_continuous) _images[0]->fill();
+    // Fill image black for single RT. Progressive RT overwrites the old image
+    if (!_continuous && !_progressive) _images[0]->fill();
 }
 //-----------------------------------------------------------------------------
 /*! 
@@ -0,0 +1,377 @@
+//#############################################################################
+//  File:      SLSampler.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLSampler.h>
+
+//-----------------------------------------------------------------------------
+//! NO. of dimension pairs per bounce: BSDF, choice and the lights
+static const SLuint  SL_SAMPLER_PAIRS_PER_BOUNCE = 2 + SL_SAMPLER_MAX_LIGHTS;
+//! Flag of the pairs that always get independent random numbers
+static const SLuint  SL_SAMPLER_RANDOM_PAIR = 0x80000000;
+//! Largest float below 1
+static const SLfloat SL_SAMPLER_ONE_MINUS_EPS = 0.99999994f;
+//! Width & height of the blue noise mask (power of 2)
+static const SLint   SL_BLUENOISE_SIZE = 64;
+//! Sigma of the gaussian energy filter of the void and cluster method
+static const SLfloat SL_BLUENOISE_SIGMA = 1.5f;
+//-----------------------------------------------------------------------------
+//! First 64 primes as bases of the Halton sequence (2 per pair)
+static const SLuint  haltonPrimes[] =
+{     2,   3,   5,   7,  11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,
+     53,  59,  61,  67,  71,  73,  79,  83,  89,  97, 101, 103, 107, 109, 113,
+    127, 131, 137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197,
+    199, 211, 223, 227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281,
+    283, 293, 307, 311};
+static const SLuint  SL_HALTON_PAIRS = sizeof(haltonPrimes)/sizeof(SLuint)/2;
+//-----------------------------------------------------------------------------
+//! Integer hash with a good avalanche (lowbias32 by C. Wellons)
+static inline SLuint hashUint(SLuint x)
+{
+    x ^= x >> 16; x *= 0x7feb352dU;
+    x ^= x >> 15; x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+//-----------------------------------------------------------------------------
+//! Hash of two integers
+static inline SLuint hashUint(SLuint a, SLuint b)
+{
+    return hashUint(a ^ (hashUint(b) + 0x9e3779b9U + (a << 6) + (a >> 2)));
+}
+//-----------------------------------------------------------------------------
+//! Maps the upper 24 bits of an integer to [0,1)
+static inline SLfloat toFloat(SLuint x)
+{
+    return (SLfloat)(x >> 8) * (1.0f / 16777216.0f);
+}
+//-----------------------------------------------------------------------------
+//! Reverses the bits of an integer
+static inline SLuint reverseBits(SLuint x)
+{
+    x = (x << 16) | (x >> 16);
+    x = ((x & 0x00ff00ffU) << 8) | ((x & 0xff00ff00U) >> 8);
+    x = ((x & 0x0f0f0f0fU) << 4) | ((x & 0xf0f0f0f0U) >> 4);
+    x = ((x & 0x33333333U) << 2) | ((x & 0xccccccccU) >> 2);
+    x = ((x & 0x55555555U) << 1) | ((x & 0xaaaaaaaaU) >> 1);
+    return x;
+}
+//-----------------------------------------------------------------------------
+/*!
+Owen scrambling of the bits of x with a hash: The Laine-Karras permutation
+changes each bit depending only on the lower bits, so applied to the reversed
+bits each bit gets flipped depending on all higher bits (see B. Burley:
+Practical Hash-based Owen Scrambling, JCGT 2020).
+*/
+static inline SLuint owenScramble(SLuint x, SLuint seed)
+{
+    x = reverseBits(x);
+    x ^= x * 0x3d20adeaU;
+    x += seed;
+    x *= (seed >> 16) | 1;
+    x ^= x * 0x05526c56U;
+    x ^= x * 0x53a22864U;
+    return reverseBits(x);
+}
+//-----------------------------------------------------------------------------
+//! Second dimension of the Sobol sequence (the first is reverseBits)
+static inline SLuint sobol1(SLuint i)
+{
+    SLuint r = 0;
+    for (SLuint v = 1U << 31; i; i >>= 1, v ^= v >> 1)
+        if (i & 1) r ^= v;
+    return r;
+}
+//-----------------------------------------------------------------------------
+//! Owen scrambled 2D Sobol point with the index shuffled by the seed
+static inline SLVec2f sobol2D(SLuint index, SLuint seed)
+{
+    SLuint i = owenScramble(index, seed);
+    return SLVec2f(toFloat(owenScramble(reverseBits(i), hashUint(seed, 1))),
+                   toFloat(owenScramble(sobol1(i), hashUint(seed, 2))));
+}
+//-----------------------------------------------------------------------------
+//! Radical inverse of i in base b
+static inline SLfloat radicalInverse(SLuint i, SLuint b)
+{
+    double invB = 1.0 / b, f = invB, r = 0.0;
+    while (i)
+    {   r += (i % b) * f;
+        i /= b;
+        f *= invB;
+    }
+    return SL_min((SLfloat)r, SL_SAMPLER_ONE_MINUS_EPS);
+}
+//-----------------------------------------------------------------------------
+//! Adds the offset u to x modulo 1 (Cranley-Patterson rotation)
+static inline SLfloat rotate(SLfloat x, SLfloat u)
+{
+    x += u;
+    if (x >= 1.0f) x -= 1.0f;
+    return SL_min(x, SL_SAMPLER_ONE_MINUS_EPS);
+}
+//-----------------------------------------------------------------------------
+/*!
+Creates a blue noise mask of SL_BLUENOISE_SIZE^2 values in [0,1) with the void
+and cluster method of R. Ulichney (1993): A sparse random pattern is relaxed
+by moving the point of the tightest cluster into the largest void until this
+is the same pixel. The points of the pattern get the ranks in which they are
+removed as tightest clusters. Then the largest voids get filled up with the
+next ranks. The clusters and voids are found with the sum of gaussians of the
+points on the torus, so the mask tiles seamlessly.
+*/
+static SLVfloat createBlueNoiseMask()
+{
+    const SLint n = SL_BLUENOISE_SIZE;
+    const SLint num = n*n;
+    const SLfloat twoSigmaSqr = 2.0f*SL_BLUENOISE_SIGMA*SL_BLUENOISE_SIGMA;
+
+    // Gaussian on the torus by the offset of two pixels
+    SLVfloat kernel((SLuint)num);
+    for (SLint dy = 0; dy < n; ++dy)
+    {   for (SLint dx = 0; dx < n; ++dx)
+        {   SLfloat ex = (SLfloat)SL_min(dx, n-dx);
+            SLfloat ey = (SLfloat)SL_min(dy, n-dy);
+            kernel[dy*n + dx] = exp(-(ex*ex + ey*ey) / twoSigmaSqr);
+        }
+    }
+
+    SLVfloat energy((SLuint)num, 0.0f);
+    SLVuchar on((SLuint)num, 0);
+    SLVint   rank((SLuint)num, 0);
+
+    auto splat = [&](SLint p, SLfloat sign)
+    {   SLint px = p % n, py = p / n;
+        for (SLint qy = 0; qy < n; ++qy)
+        {   const SLfloat* k = &kernel[((qy - py + n) % n) * n];
+            SLfloat* e = &energy[qy*n];
+            for (SLint qx = 0; qx < n; ++qx)
+                e[qx] += sign * k[(qx - px + n) % n];
+        }
+        on[p] = sign > 0.0f ? 1 : 0;
+    };
+    auto tightestCluster = [&]()
+    {   SLint best = -1;
+        for (SLint p = 0; p < num; ++p)
+            if (on[p] && (best < 0 || energy[p] > energy[best])) best = p;
+        return best;
+    };
+    auto largestVoid = [&]()
+    {   SLint best = -1;
+        for (SLint p = 0; p < num; ++p)
+            if (!on[p] && (best < 0 || energy[p] < energy[best])) best = p;
+        return best;
+    };
+
+    // Random initial pattern with 10% of the pixels
+    SLint numOn = 0;
+    for (SLuint h = 1; numOn < num/10; )
+    {   h = hashUint(h);
+        SLint p = (SLint)(h % (SLuint)num);
+        if (!on[p]) {splat(p, 1.0f); numOn++;}
+    }
+
+    // Relax it until the tightest cluster is the largest void
+    for (SLint i = 0; i < num; ++i)
+    {   SLint c = tightestCluster();
+        splat(c, -1.0f);
+        SLint v = largestVoid();
+        splat(v, 1.0f);
+        if (v == c) break;
+    }
+    SLVuchar initialOn(on);
+    SLVfloat initialEnergy(energy);
+
+    // Rank the initial points by removing the tightest clusters
+    for (SLint r = numOn-1; r >= 0; --r)
+    {   SLint c = tightestCluster();
+        splat(c, -1.0f);
+        rank[c] = r;
+    }
+
+    // Rank the rest by filling the largest voids
+    on = initialOn;
+    energy = initialEnergy;
+    for (SLint r = numOn; r < num; ++r)
+    {   SLint v = largestVoid();
+        splat(v, 1.0f);
+        rank[v] = r;
+    }
+
+    SLVfloat mask((SLuint)num);
+    for (SLint p = 0; p < num; ++p)
+        mask[p] = ((SLfloat)rank[p] + 0.5f) / (SLfloat)num;
+    return mask;
+}
+//-----------------------------------------------------------------------------
+//! Returns the blue noise mask that is created at the first call
+static const SLVfloat& blueNoiseMask()
+{
+    static const SLVfloat mask = createBlueNoiseMask();
+    return mask;
+}
+//-----------------------------------------------------------------------------
+SLSampler::SLSampler(SLSamplerType type,
+                     SLuint x,
+                     SLuint y,
+                     SLuint sampleIndex,
+                     SLuint seed)
+{
+    _type = type;
+    _x = x;
+    _y = y;
+    _index = sampleIndex;
+    _pixelHash = hashUint(hashUint(x, y), seed);
+    _light = 0;
+
+    if (_type == ST_blueNoise) blueNoiseMask();
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns the 2D sample of the dimension pair in [0,1)^2. The pairs of a path
+are given by pairPixel, pairBSDF, pairChoice and pairLight.
+*/
+SLVec2f SLSampler::get2D(SLuint pair) const
+{
+    SLSamplerType type = _type;
+    if (pair & SL_SAMPLER_RANDOM_PAIR) type = ST_random;
+    if (type == ST_halton && pair >= SL_HALTON_PAIRS) type = ST_random;
+
+    switch (type)
+    {
+        case ST_halton:
+        {   SLuint h = hashUint(_pixelHash, pair);
+            return SLVec2f(rotate(radicalInverse(_index, haltonPrimes[2*pair]),
+                                  toFloat(h)),
+                           rotate(radicalInverse(_index, haltonPrimes[2*pair+1]),
+                                  toFloat(hashUint(h))));
+        }
+        case ST_sobol:
+            return sobol2D(_index, hashUint(_pixelHash, pair));
+
+        case ST_blueNoise:
+        {   // Same sequence for all pixels rotated by the mask at a toroidal
+            // offset per pair and dimension
+            const SLVfloat& mask = blueNoiseMask();
+            const SLint m = SL_BLUENOISE_SIZE - 1;
+            SLuint h0 = hashUint(pair, 0x5bd1e995U);
+            SLuint h1 = hashUint(h0);
+            SLint x = (SLint)_x, y = (SLint)_y;
+            SLfloat u0 = mask[((y + (h0 >> 6)) & m) * SL_BLUENOISE_SIZE + ((x + h0) & m)];
+            SLfloat u1 = mask[((y + (h1 >> 6)) & m) * SL_BLUENOISE_SIZE + ((x + h1) & m)];
+            SLVec2f p = sobol2D(_index, h0);
+            return SLVec2f(rotate(p.x, u0), rotate(p.y, u1));
+        }
+        default:
+        {   SLuint h = hashUint(hashUint(_pixelHash, _index), pair);
+            return SLVec2f(toFloat(h), toFloat(hashUint(h)));
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+//! Returns the pair for the BSDF direction at the hit point of a ray of depth
+SLuint SLSampler::pairBSDF(SLint depth)
+{
+    return 1 + (SLuint)(depth-1) * SL_SAMPLER_PAIRS_PER_BOUNCE;
+}
+//-----------------------------------------------------------------------------
+//! Returns the pair for the choice between reflection & refraction
+SLuint SLSampler::pairChoice(SLint depth)
+{
+    return pairBSDF(depth) + 1;
+}
+//-----------------------------------------------------------------------------
+//! Returns the pair for the sample point on a light
+SLuint SLSampler::pairLight(SLint depth, SLuint light)
+{
+    if (light >= SL_SAMPLER_MAX_LIGHTS)
+        return SL_SAMPLER_RANDOM_PAIR | ((SLuint)depth << 16) | light;
+    return pairBSDF(depth) + 2 + light;
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns the RMSE of the estimates of numPixels pixels with numSamples samples
+each for the 4D test integrand f(u) = [u0^2 + u1^2 < 1] * [u2 < u3^2] with
+u0,u1 from the pixel pair and u2,u3 from the BSDF pair of the first bounce.
+The exact integral is pi/4 * 1/3 = pi/12. The pixels lie on a square grid of
+at most 64 pixels width, so the blue noise mask gets used as in an image.
+The result is deterministic for a given type, sample and pixel count.
+*/
+SLfloat SLSampler::testRMSE(SLSamplerType type,
+                            SLuint numSamples,
+                            SLuint numPixels)
+{
+    const double exact = SL_PI / 12.0;
+    const SLuint   width = SL_min(numPixels, (SLuint)SL_BLUENOISE_SIZE);
+    double sumSqErr = 0.0;
+
+    for (SLuint p = 0; p < numPixels; ++p)
+    {   double sum = 0.0;
+        for (SLuint s = 0; s < numSamples; ++s)
+        {   SLSampler sampler(type, p % width, p / width, s);
+            SLVec2f u01 = sampler.get2D(pairPixel());
+            SLVec2f u23 = sampler.get2D(pairBSDF(1));
+            if (u01.x*u01.x + u01.y*u01.y < 1.0f && u23.x < u23.y*u23.y)
+                sum += 1.0;
+        }
+        double err = sum / numSamples - exact;
+        sumSqErr += err * err;
+    }
+    return (SLfloat)sqrt(sumSqErr / numPixels);
+}
+//-----------------------------------------------------------------------------
+/*!
+Logs the RMSE of testRMSE for all sampler types for 1, 2, 4, ... up to
+maxSamples samples per pixel. Returns true if the RMSE of every quasi-Monte
+Carlo sequence is below the RMSE of ST_random at the largest sample count.
+*/
+SLbool SLSampler::testConvergence(SLuint maxSamples)
+{
+    SLSamplerType types[] = {ST_random, ST_halton, ST_sobol, ST_blueNoise};
+    SLfloat randomRMSE = 0.0f;
+    SLbool passed = true;
+
+    SL_LOG("\nSampler convergence of a 4D integrand (samples: RMSE):\n");
+    for (auto type : types)
+    {   SL_LOG("%-10s:", typeName(type));
+        SLfloat rmse = 0.0f;
+        for (SLuint n = 1; n <= maxSamples; n *= 2)
+        {   rmse = testRMSE(type, n);
+            SL_LOG(" %d: %.4f", n, rmse);
+        }
+        SL_LOG("\n");
+
+        if (type == ST_random)
+            randomRMSE = rmse;
+        else if (rmse >= randomRMSE)
+        {   SL_LOG("%s is not below the random RMSE of %.4f\n", typeName(type), randomRMSE);
+            passed = false;
+        }
+    }
+    SL_LOG("Sampler convergence test %s\n", passed ? "PASSED" : "FAILED");
+    return passed;
+}
+//-----------------------------------------------------------------------------
+//! Returns the name of a sampler type
+const SLchar* SLSampler::typeName(SLSamplerType type)
+{
+    switch (type)
+    {   case ST_random:    return "Random";
+        case ST_halton:    return "Halton";
+        case ST_sobol:     return "Sobol";
+        case ST_blueNoise: return "Blue Noise";
+        default:           return "Unknown";
+    }
+}
+//-----------------------------------------------------------------------------
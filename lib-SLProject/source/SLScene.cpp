@@ -18,6 +18,7 @@
 #include <SLCamera.h>
 #include <SLText.h>
 #include <SLLight.h>
+#include <SLLightClusters.h>
 #include <SLTexFont.h>
 #include <SLButton.h>
 #include <SLAnimation.h>
@@ -68,8 +69,6 @@ SLScene::SLScene(SLstring name) : SLObject(name)
     _menuRT         = nullptr;
     _menuPT         = nullptr;
     _info           = nullptr;
-    _infoGL         = nullptr;
-    _infoRT         = nullptr;
     _infoLoading    = nullptr;
     _btnHelp        = nullptr;
     _btnAbout       = nullptr;
@@ -77,6 +76,12 @@ SLScene::SLScene(SLstring name) : SLObject(name)
     _selectedMesh   = nullptr;
     _selectedNode   = nullptr;
     _stopAnimations = false;
+    _fixedTimeStepMS = 0.0f;
+    _maxSubSteps = 5;
+    _accumulatorMS = 0.0f;
+    _simTimeMS = 0.0f;
+    _numSimSteps = 0;
+    _interpolationAlpha = 1.0f;
 
     _fps = 0;
     _elapsedTimeMS = 0;
@@ -102,6 +107,8 @@ SLScene::SLScene(SLstring name) : SLObject(name)
     p = new SLGLGenericProgram("FontTex.vert","FontTex.frag");
     p = new SLGLGenericProgram("StereoOculus.vert","StereoOculus.frag");
     p = new SLGLGenericProgram("StereoOculusDistortionMesh.vert","StereoOculusDistortionMesh.frag");
+    p = SLLightClusters::createProgram(false);
+    p = SLLightClusters::createProgram(true);
     _numProgsPreload = (SLint)_programs.size();
    
     // font and video texture are not added to the _textures vector
@@ -151,6 +158,10 @@ The destructor is called in slTerminate.
 */
 SLScene::~SLScene()
 {
+    // The node index dies with the scene: unlink all nodes at once instead
+    // of removing them one by one when the scenegraph and menus get deleted
+    _nodeIndex.clear();
+
     // Delete all remaining sceneviews
     for (auto sv : _sceneViews)
         if (sv != nullptr)
@@ -204,6 +215,11 @@ void SLScene::init()
 
     _timer.start();
 
+    // reset the loading progress text
+    _infoLoadingText = "";
+    delete _infoLoading;
+    _infoLoading = nullptr;
+
     // load virtual cursor texture
     _texCursor = new SLGLTexture("cursor.tga");
 
@@ -261,6 +277,13 @@ void SLScene::unInit()
     _eventHandlers.clear();
 
     _animManager.clear();
+    _accumulatorMS = 0.0f;
+    _simTimeMS = 0.0f;
+    _numSimSteps = 0;
+    _interpolationAlpha = 1.0f;
+
+    // return the empty chunks of the pooled nodes, meshes & animations
+    SLMemPool::releaseAll();
 
     // reset all states
     SLGLState::getInstance()->initAll();
@@ -279,6 +302,8 @@ bool SLScene::onUpdate()
         if (sv != nullptr && !sv->gotPainted())
             return false;
 
+    SL_PROFILE_SCOPE("SLScene::onUpdate");
+
     // Reset all _gotPainted flags
     for (auto sv : _sceneViews)
         if (sv != nullptr)
@@ -337,10 +362,11 @@ bool SLScene::onUpdate()
     SLbool animatedOrChanged = SLInputManager::instance().pollEvents();
 
     ///////////////////////////////////////////////////////////////////////////////
-    animatedOrChanged |= !_stopAnimations && _animManager.update(elapsedTimeSec());
+    animatedOrChanged |= updateAnimations(_elapsedTimeMS);
     ///////////////////////////////////////////////////////////////////////////////
     
     // Do software skinning on all changed skeletons
+    SL_PROFILE_SCOPE("Skinning & AABB update");
     for (auto mesh : _meshes) 
     {   if (mesh->skeleton() && 
             mesh->skeleton()->changed() && 
@@ -354,16 +380,84 @@ bool SLScene::onUpdate()
             mesh->updateAccelStruct();
     }
     
-    // Update AABBs efficiently. The updateAABBRec call won't generate any overhead if nothing changed
+    // Update the world matrices & AABBs of all changed nodes in a flat pass.
+    // The store is only rebuilt if the hierarchy changed.
     SLGLState::getInstance()->modelViewMatrix.identity();
-    _root3D->updateAABBRec();
-
+    _transforms.build(_root3D);
+    _transforms.update();
+
+    // Reduce, evict or reload textures by their use in the last frame
+    {   SL_PROFILE_SCOPE("SLTexResidency::update");
+        SLVTexResidencyChange changes;
+        _texResidency.update(changes);
+        for (auto& c : changes)
+            c.texture->applyResidency(c.level);
+    }
 
     _updateTimesMS.set(timeMilliSec()-startUpdateMS);
     
     return animatedOrChanged;
 }
 
+//-----------------------------------------------------------------------------
+/*!
+SLScene::updateAnimations advances all animations by the passed frame time.
+Without a fixed time step (_fixedTimeStepMS = 0) the animations are updated
+once with the frame time, so their result depends on the frame rate.
+\n
+With a fixed time step the frame time gets added to an accumulator and the
+animations are updated in steps of exactly _fixedTimeStepMS as long as the
+accumulator holds a full step. So the same sequence of steps is done for any
+frame rate and the results are reproducible. At most _maxSubSteps steps are
+done per frame: After a long frame (e.g. after an idle time with slowdown on
+idle or a breakpoint) the rest of the time is dropped instead of catching up
+with ever more steps. The rest in the accumulator is less than one step. The
+animated nodes are rendered at the interpolation between the pose before and
+after the last step with alpha = rest / step.
+@param  frameTimeMS     time since the last update in ms
+@return true if any animation changed a node
+*/
+SLbool SLScene::updateAnimations(SLfloat frameTimeMS)
+{
+    // Stopped animations show the pose of the last step, not an interpolation
+    if (_stopAnimations)
+    {   _accumulatorMS = 0.0f;
+        _interpolationAlpha = 1.0f;
+        return _animManager.restoreCurrentPose();
+    }
+
+    // Put back the pose of the last step that got interpolated for rendering
+    _animManager.restoreCurrentPose();
+
+    if (_fixedTimeStepMS <= 0.0f)
+    {   _simTimeMS += frameTimeMS;
+        _numSimSteps++;
+        _interpolationAlpha = 1.0f;
+        return _animManager.update(frameTimeMS * 0.001f);
+    }
+
+    _accumulatorMS += frameTimeMS;
+    SLint numSteps = (SLint)(_accumulatorMS / _fixedTimeStepMS);
+    if (numSteps > _maxSubSteps)
+    {   numSteps = _maxSubSteps;
+        _accumulatorMS = numSteps * _fixedTimeStepMS;
+    }
+
+    SLbool updated = false;
+    for (SLint i=0; i<numSteps; ++i)
+    {   if (i == numSteps-1) 
+            _animManager.storePreviousPose();
+        updated |= _animManager.update(_fixedTimeStepMS * 0.001f);
+        _accumulatorMS -= _fixedTimeStepMS;
+        _simTimeMS += _fixedTimeStepMS;
+        _numSimSteps++;
+    }
+    if (_accumulatorMS < 0.0f) _accumulatorMS = 0.0f;
+
+    _interpolationAlpha = _accumulatorMS / _fixedTimeStepMS;
+    updated |= _animManager.interpolatePose(_interpolationAlpha);
+    return updated;
+}
 //-----------------------------------------------------------------------------
 /*!
 SLScene::info deletes previous info text and sets new one with a max. width 
@@ -450,6 +544,21 @@ void SLScene::copyVideoImage(SLint width,
     _videoTexture.copyVideoImage(width, height, srcPixelFormat, data, isTopLeft);
 }
 //-----------------------------------------------------------------------------
+/*! Sets the progress text of the loading screen and repaints all sceneviews
+that show the loading screen. This function may only be called from the GL
+thread e.g. during the scene loading in onLoad.
+*/
+void SLScene::loadingProgress(SLstring progressText)
+{
+    _infoLoadingText = progressText;
+    delete _infoLoading;
+    _infoLoading = nullptr;
+
+    for (auto sv : _sceneViews)
+        if (sv != nullptr && sv->showLoading() && sv->onWndUpdate)
+            sv->onWndUpdate();
+}
+//-----------------------------------------------------------------------------
 //! Deletes all menus and buttons objects
 void SLScene::deleteAllMenus()
 {                        _menu2D     = nullptr;
@@ -457,8 +566,6 @@ void SLScene::deleteAllMenus()
     delete _menuRT;      _menuRT     = nullptr;
     delete _menuPT;      _menuPT     = nullptr;
     delete _info;        _info       = nullptr;
-    delete _infoGL;      _infoGL     = nullptr;
-    delete _infoRT;      _infoRT     = nullptr;
     delete _btnAbout;    _btnAbout   = nullptr;
     delete _btnHelp;     _btnHelp    = nullptr;
     delete _btnCredits;  _btnCredits = nullptr;
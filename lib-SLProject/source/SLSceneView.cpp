@@ -23,6 +23,7 @@
 #include <SLLightSphere.h>
 #include <SLLightRect.h>
 #include <SLRay.h>
+#include <SLRayQuery.h>
 #include <SLTexFont.h>
 #include <SLButton.h>
 #include <SLBox.h>
@@ -115,6 +116,10 @@ void SLSceneView::init(SLstring name,
     _doDepthTest = true;
     _doMultiSampling = true;    // true=OpenGL multisampling is turned on
     _doFrustumCulling = true;   // true=enables view frustum culling
+    _doOcclusionCulling = true; // true=enables CPU occlusion culling
+    _doClusteredLighting = false;// true=forces clustered lighting with few lights
+    _numOccluded = 0;
+    _lodPixelError = 1.0f;      // max. projected LOD error in pixels
     _waitEvents = true;
     _usesRotation = false;
     _drawBits.allOff();
@@ -328,6 +333,9 @@ void SLSceneView::onInitialize()
         if (s->menuGL()) s->menuGL()->statsRec(_stats);
         if (s->menuRT()) s->menuRT()->statsRec(_stats);
         if (s->menuPT()) s->menuPT()->statsRec(_stats);
+        SLMemPool::statsAll(_stats.numPoolAllocs,
+                            _stats.numPoolLive,
+                            _stats.numPoolBytes);
     }
 
     initSceneViewCamera();
@@ -383,6 +391,7 @@ the 2D or 3D graph was updated or waitEvents is false.
 */
 SLbool SLSceneView::onPaint()
 {  
+    SL_PROFILE_SCOPE("SLSceneView::onPaint");
     SLScene* s = SLScene::current;
     SLGLVertexArray::totalDrawCalls = 0;
     SLbool camUpdated = false;
@@ -446,6 +455,13 @@ and SLSceneView::_blendNodes with the visible nodes. Nodes that are not
 visible with the current camera are not drawn. 
 </li>
 <li>
+<b>Occlusion Culling</b>:
+SLSceneView::occlusionCull removes the nodes from SLSceneView::_opaqueNodes
+and SLSceneView::_blendNodes that are hidden behind the largest opaque nodes.
+The textures of the remaining nodes are passed to the texture residency
+manager by SLSceneView::updateTexResidency.
+</li>
+<li>
 <b>Draw Opaque and Blended Nodes</b>:
 By calling the SLSceneView::draw3D all nodes in the vectors 
 SLSceneView::_opaqueNodes and SLSceneView::_blendNodes will be drawn.
@@ -461,6 +477,7 @@ is drawn.
 */
 SLbool SLSceneView::draw3DGL(SLfloat elapsedTimeMS)
 {
+    SL_PROFILE_SCOPE("SLSceneView::draw3DGL");
     SLScene* s = SLScene::current;
 
     preDraw();
@@ -513,14 +530,33 @@ SLbool SLSceneView::draw3DGL(SLfloat elapsedTimeMS)
          _camera->setView(this, ET_left);
     else _camera->setView(this, ET_center);
 
-    ////////////////////////
-    // 4. Frustum Culling //
-    ////////////////////////
+    ////////////////////////////////////
+    // 4. Frustum & Occlusion Culling //
+    ////////////////////////////////////
    
     _camera->setFrustumPlanes(); 
     _blendNodes.clear();
     _opaqueNodes.clear();     
-    s->root3D()->cullRec(this);
+    {   SL_PROFILE_SCOPE("SLNode::cullRec");
+        s->root3D()->cullRec(this);
+    }
+    occlusionCull();
+    updateLightClusters();
+    updateTexResidency();
+
+    // Count the drawn triangles per LOD level
+    _lodTriangles.clear();
+    for (auto nodes : {&_opaqueNodes, &_blendNodes})
+    {   for (auto node : *nodes)
+        {   for (auto mesh : node->meshes())
+            {   SLint level = mesh->validLOD(node->lodLevel());
+                if (_lodTriangles.size() <= (SLuint)level)
+                    _lodTriangles.resize(level+1, 0);
+                if (mesh->primitive() == PT_triangles)
+                    _lodTriangles[level] += mesh->lodNumI(level)/3;
+            }
+        }
+    }
    
     _cullTimeMS = s->timeMilliSec() - startMS;
 
@@ -546,6 +582,7 @@ SLbool SLSceneView::draw3DGL(SLfloat elapsedTimeMS)
       
     // Enable all color channels again
     _stateGL->colorMask(1, 1, 1, 1); 
+    _stateGL->lightClusters = nullptr;
 
     _draw3DTimeMS = s->timeMilliSec()-startMS;
 
@@ -554,6 +591,166 @@ SLbool SLSceneView::draw3DGL(SLfloat elapsedTimeMS)
     GET_GL_ERROR; // Check if any OGL errors occurred
     return camUpdated;
 }
+//-----------------------------------------------------------------------------
+//! Min. apparent size (AABB radius / distance) of an occluder node
+static const SLfloat SL_OCCLUDER_MIN_SIZE = 0.05f;
+//! Max. NO. of triangles of a single occluder node
+static const SLuint  SL_OCCLUDER_MAX_TRIANGLES = 4096;
+//! Max. NO. of occluder triangles rasterized per frame
+static const SLuint  SL_OCCLUDER_BUDGET = 32768;
+//-----------------------------------------------------------------------------
+//! Returns true for cameras & lights that are never culled
+static SLbool isCameraOrLight(SLNode* node)
+{
+    return typeid(*node)==typeid(SLCamera) ||
+           typeid(*node)==typeid(SLLightSphere) ||
+           typeid(*node)==typeid(SLLightRect);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLSceneView::occlusionCull removes the occluded nodes from the vectors
+_opaqueNodes and _blendNodes after the frustum culling. The opaque nodes with
+the largest apparent size (AABB radius / distance) are rasterized at their
+current LOD as occluders into the CPU depth buffer of SLOcclusionCuller until
+SL_OCCLUDER_BUDGET triangles are reached. Then all nodes AABBs are tested
+against its depth pyramid. Occlusion culling is skipped in stereo projections
+and in wireframe mode.
+*/
+void SLSceneView::occlusionCull()
+{
+    SL_PROFILE_SCOPE("SLSceneView::occlusionCull");
+    _numOccluded = 0;
+    if (!_doOcclusionCulling ||
+        _camera->projection() > P_monoOrthographic ||
+        drawBit(SL_DB_WIREMESH)) return;
+
+    _occlusionCuller.clear(_scrWdivH,
+                           _stateGL->projectionMatrix * _stateGL->viewMatrix);
+
+    // Collect the occluder candidates with their apparent size
+    SLVec3f eye = _camera->updateAndGetWM().translation();
+    vector<pair<SLfloat, SLNode*>> occluders;
+    for (auto node : _opaqueNodes)
+    {   if (node->meshes().empty() || isCameraOrLight(node) ||
+            node->drawBit(SL_DB_HIDDEN) || node->drawBit(SL_DB_WIREMESH))
+            continue;
+
+        SLuint numT = 0;
+        for (auto mesh : node->meshes())
+        {   if (mesh->primitive() == PT_triangles)
+                numT += mesh->lodNumI(node->lodLevel())/3;
+        }
+        if (!numT || numT > SL_OCCLUDER_MAX_TRIANGLES) continue;
+
+        SLAABBox* aabb = node->aabb();
+        SLfloat dist = max((eye - aabb->centerWS()).length(), _camera->clipNear());
+        SLfloat size = aabb->radiusWS() / dist;
+        if (size >= SL_OCCLUDER_MIN_SIZE)
+            occluders.push_back(make_pair(size, node));
+    }
+    if (occluders.empty()) return;
+
+    // Rasterize the largest occluders first
+    std::sort(occluders.begin(), occluders.end(),
+              [](const pair<SLfloat, SLNode*>& a, const pair<SLfloat, SLNode*>& b)
+              {   return a.first > b.first;});
+
+    for (auto& o : occluders)
+    {   if (_occlusionCuller.numTriangles() >= SL_OCCLUDER_BUDGET) break;
+        SLNode* node = o.second;
+        SLbool cullBackFaces = !drawBit(SL_DB_CULLOFF) && !node->drawBit(SL_DB_CULLOFF);
+        for (auto mesh : node->meshes())
+            _occlusionCuller.rasterize(mesh,
+                                       node->lodLevel(),
+                                       node->updateAndGetWM(),
+                                       cullBackFaces);
+    }
+    _occlusionCuller.buildPyramid();
+
+    // Remove the occluded nodes from the opaque & blended nodes
+    for (auto nodes : {&_opaqueNodes, &_blendNodes})
+    {   SLuint numVisible = 0;
+        for (auto node : *nodes)
+        {   if (isCameraOrLight(node) || _occlusionCuller.isVisible(node->aabb()))
+                (*nodes)[numVisible++] = node;
+            else
+            {   node->aabb()->isVisible(false);
+                _numOccluded++;
+            }
+        }
+        nodes->resize(numVisible);
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+SLSceneView::usesClusteredLighting returns true if the lights are evaluated
+per cluster. This is the case if it is turned on in the menu or if the scene
+has more lights than the SL_MAX_LIGHTS that can be passed as uniforms. Stereo
+projections and OpenGL (ES) 2 use the standard lighting.
+*/
+SLbool SLSceneView::usesClusteredLighting()
+{
+    return (_doClusteredLighting ||
+            SLScene::current->lights().size() > SL_MAX_LIGHTS) &&
+           _camera && _camera->projection() <= P_monoOrthographic &&
+           SLLightClusters::isSupported();
+}
+//-----------------------------------------------------------------------------
+/*!
+SLSceneView::updateLightClusters assigns the lights of the scene to the
+clusters of the view after the camera is set. While the 3D scene is drawn the
+clusters are set in SLGLState::lightClusters so that SLMaterial::activate uses
+the clustered variants of the standard lighting programs.
+*/
+void SLSceneView::updateLightClusters()
+{
+    _stateGL->lightClusters = nullptr;
+    if (!usesClusteredLighting()) return;
+
+    _lightClusters.update(SLScene::current->lights(),
+                          _stateGL->viewMatrix,
+                          _stateGL->projectionMatrix,
+                          _scrW, _scrH,
+                          _camera->clipNear(),
+                          _camera->clipFar());
+    _stateGL->lightClusters = &_lightClusters;
+
+    // Force the activation of the material with the clustered program
+    SLMaterial::current = nullptr;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLSceneView::updateTexResidency passes the textures of the materials of all
+visible nodes to the residency manager of the scene (see SLTexResidency). Their
+size on screen is the projected diameter of the nodes AABB in pixels, so that
+distant textures can drop their finest mip levels.
+*/
+void SLSceneView::updateTexResidency()
+{
+    SL_PROFILE_SCOPE("SLSceneView::updateTexResidency");
+    SLTexResidency& residency = SLScene::current->texResidency();
+    SLbool isOrtho = _camera->projection() == P_monoOrthographic;
+    SLVec3f eye = _camera->updateAndGetWM().translation();
+    SLfloat pixelsPerRad = (SLfloat)_scrH /
+                           (2.0f * tan(_camera->fov() * SL_DEG2RAD * 0.5f));
+
+    for (auto nodes : {&_opaqueNodes, &_blendNodes})
+    {   for (auto node : *nodes)
+        {   SLfloat size = (SLfloat)_scrH;
+            if (!isOrtho)
+            {   SLAABBox* aabb = node->aabb();
+                SLfloat dist = max((eye - aabb->centerWS()).length(), _camera->clipNear());
+                size = 2.0f * aabb->radiusWS() / dist * pixelsPerRad;
+            }
+            for (auto mesh : node->meshes())
+            {   if (!mesh->mat) continue;
+                for (auto tex : mesh->mat->textures())
+                    if (tex->residencyID() >= 0)
+                        residency.use(tex->residencyID(), size);
+            }
+        }
+    }
+}
 //----------------------------------------------------------------------------- 
 /*!
 SLSceneView::draw3DGLAll renders the opaque nodes before blended nodes.
@@ -563,6 +760,8 @@ added the to the array _opaqueNodes.
 */
 void SLSceneView::draw3DGLAll()
 {  
+    SL_PROFILE_SCOPE("SLSceneView::draw3DGLAll");
+
     // 1) Draw first the opaque shapes and all helper lines (normals and AABBs)
     draw3DGLNodes(_opaqueNodes, false, false);
     draw3DGLLines(_opaqueNodes);
@@ -725,6 +924,7 @@ update is done to the 2D scenegraph.
 */
 void SLSceneView::draw2DGL()
 {
+    SL_PROFILE_SCOPE("SLSceneView::draw2DGL");
     SLScene* s = SLScene::current;
     SLfloat startMS = s->timeMilliSec();
 
@@ -860,6 +1060,9 @@ void SLSceneView::draw2DGLAll()
     _stateGL->blend(true);              // Enable blending
     _stateGL->polygonLine(false);       // Only filled polygons
 
+    // Collect all texts in the text batch
+    _textBatch.begin();
+
     // Draw 2D loading text
     if (_showLoading)
     {   build2DInfoLoading();
@@ -876,27 +1079,29 @@ void SLSceneView::draw2DGLAll()
     if (!_showLoading && _showStats &&
         (s->menu2D()==s->menuGL() || s->menu2D()==s->btnAbout()))
     {   build2DInfoGL();
-        if (s->infoGL())
-		{   _stateGL->pushModelViewMatrix();
-			_stateGL->modelViewMatrix.translate(-w2, h2, depth);
-			_stateGL->modelViewMatrix.translate(SLButton::minMenuPos.x, -SLButton::minMenuPos.y, 0);
-            _stateGL->modelViewMatrix.multiply(s->infoGL()->om());
-            s->infoGL()->drawRec(this);
-            _stateGL->popModelViewMatrix();
-        }
+        SLTexFont* f = SLTexFont::getFont(1.2f, _dpi);
+        SLVec2f size = f->calcTextSize(_infoStats, (SLfloat)_scrW, 1.0f);
+        _stateGL->pushModelViewMatrix();
+        _stateGL->modelViewMatrix.translate(-w2, h2, depth);
+        _stateGL->modelViewMatrix.translate(SLButton::minMenuPos.x, -SLButton::minMenuPos.y, 0);
+        _stateGL->modelViewMatrix.translate(10.0f, -size.y-5.0f, 0.0f);
+        _textBatch.add(f, _infoStats, SLCol4f::WHITE, (SLfloat)_scrW, 1.0f,
+                       _stateGL->modelViewMatrix);
+        _stateGL->popModelViewMatrix();
     }
    
     // Draw statistics for RT
     if (!_showLoading && _showStats &&
         (s->menu2D()==s->menuRT()))
     {   build2DInfoRT();
-        if (s->infoRT()) 
-        {   _stateGL->pushModelViewMatrix();  
-            _stateGL->modelViewMatrix.translate(-w2, h2, depth);
-            _stateGL->modelViewMatrix.multiply(s->infoRT()->om());
-            s->infoRT()->drawRec(this);
-            _stateGL->popModelViewMatrix();
-        } 
+        SLTexFont* f = SLTexFont::getFont(1.2f, _dpi);
+        SLVec2f size = f->calcTextSize(_infoStats, (SLfloat)_scrW, 1.0f);
+        _stateGL->pushModelViewMatrix();  
+        _stateGL->modelViewMatrix.translate(-w2, h2, depth);
+        _stateGL->modelViewMatrix.translate(10.0f, -size.y-5.0f, 0.0f);
+        _textBatch.add(f, _infoStats, SLCol4f::WHITE, (SLfloat)_scrW, 1.0f,
+                       _stateGL->modelViewMatrix);
+        _stateGL->popModelViewMatrix();
     }
 
     // Draw scene info text if menuGL or menuRT is closed
@@ -913,14 +1118,18 @@ void SLSceneView::draw2DGLAll()
         s->info()->drawRec(this);
         _stateGL->popModelViewMatrix();
     }
+
+    // Draw the info texts with one draw call per font
+    _textBatch.flush();
    
-    // Draw menu buttons tree
+    // Draw menu buttons tree (the button texts are drawn on top with end)
     if (!_showLoading && _showMenu && s->menu2D())
     {   _stateGL->pushModelViewMatrix();  
         _stateGL->modelViewMatrix.translate(-w2, -h2, 0);
         s->menu2D()->drawRec(this);
         _stateGL->popModelViewMatrix();
     }   
+    _textBatch.end();
    
     // 2D finger touch points  
     #ifndef SL_GLES2
@@ -1075,8 +1284,9 @@ SLbool SLSceneView::onMouseMove(SLint x, SLint y)
     {   SLMouseButton btn = _mouseDownL ? MB_left : 
                             _mouseDownR ? MB_right : MB_middle;
       
-        // Handle move in RT mode
-        if (_renderType == RT_rt && !_raytracer.continuous())
+        // Handle move in RT mode (progressive RT keeps tracing while moving)
+        if (_renderType == RT_rt && !_raytracer.continuous() &&
+            !_raytracer.progressive())
         {   if (_raytracer.state()==rtFinished)
                 _raytracer.state(rtMoveGL);
             else
@@ -1153,15 +1363,15 @@ SLbool SLSceneView::onDoubleClick(SLMouseButton button,
     {   _mouseDownR = false;
       
         SLRay pickRay;
-        if (_camera) 
+        SLRayHit hit;
+        if (_camera && s->root3D()) 
         {   _camera->eyeToPixelRay((SLfloat)x, (SLfloat)y, &pickRay);
-            s->root3D()->hitRec(&pickRay);
-            if(pickRay.hitNode)
-                cout << "NODE HIT: " << pickRay.hitNode->name() << endl;
+            if (SLRayQuery(s->root3D()).raycast(pickRay.origin, pickRay.dir, hit))
+                cout << "NODE HIT: " << hit.node->name() << endl;
         }
       
-        if (pickRay.length < FLT_MAX)
-        {   s->selectNodeMesh(pickRay.hitNode, pickRay.hitMesh);
+        if (hit.node)
+        {   s->selectNodeMesh(hit.node, hit.mesh);
             if (onSelectedNodeMesh)
             onSelectedNodeMesh(s->selectedNode(), s->selectedMesh());
             result = true;
@@ -1437,12 +1647,23 @@ SLbool SLSceneView::onCommand(SLCommand cmd)
         case C_useSceneViewCamera: switchToSceneViewCamera(); return true;
         case C_statsToggle:        _showStats = !_showStats; return true;
         case C_sceneInfoToggle:    _showInfo = !_showInfo; return true;
+        case C_profileToggle:
+            if (SLProfiler::isEnabled())
+            {   static SLint no = 0;
+                SLchar filename[255];
+                sprintf(filename, "SLProfile_%d.json", no++);
+                SLProfiler::stop();
+                SLProfiler::exportChromeTrace(filename);
+            } else SLProfiler::start();
+            return true;
         case C_waitEventsToggle:   _waitEvents = !_waitEvents; return true;
         case C_multiSampleToggle:
             _doMultiSampling = !_doMultiSampling;
             _raytracer.aaSamples(_doMultiSampling ? 3 : 1);
             return true;
         case C_frustCullToggle:    _doFrustumCulling = !_doFrustumCulling; return true;
+        case C_occlCullToggle:     _doOcclusionCulling = !_doOcclusionCulling; return true;
+        case C_clusterLightToggle: _doClusteredLighting = !_doClusteredLighting; return true;
         case C_depthTestToggle:    _doDepthTest = !_doDepthTest; return true;
 
         case C_normalsToggle:      _drawBits.toggle(SL_DB_NORMALS);  return true;
@@ -1463,6 +1684,9 @@ SLbool SLSceneView::onCommand(SLCommand cmd)
         case C_rtContinuously:
             _raytracer.continuous(!_raytracer.continuous());
             return true;
+        case C_rtProgressive:
+            _raytracer.progressive(!_raytracer.progressive());
+            return true;
         case C_rtDistributed:
             _raytracer.distributed(!_raytracer.distributed());
             startRaytracing(5);
@@ -1488,6 +1712,12 @@ SLbool SLSceneView::onCommand(SLCommand cmd)
         case C_pt5000: startPathtracing(5, 5000); return true;
         case C_pt10000: startPathtracing(5, 100000); return true;
         case C_ptSaveImage: _pathtracer.saveImage(); return true;
+        case C_ptSamplerRandom: _pathtracer.samplerType(ST_random); return true;
+        case C_ptSamplerHalton: _pathtracer.samplerType(ST_halton); return true;
+        case C_ptSamplerSobol: _pathtracer.samplerType(ST_sobol); return true;
+        case C_ptSamplerBlueNoise: _pathtracer.samplerType(ST_blueNoise); return true;
+        case C_ptSetReference: _pathtracer.setReference(); return true;
+        case C_ptTestSamplers: SLSampler::testConvergence(); return true;
 
         default: break;
     }
@@ -1593,7 +1823,7 @@ void SLSceneView::rebuild2DMenus(SLbool showAboutFirst)
 //-----------------------------------------------------------------------------
 /*! 
 SLSceneView::build2D builds the GUI menu button tree for the _menuGL and the 
-_menuRT group as well as the _infoGL and _infoRT groups with info texts. 
+_menuRT group. 
 See SLButton and SLText class for more infos. 
 */
 void SLSceneView::build2DMenus()
@@ -1730,6 +1960,9 @@ void SLSceneView::build2DMenus()
     if (_stateGL->hasMultiSampling())
         mn2->addChild(new SLButton(this, "Do Multi Sampling", f, C_multiSampleToggle, true, _doMultiSampling, 0, false));
     mn2->addChild(new SLButton(this, "Do Frustum Culling", f, C_frustCullToggle, true, _doFrustumCulling, 0, false));
+    mn2->addChild(new SLButton(this, "Do Occlusion Culling", f, C_occlCullToggle, true, _doOcclusionCulling, 0, false));
+    if (SLLightClusters::isSupported())
+        mn2->addChild(new SLButton(this, "Do Clustered Lighting", f, C_clusterLightToggle, true, _doClusteredLighting, 0, false));
     mn2->addChild(new SLButton(this, "Do Depth Test", f, C_depthTestToggle, true, _doDepthTest, 0, false));
     mn2->addChild(new SLButton(this, "Animation off", f, C_animationToggle, true, false, 0, false));
 
@@ -1751,6 +1984,7 @@ void SLSceneView::build2DMenus()
     mn2->addChild(new SLButton(this, "Credits", f, C_creditsToggle));
     mn2->addChild(new SLButton(this, "Scene Info", f, C_sceneInfoToggle, true, _showInfo));
     mn2->addChild(new SLButton(this, "Statistics", f, C_statsToggle, true, _showStats));
+    mn2->addChild(new SLButton(this, "Record Profile", f, C_profileToggle, true, SLProfiler::isEnabled()));
 
     mn2 = new SLButton(this, "Renderer >", f);
     mn1->addChild(mn2);
@@ -1779,6 +2013,7 @@ void SLSceneView::build2DMenus()
    
     mn1->addChild(new SLButton(this, "OpenGL Rendering", f, C_renderOpenGL, false, false, 0, true,  0, 0, green));
     mn1->addChild(new SLButton(this, "Render continuously", f, C_rtContinuously, true, _raytracer.continuous(), 0, true,  0, 0, green));
+    mn1->addChild(new SLButton(this, "Render progressively", f, C_rtProgressive, true, _raytracer.progressive(), 0, true,  0, 0, green));
     mn1->addChild(new SLButton(this, "Render parallel distributed", f, C_rtDistributed, true, _raytracer.distributed(), 0, true,  0, 0, green));
     mn1->addChild(new SLButton(this, "Rendering Depth 1", f, C_rt1, false, false, 0, true,  0, 0, green));
     mn1->addChild(new SLButton(this, "Rendering Depth 5", f, C_rt5, false, false, 0, true,  0, 0, green));
@@ -1809,6 +2044,16 @@ void SLSceneView::build2DMenus()
     mn1->addChild(new SLButton(this, "1000 Sample Rays", f, C_pt1000, false, false, 0, true,  0, 0, blue));
     mn1->addChild(new SLButton(this, "5000 Sample Rays", f, C_pt5000, false, false, 0, true,  0, 0, blue));
     mn1->addChild(new SLButton(this, "10000 Sample Rays", f, C_pt10000, false, false, 0, true,  0, 0, blue));
+
+    SLSamplerType st = _pathtracer.samplerType();
+    mn2 = new SLButton(this, "Sampler >", f, C_menu, false, false, 0, true,  0, 0, blue);
+    mn1->addChild(mn2);
+    mn2->addChild(new SLButton(this, "Random", f, C_ptSamplerRandom, true, st==ST_random, mn2, true,  0, 0, blue));
+    mn2->addChild(new SLButton(this, "Halton", f, C_ptSamplerHalton, true, st==ST_halton, mn2, true,  0, 0, blue));
+    mn2->addChild(new SLButton(this, "Sobol", f, C_ptSamplerSobol, true, st==ST_sobol, mn2, true,  0, 0, blue));
+    mn2->addChild(new SLButton(this, "Blue Noise", f, C_ptSamplerBlueNoise, true, st==ST_blueNoise, mn2, true,  0, 0, blue));
+    mn2->addChild(new SLButton(this, "Test Convergence", f, C_ptTestSamplers, false, false, 0, true,  0, 0, blue));
+    mn1->addChild(new SLButton(this, "Set as RMSE Reference", f, C_ptSetReference, false, false, 0, true,  0, 0, blue));
     #ifndef SL_GLES2
     mn1->addChild(new SLButton(this, "Save Image", f, C_ptSaveImage, false, false, 0, true,  0, 0, blue));
     #endif
@@ -1829,13 +2074,12 @@ void SLSceneView::build2DMenus()
 }
 //-----------------------------------------------------------------------------
 /*! 
-SLSceneView::build2DInfoGL builds the _infoGL groups with info texts. 
-See SLButton and SLText class for more infos. 
+SLSceneView::build2DInfoGL builds the GL statistics text in _infoStats. 
+It is drawn with the text batch in SLSceneView::draw2DGLAll. 
 */
 void SLSceneView::build2DInfoGL()
 {
     SLScene* s = SLScene::current;
-    if (s->infoGL()) delete s->infoGL();
    
     // prepare some statistic infos
     SLCamera* cam = camera();
@@ -1867,6 +2111,10 @@ void SLSceneView::build2DInfoGL()
     sprintf(m+strlen(m), "Draw Time 3D: %4.1f ms (%0.0f%%)\\n",  s->draw3DTimesMS().average(), draw3DTimePC);
     sprintf(m+strlen(m), "Draw Time 2D: %4.1f ms (%0.0f%%)\\n",  s->draw2DTimesMS().average(), draw2DTimePC);
     sprintf(m+strlen(m), "Shapes in Frustum: %d\\n", cam->numRendered());
+    if (_doOcclusionCulling)
+        sprintf(m+strlen(m), "Shapes occluded: %d (%u occluder triangles)\\n", _numOccluded, _occlusionCuller.numTriangles());
+    if (_renderType == RT_gl && usesClusteredLighting())
+        sprintf(m+strlen(m), "Clustered lights: %u (max. %u per cluster)\\n", _lightClusters.numLights(), _lightClusters.maxLightsPerCluster());
     sprintf(m+strlen(m), "NO. of drawcalls: %d\\n", SLGLVertexArray::totalDrawCalls);
     sprintf(m+strlen(m), "--------------------------------------------\\n");
     sprintf(m+strlen(m), "OpenGL: %s (%s)\\n", _stateGL->glVersionNO().c_str(), _stateGL->glVersion().c_str());
@@ -1888,30 +2136,33 @@ void SLSceneView::build2DInfoGL()
     sprintf(m+strlen(m), "CPU MB in Tex.: %3.2f\\n", (SLfloat)cpuTexMemoryBytes / 1E6f);
     sprintf(m+strlen(m), "CPU MB in Meshes: %3.2f\\n", (SLfloat)_stats.numBytes / 1E6f);
     sprintf(m+strlen(m), "CPU MB in Voxel.: %3.2f\\n", (SLfloat)_stats.numBytesAccel / 1E6f);
+    sprintf(m+strlen(m), "CPU MB in Pools: %3.2f (%u of %u allocs live)\\n", (SLfloat)_stats.numPoolBytes / 1E6f, _stats.numPoolLive, _stats.numPoolAllocs);
     sprintf(m+strlen(m), "CPU MB in Total: %3.2f\\n", (SLfloat)(cpuTexMemoryBytes + _stats.numBytes + _stats.numBytesAccel) / 1E6f);
-    sprintf(m+strlen(m), "GPU MB in VBO: %4.2f\\n", (SLfloat)SLGLVertexBuffer::totalBufferSize / 1E6f);
+    sprintf(m+strlen(m), "GPU MB in VBO: %4.2f (%4.2f as float)\\n", (SLfloat)SLGLVertexBuffer::totalBufferSize / 1E6f, (SLfloat)SLGLVertexBuffer::totalBufferSizeFloat / 1E6f);
     sprintf(m+strlen(m), "GPU MB in Tex.: %4.2f\\n", (SLfloat)SLGLTexture::numBytesInTextures / 1E6f);
+    sprintf(m+strlen(m), "Tex. budget MB: %4.2f (%u reduced, %u evicted)\\n", (SLfloat)s->texResidency().budget() / 1E6f, s->texResidency().numReduced(), s->texResidency().numEvicted());
     sprintf(m+strlen(m), "GPU MB in Total: %3.2f\\n", (SLfloat)(SLGLVertexBuffer::totalBufferSize + SLGLTexture::numBytesInTextures) / 1E6f);
     sprintf(m+strlen(m), "No. of Voxels/empty: %d / %4.1f%%\\n", _stats.numVoxels, voxelsEmpty);
     sprintf(m+strlen(m), "Avg. & Max. Tria/Voxel: %4.1f / %d\\n", avgTriPerVox, _stats.numVoxMaxTria);
     sprintf(m+strlen(m), "Group & Leaf Nodes: %u / %u\\n", _stats.numGroupNodes, _stats.numLeafNodes);
     sprintf(m+strlen(m), "Meshes & Triangles: %u / %u\\n", _stats.numMeshes, _stats.numTriangles);
+    if (_lodTriangles.size() > 1)
+    {   sprintf(m+strlen(m), "Drawn triangles per LOD:");
+        for (SLuint l=0; l<_lodTriangles.size(); ++l)
+            sprintf(m+strlen(m), " %u", _lodTriangles[l]);
+        sprintf(m+strlen(m), "\\n");
+    }
 
-    SLTexFont* f = SLTexFont::getFont(1.2f, _dpi);
-    SLText* t = new SLText(m, f, SLCol4f::WHITE, (SLfloat)_scrW, 1.0f);
-    t->translate(10.0f, -t->size().y-5.0f, 0.0f, TS_object);
-    s->infoGL(t);
+    _infoStats = m;
 }
 //-----------------------------------------------------------------------------
 /*! 
-SLSceneView::build2DInfoRT builds the _infoRT group with info texts. 
-See SLButton and SLText class for more infos. 
+SLSceneView::build2DInfoRT builds the RT statistics text in _infoStats. 
+It is drawn with the text batch in SLSceneView::draw2DGLAll. 
 */
 void SLSceneView::build2DInfoRT()
 {     
     SLScene* s = SLScene::current;
-    if (s->infoRT()) 
-        delete s->infoRT();
   
     // prepare some statistic infos
     SLCamera* cam = camera();
@@ -1972,10 +2223,7 @@ void SLSceneView::build2DInfoRT()
     sprintf(m+strlen(m), "Avg. Tria./Voxel: %4.1f\\n", avgTriPerVox);
     sprintf(m+strlen(m), "Max. Tria./Voxel: %d", _stats.numVoxMaxTria);
    
-    SLTexFont* f = SLTexFont::getFont(1.2f, _dpi);
-    SLText* t = new SLText(m, f, SLCol4f::WHITE, (SLfloat)_scrW, 1.0f);
-    t->translate(10.0f, -t->size().y-5.0f, 0.0f, TS_object);
-    s->infoRT(t);
+    _infoStats = m;
 }
 //-----------------------------------------------------------------------------
 /*!
@@ -1987,7 +2235,10 @@ void SLSceneView::build2DInfoLoading()
     SLScene* s = SLScene::current;
     if (s->infoLoading()) return;
     SLTexFont* f = SLTexFont::getFont(3, _dpi);
-    SLText* t = new SLText("Loading Scene . . .", f, SLCol4f::WHITE, (SLfloat)_scrW, 1.0f);
+    SLstring loading = "Loading Scene . . .";
+    if (!s->infoLoadingText().empty())
+        loading += " " + s->infoLoadingText();
+    SLText* t = new SLText(loading, f, SLCol4f::WHITE, (SLfloat)_scrW, 1.0f);
     t->translate(10.0f, -t->size().y-5.0f, 0.0f, TS_object);
     t->translate(_scrW*0.5f - t->size().x*0.5f, -(_scrH*0.5f) + t->size().y, 0.0f, TS_object);
     s->infoLoading(t);
@@ -2058,7 +2309,14 @@ SLstring SLSceneView::windowTitle()
         return SLstring("-");
 
     if (_renderType == RT_rt)
-    {   if (_raytracer.continuous())
+    {   if (_raytracer.progressive() && _raytracer.state()!=rtFinished)
+        {   sprintf(title, "%s (1/%d res., %d%%, Threads: %d)", 
+                    s->name().c_str(), 
+                    _raytracer.progBlock(),
+                    _raytracer.pcRendered(), 
+                    _raytracer.numThreads());
+        } else
+        if (_raytracer.continuous())
         {   sprintf(title, "%s (fps: %4.1f, Threads: %d)", 
                     s->name().c_str(), 
                     s->fps(),
@@ -2071,10 +2329,11 @@ SLstring SLSceneView::windowTitle()
         }
     } else
     if (_renderType == RT_pt)
-    {   sprintf(title, "%s (%d%%, Threads: %d)", 
+    {   sprintf(title, "%s (%d%%, Threads: %d, %s)", 
                 s->name().c_str(), 
                 _pathtracer.pcRendered(), 
-                _pathtracer.numThreads());
+                _pathtracer.numThreads(),
+                SLSampler::typeName(_pathtracer.samplerType()));
     } else
     {   SLuint nr = _camera->numRendered() ? _camera->numRendered() : _stats.numNodes;
         if (s->fps() > 5)
@@ -2107,7 +2366,14 @@ prior to the rendering start.
 */
 SLbool SLSceneView::draw3DRT()
 {
+    SL_PROFILE_SCOPE("SLSceneView::draw3DRT");
     SLbool updated = false;
+
+    // Restart a finished progressive RT if the camera got moved
+    if (_raytracer.progressive() && 
+        _raytracer.state()==rtFinished && 
+        _raytracer.viewChanged())
+        _raytracer.state(rtReady);
    
     // if the raytracer not yet got started
     if (_raytracer.state()==rtReady)
@@ -2123,6 +2389,12 @@ SLbool SLSceneView::draw3DRT()
             mesh->updateAccelStruct();
 
         // Start raytracing
+        if (_raytracer.progressive())
+        {   _raytracer.renderProgressive(this);
+
+            // Request a repaint as long as refinement passes are pending
+            updated = _raytracer.state()==rtReady;
+        } else
         if (_raytracer.distributed())
              _raytracer.renderDistrib(this);
         else _raytracer.renderClassic(this);
@@ -2163,6 +2435,7 @@ prior to the rendering start.
 */
 SLbool SLSceneView::draw3DPT()
 {
+    SL_PROFILE_SCOPE("SLSceneView::draw3DPT");
     SLbool updated = false;
    
     // if the pathtracer not yet got started
@@ -757,16 +757,17 @@ void SLScene::onLoad(SLSceneView* sv, SLCommand sceneName)
         light1->attenuation(1,0,0);
 
         SLAssimpImporter importer;
-        SLNode* largeModel = importer.load("PLY/switzerland.ply"
-                                            //,SLProcess_JoinIdenticalVertices
-                                            //|SLProcess_RemoveRedundantMaterials
-                                            //|SLProcess_SortByPType
-                                            //|SLProcess_FindDegenerates
-                                            //|SLProcess_FindInvalidData
-                                            //|SLProcess_SplitLargeMeshes
-                                           );
+        importer.useCache(true);
+        SLNode* largeModel = importer.load("PLY/switzerland.ply",
+                                           true,
+                                           SLProcess_Default
+                                           |SLProcess_SLGenerateLODs);
         largeModel->scaleToCenter(100000.0f);
 
+        // Store the vertex attributes in compact quantized VBOs
+        for (auto mesh : _meshes)
+            mesh->useQuantization(true);
+
         SLNode* scene = new SLNode("Scene");
         scene->addChild(light1);
         if (largeModel) scene->addChild(largeModel);
@@ -1163,6 +1164,11 @@ void SLScene::onLoad(SLSceneView* sv, SLCommand sceneName)
         SLMaterial*  mat  = new SLMaterial("mat1", texC, texN, 0, 0, sp);
 
 
+        // The LOD index sets of the first sphere are reused for all other
+        // spheres. They share the vertex data of their own sphere mesh.
+        vector<SLVuint> lodIndices;
+        SLVfloat lodErrors;
+
         // create spheres around the center sphere
         SLint size = 8;
         for (SLint iZ=-size; iZ<=size; ++iZ)
@@ -1173,6 +1179,9 @@ void SLScene::onLoad(SLSceneView* sv, SLCommand sceneName)
                     SLint res = 30 * SL::testFactor;
                     SLSphere* earth = new SLSphere(0.3f, res, res, "earth", mat);
                     earth->useHalfFloats(false);
+                    if (lodIndices.empty())
+                        earth->simplifyLODs(3, 0.5f, lodIndices, lodErrors);
+                    earth->addLODs(lodIndices, lodErrors);
                     SLNode* sphere = new SLNode(earth);
                     sphere->translate(float(iX), float(iY), float(iZ), TS_object);
                     scene->addChild(sphere);
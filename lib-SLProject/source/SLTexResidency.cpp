@@ -0,0 +1,223 @@
+//#############################################################################
+//  File:      SLTexResidency.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLTexResidency.h>
+
+//-----------------------------------------------------------------------------
+//! NO. of levels a texture may be sharper than its size on screen
+static const SLint  SL_TEXRES_LOD_BIAS = 1;
+//! Max. NO. of textures that get a finer level per frame
+static const SLuint SL_TEXRES_MAX_LOADS = 4;
+//! Wanted level of a texture that was not seen in a frame
+static const SLint  SL_TEXRES_NOT_SEEN = INT_MAX;
+//-----------------------------------------------------------------------------
+SLTexResidency::SLTexResidency()
+{
+    _numTextures = 0;
+    _numEvicted = 0;
+    _frame = 1;
+    _budget = SL_TEXRES_DEFAULT_BUDGET;
+    _unseenFrames = 300;
+    _unseenLevel = 2;
+}
+//-----------------------------------------------------------------------------
+/*!
+Registers a texture and returns its id. The bytes are the GPU bytes at level
+0 including the mipmaps, the size is the max. of its width and height and
+maxLevel is the max. NO. of levels that can be dropped (0 for textures that
+can only be evicted). The texture is not yet resident.
+*/
+SLint SLTexResidency::add(SLGLTexture* texture,
+                          SLuint bytes,
+                          SLint size,
+                          SLint maxLevel)
+{
+    assert(texture);
+
+    SLint id;
+    if (_freeIDs.size())
+    {   id = _freeIDs.back();
+        _freeIDs.pop_back();
+    } else
+    {   id = (SLint)_entries.size();
+        _entries.push_back(SLTexEntry());
+    }
+
+    SLTexEntry& e = _entries[id];
+    e.texture  = texture;
+    e.bytes    = bytes;
+    e.size     = size;
+    e.maxLevel = SL_max(maxLevel, 0);
+    e.level    = -1;
+    e.wanted   = SL_TEXRES_NOT_SEEN;
+    e.lastUsed = _frame;
+    _numTextures++;
+    return id;
+}
+//-----------------------------------------------------------------------------
+//! Unregisters a texture
+void SLTexResidency::remove(SLint id)
+{
+    assert(id >= 0 && id < (SLint)_entries.size() && _entries[id].texture);
+    _entries[id].texture = nullptr;
+    _freeIDs.push_back(id);
+    _numTextures--;
+}
+//-----------------------------------------------------------------------------
+//! Sets the level a texture got uploaded with
+void SLTexResidency::loaded(SLint id, SLint level)
+{
+    SLTexEntry& e = _entries[id];
+    e.level = SL_min(SL_max(level, 0), e.maxLevel);
+    e.lastUsed = _frame;
+}
+//-----------------------------------------------------------------------------
+//! Marks a texture as used in the current frame
+void SLTexResidency::touch(SLint id)
+{
+    _entries[id].lastUsed = _frame;
+}
+//-----------------------------------------------------------------------------
+/*!
+Marks a texture as seen in the current frame with its projected size in
+pixels. The finest wanted level of all uses in a frame wins.
+*/
+void SLTexResidency::use(SLint id, SLfloat screenSize)
+{
+    SLTexEntry& e = _entries[id];
+    e.lastUsed = _frame;
+
+    SLint level = 0;
+    if (screenSize > 0.0f)
+    {   SLfloat ratio = (SLfloat)e.size / screenSize;
+        if (ratio > 1.0f)
+            level = (SLint)floor(log2(ratio)) - SL_TEXRES_LOD_BIAS;
+    }
+    level = SL_min(SL_max(level, 0), e.maxLevel);
+    e.wanted = SL_min(e.wanted, level);
+}
+//-----------------------------------------------------------------------------
+//! Returns the GPU bytes of a texture at a level (0 for level -1)
+SLuint64 SLTexResidency::bytesAt(const SLTexEntry& e, SLint level) const
+{
+    if (level < 0) return 0;
+    return SL_max((SLuint64)e.bytes >> (2*level), (SLuint64)1);
+}
+//-----------------------------------------------------------------------------
+//! Returns the GPU bytes of all resident textures
+SLuint64 SLTexResidency::bytesResident() const
+{
+    SLuint64 bytes = 0;
+    for (auto& e : _entries)
+        if (e.texture) bytes += bytesAt(e, e.level);
+    return bytes;
+}
+//-----------------------------------------------------------------------------
+//! Returns the NO. of resident textures with dropped levels
+SLuint SLTexResidency::numReduced() const
+{
+    SLuint num = 0;
+    for (auto& e : _entries)
+        if (e.texture && e.level > 0) num++;
+    return num;
+}
+//-----------------------------------------------------------------------------
+/*!
+Decides the resident level of all textures at the end of a frame and returns
+the changes. The entries already get the new levels, so the changes must be
+carried out. Afterwards the next frame starts.
+*/
+void SLTexResidency::update(SLVTexResidencyChange& changes)
+{
+    changes.clear();
+    SLuint numEntries = (SLuint)_entries.size();
+    SLVint target(numEntries, -1);
+    SLuint64 total = 0;
+
+    // Target levels without the budget
+    vector<pair<SLint, SLuint>> finer;
+    for (SLuint i = 0; i < numEntries; ++i)
+    {   SLTexEntry& e = _entries[i];
+        if (!e.texture || e.level < 0) continue;
+
+        if (e.lastUsed == _frame)
+        {   target[i] = e.wanted == SL_TEXRES_NOT_SEEN ? e.level : e.wanted;
+            if (target[i] < e.level)
+                finer.push_back(make_pair(target[i], i));
+        }
+        else if (_frame - e.lastUsed > _unseenFrames)
+            target[i] = SL_max(e.level, SL_min(_unseenLevel, e.maxLevel));
+        else target[i] = e.level;
+    }
+
+    // Limit the uploads of finer levels to the most needed ones
+    if (finer.size() > SL_TEXRES_MAX_LOADS)
+    {   std::sort(finer.begin(), finer.end());
+        for (SLuint f = SL_TEXRES_MAX_LOADS; f < finer.size(); ++f)
+            target[finer[f].second] = _entries[finer[f].second].level;
+    }
+
+    for (SLuint i = 0; i < numEntries; ++i)
+        if (target[i] >= 0) total += bytesAt(_entries[i], target[i]);
+
+    if (total > _budget)
+    {
+        // Evict the textures not used in this frame least recently used first
+        vector<pair<SLuint, SLuint>> unused;
+        for (SLuint i = 0; i < numEntries; ++i)
+            if (target[i] >= 0 && _entries[i].lastUsed != _frame)
+                unused.push_back(make_pair(_entries[i].lastUsed, i));
+        std::sort(unused.begin(), unused.end());
+
+        for (auto& u : unused)
+        {   if (total <= _budget) break;
+            total -= bytesAt(_entries[u.second], target[u.second]);
+            target[u.second] = -1;
+        }
+
+        // Drop a level of the largest used textures until they fit
+        priority_queue<pair<SLuint64, SLuint>> largest;
+        for (SLuint i = 0; i < numEntries; ++i)
+            if (target[i] >= 0 && target[i] < _entries[i].maxLevel)
+                largest.push(make_pair(bytesAt(_entries[i], target[i]), i));
+
+        while (total > _budget && !largest.empty())
+        {   SLuint i = largest.top().second;
+            largest.pop();
+            total -= bytesAt(_entries[i], target[i]);
+            target[i]++;
+            total += bytesAt(_entries[i], target[i]);
+            if (target[i] < _entries[i].maxLevel)
+                largest.push(make_pair(bytesAt(_entries[i], target[i]), i));
+        }
+    }
+
+    // Return the changes and start the next frame
+    for (SLuint i = 0; i < numEntries; ++i)
+    {   SLTexEntry& e = _entries[i];
+        if (!e.texture) continue;
+        if (target[i] != e.level)
+        {   SLTexResidencyChange c;
+            c.texture = e.texture;
+            c.level = target[i];
+            changes.push_back(c);
+            if (target[i] < 0) _numEvicted++;
+            e.level = target[i];
+        }
+        e.wanted = SL_TEXRES_NOT_SEEN;
+    }
+    _frame++;
+}
+//-----------------------------------------------------------------------------
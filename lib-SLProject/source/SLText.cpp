@@ -17,6 +17,7 @@
 #include <SLScene.h>
 #include <SLGLProgram.h>
 #include <SLGLState.h>
+#include <SLSceneView.h>
 
 //-----------------------------------------------------------------------------
 /*! 
@@ -37,11 +38,19 @@ SLText::SLText(SLstring text, SLTexFont* font, SLCol4f color,
 }
 //-----------------------------------------------------------------------------
 /*! 
-SLText::shapeDraw draws the text buffer objects
+SLText::shapeDraw draws the text buffer objects. If the text batch of the 
+scene view is open the text is added to it with the current model view matrix
+instead (see SLTextBatch).
 */
 void SLText::drawRec(SLSceneView* sv)
 { 
     if (_drawBits.get(SL_DB_HIDDEN) || !_stateGL->blend()) return;
+
+    if (sv && sv->textBatch()->isOpen())
+    {   sv->textBatch()->add(_font, _text, _color, _maxW, _lineH,
+                             _stateGL->modelViewMatrix);
+        return;
+    }
    
     // create buffer object for text once
     if (!_vao.id())
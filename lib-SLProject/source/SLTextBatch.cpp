@@ -0,0 +1,212 @@
+//#############################################################################
+//  File:      SLTextBatch.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLTextBatch.h>
+#include <SLScene.h>
+#include <SLGLProgram.h>
+#include <SLGLState.h>
+
+//-----------------------------------------------------------------------------
+SLTextBatch::SLTextBatch()
+{
+    _isOpen = false;
+    _needsGenerate = true;
+    _numChars = 0;
+    _numFlushedChars = 0;
+    _numFlushedRuns = 0;
+    _dirtyMin = UINT_MAX;
+    _dirtyMax = 0;
+    _numDrawCalls = 0;
+    _numUploaded = 0;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLTextBatch::begin starts collecting the texts of a new frame. The vertex
+data of the last frame stays in place for the comparison in add.
+*/
+void SLTextBatch::begin()
+{
+    _isOpen = true;
+    _numChars = 0;
+    _numFlushedChars = 0;
+    _numFlushedRuns = 0;
+    _numDrawCalls = 0;
+    _numUploaded = 0;
+    _runs.clear();
+}
+//-----------------------------------------------------------------------------
+/*!
+SLTextBatch::reserve grows the vertex and index vectors to the next power of
+2 that holds numChars characters. The VAO gets regenerated on the next flush.
+*/
+void SLTextBatch::reserve(SLuint numChars)
+{
+    SLuint capacity = (SLuint)_P.size() / 4;
+    if (numChars <= capacity || capacity == SL_TEXTBATCH_MAX_CHARS) return;
+
+    SLuint newCapacity = max(capacity, (SLuint)256);
+    while (newCapacity < numChars) newCapacity *= 2;
+    newCapacity = min(newCapacity, (SLuint)SL_TEXTBATCH_MAX_CHARS);
+
+    _P.resize(newCapacity*4, SLVec3f::ZERO);
+    _Tc.resize(newCapacity*4, SLVec2f::ZERO);
+    _I.resize(newCapacity*6);
+    for (SLuint c=capacity; c<newCapacity; ++c)
+    {   SLushort iV = (SLushort)(c*4);
+        SLuint   iI = c*6;
+        _I[iI  ] = iV;   _I[iI+1] = iV+1; _I[iI+2] = iV+3;
+        _I[iI+3] = iV+1; _I[iI+4] = iV+2; _I[iI+5] = iV+3;
+    }
+    _needsGenerate = true;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLTextBatch::add lays out the text with the same line wrapping as
+SLTexFont::buildTextBuffers and writes its character quads transformed by the
+model view matrix mv to the end of the batch. Only vertices that differ from
+the last upload extend the dirty range. Characters beyond
+SL_TEXTBATCH_MAX_CHARS are skipped.
+*/
+void SLTextBatch::add(SLTexFont* font,
+                      const SLstring& text,
+                      const SLCol4f& color,
+                      SLfloat maxWidth,
+                      SLfloat lineHeight,
+                      const SLMat4f& mv)
+{
+    assert(font);
+    if (!_isOpen || text.empty()) return;
+
+    // Get the character ranges of the lines
+    if (maxWidth > 0.0f)
+        font->wrapTextToLines(text, maxWidth, _lines);
+    else
+    {   _lines.clear();
+        _lines.push_back({0, (SLuint)text.length(), 0});
+    }
+
+    reserve(_numChars + (SLuint)text.length());
+    SLuint capacity = (SLuint)_P.size() / 4;
+
+    // Continue the last run if it has the same font & color
+    if (_runs.size() > _numFlushedRuns &&
+        _runs.back().font == font &&
+        _runs.back().color == color)
+         ; // chars are appended to the last run
+    else _runs.push_back({font, color, _numChars, 0});
+    SLTextBatchRun& run = _runs.back();
+
+    // The 2D model view matrix is affine: p = o + x*ax + y*ay
+    SLVec3f o  = mv * SLVec3f(0,0,0);
+    SLVec3f ax = mv * SLVec3f(1,0,0) - o;
+    SLVec3f ay = mv * SLVec3f(0,1,0) - o;
+
+    SLfloat h = (SLfloat)font->charsHeight;
+    SLfloat y = (SLfloat)(_lines.size()-1) * h * lineHeight;
+
+    for (auto& line : _lines)
+    {   SLfloat x = 0.0f;
+        SLuint numLineChars = line.last > line.first ? line.last - line.first : 0;
+
+        for (SLuint i=0; i<numLineChars+line.numBlanks; ++i)
+        {   if (_numChars >= capacity) return;
+
+            SLuchar c = i < numLineChars ? (SLuchar)text[line.first+i] : ' ';
+            SLTexFont::SLTexFontChar& fc = font->chars[c];
+            SLfloat w = fc.width;
+
+            SLVec3f P[4] = {o + ax*x     + ay*y,
+                            o + ax*(x+w) + ay*y,
+                            o + ax*(x+w) + ay*(y+h),
+                            o + ax*x     + ay*(y+h)};
+            SLVec2f T[4] = {SLVec2f(fc.tx1, fc.ty2),
+                            SLVec2f(fc.tx2, fc.ty2),
+                            SLVec2f(fc.tx2, fc.ty1),
+                            SLVec2f(fc.tx1, fc.ty1)};
+
+            SLuint iV = _numChars*4;
+            for (SLuint k=0; k<4; ++k)
+            {   if (_P[iV+k] != P[k] || _Tc[iV+k] != T[k])
+                {   _P[iV+k]  = P[k];
+                    _Tc[iV+k] = T[k];
+                    _dirtyMin = min(_dirtyMin, iV+k);
+                    _dirtyMax = max(_dirtyMax, iV+k+1);
+                }
+            }
+
+            _numChars++;
+            run.num++;
+            x += w;
+        }
+        y -= h * lineHeight;
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+SLTextBatch::flush uploads the dirty vertex range and draws all runs that
+were added since the last flush with one draw call per run.
+*/
+void SLTextBatch::flush()
+{
+    if (_numChars == _numFlushedChars) return;
+
+    SLGLProgram* sp = SLScene::current->programs(SP_fontTex);
+    sp->useProgram();
+
+    if (_needsGenerate)
+    {   _vao.clearAttribs();
+        _vao.setAttrib(AT_position, sp->getAttribLocation("a_position"), &_P);
+        _vao.setAttrib(AT_texCoord, sp->getAttribLocation("a_texCoord"), &_Tc);
+        _vao.setIndices(&_I);
+        _vao.generate((SLuint)_P.size(), BU_dynamic, false);
+        _numUploaded += (SLuint)_P.size() / 4;
+        _needsGenerate = false;
+    }
+    else if (_dirtyMin < _dirtyMax)
+    {   SLuint numVertices = _dirtyMax - _dirtyMin;
+        _vao.updateAttrib(AT_position, 3, &_P[0],  _dirtyMin, numVertices);
+        _vao.updateAttrib(AT_texCoord, 2, &_Tc[0], _dirtyMin, numVertices);
+        _numUploaded += (numVertices + 3) / 4;
+    }
+    _dirtyMin = UINT_MAX;
+    _dirtyMax = 0;
+
+    // The vertices are already in view space
+    SLGLState* state = SLGLState::getInstance();
+    sp->uniformMatrix4fv("u_mvpMatrix", 1, (SLfloat*)state->projectionMatrix.m());
+    sp->uniform1i("u_texture0", 0);
+
+    for (SLuint r=_numFlushedRuns; r<_runs.size(); ++r)
+    {   SLTextBatchRun& run = _runs[r];
+        if (!run.num) continue;
+        run.font->bindActive();
+        sp->uniform4fv("u_textColor", 1, (SLfloat*)&run.color);
+        _vao.drawElementsAs(PT_triangles,
+                            run.num*6,
+                            run.first*6);
+        _numDrawCalls++;
+    }
+
+    _numFlushedChars = _numChars;
+    _numFlushedRuns = (SLuint)_runs.size();
+}
+//-----------------------------------------------------------------------------
+//! SLTextBatch::end draws the remaining texts and stops collecting
+void SLTextBatch::end()
+{
+    flush();
+    _isOpen = false;
+}
+//-----------------------------------------------------------------------------
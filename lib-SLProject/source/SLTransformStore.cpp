@@ -0,0 +1,244 @@
+//#############################################################################
+//  File:      SLTransformStore.cpp
+//  Author:    Marcus Hudritsch
+//  Date:      October 2016
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/Coding-Style-Guidelines
+//  Copyright: Marcus Hudritsch
+//             This software is provide under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <stdafx.h>           // precompiled headers
+#ifdef SL_MEMLEAKDETECT       // set in SL.h for debug config only
+#include <debug_new.h>        // memory leak detector
+#endif
+
+#include <SLTransformStore.h>
+#include <SLNode.h>
+
+//-----------------------------------------------------------------------------
+//! Min. NO. of nodes in a depth level to update them with additional threads
+static const SLuint SL_TRANSFORM_MIN_PARALLEL = 4096;
+//! NO. of nodes a thread updates at once
+static const SLuint SL_TRANSFORMS_PER_JOB = 512;
+//-----------------------------------------------------------------------------
+SLTransformStore::SLTransformStore()
+{
+    _root = nullptr;
+    _numUpdated = 0;
+}
+//-----------------------------------------------------------------------------
+SLTransformStore::~SLTransformStore()
+{
+    invalidate();
+}
+//-----------------------------------------------------------------------------
+/*!
+Flattens the scenegraph below the root in breadth first order. Nothing is
+done if the store is still valid for this root. After the build all nodes are
+flagged dirty, so that the next update computes all world matrices.
+*/
+void SLTransformStore::build(SLNode* root)
+{
+    if (root == _root) return;
+    invalidate();
+    if (!root) return;
+
+    SL_PROFILE_SCOPE("SLTransformStore::build");
+
+    _nodes.push_back(root);
+    _parents.push_back(-1);
+    _levels.push_back(0);
+
+    // Append the children of each node in breadth first order
+    SLuint levelEnd = 1;
+    for (SLuint s = 0; s < _nodes.size(); ++s)
+    {   if (s == levelEnd)
+        {   _levels.push_back(s);
+            levelEnd = (SLuint)_nodes.size();
+        }
+        SLNode* node = _nodes[s];
+        _firstChild.push_back((SLuint)_nodes.size());
+        _numChildren.push_back((SLuint)node->_children.size());
+        for (auto child : node->_children)
+        {   _nodes.push_back(child);
+            _parents.push_back((SLint)s);
+        }
+    }
+    _levels.push_back((SLuint)_nodes.size());
+
+    SLuint numNodes = (SLuint)_nodes.size();
+    _world.resize(numNodes);
+    _worldI.resize(numNodes);
+    _marked.assign(numNodes, 0);
+
+    for (SLuint s = 0; s < numNodes; ++s)
+    {   SLNode* node = _nodes[s];
+        node->_store = this;
+        node->_slot = (SLint)s;
+        if (!node->_isAABBUpToDate)
+            _dirtyAABB.push_back(s);
+    }
+
+    // The root covers all nodes of the first update
+    _dirty.push_back(0);
+    _root = root;
+}
+//-----------------------------------------------------------------------------
+/*!
+Detaches all nodes from the store. Pending world matrix updates are done
+before, so the nodes are up to date for their lazy updates. The pending AABB
+updates stay flagged in the nodes.
+*/
+void SLTransformStore::invalidate()
+{
+    if (!_root) return;
+
+    updateWorld();
+
+    for (auto node : _nodes)
+    {   node->_store = nullptr;
+        node->_slot = -1;
+    }
+
+    _root = nullptr;
+    _nodes.clear();
+    _parents.clear();
+    _firstChild.clear();
+    _numChildren.clear();
+    _levels.clear();
+    _world.clear();
+    _worldI.clear();
+    _dirty.clear();
+    _dirtyAABB.clear();
+    _work.clear();
+    _marked.clear();
+}
+//-----------------------------------------------------------------------------
+/*!
+Updates the world matrices of the nodes in the range [first, end) of _work
+and writes them back to the nodes. All parents are already up to date.
+*/
+void SLTransformStore::updateSlots(SLuint first, SLuint end)
+{
+    for (SLuint i = first; i < end; ++i)
+    {   SLuint  s = _work[i];
+        SLint   p = _parents[s];
+        SLNode* node = _nodes[s];
+
+        if (p >= 0)
+            _world[s].setMatrix(_world[p] * node->_om);
+        else if (node->_parent)
+            _world[s].setMatrix(node->_parent->updateAndGetWM() * node->_om);
+        else
+            _world[s].setMatrix(node->_om);
+
+        _worldI[s].setMatrix(_world[s].inverse());
+
+        node->_wm.setMatrix(_world[s]);
+        node->_wmI.setMatrix(_worldI[s]);
+        node->_wmN.setMatrix(_world[s].mat3());
+        node->_isWMUpToDate = true;
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+Updates the world matrices of all dirty nodes and their subtrees. The dirty
+slots are expanded to their subtrees and sorted into depth order. Each depth
+level is then updated in one linear pass. Large levels are split into jobs for
+SL::maxThreads() threads. Finally the AABBs of all updated nodes get flagged.
+*/
+void SLTransformStore::updateWorld()
+{
+    if (_dirty.empty()) return;
+
+    SL_PROFILE_SCOPE("SLTransformStore::updateWorld");
+
+    // Collect the dirty slots and all their descendants once
+    _work.clear();
+    for (auto s : _dirty)
+    {   if (!_marked[s])
+        {   _marked[s] = 1;
+            _work.push_back(s);
+        }
+    }
+    _dirty.clear();
+
+    for (SLuint i = 0; i < _work.size(); ++i)
+    {   SLuint s = _work[i];
+        SLuint end = _firstChild[s] + _numChildren[s];
+        for (SLuint c = _firstChild[s]; c < end; ++c)
+        {   if (!_marked[c])
+            {   _marked[c] = 1;
+                _work.push_back(c);
+            }
+        }
+    }
+
+    // Slot order is depth order
+    std::sort(_work.begin(), _work.end());
+
+    // Update level by level since all nodes of a level are independent
+    SLuint numWork = (SLuint)_work.size();
+    SLuint first = 0;
+    SLuint level = 0;
+    while (first < numWork)
+    {   while (_levels[level+1] <= _work[first]) level++;
+
+        SLuint end = first;
+        while (end < numWork && _work[end] < _levels[level+1]) end++;
+
+        SLuint numSlots = end - first;
+        SLuint numThreads = numSlots < SL_TRANSFORM_MIN_PARALLEL ? 1 :
+                            SL_min(SL::maxThreads(), numSlots / SL_TRANSFORMS_PER_JOB + 1);
+        if (numThreads <= 1)
+            updateSlots(first, end);
+        else
+        {   atomic<SLuint> nextSlot(first);
+            auto runJobs = [&]()
+            {   for (SLuint i = nextSlot.fetch_add(SL_TRANSFORMS_PER_JOB);
+                     i < end;
+                     i = nextSlot.fetch_add(SL_TRANSFORMS_PER_JOB))
+                    updateSlots(i, SL_min(i + SL_TRANSFORMS_PER_JOB, end));
+            };
+
+            // Start additional threads and do the same work in the main thread
+            vector<thread> threads;
+            for (SLuint t=0; t < numThreads-1; t++)
+                threads.push_back(thread(runJobs));
+            runJobs();
+            for(auto& thread : threads) thread.join();
+        }
+        first = end;
+    }
+
+    // The AABB of a moved node and of all its parents must be updated
+    for (auto s : _work)
+    {   _marked[s] = 0;
+        _nodes[s]->needAABBUpdate();
+    }
+
+    _numUpdated = numWork;
+}
+//-----------------------------------------------------------------------------
+/*!
+Updates all world matrices and then all flagged AABBs in reverse slot order,
+so that the children are always done before their parents.
+*/
+void SLTransformStore::update()
+{
+    updateWorld();
+
+    if (_dirtyAABB.empty()) return;
+
+    SL_PROFILE_SCOPE("SLTransformStore::update AABBs");
+
+    std::sort(_dirtyAABB.begin(), _dirtyAABB.end(), std::greater<SLuint>());
+    for (auto s : _dirtyAABB)
+    {   SLNode* node = _nodes[s];
+        if (!node->_isAABBUpToDate)
+            node->updateAABBRec();
+    }
+    _dirtyAABB.clear();
+}
+//-----------------------------------------------------------------------------
@@ -86,15 +86,33 @@ void SLCurveBezier::init(const SLVVec4f& points,
             _controls[i] = controlPoints[i];
     }
 
-    // set up curve segment lengths
+    buildArcLengthTable();
+}
+//-----------------------------------------------------------------------------
+/*!
+SLCurveBezier::buildArcLengthTable calculates the segment lengths and the arc
+length from the curve start at SL_BEZIER_ARCLEN_SAMPLES+1 equidistant
+parameters u per segment. The last entry of a segment is equal to the first
+entry of the next segment, so the whole table is ascending.
+*/
+void SLCurveBezier::buildArcLengthTable()
+{
+    const SLuint N = SL_BEZIER_ARCLEN_SAMPLES;
+    SLuint numSegments = (SLuint)_points.size()-1;
+
     _lengths.clear();
-    _lengths.resize(_points.size()-1);
+    _lengths.resize(numSegments);
+    _arcLengths.clear();
+    _arcLengths.resize(numSegments*(N+1));
     _totalLength = 0.0f;
 
-    _totalLength = 0.0f;
-    for (SLuint i = 0; i < _points.size()-1; ++i)
-    {   _lengths[i] = segmentArcLength(i, 0.0f, 1.0f);
-        _totalLength += _lengths[i];
+    for (SLuint i = 0; i < numSegments; ++i)
+    {   SLfloat* table = &_arcLengths[i*(N+1)];
+        table[0] = _totalLength;
+        for (SLuint k = 0; k < N; ++k)
+            table[k+1] = table[k] + segmentArcLength(i, (SLfloat)k/N, (SLfloat)(k+1)/N);
+        _lengths[i] = table[N] - table[0];
+        _totalLength = table[N];
     }
 }
 //-----------------------------------------------------------------------------
@@ -178,6 +196,7 @@ void SLCurveBezier::dispose()
 {
     _points.clear();   
     _lengths.clear();
+    _arcLengths.clear();
     _totalLength = 0.0f;
 }
 //-------------------------------------------------------------------------------
@@ -193,10 +212,7 @@ SLVec3f SLCurveBezier::evaluate(const SLfloat t)
     if (t >= _points[_points.size()-1].w) return _points[_points.size()-1].vec3();
 
     // find segment and parameter
-    unsigned int i;
-    for (i = 0; i < _points.size()-1; ++i)
-        if (t < _points[i+1].w) 
-            break;
+    SLuint i = findSegment(t);
 
     SLfloat t0 = _points[i].w;
     SLfloat t1 = _points[i+1].w;
@@ -232,16 +248,21 @@ SLVec3f SLCurveBezier::velocity(SLfloat t)
         return _points[_points.size()-1].vec3();
 
     // find segment and parameter
-    unsigned int i;
-    for (i = 0; i < _points.size()-1; ++i)
-        if (t < _points[i+1].w)
-            break;
+    SLuint i = findSegment(t);
 
     SLfloat t0 = _points[i].w;
     SLfloat t1 = _points[i+1].w;
     SLfloat u  = (t - t0)/(t1 - t0);
 
-    // evaluate
+    return segmentVelocity(i, u);
+}
+//-------------------------------------------------------------------------------
+/*!
+SLCurveBezier::segmentVelocity returns the first derivative of segment i at
+the segment parameter u.
+*/
+SLVec3f SLCurveBezier::segmentVelocity(SLuint i, SLfloat u)
+{
     SLVec3f A = _points[i+1].vec3()
                 - 3.0f*_controls[2*i+1]
                 + 3.0f*_controls[2*i]
@@ -253,7 +274,24 @@ SLVec3f SLCurveBezier::velocity(SLfloat t)
                 - 3.0f*_points[i].vec3();
     
     return C + u*(B + 3.0f*u*A);
-
+}
+//-------------------------------------------------------------------------------
+/*!
+SLCurveBezier::findSegment returns the index i of the segment with
+_points[i].w <= t < _points[i+1].w by binary search. t must be within the
+time range of the curve.
+*/
+SLuint SLCurveBezier::findSegment(SLfloat t)
+{
+    SLuint lo = 0;
+    SLuint hi = (SLuint)_points.size()-1;
+    while (hi - lo > 1)
+    {   SLuint mid = (lo + hi) / 2;
+        if (t < _points[mid].w)
+             hi = mid;
+        else lo = mid;
+    }
+    return lo;
 }
 //-------------------------------------------------------------------------------
 /*!
@@ -271,9 +309,7 @@ SLVec3f SLCurveBezier::acceleration(SLfloat t)
         return _points[_points.size()-1].vec3();
 
     // find segment and parameter
-    unsigned int i;
-    for (i = 0; i < _points.size()-1; ++i)
-        if (t < _points[i+1].w) break;
+    SLuint i = findSegment(t);
 
     SLfloat t0 = _points[i].w;
     SLfloat t1 = _points[i+1].w;
@@ -294,30 +330,49 @@ SLVec3f SLCurveBezier::acceleration(SLfloat t)
 //-------------------------------------------------------------------------------
 /*!
 SLCurveBezier::findParamByDist gets parameter s distance in arc length from Q(t1).
-Returns max SLfloat if can't find it.
+The table interval that contains the target arc length is found by binary
+search and inverted linearly. One Newton-Raphson step on the exact length
+within the interval refines the parameter. Returns the time of the last point
+if the distance reaches beyond the curve end.
 */
 SLfloat SLCurveBezier::findParamByDist(SLfloat t1, SLfloat s)
 {
+    const SLuint N = SL_BEZIER_ARCLEN_SAMPLES;
+    SLuint numSegments = (SLuint)_points.size()-1;
+
     // ensure that we remain within valid parameter space
-    if (s > arcLength(t1, _points[_points.size()-1].w))
-        return _points[_points.size()-1].w;
-
-    // make first guess
-    SLfloat p = t1 + s*(_points[_points.size()-1].w-_points[0].w)/_totalLength;
-    for (SLuint i = 0; i < 32; ++i)
-    {
-        // compute function value and test against zero
-        SLfloat func = arcLength(t1, p) - s;
-        if (SL_abs(func) < 1.0e-03f) return p;
-
-        // perform Newton-Raphson iteration step
-        SLfloat speed = velocity(p).length();
-        assert(SL_abs(speed) > FLT_EPSILON);
-        p -= func/speed;
+    SLfloat target = arcLengthTo(t1) + s;
+    if (target >= _totalLength) return _points[numSegments].w;
+    if (target <= 0.0f) return _points[0].w;
+
+    // find the last table entry that is not greater than the target
+    SLuint j = (SLuint)(upper_bound(_arcLengths.begin(),
+                                    _arcLengths.end(),
+                                    target) - _arcLengths.begin()) - 1;
+    SLuint i = j / (N+1);
+    SLuint k = j % (N+1);
+    if (k == N)
+    {   if (i < numSegments-1) {i++; k = 0;}
+        else k = N-1;
+    }
+
+    // invert the table interval linearly
+    SLfloat* table = &_arcLengths[i*(N+1)];
+    SLfloat  ds = table[k+1] - table[k];
+    SLfloat  uMin = (SLfloat)k/N;
+    SLfloat  uMax = (SLfloat)(k+1)/N;
+    SLfloat  u = uMin;
+    if (ds > FLT_EPSILON)
+        u += (target - table[k]) / ds / N;
+
+    // perform one Newton-Raphson step with the exact length
+    SLfloat speed = segmentVelocity(i, u).length();
+    if (speed > FLT_EPSILON)
+    {   SLfloat func = table[k] + segmentArcLength(i, uMin, u) - target;
+        u = SL_clamp(u - func/speed, uMin, uMax);
     }
 
-    // done iterating, return failure case
-    return FLT_MAX;
+    return _points[i].w + u*(_points[i+1].w - _points[i].w);
 }
 //-------------------------------------------------------------------------------
 /*! 
@@ -326,39 +381,26 @@ Calculate length of curve between parameters t1 and t2
 SLfloat SLCurveBezier::arcLength(SLfloat t1, SLfloat t2)
 {
     if (t2 <= t1) return 0.0f;
-    if (t1 < _points[0].w) t1 = _points[0].w;
-    if (t2 > _points[_points.size()-1].w) t2 = _points[_points.size()-1].w;
-
-    // find segment and parameter
-    unsigned int seg1;
-    for (seg1 = 0; seg1 < _points.size()-1; ++seg1)
-        if (t1 < _points[seg1+1].w)
-            break;
-
-    SLfloat u1 = (t1 - _points[seg1].w)/(_points[seg1+1].w - _points[seg1].w);
-    
-    // find segment and parameter
-    unsigned int seg2;
-    for (seg2 = 0; seg2 < _points.size()-1; ++seg2)
-    if (t2 <= _points[seg2+1].w)
-        break;
+    return arcLengthTo(t2) - arcLengthTo(t1);
+}
+//-------------------------------------------------------------------------------
+/*!
+SLCurveBezier::arcLengthTo returns the arc length from the curve start to the
+parameter t. The table gives the length up to the table parameter below t.
+Only the short rest is measured by subdivision.
+*/
+SLfloat SLCurveBezier::arcLengthTo(SLfloat t)
+{
+    const SLuint N = SL_BEZIER_ARCLEN_SAMPLES;
 
-    SLfloat u2 = (t2 - _points[seg2].w)/(_points[seg2+1].w - _points[seg2].w);
-    
-    // both parameters lie in one segment
-    SLfloat result;
-    if (seg1 == seg2)
-    result = segmentArcLength(seg1, u1, u2);
+    if (t <= _points[0].w) return 0.0f;
+    if (t >= _points[_points.size()-1].w) return _totalLength;
 
-    // parameters cross segments
-    else
-    {   result = segmentArcLength(seg1, u1, 1.0f);
-        for (SLuint i = seg1+1; i < seg2; ++i)
-            result += _lengths[i];
-        result += segmentArcLength(seg2, 0.0f, u2);
-    }
+    SLuint  i = findSegment(t);
+    SLfloat u = (t - _points[i].w)/(_points[i+1].w - _points[i].w);
+    SLuint  k = min((SLuint)(u*N), N-1);
 
-    return result;
+    return _arcLengths[i*(N+1)+k] + segmentArcLength(i, (SLfloat)k/N, u);
 }
 //-------------------------------------------------------------------------------
 /*!
@@ -387,6 +429,8 @@ SLfloat SLCurveBezier::segmentArcLength(SLuint  i, SLfloat u1, SLfloat u2)
     SLVec3f L3 = minus_u2*L2 + u2*(minus_u2*H + u2*(minus_u2*P2 + u2*P3));
 
     // resubdivide to get control points for subcurve between u1 and u2
+    // u1 is relative to the subcurve from 0.0 to u2
+    u1 /= u2;
     SLfloat minus_u1 = (1.0f - u1);
     H = minus_u1*L1 + u1*L2;
     SLVec3f R3 = L3;